@@ -33,6 +33,9 @@
 #include "StelActionMgr.hpp"
 #include "StelApp.hpp"
 #include "StelCore.hpp"
+#include "StelEphemerisSession.hpp"
+#include "StelEventFinder.hpp"
+#include "StelEventFunctions.hpp"
 #include "StelFader.hpp"
 #include "StelFileMgr.hpp"
 #include "StelGui.hpp"
@@ -51,6 +54,27 @@
 #include "ZoneArray.hpp"
 
 
+namespace
+{
+	// Module of the vector product of the Heliocentric Ecliptic Coordinates of the observer
+	// and of the Moon (projected over the Ecliptic plane). It is zero at New and Full Moon.
+	class LunarPhaseFunction : public StelEventFinder::Function
+	{
+	public:
+		LunarPhaseFunction(StelEphemerisSession& session, const PlanetP& moon) : session(session), moon(moon) {}
+		virtual double value(double JD)
+		{
+			session.setJD(JD);
+			Vec3d earthPos = session.getObserverHeliocentricEclipticPos();
+			Vec3d moonPos = session.getHeliocentricEclipticPos(moon);
+			return moonPos[0]*earthPos[1] - moonPos[1]*earthPos[0];
+		}
+	private:
+		StelEphemerisSession& session;
+		PlanetP moon;
+	};
+}
+
 StelModule* ObservabilityStelPluginInterface::getStelModule() const
 {
 	return new Observability();
@@ -103,8 +127,6 @@ Observability::Observability()
 	, MoonSet(0.)
 	, MoonCulm(0.)	
 	, lastJDMoon(0.)	
-	, ObserverLoc(0.)
-	, myPlanet(Q_NULLPTR)
 	, nDays(0)
 	, dmyFormat(false)
 	, hasRisen(false)
@@ -133,13 +155,9 @@ Observability::Observability()
 	isSun = false;
 	isScreen = true;
 
-	//Get pointer to the Earth:
-	PlanetP Earth = GETSTELMODULE(SolarSystem)->getEarth();
-	myEarth = Earth.data();
-
-	// Get pointer to the Moon/Sun:
-	PlanetP Moon = GETSTELMODULE(SolarSystem)->getMoon();
-	myMoon = Moon.data();
+	// Get pointers to the Sun and Moon:
+	mySun = GETSTELMODULE(SolarSystem)->getSun();
+	myMoon = GETSTELMODULE(SolarSystem)->getMoon();
 
 	// I think this can be done in a more simple way...--BM
 	for (int i=0;i<366;i++) {
@@ -285,7 +303,6 @@ void Observability::draw(StelCore* core)
 // Get current date, location, and check if there is something selected.
 	double currlat = (core->getCurrentLocation().latitude)/Rad2Deg;
 	double currlon = (core->getCurrentLocation().longitude)/Rad2Deg;
-	double currheight = (6371.+(core->getCurrentLocation().altitude)/1000.)/UA;
 	double currJD = core->getJD();
 	double currJDint;
 	GMTShift = core->getUTCOffset(currJD)/24.0;
@@ -328,10 +345,6 @@ void Observability::draw(StelCore* core)
 	{
 		locChanged = true;
 		mylat = currlat; mylon = currlon;
-		double temp1 = currheight*std::cos(currlat);
-		ObserverLoc[0] = temp1*std::cos(currlon);
-		ObserverLoc[1] = temp1*std::sin(currlon);
-		ObserverLoc[2] = currheight*std::sin(currlat);
 	};
 
 
@@ -440,7 +453,7 @@ void Observability::draw(StelCore* core)
 				}
 				
 			// Now get a pointer to the planet's instance:
-				myPlanet = ssObject.data();
+				myPlanet = ssObject;
 			}
 		}
 	}
@@ -1010,18 +1023,16 @@ QString Observability::formatAsDateRange(int startDay, int endDay)
 // Compute planet's position for each day of the current year:
 void Observability::updatePlanetData(StelCore *core)
 {
+	StelEphemerisSession session(core);
 	double tempH;
 	for (int i=0; i<nDays; i++)
 	{
-		getPlanetCoords(core, yearJD[i], objectRA[i], objectDec[i], false);
+		getPlanetCoords(session, yearJD[i], objectRA[i], objectDec[i]);
 		tempH = calculateHourAngle(mylat, refractedHorizonAlt, objectDec[i]);
 		objectH0[i] = tempH;
 		objectSidT[0][i] = toUnsignedRA(objectRA[i]-tempH);
 		objectSidT[1][i] = toUnsignedRA(objectRA[i]+tempH);
 	}
-
-// Return the planet to its current time:
-	getPlanetCoords(core, myJD, objectRA[0], objectDec[0], true);
 }
 
 /////////////////////////////////////////////////
@@ -1041,22 +1052,17 @@ void Observability::updateSunData(StelCore* core)
 	nDays = (year==sameYear)?366:365;
 	
 // Compute Earth's position throughout the year:
-	Vec3d pos, sunPos;
+	StelEphemerisSession session(core);
+	Vec3d sunPos;
 	for (int i=0; i<nDays; i++)
 	{
 		yearJD[i].first = Jan1stJD + (double)i;
 		yearJD[i].second = yearJD[i].first+core->computeDeltaT(yearJD[i].first)/86400.0;
-		myEarth->computePosition(yearJD[i].second);
-		myEarth->computeTransMatrix(yearJD[i].first, yearJD[i].second);
-		pos = myEarth->getHeliocentricEclipticPos();
-		sunPos = core->j2000ToEquinoxEqu((StelCore::matVsop87ToJ2000)*(-pos), StelCore::RefractionOff);
-		EarthPos[i] = -pos;
+		session.setJD(yearJD[i].first);
+		sunPos = session.getEquinoxEquatorialPos(mySun);
+		EarthPos[i] = -session.getObserverHeliocentricEclipticPos();
 		toRADec(sunPos,sunRA[i],sunDec[i]);
 	};
-
-//Return the Earth to its current time:
-	myEarth->computePosition(myJD.second);
-	myEarth->computeTransMatrix(myJD.first, myJD.second);
 }
 ///////////////////////////////////////////////////
 
@@ -1106,22 +1112,23 @@ bool Observability::CheckRise(int day)
 	if (sunSidT[0][day]<0.0 || sunSidT[1][day]<0.0)
 		return false;
 
-	// Iterate over the whole year:
-	int nBin = 1000;
+	if (objectH0[day] < 0.0 && alti>0.0)
+		return true;
+
+	// The night spans the sidereal times from sunSidT[1] to sunSidT[0]. The source is observable
+	// if its hour angle is within objectH0 at some time of the night, i.e. if its RA is closer
+	// than objectH0 to that interval:
 	double auxSid1 = sunSidT[0][day];
 	auxSid1 += (sunSidT[0][day] < sunSidT[1][day]) ? 24.0 : 0.0;
-	double deltaT = (auxSid1-sunSidT[1][day]) / ((double)nBin);
+	double nightLength = auxSid1-sunSidT[1][day];
 
-	double hour; 
-	for (int j=0; j<nBin; j++)
-	{
-		hour = toUnsignedRA(sunSidT[1][day]+deltaT*(double)j - objectRA[day]);
-		hour -= (hour>12.) ? 24.0 : 0.0;
-		if (qAbs(hour)<objectH0[day] || (objectH0[day] < 0.0 && alti>0.0))
-			return true;
-	}
+	double distance = toUnsignedRA(objectRA[day] - sunSidT[1][day]);
+	if (distance <= nightLength)
+		distance = 0.0;
+	else
+		distance = qMin(distance-nightLength, 24.0-distance);
 
-	return false;
+	return distance<objectH0[day];
 }
 ///////////////////////////////////////////
 
@@ -1273,89 +1280,12 @@ double Observability::sign(double d)
 
 
 
-//////////////////////////
-// Get the coordinates of Sun or Moon for a given JD:
-// getBack controls whether Earth and Moon must be returned to their original positions after computation.
-void Observability::getSunMoonCoords(StelCore *core, QPair<double, double> JD,
-				     double &raSun, double &decSun,
-				     double &raMoon, double &decMoon,
-				     double &eclLon, bool getBack)
-                                     //, Vec3d &AltAzVector)
-{
-
-	if (getBack) // Return the Moon and Earth to their current position:
-	{
-		myEarth->computePosition(JD.second);
-		myEarth->computeTransMatrix(JD.first, JD.second);
-		myMoon->computePosition(JD.second);
-		myMoon->computeTransMatrix(JD.first, JD.second);
-	} 
-	else // Compute coordinates:
-	{
-		myEarth->computePosition(JD.second);
-		myEarth->computeTransMatrix(JD.first, JD.second);
-		Vec3d earthPos = myEarth->getHeliocentricEclipticPos();
-		double curSidT;
-
-// Sun coordinates:
-		Vec3d sunPos = core->j2000ToEquinoxEqu((StelCore::matVsop87ToJ2000)*(-earthPos), StelCore::RefractionOff);
-		toRADec(sunPos, raSun, decSun);
-
-// Moon coordinates:
-		curSidT = myEarth->getSiderealTime(JD.first, JD.second)/Rad2Deg;
-		RotObserver = (Mat4d::zrotation(curSidT))*ObserverLoc;
-		LocTrans = (StelCore::matVsop87ToJ2000)*(Mat4d::translation(-earthPos));
-		myMoon->computePosition(JD.second);
-		myMoon->computeTransMatrix(JD.first, JD.second);
-		Vec3d moonPos = myMoon->getHeliocentricEclipticPos();
-		sunPos = (core->j2000ToEquinoxEqu(LocTrans*moonPos, StelCore::RefractionOff))-RotObserver;
-		
-		eclLon = moonPos[0]*earthPos[1] - moonPos[1]*earthPos[0];
-
-		toRADec(sunPos,raMoon,decMoon);
-	};
-}
-//////////////////////////////////////////////
-
-
-
 //////////////////////////
 // Get the Observer-to-Moon distance JD:
-// getBack controls whether Earth and Moon must be returned to their original positions after computation.
-void Observability::getMoonDistance(StelCore *core, QPair<double, double> JD, double &distance, bool getBack)
+void Observability::getMoonDistance(StelEphemerisSession &session, QPair<double, double> JD, double &distance)
 {
-
-	if (getBack) // Return the Moon and Earth to their current position:
-	{
-		myEarth->computePosition(JD.second);
-		myEarth->computeTransMatrix(JD.first, JD.second);
-		myMoon->computePosition(JD.second);
-		myMoon->computeTransMatrix(JD.first, JD.second);
-	} 
-	else
-	{	// Compute coordinates:
-		myEarth->computePosition(JD.second);
-		myEarth->computeTransMatrix(JD.first, JD.second);
-		Vec3d earthPos = myEarth->getHeliocentricEclipticPos();
-//		double curSidT;
-
-// Sun coordinates:
-//		Pos2 = core->j2000ToEquinoxEqu((core->matVsop87ToJ2000)*(-Pos0));
-//		toRADec(Pos2,RASun,DecSun);
-
-// Moon coordinates:
-//		curSidT = myEarth->getSiderealTime(JD)/Rad2Deg;
-//		RotObserver = (Mat4d::zrotation(curSidT))*ObserverLoc;
-		LocTrans = (StelCore::matVsop87ToJ2000)*(Mat4d::translation(-earthPos));
-		myMoon->computePosition(JD.second);
-		myMoon->computeTransMatrix(JD.first, JD.second);
-		Pos1 = myMoon->getHeliocentricEclipticPos();
-		Pos2 = (core->j2000ToEquinoxEqu(LocTrans*Pos1), StelCore::RefractionOff); //-RotObserver;
-
-		distance = std::sqrt(Pos2*Pos2);
-
-//		toRADec(Pos2,RAMoon,DecMoon);
-	};
+	session.setJD(JD.first);
+	distance = session.getJ2000EquatorialPos(myMoon).length();
 }
 //////////////////////////////////////////////
 
@@ -1364,45 +1294,26 @@ void Observability::getMoonDistance(StelCore *core, QPair<double, double> JD, do
 
 //////////////////////////////////////////////
 // Get the Coords of a planet:
-void Observability::getPlanetCoords(StelCore *core, QPair<double, double> JD, double &RA, double &Dec, bool getBack)
+void Observability::getPlanetCoords(StelEphemerisSession &session, QPair<double, double> JD, double &RA, double &Dec)
 {
-
-	if (getBack)
-	{
-	// Return the planet to its current time:
-		myPlanet->computePosition(JD.second);
-		myPlanet->computeTransMatrix(JD.first, JD.second);
-		myEarth->computePosition(JD.second);
-		myEarth->computeTransMatrix(JD.first, JD.second);
-	} else
-	{
-	// Compute planet's position:
-		myPlanet->computePosition(JD.second);
-		myPlanet->computeTransMatrix(JD.first, JD.second);
-		Pos1 = myPlanet->getHeliocentricEclipticPos();
-		myEarth->computePosition(JD.second);
-		myEarth->computeTransMatrix(JD.first, JD.second);
-		Pos2 = myEarth->getHeliocentricEclipticPos();
-		LocTrans = (StelCore::matVsop87ToJ2000)*(Mat4d::translation(-Pos2));
-		Pos2 = core->j2000ToEquinoxEqu(LocTrans*Pos1, StelCore::RefractionOff);
-		toRADec(Pos2,RA,Dec);
-	};
-
+	session.setJD(JD.first);
+	Pos2 = session.getEquinoxEquatorialPos(myPlanet);
+	toRADec(Pos2,RA,Dec);
 }
 //////////////////////////////////////////////
 
 
 
 //////////////////////////////////////////////
-// Solves Moon's, Sun's, or Planet's ephemeris by bissection.
+// Solves Moon's, Sun's, or Planet's ephemeris by root finding.
 bool Observability::calculateSolarSystemEvents(StelCore* core, int bodyType)
 {
 
-	const int NUM_ITER = 100;
-	int i;
-	double hHoriz, ra, dec, raSun, decSun, tempH, /* tempJd, */ tempEphH, curSidT, eclLon;
-	QPair<double, double> tempJd;
-	//Vec3d Observer;
+	// The initial guesses are within a few minutes of the events, except close to the poles
+	const double searchStep = 1./24.;
+	const double searchRange = 0.5;
+	double hHoriz, ra, dec, root;
+	StelEphemerisSession session(core);
 
 	hHoriz = calculateHourAngle(mylat, refractedHorizonAlt, selDec);
 	bool raises = hHoriz > 0.0;
@@ -1416,47 +1327,32 @@ bool Observability::calculateSolarSystemEvents(StelCore* core, int bodyType)
 
 		lastType = bodyType;
 
-		myEarth->computePosition(myJD.second);
-		myEarth->computeTransMatrix(myJD.first, myJD.second);
-		Vec3d earthPos = myEarth->getHeliocentricEclipticPos();
-
+		session.setJD(myJD.first);
 		if (bodyType == 1) // Sun position
-		{
-			Pos2 = core->j2000ToEquinoxEqu((StelCore::matVsop87ToJ2000)*(-earthPos), StelCore::RefractionOff);
-		}
+			Pos2 = session.getEquinoxEquatorialPos(mySun);
 		else if (bodyType==2) // Moon position
-		{
-			curSidT = myEarth->getSiderealTime(myJD.first, myJD.second)/Rad2Deg;
-			RotObserver = (Mat4d::zrotation(curSidT))*ObserverLoc;
-			LocTrans = (StelCore::matVsop87ToJ2000)*(Mat4d::translation(-earthPos));
-			myMoon->computePosition(myJD.second);
-			myMoon->computeTransMatrix(myJD.first, myJD.second);
-			Pos1 = myMoon->getHeliocentricEclipticPos();
-			Pos2 = (core->j2000ToEquinoxEqu(LocTrans*Pos1, StelCore::RefractionOff))-RotObserver;
-		}
+			Pos2 = session.getEquinoxEquatorialPos(myMoon);
 		else // Planet position
-		{
-			myPlanet->computePosition(myJD.second);
-			myPlanet->computeTransMatrix(myJD.first, myJD.second);
-			Pos1 = myPlanet->getHeliocentricEclipticPos();
-			LocTrans = (StelCore::matVsop87ToJ2000)*(Mat4d::translation(-earthPos));
-			Pos2 = core->j2000ToEquinoxEqu(LocTrans*Pos1, StelCore::RefractionOff);
-		};
+			Pos2 = session.getEquinoxEquatorialPos(myPlanet);
 
 		toRADec(Pos2,ra,dec);
-		Vec3d moonAltAz = core->equinoxEquToAltAz(Pos2, StelCore::RefractionOff);
+		Vec3d moonAltAz = session.equinoxEquToAltAz(Pos2, StelCore::RefractionOff);
 		hasRisen = moonAltAz[2] > refractedHorizonAlt;
 
 // Initial guesses of rise/set/transit times.
 // They are called 'Moon', but are also used for the Sun or planet:
 
 		double Hcurr = -calculateHourAngle(mylat,alti,selDec)*sign(LocPos[1]);
-		double SidT = toUnsignedRA(selRA + Hcurr);
 
 		MoonCulm = -Hcurr; 
 		MoonRise = (-hHoriz-Hcurr);
 		MoonSet = (hHoriz-Hcurr);
 
+// They are refined as the roots of the altitude above the horizon, and as its maximum:
+		const PlanetP body = (bodyType==1) ? mySun : ((bodyType==2) ? myMoon : myPlanet);
+		StelAltitudeFunction altitude(session, body, refractedHorizonAlt, StelCore::RefractionOff);
+		StelEventFinder finder(altitude);
+
 		if (raises)
 		{
 			if (!hasRisen)
@@ -1466,81 +1362,14 @@ bool Observability::calculateSolarSystemEvents(StelCore* core, int bodyType)
 			}
 
 // Rise time:
-			tempEphH = MoonRise*TFrac;
-			MoonRise = myJD.first + (MoonRise/24.);
-			for (i=0; i<NUM_ITER; i++)
-			{
-	// Get modified coordinates:
-				tempJd.first = MoonRise;
-				tempJd.second=tempJd.first+core->computeDeltaT(tempJd.first)/86400.0;
-	
-				if (bodyType<3)
-				{
-					getSunMoonCoords(core, tempJd,
-					                 raSun, decSun,
-					                 ra, dec,
-					                 eclLon, false);
-				} else
-				{
-					getPlanetCoords(core, tempJd, ra, dec, false);
-				};
-
-				if (bodyType==1) {ra = raSun; dec = decSun;};
-
-	// Current hour angle at mod. coordinates:
-				Hcurr = toUnsignedRA(SidT-ra);
-				Hcurr -= (hasRisen)?0.0:24.;
-				Hcurr -= (Hcurr>12.)?24.0:0.0;
-
-	// H at horizon for mod. coordinates:
-				hHoriz = calculateHourAngle(mylat,refractedHorizonAlt,dec);
-	// Compute eph. times for mod. coordinates:
-				tempH = (-hHoriz-Hcurr)*TFrac;
-				if (hasRisen==false) tempH += (tempH<0.0)?24.0:0.0;
-			// Check convergence:
-				if (qAbs(tempH-tempEphH)<StelCore::JD_SECOND) break;
-			// Update rise-time estimate:
-				tempEphH = tempH;
-				MoonRise = myJD.first + (tempEphH/24.);
-			};
+			MoonRise = myJD.first + (MoonRise*TFrac/24.);
+			if (finder.findRootNear(MoonRise, searchStep, searchRange, &root))
+				MoonRise = root;
 
 // Set time:  
-			tempEphH = MoonSet;
-			MoonSet = myJD.first + (MoonSet/24.);
-			for (i=0; i<NUM_ITER; i++)
-			{
-	// Get modified coordinates:
-				tempJd.first = MoonSet;
-				tempJd.second=tempJd.first+core->computeDeltaT(tempJd.first)/86400.0;
-
-				
-				if (bodyType < 3)
-					getSunMoonCoords(core, tempJd,
-					                 raSun, decSun,
-					                 ra, dec,
-					                 eclLon, false);
-				else
-					getPlanetCoords(core, tempJd, ra, dec, false);
-				
-				if (bodyType==1) {ra = raSun; dec = decSun;};
-				
-	// Current hour angle at mod. coordinates:
-				Hcurr = toUnsignedRA(SidT-ra);
-				Hcurr -= (hasRisen)?24.:0.;
-				Hcurr += (Hcurr<-12.)?24.0:0.0;
-	// H at horizon for mod. coordinates:
-				hHoriz = calculateHourAngle(mylat, refractedHorizonAlt, dec);
-	// Compute eph. times for mod. coordinates:
-				tempH = (hHoriz-Hcurr)*TFrac;
-				if (!hasRisen)
-					tempH -= (tempH>0.0)?24.0:0.0;
-		// Check convergence:
-				if (qAbs(tempH-tempEphH)<StelCore::JD_SECOND)
-					break;
-		// Update set-time estimate:
-				tempEphH = tempH;
-				MoonSet = myJD.first + (tempEphH/24.);
-			};
+			MoonSet = myJD.first + (MoonSet*TFrac/24.);
+			if (finder.findRootNear(MoonSet, searchStep, searchRange, &root))
+				MoonSet = root;
 		} 
 		else // Comes from if(raises)
 		{
@@ -1549,41 +1378,13 @@ bool Observability::calculateSolarSystemEvents(StelCore* core, int bodyType)
 		};
 
 // Culmination time:
-		tempEphH = MoonCulm;
-		MoonCulm = myJD.first + (MoonCulm/24.);
-
-		for (i=0; i<NUM_ITER; i++)
+		MoonCulm = myJD.first + (MoonCulm*TFrac/24.);
+		double culmination;
+		if (finder.findMaximumNear(MoonCulm, searchStep, searchRange, &root, &culmination))
 		{
-			// Get modified coordinates:
-			tempJd.first = MoonCulm;
-			tempJd.second=tempJd.first+core->computeDeltaT(tempJd.first)/86400.0;
-
-
-			if (bodyType<3)
-			{
-				getSunMoonCoords(core,tempJd,raSun,decSun,ra,dec,eclLon,false);
-			} else
-			{
-				getPlanetCoords(core,tempJd,ra,dec,false);
-			};
-
-
-			if (bodyType==1) {ra = raSun; dec = decSun;};
-
-
-	// Current hour angle at mod. coordinates:
-			Hcurr = toUnsignedRA(SidT-ra);
-			Hcurr += (LocPos[1]<0.0)?24.0:-24.0;
-			Hcurr -= (Hcurr>12.)?24.0:0.0;
-
-	// Compute eph. times for mod. coordinates:
-			tempH = -Hcurr*TFrac;
-	// Check convergence:
-			if (qAbs(tempH-tempEphH)<StelCore::JD_SECOND) break;
-			tempEphH = tempH;
-			MoonCulm = myJD.first + (tempEphH/24.);
-			culmAlt = qAbs(mylat-dec); // 90 - altitude at transit.
-		};
+			MoonCulm = root;
+			culmAlt = halfpi - (culmination + refractedHorizonAlt); // 90 - altitude at transit.
+		}
 
 
 
@@ -1611,14 +1412,11 @@ bool Observability::calculateSolarSystemEvents(StelCore* core, int bodyType)
 
 			double TempFullMoon = RefFullMoon + nT*MoonT;
 
-	// Improve the estimate iteratively (Secant method over Lunar-phase vs. time):
+	// Improve the estimate by root finding over Lunar-phase vs. time:
 
-			dT = 0.1/1440.; // 6 seconds. Our time span for the finite-difference derivative estimate.
-//			double Deriv1, Deriv2; // Variables for temporal use.
-			QPair<double, double>Sec1, Sec2; // Variables for temporal use. Contrary to the other cases, we have Sec[12].second=DeltaT[days], not JDE. This avoids needless re-computing.
-			double Temp1, Temp2; // Variables for temporal use.
+			LunarPhaseFunction lunarPhase(session, myMoon);
+			StelEventFinder phaseFinder(lunarPhase, 1./1440.); // 1 minute accuracy.
 			double iniEst1, iniEst2;  // JD values that MUST include the solution within them.
-			double Phase1;
 
 			for (int j=0; j<2; j++) 
 			{ // Two steps: one for the previos Full Moon and the other for the next one.
@@ -1626,45 +1424,9 @@ bool Observability::calculateSolarSystemEvents(StelCore* core, int bodyType)
 				iniEst1 =  TempFullMoon - 0.25*MoonT; 
 				iniEst2 =  TempFullMoon + 0.25*MoonT; 
 
-
-				Sec1.first = iniEst1; // TempFullMoon - 0.05*MoonT; // Initial estimates of Full-Moon dates
-				Sec1.second= core->computeDeltaT(Sec1.first)/86400.0; // enough to compute this once.
-				Sec2.first = iniEst2; // TempFullMoon + 0.05*MoonT;
-				Sec2.second= core->computeDeltaT(Sec2.first)/86400.0; // enough to compute this once.
-
-				// for the computation calls, we need temporary QPairs here!
-				getSunMoonCoords(core,QPair<double, double>(Sec1.first, Sec1.first+Sec1.second),raSun,decSun,ra,dec,eclLon,false);
-				Temp1 = eclLon; //Lambda(RA,Dec,RAS,DecS);
-				getSunMoonCoords(core,QPair<double, double>(Sec2.first, Sec2.first+Sec2.second),raSun,decSun,ra,dec,eclLon,false);
-				Temp2 = eclLon; //Lambda(RA,Dec,RAS,DecS);
-
-
-				for (int i=0; i<100; i++) // A limit of 100 iterations.
-				{
-					Phase1 = (Sec2.first-Sec1.first)/(Temp1-Temp2)*Temp1+Sec1.first;
-					// The ad-hoc pair needs a DeltaT, use the one of Sec1
-					getSunMoonCoords(core,QPair<double, double>(Phase1, Phase1+Sec1.second),raSun,decSun,ra,dec,eclLon,false);
-					
-					if (Temp1*eclLon < 0.0) 
-					{
-						Sec2.first = Phase1;
-						Temp2 = eclLon;
-					} else {
-						Sec1.first = Phase1;
-						Temp1 = eclLon;
-
-					};
-
-
-
-					if (qAbs(Sec2.first-Sec1.first) < 10.*dT)  // 1 minute accuracy; convergence.
-					{
-						TempFullMoon = (Sec1.first+Sec2.first)/2.;
-						break;
-					};
-					
-				};
-
+				double fullMoon;
+				if (phaseFinder.findRoot(iniEst1, iniEst2, &fullMoon))
+					TempFullMoon = fullMoon;
 
 				if (TempFullMoon > myJD.first)
 				{
@@ -1716,7 +1478,7 @@ bool Observability::calculateSolarSystemEvents(StelCore* core, int bodyType)
 //			for (int i=-PrevMonths; i<13 ; i++)
 //			{
 //				jd1 = nextFullMoon + MoonT*((double) i);
-//				getMoonDistance(core,jd1,Distance,false); 
+//				getMoonDistance(session,jd1,Distance); 
 //				if (Distance < BestDistance)
 //				{  // Month with the largest Full Moon:
 //					BestDistance = Distance;
@@ -1737,17 +1499,6 @@ bool Observability::calculateSolarSystemEvents(StelCore* core, int bodyType)
 	}; 
 
 
-// Return the Moon and Earth to its current position:
-	if (bodyType<3)
-	{
-		getSunMoonCoords(core, myJD, raSun, decSun, ra, dec, eclLon, true);
-	}
-	else
-	{
-		getPlanetCoords(core, myJD, ra, dec, true);
-	};
-
-
 	return raises;
 }
 
@@ -25,6 +25,7 @@
 #include "VecMath.hpp"
 #include "SolarSystem.hpp"
 #include "Planet.hpp"
+#include "StelEphemerisSession.hpp"
 #include "StelFader.hpp"
 
 class QPixmap;
@@ -194,38 +195,18 @@ private:
 	int calculateHeli(int imethod, int& heliRise, int& heliSet);
 
 
-	//! Computes the Sun or Moon coordinates at a given Julian date.
-	//! @param core the stellarium core.
-	//! @param JD QPair of double for the Julian date: first=JD_UT and .second=JDE_DT
-	//! @param RASun right ascension of the Sun (in hours).
-	//! @param DecSun declination of the Sun (in radians).
-	//! @param RAMoon idem for the Moon.
-	//! @param DecMoon idem for the Moon.
-	//! @param EclLon is the module of the vector product of Heliocentric Ecliptic Coordinates
-	//!        of Sun and Moon (projected over the Ecliptic plane). Useful to derive the dates
-	//!        of Full Moon.
-	//! @param getBack controls whether Earth and Moon must be returned to their original
-	//!        positions after computation.
-	void getSunMoonCoords(StelCore* core, QPair<double, double> JD,
-			      double& raSun, double& decSun,
-			      double& raMoon, double& decMoon,
-			      double& eclLon, bool getBack);
-
-
 	//! computes the selected-planet coordinates at a given Julian date.
-	//! @param core the stellarium core.
+	//! @param session the ephemeris session, whose date is set to JD.
 	//! @param JD QPair for the Julian date: .first=JD(UT), .second=JDE
 	//! @param RA right ascension of the planet (in hours).
 	//! @param Dec declination of the planet (in radians).
-	//! @param getBack controls whether the planet must be returned to its original positions
-	//!        after computation.
-	void getPlanetCoords(StelCore* core,QPair<double, double> JD,
-			     double &RA, double &Dec, bool getBack);
+	void getPlanetCoords(StelEphemerisSession& session, QPair<double, double> JD,
+			     double &RA, double &Dec);
 
 	//! Computes the Earth-Moon distance (in AU) at a given Julian date.
-	//! The parameters are similar to those of getSunMoonCoords() or getPlanetCoords().
-	void getMoonDistance(StelCore* core, QPair<double, double> JD,
-			     double& distance, bool getBack);
+	//! The parameters are similar to those of getPlanetCoords().
+	void getMoonDistance(StelEphemerisSession& session, QPair<double, double> JD,
+			     double& distance);
 
 	//! Returns the angular separation (in radians) between two points.
 	//! @param RA1 right ascension of point 1 (in hours)
@@ -334,16 +315,13 @@ private:
 	//! Vector of Earth position through the year.
 	Vec3d EarthPos[366];
 
-	//! Position of the observer relative to the Earth Center or other coordinates:
-	Vec3d ObserverLoc, Pos1, Pos2, RotObserver; //, Pos3;
-
-	//! Matrix to transform coordinates for Sun/Moon ephemeris:
-	Mat4d LocTrans;
+	//! Coordinates of the Sun, Moon or planet:
+	Vec3d Pos2;
 
-	//! Pointer to the Earth, Moon, and planet:
-	Planet* myEarth;
-	Planet* myMoon;
-	Planet* myPlanet;
+	//! Pointer to the Sun, Moon, and planet:
+	PlanetP mySun;
+	PlanetP myMoon;
+	PlanetP myPlanet;
 
 	//! Current simulation year.
 	int curYear;
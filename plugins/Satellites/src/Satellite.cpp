@@ -759,11 +759,15 @@ void Satellite::setNewTleElements(const QString& tle1, const QString& tle2)
 }
 
 void Satellite::update(double)
+{
+	computePosition(StelApp::getInstance().getCore()->getJD()); // We have "true" JD (UTC) from core, satellites don't need JDE!
+}
+
+void Satellite::computePosition(double JD)
 {
 	if (pSatWrapper && orbitValid)
 	{
-		StelCore* core = StelApp::getInstance().getCore();
-		epochTime = core->getJD(); // + timeShift; // We have "true" JD (UTC) from core, satellites don't need JDE!
+		epochTime = JD;
 
 		pSatWrapper->setEpoch(epochTime);
 		position                 = pSatWrapper->getTEMEPos();
@@ -180,6 +180,9 @@ public:
 
 	// calculate faders, new position
 	void update(double deltaTime);
+	//! Compute the position at another date than the one of StelCore, e.g. for predictions.
+	//! @param JD the Julian day (UT)
+	void computePosition(double JD);
 
 	double getDoppler(double freq) const;
 	static bool showLabels;
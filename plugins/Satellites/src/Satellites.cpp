@@ -41,6 +41,7 @@
 #include "StelTranslator.hpp"
 #include "StelProgressController.hpp"
 #include "StelUtils.hpp"
+#include "StelEphemerisSession.hpp"
 
 #include "external/qtcompress/qzipreader.h"
 
@@ -1803,78 +1804,6 @@ bool Satellites::isValidRangeDates(const StelCore *core) const
 		return true;
 }
 
-#ifdef _OLD_IRIDIUM_PREDICTIONS
-IridiumFlaresPredictionList Satellites::getIridiumFlaresPrediction()
-{
-	StelCore* pcore = StelApp::getInstance().getCore();
-	double currentJD = pcore->getJD(); // save current JD
-	bool isTimeNow = pcore->getIsTimeNow();
-	long iJD =currentJD;
-	double JDMidnight = iJD + 0.5 - pcore->getCurrentLocation().longitude / 360.f;
-	double delta = currentJD - JDMidnight;
-
-	pcore->setJD(iJD + 0.5 - pcore->getCurrentLocation().longitude / 360.f);
-	pcore->update(10); // force update to get new coordinates
-
-	IridiumFlaresPredictionList predictions;
-	predictions.clear();
-	foreach(const SatelliteP& sat, satellites)
-	{
-		if (sat->initialized && sat.data()->getEnglishName().startsWith("IRIDIUM"))
-		{
-			double dt  = 0;
-			double angle0 = 100;
-			double lat0 = -1;
-			while (dt<1)
-			{
-				Satellite::timeShift = dt+delta;
-				sat.data()->update(0);
-
-				Vec3d pos = sat.data()->getAltAzPosApparent(pcore);
-				double lat = pos.latitude();
-				double lon = M_PI - pos.longitude();
-				double v =   sat.data()->getVMagnitude(pcore);
-				double angle =  sat.data()->sunReflAngle;
-
-				if (angle>0 && angle<2)
-				{
-					if (angle>angle0 && (v<1) && lat>5*M_PI/180)
-					{
-						IridiumFlaresPrediction flare;
-						flare.datetime = StelUtils::julianDayToISO8601String(currentJD+dt+StelApp::getInstance().getCore()->getUTCOffset(currentJD+dt)/24.f);
-						flare.satellite = sat.data()->getEnglishName();
-						flare.azimuth   = lon;
-						flare.altitude  = lat;
-						flare.magnitude = v;
-
-						predictions.append(flare);
-
-						dt +=0.005;
-					}
-					angle0 = angle;
-				}
-				if (angle>0)
-					dt+=0.000002*angle*angle;
-				else
-				{
-					if (lat0>0 && lat<0)
-						dt+=0.05;
-					else
-						dt+=0.0002;
-				}
-				lat0 = lat;
-			}
-		}
-	}
-	Satellite::timeShift = 0.;
-	if (isTimeNow)
-		pcore->setTimeNow();
-	else
-		pcore->setJD(currentJD);
-
-	return predictions;
-}
-#else
 
 struct SatDataStruct {
 	double nextJD;
@@ -1887,14 +1816,16 @@ struct SatDataStruct {
 IridiumFlaresPredictionList Satellites::getIridiumFlaresPrediction()
 {
 	StelCore* pcore = StelApp::getInstance().getCore();
-	SolarSystem* ssystem = (SolarSystem*)StelApp::getInstance().getModuleMgr().getModule("SolarSystem");
 
-	double currentJD = pcore->getJD(); // save current JD
-	bool isTimeNow = pcore->getIsTimeNow();
+	double currentJD = pcore->getJD();
 
 	double predictionJD = currentJD - 1.;  //  investigate what's seen recently// yesterday
 	double predictionEndJD = currentJD + getIridiumFlaresPredictionDepth(); // 7 days interval by default
-	pcore->setJD(predictionJD);
+
+	// The Sun is computed for the predicted dates without changing the time of the core
+	StelEphemerisSession session(pcore);
+	session.setJD(predictionJD);
+	gSatWrapper::setSunSession(&session);
 
 	bool useSouthAzimuth = StelApp::getInstance().getFlagSouthAzimuthUsage();
 
@@ -1909,6 +1840,7 @@ IridiumFlaresPredictionList Satellites::getIridiumFlaresPrediction()
 	{
 		if (sat->initialized && sat.data()->getEnglishName().startsWith("IRIDIUM"))
 		{
+			sat.data()->computePosition(predictionJD);
 			Vec3d pos = sat.data()->getAltAzPosApparent(pcore);
 			sds.angleToSun = sat.data()->sunReflAngle;
 			sds.altitude = pos.latitude();
@@ -1944,10 +1876,7 @@ IridiumFlaresPredictionList Satellites::getIridiumFlaresPrediction()
 	while (predictionJD<predictionEndJD)
 	{
 		nextJD = predictionJD + 1./24;
-		pcore->setJD(predictionJD);
-
-		ssystem->getEarth().data()->computePosition(predictionJD);
-		pcore->update(0);
+		session.setJD(predictionJD);
 
 		QMap<SatelliteP,SatDataStruct>::iterator i = iridiums.begin();
 		while (i != iridiums.end())
@@ -1955,7 +1884,7 @@ IridiumFlaresPredictionList Satellites::getIridiumFlaresPrediction()
 			if ( i.value().nextJD<=predictionJD)
 			{
 
-				i.key().data()->update(0);
+				i.key().data()->computePosition(predictionJD);
 
 				double v = i.key().data()->getVMagnitude(pcore);
 				bool flareFound = false;
@@ -2029,15 +1958,13 @@ IridiumFlaresPredictionList Satellites::getIridiumFlaresPrediction()
 		predictionJD = nextJD;
 	}
 
-	//Satellite::timeShift = 0.;
-	if (isTimeNow)
-		pcore->setTimeNow();
-	else
-		pcore->setJD(currentJD);
+	gSatWrapper::setSunSession(Q_NULLPTR);
+	// Put the satellites back to the time of the core
+	foreach(const SatelliteP& sat, iridiums.keys())
+		sat.data()->computePosition(currentJD);
 
 	return predictions;
 }
-#endif
 
 
 void Satellites::translations()
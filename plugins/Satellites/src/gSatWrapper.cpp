@@ -34,6 +34,7 @@
 #include "gSatWrapper.hpp"
 #include "StelApp.hpp"
 #include "StelCore.hpp"
+#include "StelEphemerisSession.hpp"
 #include "StelUtils.hpp"
 
 #include "SolarSystem.hpp"
@@ -214,7 +215,11 @@ void gSatWrapper::updateSunECIPos()
 	calcObserverECIPosition(observerECIPos, observerECIVel);
 
 	static const SolarSystem *solsystem = (SolarSystem*)StelApp::getInstance().getModuleMgr().getModule("SolarSystem");
-	Vec3d sunEquinoxEqPos = solsystem->getSun()->getEquinoxEquatorialPos(StelApp::getInstance().getCore());
+	Vec3d sunEquinoxEqPos;
+	if (sunSession)
+		sunEquinoxEqPos = sunSession->getEquinoxEquatorialPos(solsystem->getSun());
+	else
+		sunEquinoxEqPos = solsystem->getSun()->getEquinoxEquatorialPos(StelApp::getInstance().getCore());
 
 	//sunEquinoxEqPos is measured in AU. we need measure it in Km
 	//Vec3d sunECIPos;
@@ -225,6 +230,12 @@ void gSatWrapper::updateSunECIPos()
 
 }
 
+void gSatWrapper::setSunSession(const StelEphemerisSession* session)
+{
+	sunSession = session;
+	lastSunECIepoch = 0.0; // the cached position may come from the other source
+}
+
 Vec3d gSatWrapper::getSunECIPos()
 {
 	if (epoch != lastSunECIepoch)
@@ -245,7 +256,11 @@ gSatWrapper::Visibility gSatWrapper::getVisibilityPredict()
 	{
 		Vec3d satECIPos = getTEMEPos();
 		static const SolarSystem *solsystem = (SolarSystem*)StelApp::getInstance().getModuleMgr().getModule("SolarSystem");
-		Vec3d sunAltAzPos = solsystem->getSun()->getAltAzPosGeometric(StelApp::getInstance().getCore());
+		Vec3d sunAltAzPos;
+		if (sunSession)
+			sunAltAzPos = sunSession->getAltAzPos(solsystem->getSun(), StelCore::RefractionOff);
+		else
+			sunAltAzPos = solsystem->getSun()->getAltAzPosGeometric(StelApp::getInstance().getCore());
 		Vec3d sunECIPos = getSunECIPos();
 
 		if (sunAltAzPos[2] > 0.0)
@@ -280,6 +295,7 @@ double gSatWrapper::getPhaseAngle() const
 gTime gSatWrapper::epoch;
 gTime gSatWrapper::lastSunECIepoch=0.0; // store last time of computation to avoid all-1 computations.
 gTime gSatWrapper::lastCalcObserverECIPosition;
+const StelEphemerisSession* gSatWrapper::sunSession = Q_NULLPTR;
 
 Vec3d gSatWrapper::sunECIPos; // enough to have this once.
 Vec3d gSatWrapper::observerECIPos;
@@ -36,6 +36,8 @@
 #include "gsatellite/gSatTEME.hpp"
 #include "gsatellite/gTime.hpp"
 
+class StelEphemerisSession;
+
 //! Wrapper allowing compatibility between gsat and Stellarium/Qt.
 //! @ingroup satellites
 class gSatWrapper
@@ -69,6 +71,11 @@ public:
 	//! @return Vec3d with ECI position.
 	static Vec3d getSunECIPos();
 
+	//! Take the position of the Sun from an ephemeris session set to the epoch of the satellites,
+	//! rather than from SolarSystem at the time of StelCore, e.g. for predictions at other dates.
+	//! @param session the session, or Q_NULLPTR to use SolarSystem again
+	static void setSunSession(const StelEphemerisSession* session);
+
 	// Operation getTEMEVel
 	//! @brief This operation isolate gSatTEME getVel operation.
 	//! @return Vec3d with TEME speed. Units measured in Km/s.
@@ -150,6 +157,7 @@ private:
 	static Vec3d observerECIPos;
 	static Vec3d observerECIVel;
 	static gTime lastCalcObserverECIPosition;
+	static const StelEphemerisSession* sunSession;
 
 };
 
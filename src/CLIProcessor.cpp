@@ -20,6 +20,7 @@
 #include "CLIProcessor.hpp"
 #include "StelFileMgr.hpp"
 #include "StelUtils.hpp"
+#include "StelStartupProfiler.hpp"
 
 #include <QSettings>
 #include <QDateTime>
@@ -56,6 +57,9 @@ void CLIProcessor::parseCLIArgsPreConfig(const QStringList& argList)
 			  << "--user-dir (or -u)      : Use an alternative user data directory\n"
 			  << "--verbose               : Even more diagnostic output in logfile \n"
 			  << "                          (esp. multimedia handling)\n"
+			  << "--profile-startup       : Measure the time and memory used by the startup\n"
+			  << "                          and save it to startup-profile.json in the user directory\n"
+			  << "--profile-startup-file <file> : Like --profile-startup, saving to the given file\n"
 			  << "--compat33 (or -C)      : Request OpenGL 3.3 Compatibility Profile\n"
 			  << "                          May help for certain driver configurations. Mac?\n"
 			  << "--fix-text (or -t)      : May fix text rendering problems\n"
@@ -101,6 +105,10 @@ void CLIProcessor::parseCLIArgsPreConfig(const QStringList& argList)
 	{
 		qApp->setProperty("verbose", true);
 	}
+	if (argsGetOption(argList, "", "--profile-startup"))
+	{
+		StelStartupProfiler::setEnabled(true);
+	}
 	if (argsGetOption(argList, "-C", "--compat33"))
 	{
 		qApp->setProperty("onetime_compat33", true);
@@ -163,6 +171,21 @@ void CLIProcessor::parseCLIArgsPreConfig(const QStringList& argList)
 		qCritical() << "ERROR: while processing --user-dir option: " << e.what();
 		exit(1);
 	}
+
+	try
+	{
+		QString profileFile = argsGetOptionWithArg(argList, "", "--profile-startup-file", "").toString();
+		if (!profileFile.isEmpty())
+		{
+			StelStartupProfiler::setReportPath(profileFile);
+			StelStartupProfiler::setEnabled(true);
+		}
+	}
+	catch (std::runtime_error& e)
+	{
+		qCritical() << "ERROR: while processing --profile-startup-file option: " << e.what();
+		exit(1);
+	}
 }
 
 void CLIProcessor::parseCLIArgsPostConfig(const QStringList& argList, QSettings* confSettings)
@@ -30,6 +30,7 @@
 #include "StelActionMgr.hpp"
 #include "StelOpenGL.hpp"
 #include "StelOpenGLArray.hpp"
+#include "StelStartupProfiler.hpp"
 
 #include <QDebug>
 #include <QDir>
@@ -828,6 +829,9 @@ void StelMainView::init()
 	// The script manager can only be fully initialized after the plugins have loaded.
 	stelApp->initScriptMgr();
 
+	// The startup is over: save the measures requested with --profile-startup
+	StelStartupProfiler::writeReport();
+
 	// Set the global stylesheet, this is only useful for the tooltips.
 	StelGui* gui = dynamic_cast<StelGui*>(stelApp->getGui());
 	if (gui!=Q_NULLPTR)
@@ -57,6 +57,28 @@ float Extinction::airmass(float cosZ, const bool apparent_z) const
 	}
 }
 
+QByteArray Extinction::getForwardShaderSource()
+{
+	// Same as forward() with airmass(cosZ, false)
+	return
+		"uniform highp float extinctionCoefficient;\n"
+		"uniform int extinctionUndergroundMode;\n"
+		"highp float extinctionMagnitudeShift(highp float cosZ)\n"
+		"{\n"
+		"    if (cosZ < -0.035)\n"
+		"    {\n"
+		"        if (extinctionUndergroundMode == 0)\n"
+		"            return 0.0;\n"
+		"        if (extinctionUndergroundMode == 1)\n"
+		"            return 42.0*extinctionCoefficient;\n"
+		"        cosZ = min(1.0, -0.035 - (cosZ+0.035));\n"
+		"    }\n"
+		"    highp float nom = (1.002432*cosZ+0.148386)*cosZ+0.0096467;\n"
+		"    highp float denum = ((cosZ+0.149864)*cosZ+0.0102963)*cosZ+0.000303978;\n"
+		"    return nom/denum*extinctionCoefficient;\n"
+		"}\n";
+}
+
 /* ***************************************************************************************************** */
 
 // The following 4 are to be configured, the rest is derived.
@@ -109,6 +131,39 @@ void Refraction::updatePrecomputed()
 	press_temp_corr=pressure/1010.f * 283.f/(273.f+temperature) / 60.f;
 }
 
+QByteArray Refraction::getForwardShaderSource()
+{
+	// Same as innerRefractionForward(). The altitude is computed with atan() rather
+	// than asin(), which loses too much precision near the zenith in single precision.
+	const QByteArray minAlt = QByteArray::number(MIN_GEO_ALTITUDE_DEG, 'f', 6);
+	const QByteArray width = QByteArray::number(TRANSITION_WIDTH_GEO_DEG, 'f', 6);
+	return
+		"uniform highp float refractionPressTempCorr;\n"
+		"void refractionForward(inout highp vec3 altAzPos)\n"
+		"{\n"
+		"    highp float len = length(altAzPos);\n"
+		"    highp float lenxy = length(altAzPos.xy);\n"
+		"    if (len == 0.0)\n"
+		"        return;\n"
+		"    highp float altDeg = degrees(atan(altAzPos.z, lenxy));\n"
+		"    if (altDeg > " + minAlt + ")\n"
+		"    {\n"
+		"        highp float r = refractionPressTempCorr*(1.02/tan(radians(altDeg+10.3/(altDeg+5.11))) + 0.0019279);\n"
+		"        altDeg = min(altDeg + r, 90.0);\n"
+		"    }\n"
+		"    else if (altDeg > " + minAlt + "-" + width + ")\n"
+		"    {\n"
+		"        highp float r = refractionPressTempCorr*(1.02/tan(radians(" + minAlt + "+10.3/(" + minAlt + "+5.11))) + 0.0019279);\n"
+		"        altDeg += r*(altDeg-(" + minAlt + "-" + width + "))/" + width + ";\n"
+		"    }\n"
+		"    else\n"
+		"        return;\n"
+		"    highp float shortenxy = (lenxy > 0.0) ? cos(radians(altDeg))*len/lenxy : 1.0;\n"
+		"    altAzPos.xy *= shortenxy;\n"
+		"    altAzPos.z = sin(radians(altDeg))*len;\n"
+		"}\n";
+}
+
 void Refraction::innerRefractionForward(Vec3d& altAzPos) const
 {
 	const double length = altAzPos.length();
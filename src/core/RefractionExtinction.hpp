@@ -90,6 +90,11 @@ public:
 
 	void setUndergroundExtinctionMode(UndergroundExtinctionMode mode) {undergroundExtinctionMode=mode;}
 	UndergroundExtinctionMode getUndergroundExtinctionMode() const {return undergroundExtinctionMode;}
+
+	//! Get the GLSL source of forward(), for the vertex shaders which compute extinction on the GPU.
+	//! It defines the function "highp float extinctionMagnitudeShift(highp float cosZ)", which uses
+	//! the uniforms "extinctionCoefficient" and "extinctionUndergroundMode" (see the getters above).
+	static QByteArray getForwardShaderSource();
 	
 private:
 	//! airmass computation for @param cosZ = cosine of zenith angle z (=sin(altitude)!).
@@ -163,6 +168,17 @@ public:
 	//! Set the transformation matrices used to transform input vector to AltAz frame.
 	void setPreTransfoMat(const Mat4d& m);
 	void setPostTransfoMat(const Mat4d& m);
+	const Mat4d& getPreTransfoMat() const {return preTransfoMat;}
+	const Mat4d& getPostTransfoMat() const {return postTransfoMat;}
+
+	//! Get the correction factor of the refraction formula for the current pressure and temperature.
+	float getPressureTemperatureCorrection() const {return press_temp_corr;}
+
+	//! Get the GLSL source of the refraction applied by forward() between the pre and post transformations,
+	//! for the vertex shaders which compute refraction on the GPU. It defines the function
+	//! "void refractionForward(inout highp vec3 altAzPos)", which uses the uniform "refractionPressTempCorr"
+	//! (see getPressureTemperatureCorrection()).
+	static QByteArray getForwardShaderSource();
 
 private:
 	//! Update precomputed variables.
@@ -38,6 +38,7 @@
 #include "SporadicMeteorMgr.hpp"
 #include "StarMgr.hpp"
 #include "StelIniParser.hpp"
+#include "StelStartupProfiler.hpp"
 #include "StelProjector.hpp"
 #include "StelLocationMgr.hpp"
 #include "ToastMgr.hpp"
@@ -82,6 +83,8 @@
 #include <QCoreApplication>
 #include <QScreen>
 #include <QDateTime>
+#include <QThread>
+#include <QtConcurrent>
 #ifdef ENABLE_SPOUT
 #include <QMessageBox>
 #include "SpoutSender.hpp"
@@ -441,51 +444,56 @@ void StelApp::init(QSettings* conf)
 
 	// Stel Object Data Base manager
 	stelObjectMgr = new StelObjectMgr();
-	stelObjectMgr->init();
+	initModule(stelObjectMgr);
 	getModuleMgr().registerModule(stelObjectMgr);	
 
 	localeMgr->init();
 
+	// The catalogs of the stars and nebulas are parsed in worker threads
+	// while the modules before them are initialized
+	StarMgr* hip_stars = new StarMgr();
+	startModulePreload(hip_stars);
+	NebulaMgr* nebulas = new NebulaMgr();
+	startModulePreload(nebulas);
+
 	// Init the solar system first
 	SolarSystem* ssystem = new SolarSystem();
-	ssystem->init();
+	initModule(ssystem);
 	getModuleMgr().registerModule(ssystem);
 
 	// Init the nomenclature for Solar system bodies
 	NomenclatureMgr* nomenclature = new NomenclatureMgr();
-	nomenclature->init();
+	initModule(nomenclature);
 	getModuleMgr().registerModule(nomenclature);
 
 	// Load hipparcos stars & names
-	StarMgr* hip_stars = new StarMgr();
-	hip_stars->init();
+	initModule(hip_stars);
 	getModuleMgr().registerModule(hip_stars);
 
 	core->init();
 
 	// Init nebulas
-	NebulaMgr* nebulas = new NebulaMgr();
-	nebulas->init();
+	initModule(nebulas);
 	getModuleMgr().registerModule(nebulas);
 
 	// Init milky way
 	MilkyWay* milky_way = new MilkyWay();
-	milky_way->init();
+	initModule(milky_way);
 	getModuleMgr().registerModule(milky_way);
 
 	// Init zodiacal light
 	ZodiacalLight* zodiacal_light = new ZodiacalLight();
-	zodiacal_light->init();
+	initModule(zodiacal_light);
 	getModuleMgr().registerModule(zodiacal_light);
 
 	// Init sky image manager
 	skyImageMgr = new StelSkyLayerMgr();
-	skyImageMgr->init();
+	initModule(skyImageMgr);
 	getModuleMgr().registerModule(skyImageMgr);
 
 	// Toast surveys
 	ToastMgr* toasts = new ToastMgr();
-	toasts->init();
+	initModule(toasts);
 	getModuleMgr().registerModule(toasts);
 
 	// Init audio manager
@@ -493,43 +501,43 @@ void StelApp::init(QSettings* conf)
 
 	// Init video manager
 	videoMgr = new StelVideoMgr();
-	videoMgr->init();
+	initModule(videoMgr);
 	getModuleMgr().registerModule(videoMgr);
 
 	// Constellations
 	ConstellationMgr* constellations = new ConstellationMgr(hip_stars);
-	constellations->init();
+	initModule(constellations);
 	getModuleMgr().registerModule(constellations);
 
 	// Asterisms
 	AsterismMgr* asterisms = new AsterismMgr(hip_stars);
-	asterisms->init();
+	initModule(asterisms);
 	getModuleMgr().registerModule(asterisms);
 
 	// Landscape, atmosphere & cardinal points section
 	LandscapeMgr* landscape = new LandscapeMgr();
-	landscape->init();
+	initModule(landscape);
 	getModuleMgr().registerModule(landscape);
 
 	GridLinesMgr* gridLines = new GridLinesMgr();
-	gridLines->init();
+	initModule(gridLines);
 	getModuleMgr().registerModule(gridLines);
 
 	// Sporadic Meteors
 	SporadicMeteorMgr* meteors = new SporadicMeteorMgr(10, 72);
-	meteors->init();
+	initModule(meteors);
 	getModuleMgr().registerModule(meteors);
 
 	// User labels
 	LabelMgr* skyLabels = new LabelMgr();
-	skyLabels->init();
+	initModule(skyLabels);
 	getModuleMgr().registerModule(skyLabels);
 
 	skyCultureMgr->init();
 
 	// Init custom objects
 	CustomObjectMgr* custObj = new CustomObjectMgr();
-	custObj->init();
+	initModule(custObj);
 	getModuleMgr().registerModule(custObj);
 
 	//Create the script manager here, maybe some modules/plugins may want to connect to it
@@ -598,6 +606,7 @@ void StelApp::init(QSettings* conf)
 	}
 #endif
 
+	logStartupTimeline();
 	initialized = true;
 }
 
@@ -610,15 +619,79 @@ void StelApp::initPlugIns()
 	{
 		if (i.loadAtStartup==false)
 			continue;
+		StelStartupProfiler::Scope profile("plugin", i.info.id);
 		StelModule* m = moduleMgr->loadPlugin(i.info.id);
 		if (m!=Q_NULLPTR)
 		{
 			moduleMgr->registerModule(m, true);
 			//load extensions after the module is registered
 			moduleMgr->loadExtensions(i.info.id);
-			m->init();
+			initModule(m);
 		}
 	}
+	logStartupTimeline();
+}
+
+void StelApp::startModulePreload(StelModule* m)
+{
+	Q_ASSERT(!modulePreloads.contains(m));
+	modulePreloads.insert(m, QtConcurrent::run(this, &StelApp::preloadModule, m));
+}
+
+void StelApp::preloadModule(StelModule* m)
+{
+	StelStartupProfiler::Scope profile("preload", m->objectName());
+	const qint64 start = QDateTime::currentMSecsSinceEpoch() - startMSecs;
+	m->preload();
+	recordStartupPhase(m->objectName(), "preload", start, QDateTime::currentMSecsSinceEpoch() - startMSecs);
+}
+
+void StelApp::initModule(StelModule* m)
+{
+	QHash<StelModule*, QFuture<void> >::iterator preload = modulePreloads.find(m);
+	if (preload!=modulePreloads.end())
+	{
+		const qint64 start = QDateTime::currentMSecsSinceEpoch() - startMSecs;
+		preload.value().waitForFinished();
+		modulePreloads.erase(preload);
+		const qint64 end = QDateTime::currentMSecsSinceEpoch() - startMSecs;
+		if (end>start)
+			recordStartupPhase(m->objectName(), "wait", start, end);
+	}
+	else
+		preloadModule(m);
+
+	StelStartupProfiler::Scope profile("init", m->objectName());
+	const qint64 start = QDateTime::currentMSecsSinceEpoch() - startMSecs;
+	m->init();
+	recordStartupPhase(m->objectName(), "init", start, QDateTime::currentMSecsSinceEpoch() - startMSecs);
+}
+
+void StelApp::recordStartupPhase(const QString& module, const QString& phase, qint64 start, qint64 end)
+{
+	StartupPhase p;
+	p.module = module;
+	p.phase = phase;
+	p.thread = QThread::currentThread()==thread() ? "main" : "worker";
+	p.start = start;
+	p.end = end;
+	QMutexLocker lock(&startupTimelineMutex);
+	startupTimeline.append(p);
+}
+
+void StelApp::logStartupTimeline()
+{
+	QMutexLocker lock(&startupTimelineMutex);
+	if (startupTimeline.isEmpty())
+		return;
+	qDebug() << "Startup timeline (ms since start):";
+	foreach (const StartupPhase& p, startupTimeline)
+	{
+		qDebug() << qPrintable(QString("  %1 %2 %3 %4 - %5 (%6 ms)")
+				       .arg(p.module, -24).arg(p.phase, -7).arg(p.thread, -6)
+				       .arg(p.start, 6).arg(p.end, 6).arg(p.end-p.start));
+	}
+	startupTimeline.clear();
 }
 
 void StelApp::deinit()
@@ -22,6 +22,10 @@
 
 #include <QString>
 #include <QObject>
+#include <QFuture>
+#include <QHash>
+#include <QMutex>
+#include <QVector>
 #include "StelModule.hpp"
 
 // Predeclaration of some classes
@@ -306,6 +310,18 @@ private:
 	//! @param drawFbo the OpenGL fbo we need to render into.
 	void applyRenderBuffer(quint32 drawFbo=0);
 
+	//! Start the preload() phase of a module in the global thread pool.
+	void startModulePreload(StelModule* m);
+	//! Run the preload() phase of a module and record it in the startup timeline.
+	void preloadModule(StelModule* m);
+	//! Wait for the end of the preload() phase of a module, then call its init().
+	//! If the preload() phase was not started, it is run first on the main thread.
+	void initModule(StelModule* m);
+	//! Record a startup phase of a module. Times are in ms since the start of the program.
+	void recordStartupPhase(const QString& module, const QString& phase, qint64 start, qint64 end);
+	//! Write the startup timeline of all modules to the log.
+	void logStartupTimeline();
+
 	// The StelApp singleton
 	static StelApp* singleton;
 
@@ -429,6 +445,22 @@ private:
 	// The current main FBO/render target handle, without requiring GL queries. Valid through a draw() call
 	quint32 currentFbo;
 
+	// The preload() phases of modules which are running or waiting for their init()
+	QHash<StelModule*, QFuture<void> > modulePreloads;
+
+	// A phase of the initialization of a module
+	struct StartupPhase
+	{
+		QString module;
+		QString phase;
+		QString thread;
+		qint64 start;
+		qint64 end;
+	};
+	// All the startup phases, in order of completion. Protected by startupTimelineMutex.
+	QVector<StartupPhase> startupTimeline;
+	QMutex startupTimelineMutex;
+
 };
 
 #endif // _STELAPP_HPP_
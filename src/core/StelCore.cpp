@@ -40,6 +40,7 @@
 #include "StelPropertyMgr.hpp"
 #include "StelFileMgr.hpp"
 #include "StelMainView.hpp"
+#include "StelDeltaTTable.hpp"
 #include "EphemWrapper.hpp"
 #include "NomenclatureItem.hpp"
 #include "precession.h"
@@ -51,6 +52,7 @@
 #include <QFile>
 #include <QDir>
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 
@@ -71,12 +73,33 @@ const double StelCore::JD_DAY    = 1.;
 const double StelCore::ONE_OVER_JD_SECOND = 86400;		// 86400
 const double StelCore::TZ_ERA_BEGINNING = 2395996.5;		// December 1, 1847
 
+// Length of the windows of the tables of UTC offsets [days]. A time zone changes its offset a few times per year at most.
+static const double utcOffsetWindow = 3652.5;
+
+// Conversions between Julian days and UTC dates for the time zone database, valid for any year
+static QDateTime utcFromJD(double JD)
+{
+	return QDateTime::fromMSecsSinceEpoch(qRound64((JD - 2440587.5)*86400000.), Qt::UTC);
+}
+
+static double jdFromUTC(const QDateTime& dateTime)
+{
+	return dateTime.toMSecsSinceEpoch()/86400000. + 2440587.5;
+}
+
+// The secular acceleration of the Moon is a coefficient times this function of the date
+static double getMoonSecularAccelerationTimeFactor(const double JD)
+{
+	return StelUtils::getMoonSecularAcceleration(JD, 0., false)/StelUtils::getMoonSecularAccelerationCoefficient(0., false);
+}
+
 StelCore::StelCore()
 	: skyDrawer(Q_NULLPTR)
 	, movementMgr(Q_NULLPTR)
 	, geodesicGrid(Q_NULLPTR)
 	, currentProjectionType(ProjectionStereographic)
 	, currentDeltaTAlgorithm(EspenakMeeus)
+	, frameCounter(0)
 	, position(Q_NULLPTR)
 	, flagUseNutation(true)
 	, flagUseTopocentricCoordinates(true)	
@@ -92,6 +115,8 @@ StelCore::StelCore()
 	, deltaTnDot(-26.0)
 	, deltaTdontUseMoon(false)
 	, deltaTfunc(StelUtils::getDeltaTByEspenakMeeus)
+	, deltaTTable(Q_NULLPTR)
+	, moonSecularAccelerationTable(Q_NULLPTR)
 	, deltaTstart(-1999)
 	, deltaTfinish(3000)
 	, de430Available(false)
@@ -826,6 +851,165 @@ Vec3d StelCore::heliocentricEclipticToEquinoxEqu(const Vec3d& v) const
 	return matHeliocentricEclipticToEquinoxEqu*v;
 }
 
+bool StelCore::useRefraction(RefractionMode refMode) const
+{
+	return !(refMode==RefractionOff || skyDrawer==Q_NULLPTR || (refMode==RefractionAuto && skyDrawer->getFlagHasAtmosphere()==false));
+}
+
+template<class T> void StelCore::transfoArray(int n, const Vector3<T>* in, Vector3<T>* out, const Mat4d* pre, int refraction, const Mat4d* post) const
+{
+	const Vector3<T>* src = in;
+	if (pre)
+	{
+		pre->transfoArray(n, src, out);
+		src = out;
+	}
+	if (refraction!=0)
+	{
+		if (src!=out)
+		{
+			std::copy(src, src+n, out);
+			src = out;
+		}
+		const Refraction& refr = skyDrawer->getRefraction();
+		if (refraction>0)
+		{
+			for (int i=0; i<n; ++i)
+				refr.forward(out[i]);
+		}
+		else
+		{
+			for (int i=0; i<n; ++i)
+				refr.backward(out[i]);
+		}
+	}
+	if (post)
+	{
+		post->transfoArray(n, src, out);
+		src = out;
+	}
+	if (src!=out)
+		std::copy(src, src+n, out);
+}
+
+void StelCore::altAzToEquinoxEqu(int n, const Vec3d* in, Vec3d* out, RefractionMode refMode) const
+{
+	if (useRefraction(refMode))
+		transfoArray(n, in, out, Q_NULLPTR, -1, &matAltAzToEquinoxEqu);
+	else
+		matAltAzToEquinoxEqu.transfoArray(n, in, out);
+}
+
+void StelCore::altAzToEquinoxEqu(int n, const Vec3f* in, Vec3f* out, RefractionMode refMode) const
+{
+	if (useRefraction(refMode))
+		transfoArray(n, in, out, Q_NULLPTR, -1, &matAltAzToEquinoxEqu);
+	else
+		matAltAzToEquinoxEqu.transfoArray(n, in, out);
+}
+
+void StelCore::equinoxEquToAltAz(int n, const Vec3d* in, Vec3d* out, RefractionMode refMode) const
+{
+	transfoArray(n, in, out, &matEquinoxEquToAltAz, useRefraction(refMode) ? 1 : 0, Q_NULLPTR);
+}
+
+void StelCore::equinoxEquToAltAz(int n, const Vec3f* in, Vec3f* out, RefractionMode refMode) const
+{
+	transfoArray(n, in, out, &matEquinoxEquToAltAz, useRefraction(refMode) ? 1 : 0, Q_NULLPTR);
+}
+
+void StelCore::altAzToJ2000(int n, const Vec3d* in, Vec3d* out, RefractionMode refMode) const
+{
+	transfoArray(n, in, out, Q_NULLPTR, useRefraction(refMode) ? -1 : 0, &matAltAzToJ2000);
+}
+
+void StelCore::altAzToJ2000(int n, const Vec3f* in, Vec3f* out, RefractionMode refMode) const
+{
+	transfoArray(n, in, out, Q_NULLPTR, useRefraction(refMode) ? -1 : 0, &matAltAzToJ2000);
+}
+
+void StelCore::j2000ToAltAz(int n, const Vec3d* in, Vec3d* out, RefractionMode refMode) const
+{
+	transfoArray(n, in, out, &matJ2000ToAltAz, useRefraction(refMode) ? 1 : 0, Q_NULLPTR);
+}
+
+void StelCore::j2000ToAltAz(int n, const Vec3f* in, Vec3f* out, RefractionMode refMode) const
+{
+	transfoArray(n, in, out, &matJ2000ToAltAz, useRefraction(refMode) ? 1 : 0, Q_NULLPTR);
+}
+
+void StelCore::equinoxEquToJ2000(int n, const Vec3d* in, Vec3d* out, RefractionMode refMode) const
+{
+	if (useRefraction(refMode))
+		transfoArray(n, in, out, &matEquinoxEquToAltAz, -1, &matAltAzToJ2000);
+	else
+		matEquinoxEquToJ2000.transfoArray(n, in, out);
+}
+
+void StelCore::equinoxEquToJ2000(int n, const Vec3f* in, Vec3f* out, RefractionMode refMode) const
+{
+	if (useRefraction(refMode))
+		transfoArray(n, in, out, &matEquinoxEquToAltAz, -1, &matAltAzToJ2000);
+	else
+		matEquinoxEquToJ2000.transfoArray(n, in, out);
+}
+
+void StelCore::j2000ToEquinoxEqu(int n, const Vec3d* in, Vec3d* out, RefractionMode refMode) const
+{
+	if (useRefraction(refMode))
+		transfoArray(n, in, out, &matJ2000ToAltAz, 1, &matAltAzToEquinoxEqu);
+	else
+		matJ2000ToEquinoxEqu.transfoArray(n, in, out);
+}
+
+void StelCore::j2000ToEquinoxEqu(int n, const Vec3f* in, Vec3f* out, RefractionMode refMode) const
+{
+	if (useRefraction(refMode))
+		transfoArray(n, in, out, &matJ2000ToAltAz, 1, &matAltAzToEquinoxEqu);
+	else
+		matJ2000ToEquinoxEqu.transfoArray(n, in, out);
+}
+
+void StelCore::galacticToJ2000(int n, const Vec3d* in, Vec3d* out) const
+{
+	matGalacticToJ2000.transfoArray(n, in, out);
+}
+
+void StelCore::galacticToJ2000(int n, const Vec3f* in, Vec3f* out) const
+{
+	matGalacticToJ2000.transfoArray(n, in, out);
+}
+
+void StelCore::j2000ToGalactic(int n, const Vec3d* in, Vec3d* out) const
+{
+	matJ2000ToGalactic.transfoArray(n, in, out);
+}
+
+void StelCore::j2000ToGalactic(int n, const Vec3f* in, Vec3f* out) const
+{
+	matJ2000ToGalactic.transfoArray(n, in, out);
+}
+
+void StelCore::heliocentricEclipticToAltAz(int n, const Vec3d* in, Vec3d* out, RefractionMode refMode) const
+{
+	transfoArray(n, in, out, &matHeliocentricEclipticJ2000ToAltAz, useRefraction(refMode) ? 1 : 0, Q_NULLPTR);
+}
+
+void StelCore::heliocentricEclipticToAltAz(int n, const Vec3f* in, Vec3f* out, RefractionMode refMode) const
+{
+	transfoArray(n, in, out, &matHeliocentricEclipticJ2000ToAltAz, useRefraction(refMode) ? 1 : 0, Q_NULLPTR);
+}
+
+void StelCore::heliocentricEclipticToEquinoxEqu(int n, const Vec3d* in, Vec3d* out) const
+{
+	matHeliocentricEclipticToEquinoxEqu.transfoArray(n, in, out);
+}
+
+void StelCore::heliocentricEclipticToEquinoxEqu(int n, const Vec3f* in, Vec3f* out) const
+{
+	matHeliocentricEclipticToEquinoxEqu.transfoArray(n, in, out);
+}
+
 /*
 //! Transform vector from heliocentric coordinate to false equatorial : equatorial
 //! coordinate but centered on the observer position (useful for objects close to earth)
@@ -939,6 +1123,7 @@ StelProjector::ModelViewTranformP StelCore::getSupergalacticModelViewTransform(R
 // called in update() (for every frame)
 void StelCore::updateTransformMatrices()
 {
+	invalidateFrameCache();
 	matAltAzToEquinoxEqu = position->getRotAltAzToEquatorial(getJD(), getJDE());
 	matEquinoxEquToAltAz = matAltAzToEquinoxEqu.transpose();
 
@@ -1292,46 +1477,29 @@ void StelCore::moveObserverTo(const StelLocation& target, double duration, doubl
 
 float StelCore::getUTCOffset(const double JD) const
 {
-	int year, month, day, hour, minute, second;
-	StelUtils::getDateFromJulianDay(JD, &year, &month, &day);
-	StelUtils::getTimeFromJulianDay(JD, &hour, &minute, &second);
-	// as analogous to second statement in getJDFromDate, nkerr
-	if ( year <= 0 )
+	const StelLocation& loc = getCurrentLocation();
+	const QString& tzName = currentTimeZone;
+	if (tzName!=utcOffsetTable.timeZoneName)
 	{
-		year = year - 1;
+		// The time zone changed: its transitions are read again when needed
+		const QTimeZone tz(tzName.toUtf8());
+		utcOffsetTable.timeZoneName = tzName;
+		utcOffsetTable.validName = tz.isValid();
+		utcOffsetTable.timeZone = tz.isValid() ? tz : QTimeZone::systemTimeZone();
+		utcOffsetTable.beginJD = utcOffsetTable.endJD = 0.;
 	}
-	//getTime/DateFromJulianDay returns UTC time, not local time
-	QDateTime universal(QDate(year, month, day), QTime(hour, minute, second), Qt::UTC);
-	if (!universal.isValid())
-	{
-		//qWarning() << "JD " << QString("%1").arg(JD) << " out of bounds of QT help with GMT shift, using current datetime";
-		// Assumes the GMT shift was always the same before year -4710
-		universal = QDateTime(QDate(-4710, month, day), QTime(hour, minute, second), Qt::UTC);
-	}
-
-	StelLocation loc = getCurrentLocation();
-	QString tzName = getCurrentTimeZone();
-	QTimeZone* tz = new QTimeZone(tzName.toUtf8());
 
 	int shiftInSeconds = 0;
-	if (tzName=="system_default" || (loc.planetName=="Earth" && !tz->isValid() && !QString("LMST LTST").contains(tzName)))
+	if (tzName=="system_default" || (loc.planetName=="Earth" && !utcOffsetTable.validName && !QString("LMST LTST").contains(tzName)))
 	{
-		QDateTime local = universal.toLocalTime();
-		//Both timezones should be interpreted as UTC because secsTo() converts both
-		//times to UTC if their zones have different daylight saving time rules.
-		local.setTimeSpec(Qt::UTC);
-		shiftInSeconds = universal.secsTo(local);
+		// Local time of the system, always with DST
+		shiftInSeconds = lookupUTCOffset(JD, true);
 	}
 	else
 	{
 		// The first adoption of a standard time was on December 1, 1847 in Great Britain
-		if (tz->isValid() && loc.planetName=="Earth" && (JD>=StelCore::TZ_ERA_BEGINNING || getUseCustomTimeZone()))
-		{
-			if (getUseDST())
-				shiftInSeconds = tz->offsetFromUtc(universal);
-			else
-				shiftInSeconds = tz->standardTimeOffset(universal);
-		}
+		if (utcOffsetTable.validName && loc.planetName=="Earth" && (JD>=StelCore::TZ_ERA_BEGINNING || getUseCustomTimeZone()))
+			shiftInSeconds = lookupUTCOffset(JD, getUseDST());
 		else
 			shiftInSeconds = (loc.longitude/15.f)*3600.f; // Local Mean Solar Time
 
@@ -1340,13 +1508,49 @@ float StelCore::getUTCOffset(const double JD) const
 
 	}
 
-	delete tz;
-	tz = Q_NULLPTR;
-
 	float shiftInHours = shiftInSeconds / 3600.0f;
 	return shiftInHours;
 }
 
+int StelCore::lookupUTCOffset(double JD, bool useDST) const
+{
+	UTCOffsetTable& table = utcOffsetTable;
+	if (!table.timeZone.hasTransitions())
+	{
+		// Without a list of transitions, ask the zone every time
+		const QTimeZone::OffsetData data = table.timeZone.offsetData(utcFromJD(JD));
+		return useDST ? data.offsetFromUtc : data.standardTimeOffset;
+	}
+
+	if (JD<table.beginJD || JD>=table.endJD)
+	{
+		table.beginJD = std::floor(JD/utcOffsetWindow)*utcOffsetWindow;
+		table.endJD = table.beginJD + utcOffsetWindow;
+		table.transitionJD.clear();
+		table.offset.clear();
+		table.standardOffset.clear();
+
+		const QDateTime begin = utcFromJD(table.beginJD);
+		const QTimeZone::OffsetData first = table.timeZone.offsetData(begin);
+		table.transitionJD.append(table.beginJD);
+		table.offset.append(first.offsetFromUtc);
+		table.standardOffset.append(first.standardTimeOffset);
+		foreach (const QTimeZone::OffsetData& transition, table.timeZone.transitions(begin, utcFromJD(table.endJD)))
+		{
+			const double transitionJD = jdFromUTC(transition.atUtc);
+			if (transitionJD<=table.beginJD)
+				continue;
+			table.transitionJD.append(transitionJD);
+			table.offset.append(transition.offsetFromUtc);
+			table.standardOffset.append(transition.standardTimeOffset);
+		}
+	}
+
+	// The last change before JD
+	const int i = std::upper_bound(table.transitionJD.constBegin(), table.transitionJD.constEnd(), JD) - table.transitionJD.constBegin() - 1;
+	return useDST ? table.offset.at(i) : table.standardOffset.at(i);
+}
+
 QString StelCore::getCurrentTimeZone() const
 {
 	return currentTimeZone;
@@ -1932,10 +2136,12 @@ double StelCore::getDeltaT() const
 double StelCore::computeDeltaT(const double JD)
 {
 	double DeltaT = 0.;
+	// Nothing is written here: positions may be computed from worker threads.
+	double nDot = deltaTnDot;
 	if (currentDeltaTAlgorithm==Custom)
 	{
 		// User defined coefficients for quadratic equation for DeltaT may change frequently.
-		deltaTnDot = deltaTCustomNDot; // n.dot = custom value "/cy/cy
+		nDot = deltaTCustomNDot; // n.dot = custom value "/cy/cy
 		int year, month, day;
 		StelUtils::getDateFromJulianDay(JD, &year, &month, &day);
 		double u = (StelUtils::getDecYear(year,month,day)-getDeltaTCustomYear())/100;
@@ -1945,11 +2151,17 @@ double StelCore::computeDeltaT(const double JD)
 	else
 	{
 		Q_ASSERT(deltaTfunc);
-		DeltaT=deltaTfunc(JD);
+		DeltaT = deltaTTable ? deltaTTable->value(JD) : deltaTfunc(JD);
 	}
 
 	if (!deltaTdontUseMoon)
-		DeltaT += StelUtils::getMoonSecularAcceleration(JD, deltaTnDot, ((de430Active&&EphemWrapper::jd_fits_de430(JD)) || (de431Active&&EphemWrapper::jd_fits_de431(JD))));
+	{
+		const bool useDE43x = (de430Active&&EphemWrapper::jd_fits_de430(JD)) || (de431Active&&EphemWrapper::jd_fits_de431(JD));
+		if (moonSecularAccelerationTable)
+			DeltaT += StelUtils::getMoonSecularAccelerationCoefficient(nDot, useDE43x)*moonSecularAccelerationTable->value(JD);
+		else
+			DeltaT += StelUtils::getMoonSecularAcceleration(JD, nDot, useDE43x);
+	}
 
 	return DeltaT;
 }
@@ -2208,6 +2420,10 @@ void StelCore::setCurrentDeltaTAlgorithm(DeltaTAlgorithm algorithm)
 			qCritical() << "StelCore: unknown DeltaT algorithm selected (" << currentDeltaTAlgorithm << ")! (setting nDot=-26., but no function!!)";
 	}
 	Q_ASSERT((currentDeltaTAlgorithm==Custom) || (deltaTfunc!=Q_NULLPTR));
+
+	// The algorithms are tabulated once for the whole session. The custom equation is cheap and its coefficients may change at any time.
+	deltaTTable = deltaTfunc ? StelDeltaTTable::get(deltaTfunc) : Q_NULLPTR;
+	moonSecularAccelerationTable = StelDeltaTTable::get(getMoonSecularAccelerationTimeFactor);
 }
 
 //! Set the current algorithm for time correction to use
@@ -28,13 +28,16 @@
 #include <QString>
 #include <QStringList>
 #include <QTime>
+#include <QTimeZone>
 #include <QPair>
+#include <QVector>
 
 class StelToneReproducer;
 class StelSkyDrawer;
 class StelGeodesicGrid;
 class StelMovementMgr;
 class StelObserver;
+class StelDeltaTTable;
 
 //! @class StelCore
 //! Main class for Stellarium core processing.
@@ -239,6 +242,34 @@ public:
 
 	//! Transform from heliocentric coordinate to equatorial at current equinox (for the planet where the observer stands)
 	Vec3d heliocentricEclipticToEquinoxEqu(const Vec3d& v) const;
+
+	//! @name Transformations of arrays
+	//! Transform the n vectors of in into out like the functions of the same name for a single vector do.
+	//! Each matrix is applied to the whole array in one loop, which the compiler can vectorize,
+	//! so that these are much faster for long arrays of vertices than calls per vector.
+	//! in and out may be the same array.
+	//@{
+	void altAzToEquinoxEqu(int n, const Vec3d* in, Vec3d* out, RefractionMode refMode=RefractionAuto) const;
+	void altAzToEquinoxEqu(int n, const Vec3f* in, Vec3f* out, RefractionMode refMode=RefractionAuto) const;
+	void equinoxEquToAltAz(int n, const Vec3d* in, Vec3d* out, RefractionMode refMode=RefractionAuto) const;
+	void equinoxEquToAltAz(int n, const Vec3f* in, Vec3f* out, RefractionMode refMode=RefractionAuto) const;
+	void altAzToJ2000(int n, const Vec3d* in, Vec3d* out, RefractionMode refMode=RefractionAuto) const;
+	void altAzToJ2000(int n, const Vec3f* in, Vec3f* out, RefractionMode refMode=RefractionAuto) const;
+	void j2000ToAltAz(int n, const Vec3d* in, Vec3d* out, RefractionMode refMode=RefractionAuto) const;
+	void j2000ToAltAz(int n, const Vec3f* in, Vec3f* out, RefractionMode refMode=RefractionAuto) const;
+	void equinoxEquToJ2000(int n, const Vec3d* in, Vec3d* out, RefractionMode refMode=RefractionAuto) const;
+	void equinoxEquToJ2000(int n, const Vec3f* in, Vec3f* out, RefractionMode refMode=RefractionAuto) const;
+	void j2000ToEquinoxEqu(int n, const Vec3d* in, Vec3d* out, RefractionMode refMode=RefractionAuto) const;
+	void j2000ToEquinoxEqu(int n, const Vec3f* in, Vec3f* out, RefractionMode refMode=RefractionAuto) const;
+	void galacticToJ2000(int n, const Vec3d* in, Vec3d* out) const;
+	void galacticToJ2000(int n, const Vec3f* in, Vec3f* out) const;
+	void j2000ToGalactic(int n, const Vec3d* in, Vec3d* out) const;
+	void j2000ToGalactic(int n, const Vec3f* in, Vec3f* out) const;
+	void heliocentricEclipticToAltAz(int n, const Vec3d* in, Vec3d* out, RefractionMode refMode=RefractionAuto) const;
+	void heliocentricEclipticToAltAz(int n, const Vec3f* in, Vec3f* out, RefractionMode refMode=RefractionAuto) const;
+	void heliocentricEclipticToEquinoxEqu(int n, const Vec3d* in, Vec3d* out) const;
+	void heliocentricEclipticToEquinoxEqu(int n, const Vec3f* in, Vec3f* out) const;
+	//@}
 //	//! Transform vector from heliocentric coordinate to false equatorial : equatorial
 //	//! coordinate but centered on the observer position (useful for objects close to earth)
 //	//! Unused as of V0.13
@@ -284,9 +315,18 @@ public:
 	//! Return the observer heliocentric ecliptic position (GZ: presumably J2000)
 	Vec3d getObserverHeliocentricEclipticPos() const;
 
+	//! Get a counter which changes whenever the positions of the solar system objects or the
+	//! transformation matrices may have changed: at least once per frame, and whenever they are
+	//! recomputed, e.g. for another date by AstroCalc. Objects may cache the coordinates they
+	//! derive from them as long as it keeps the same value.
+	quint64 getFrameCounter() const {return frameCounter;}
+	//! Change the frame counter, so that the coordinates cached for the current value are not used anymore.
+	void invalidateFrameCache() {++frameCounter;}
+
 	//! Get the informations on the current location
 	const StelLocation& getCurrentLocation() const;
 	//! Get the UTC offset on the current location (in hours)
+	//! The offsets of the time zone are cached for a few years around JD: call it from the main thread only.
 	float getUTCOffset(const double JD) const;
 
 	QString getCurrentTimeZone() const;
@@ -692,7 +732,7 @@ public slots:
 	//! Get n-dot for custom equation for calculation of DeltaT
 	float getDeltaTCustomNDot() const { return deltaTCustomNDot; }
 	//! Get n-dot for current DeltaT algorithm
-	float getDeltaTnDot() const { return deltaTnDot; }
+	float getDeltaTnDot() const { return currentDeltaTAlgorithm==Custom ? deltaTCustomNDot : deltaTnDot; }
 	//! Get coefficients for custom equation for calculation of DeltaT
 	Vec3f getDeltaTCustomEquationCoefficients() const { return deltaTCustomEquationCoeff; }
 
@@ -765,6 +805,12 @@ private:
 
 	void registerMathMetaTypes();
 
+	// Whether the coordinate transformations apply refraction in refMode
+	bool useRefraction(RefractionMode refMode) const;
+	// Transform n vectors by pre, apply refraction forward (refraction>0) or backward (refraction<0), then transform them by post.
+	// pre and post may be null.
+	template<class T> void transfoArray(int n, const Vector3<T>* in, Vector3<T>* out, const Mat4d* pre, int refraction, const Mat4d* post) const;
+
 
 	// Matrices used for every coordinate transfo
 	Mat4d matHeliocentricEclipticJ2000ToAltAz; // Transform from heliocentric ecliptic Cartesian (VSOP87A) to topocentric (StelObserver) altazimuthal coordinate
@@ -782,6 +828,9 @@ private:
 	Mat4d matAltAzModelView;           // Modelview matrix for observer-centric altazimuthal drawing
 	Mat4d invertMatAltAzModelView;     // Inverted modelview matrix for observer-centric altazimuthal drawing
 
+	// See getFrameCounter()
+	quint64 frameCounter;
+
 	// Position variables
 	StelObserver* position;
 	// The ID of the default startup location
@@ -807,6 +856,23 @@ private:
 	bool flagUseDST;
 	bool flagUseCTZ; // custom time zone
 
+	// Offsets from UTC of the current time zone, from its transitions over a window of years.
+	// Building a QTimeZone and converting dates through it for every call of getUTCOffset() is slow.
+	struct UTCOffsetTable
+	{
+		UTCOffsetTable() : validName(false), beginJD(0.), endJD(0.) {}
+		QString timeZoneName;         // name of the time zone the table was made for
+		QTimeZone timeZone;           // the zone of that name, or the zone of the system if the name is not valid
+		bool validName;               // whether the name is a valid zone (it is not for "system_default", "LMST"...)
+		double beginJD, endJD;        // window covered by the table
+		QVector<double> transitionJD; // UTC dates of the changes of offset, the first one is beginJD
+		QVector<int> offset;          // offset from UTC after each change, with DST [seconds]
+		QVector<int> standardOffset;  // standard offset from UTC after each change [seconds]
+	};
+	mutable UTCOffsetTable utcOffsetTable;
+	// Get the offset from UTC at JD [seconds] of the time zone of utcOffsetTable, building the table for the window of JD if needed
+	int lookupUTCOffset(double JD, bool useDST) const;
+
 	// Variables for equations of DeltaT
 	Vec3f deltaTCustomEquationCoeff;
 	float deltaTCustomNDot;
@@ -814,6 +880,8 @@ private:
 	float deltaTnDot; // The currently applied nDot correction. (different per algorithm, and displayed in status line.)
 	bool  deltaTdontUseMoon; // true if the currenctly selected algorithm does not do a lunar correction (?????)
 	double (*deltaTfunc)(const double JD); // This is a function pointer which must be set to a function which computes DeltaT(JD).
+	const StelDeltaTTable* deltaTTable; // Table of deltaTfunc, null for the custom equation.
+	const StelDeltaTTable* moonSecularAccelerationTable; // Table of the time factor of StelUtils::getMoonSecularAcceleration().
 	int deltaTstart;   // begin year of validity range for the selected DeltaT algorithm. (SET INT_MIN to mark infinite)
 	int deltaTfinish;  // end   year of validity range for the selected DeltaT algorithm. (Set INT_MAX to mark infinite)
 
@@ -0,0 +1,95 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelDeltaTTable.hpp"
+
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <cmath>
+
+namespace
+{
+	// Years -2000 to 3000, which covers the validity ranges of all algorithms
+	const double tableBeginJD = 2451545.0 - 4000.*365.25;
+	const double tableEndJD = 2451545.0 + 1000.*365.25;
+	// Eight samples per year [days]
+	const double tableStep = 365.25/8.;
+	// Largest difference to the function allowed at the checked points of an interval [s]
+	const double maxError = 0.05;
+
+	QMutex tablesMutex;
+	QList<StelDeltaTTable*> tables;
+	QList<StelDeltaTTable::Function> tableFunctions;
+}
+
+const StelDeltaTTable* StelDeltaTTable::get(Function function)
+{
+	QMutexLocker locker(&tablesMutex);
+	const int i = tableFunctions.indexOf(function);
+	if (i>=0)
+		return tables.at(i);
+	StelDeltaTTable* table = new StelDeltaTTable(function, tableBeginJD, tableEndJD, tableStep);
+	tables.append(table);
+	tableFunctions.append(function);
+	return table;
+}
+
+StelDeltaTTable::StelDeltaTTable(Function function, double beginJD, double endJD, double step)
+	: function(function)
+	, beginJD(beginJD)
+	, step(step)
+{
+	const int n = static_cast<int>(std::ceil((endJD-beginJD)/step)) + 1;
+	values.resize(n);
+	for (int i=0; i<n; ++i)
+		values[i] = function(beginJD + i*step);
+
+	// Several algorithms jump from a polynomial to the next one, or from a year to the next one,
+	// and the spline would smear these jumps over two steps. Check each interval at its quarters
+	// and call the function directly in the intervals where the spline does not follow it.
+	interpolated.fill(false, n);
+	for (int i=1; i<n-2; ++i)
+	{
+		bool ok = true;
+		for (int k=1; k<4 && ok; ++k)
+			ok = std::fabs(interpolate(i, 0.25*k) - function(beginJD + (i+0.25*k)*step)) <= maxError;
+		interpolated[i] = ok;
+	}
+}
+
+double StelDeltaTTable::interpolate(const int i, const double t) const
+{
+	const double y0 = values.at(i-1);
+	const double y1 = values.at(i);
+	const double y2 = values.at(i+1);
+	const double y3 = values.at(i+2);
+	return y1 + 0.5*t*(y2-y0 + t*(2.*y0-5.*y1+4.*y2-y3 + t*(3.*(y1-y2)+y3-y0)));
+}
+
+double StelDeltaTTable::value(const double JD) const
+{
+	const double x = (JD-beginJD)/step;
+	const int i = static_cast<int>(std::floor(x));
+	// The interpolation needs a sample before and two after
+	if (i<1 || i>values.size()-3 || !interpolated.at(i))
+		return function(JD);
+	return interpolate(i, x-i);
+}
@@ -0,0 +1,64 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELDELTATTABLE_HPP_
+#define _STELDELTATTABLE_HPP_
+
+#include <QVector>
+
+//! @class StelDeltaTTable
+//! A function of the date, like the DeltaT algorithms of StelUtils, tabulated every few weeks
+//! and interpolated with a cubic (Catmull-Rom) spline.
+//! DeltaT is computed for every position of every body, and most algorithms convert the JD to a
+//! calendar date and evaluate a piecewise polynomial each time. A table answers in constant time.
+//! Each interval of the table is checked against the function when it is built: where the spline
+//! does not follow the function within 0.05 s, like around the dates where an algorithm jumps from
+//! a polynomial to the next one or where it changes once a year, the function is called directly.
+//! Elsewhere, as the algorithms give the same value for the whole day, the error is at most
+//! 0.05 s plus half the change of DeltaT in a day, which stays below 0.2 s over the table.
+//! Outside the years covered by the table, the function is called directly.
+//! The tables are immutable: they can be read from any thread.
+class StelDeltaTTable
+{
+public:
+	typedef double (*Function)(const double JD);
+
+	//! Get the table of a function, which is built the first time and then kept,
+	//! as the DeltaT functions do not change. Thread-safe.
+	static const StelDeltaTTable* get(Function function);
+
+	//! Get the interpolated value of the function at JD.
+	double value(const double JD) const;
+
+private:
+	StelDeltaTTable(Function function, double beginJD, double endJD, double step);
+	Q_DISABLE_COPY(StelDeltaTTable)
+
+	//! Catmull-Rom spline through the samples i-1 to i+2, at the fraction t of the interval from i to i+1.
+	double interpolate(const int i, const double t) const;
+
+	Function function;
+	double beginJD;
+	double step;
+	QVector<double> values;
+	//! Whether the spline is used in the interval beginning at each sample.
+	QVector<bool> interpolated;
+};
+
+#endif // _STELDELTATTABLE_HPP_
@@ -0,0 +1,211 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelEphemerisSession.hpp"
+#include "StelApp.hpp"
+#include "StelModuleMgr.hpp"
+#include "StelSkyDrawer.hpp"
+#include "StelUtils.hpp"
+#include "SolarSystem.hpp"
+
+#include <QThread>
+
+#include <cmath>
+
+namespace
+{
+	// Light time per AU [days]
+	const double lightTimePerAU = AU / (SPEED_OF_LIGHT * 86400.);
+	// Each evaluation of the light time reduces its error about 10000 times (see SolarSystem.cpp)
+	const int maxLightTimeIterations = 3;
+	// About 10 ms
+	const double lightTimeTolerance = 1e-7;
+}
+
+StelEphemerisSession::Settings::Settings(StelCore* core)
+	: core(core)
+	, observer(new StelObserver(core->getCurrentLocation()), &QObject::deleteLater)
+{
+	init();
+}
+
+StelEphemerisSession::Settings::Settings(StelCore* core, const StelLocation& location)
+	: core(core)
+	, observer(new StelObserver(location), &QObject::deleteLater)
+{
+	init();
+}
+
+void StelEphemerisSession::Settings::init()
+{
+	Q_ASSERT(QThread::currentThread()==StelApp::getInstance().thread());
+	topocentric = core->getUseTopocentricCoordinates();
+	lightTime = GETSTELMODULE(SolarSystem)->getFlagLightTravelTime();
+	const StelSkyDrawer* skyDrawer = core->getSkyDrawer();
+	hasAtmosphere = skyDrawer!=Q_NULLPTR && skyDrawer->getFlagHasAtmosphere();
+	if (skyDrawer)
+		refraction = skyDrawer->getRefraction();
+	JD = core->getJD();
+}
+
+StelEphemerisSession::StelEphemerisSession(StelCore* core)
+	: settings(core)
+{
+	setJD(settings.JD);
+}
+
+StelEphemerisSession::StelEphemerisSession(StelCore* core, const StelLocation& location)
+	: settings(core, location)
+{
+	setJD(settings.JD);
+}
+
+StelEphemerisSession::StelEphemerisSession(const Settings& settings)
+	: settings(settings)
+{
+	setJD(settings.JD);
+}
+
+void StelEphemerisSession::setJD(double newJD)
+{
+	// Same as StelCore::setJD() and StelCore::updateTransformMatrices(), on the matrices of the session
+	JD = newJD;
+	JDE = JD + settings.core->computeDeltaT(JD)/86400.;
+
+	const StelObserver& observer = *settings.observer;
+	const PlanetP home = observer.getHomePlanet();
+	const Vec3d center = home->computeHeliocentricEclipticPos(JDE);
+	matAltAzToEquinoxEqu = observer.getRotAltAzToEquatorial(JD, JDE);
+	matEquinoxEquToAltAz = matAltAzToEquinoxEqu.transpose();
+	matEquinoxEquToJ2000 = StelCore::matVsop87ToJ2000 * home->computeRotEquatorialToVsop87(JDE);
+	matJ2000ToEquinoxEqu = matEquinoxEquToJ2000.transpose();
+	matJ2000ToAltAz = matEquinoxEquToAltAz*matJ2000ToEquinoxEqu;
+
+	observerPos = center;
+	if (settings.topocentric)
+	{
+		const Vec3d offset = observer.getTopographicOffsetFromCenter();
+		const double sigma = observer.getCurrentLocation().latitude*M_PI/180.0 - offset[2];
+		const double rho = observer.getDistanceFromCenter();
+		const Mat4d altAzToVsop87 = StelCore::matJ2000ToVsop87 * matEquinoxEquToJ2000 * matAltAzToEquinoxEqu;
+		observerPos += altAzToVsop87.multiplyWithoutTranslation(Vec3d(rho*std::sin(sigma), 0., rho*std::cos(sigma)));
+	}
+
+	if (settings.lightTime)
+	{
+		// Like in SolarSystem::computePositions(): the Sun is seen displaced by the motion of the home planet during the light time
+		sunPos = center - home->computeHeliocentricEclipticPos(JDE - center.length()*lightTimePerAU);
+	}
+	else
+		sunPos.set(0., 0., 0.);
+}
+
+Vec3d StelEphemerisSession::getHeliocentricEclipticPos(const PlanetP& body) const
+{
+	if (!body->getParent())
+		return sunPos;
+	Vec3d pos = body->computeHeliocentricEclipticPos(JDE);
+	if (settings.lightTime)
+	{
+		double lightTimeJDE = JDE;
+		for (int i=0; i<maxLightTimeIterations; ++i)
+		{
+			const double correctedJDE = JDE - (pos-observerPos).length()*lightTimePerAU;
+			if (std::fabs(correctedJDE-lightTimeJDE) <= lightTimeTolerance)
+				break;
+			lightTimeJDE = correctedJDE;
+			pos = body->computeHeliocentricEclipticPos(lightTimeJDE);
+		}
+	}
+	return pos;
+}
+
+Vec3d StelEphemerisSession::getJ2000EquatorialPos(const PlanetP& body) const
+{
+	return StelCore::matVsop87ToJ2000.multiplyWithoutTranslation(getHeliocentricEclipticPos(body) - observerPos);
+}
+
+Vec3d StelEphemerisSession::getObjectJ2000EquatorialPos(const StelObjectP& object) const
+{
+	const PlanetP body = qSharedPointerDynamicCast<Planet>(object);
+	if (body)
+		return getJ2000EquatorialPos(body);
+	return object->getJ2000EquatorialPosAtJDE(settings.core, JDE);
+}
+
+Vec3d StelEphemerisSession::getObjectAltAzPos(const StelObjectP& object, StelCore::RefractionMode refMode) const
+{
+	return j2000ToAltAz(getObjectJ2000EquatorialPos(object), refMode);
+}
+
+Vec3d StelEphemerisSession::getEquinoxEquatorialPos(const PlanetP& body) const
+{
+	return matJ2000ToEquinoxEqu*getJ2000EquatorialPos(body);
+}
+
+Vec3d StelEphemerisSession::getAltAzPos(const PlanetP& body, StelCore::RefractionMode refMode) const
+{
+	return j2000ToAltAz(getJ2000EquatorialPos(body), refMode);
+}
+
+double StelEphemerisSession::getSpheroidAngularSize(const PlanetP& body) const
+{
+	return std::atan2(body->getRadius()*body->getSphereScale(), getJ2000EquatorialPos(body).length()) * 180./M_PI;
+}
+
+double StelEphemerisSession::getPhaseAngle(const PlanetP& body) const
+{
+	// Same as Planet::getPhaseAngle()
+	const double observerRq = observerPos.lengthSquared();
+	const Vec3d planetHelioPos = getHeliocentricEclipticPos(body);
+	const double planetRq = planetHelioPos.lengthSquared();
+	const double observerPlanetRq = (observerPos - planetHelioPos).lengthSquared();
+	return std::acos((observerPlanetRq + planetRq - observerRq)/(2.0*std::sqrt(observerPlanetRq*planetRq)));
+}
+
+double StelEphemerisSession::getElongation(const PlanetP& body) const
+{
+	// Same as Planet::getElongation()
+	const double observerRq = observerPos.lengthSquared();
+	const Vec3d planetHelioPos = getHeliocentricEclipticPos(body);
+	const double planetRq = planetHelioPos.lengthSquared();
+	const double observerPlanetRq = (observerPos - planetHelioPos).lengthSquared();
+	return std::acos((observerPlanetRq + observerRq - planetRq)/(2.0*std::sqrt(observerPlanetRq*observerRq)));
+}
+
+bool StelEphemerisSession::useRefraction(StelCore::RefractionMode refMode) const
+{
+	return refMode==StelCore::RefractionOn || (refMode==StelCore::RefractionAuto && settings.hasAtmosphere);
+}
+
+Vec3d StelEphemerisSession::j2000ToAltAz(const Vec3d& v, StelCore::RefractionMode refMode) const
+{
+	Vec3d r = matJ2000ToAltAz*v;
+	if (useRefraction(refMode))
+		settings.refraction.forward(r);
+	return r;
+}
+
+Vec3d StelEphemerisSession::equinoxEquToAltAz(const Vec3d& v, StelCore::RefractionMode refMode) const
+{
+	Vec3d r = matEquinoxEquToAltAz*v;
+	if (useRefraction(refMode))
+		settings.refraction.forward(r);
+	return r;
+}
@@ -0,0 +1,150 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELEPHEMERISSESSION_HPP_
+#define _STELEPHEMERISSESSION_HPP_
+
+#include "Planet.hpp"
+#include "RefractionExtinction.hpp"
+#include "StelCore.hpp"
+#include "StelLocation.hpp"
+#include "StelObject.hpp"
+#include "StelObserver.hpp"
+#include "VecMath.hpp"
+
+//! @class StelEphemerisSession
+//! Positions of solar system bodies for an observer at any date, computed without changing
+//! the time of StelCore or the state of the planets. Other objects, like the stars with their
+//! proper motion, are computed at the date of the session too (see getObjectJ2000EquatorialPos()).
+//! Batch computations (AstroCalc tables, searches of phenomena, plugins) used to set the date
+//! of StelCore and update it for every sample, which recomputes the whole solar system,
+//! emits the signals of a time change and disturbs the view. A session computes only
+//! the bodies asked for, with the same corrections as StelCore and SolarSystem:
+//! DeltaT, precession and nutation, topocentric coordinates, light time and refraction.
+//! The settings are taken from StelCore when the session is created, or when its Settings
+//! are captured. Sessions are created from StelCore on the main thread only, but from Settings
+//! in any thread: a worker of QtConcurrent creates its own session from the settings captured
+//! by the main thread, and several sessions can run concurrently.
+//! The getters are const and thread-safe, but setJD() must not run concurrently with them.
+//! Usage:
+//! @code
+//! StelEphemerisSession session(core);
+//! for (double jd=startJD; jd<stopJD; jd+=step)
+//! {
+//! 	session.setJD(jd);
+//! 	Vec3d altAz = session.getAltAzPos(planet);
+//! 	...
+//! }
+//! @endcode
+class StelEphemerisSession
+{
+public:
+	//! @class Settings
+	//! The settings of sessions, copied from StelCore, SolarSystem and StelSkyDrawer.
+	//! They must be captured on the main thread, but can be copied to any thread.
+	class Settings
+	{
+	public:
+		//! Capture the settings for the current location and date of core.
+		explicit Settings(StelCore* core);
+		//! Capture the settings for another location. If its planet is unknown, the Earth is used.
+		Settings(StelCore* core, const StelLocation& location);
+
+	private:
+		friend class StelEphemerisSession;
+		void init();
+
+		StelCore* core;
+		// Only read by the sessions. It is deleted in the main thread, which owns it.
+		QSharedPointer<StelObserver> observer;
+		bool topocentric;
+		bool lightTime;
+		bool hasAtmosphere;
+		Refraction refraction;
+		double JD;
+	};
+
+	//! Create a session for the current location and date of core. Main thread only.
+	explicit StelEphemerisSession(StelCore* core);
+	//! Create a session for another location. If its planet is unknown, the Earth is used. Main thread only.
+	StelEphemerisSession(StelCore* core, const StelLocation& location);
+	//! Create a session from captured settings, at their date. Any thread.
+	explicit StelEphemerisSession(const Settings& settings);
+
+	//! Set the date of the session.
+	//! @param JD the Julian day (UT). JDE is computed with the DeltaT algorithm of StelCore.
+	void setJD(double JD);
+	double getJD() const {return JD;}
+	double getJDE() const {return JDE;}
+
+	const StelLocation& getLocation() const {return settings.observer->getCurrentLocation();}
+	PlanetP getHomePlanet() const {return settings.observer->getHomePlanet();}
+
+	//! Get the position of the observer in heliocentric ecliptic J2000 coordinates [AU]
+	Vec3d getObserverHeliocentricEclipticPos() const {return observerPos;}
+
+	//! Get the heliocentric ecliptic J2000 position of a body [AU], corrected for light time if enabled.
+	Vec3d getHeliocentricEclipticPos(const PlanetP& body) const;
+	//! Get the position of a body relative to the observer in equatorial J2000 coordinates [AU],
+	//! like Planet::getJ2000EquatorialPos().
+	Vec3d getJ2000EquatorialPos(const PlanetP& body) const;
+	//! Get the position of a body relative to the observer in equatorial coordinates of date [AU].
+	Vec3d getEquinoxEquatorialPos(const PlanetP& body) const;
+	//! Get the position of a body relative to the observer in altazimuthal coordinates [AU].
+	Vec3d getAltAzPos(const PlanetP& body, StelCore::RefractionMode refMode=StelCore::RefractionAuto) const;
+	//! Get the position of any object relative to the observer in equatorial J2000 coordinates at the date of the session.
+	//! Solar system bodies are computed like by getJ2000EquatorialPos(), the other objects by
+	//! StelObject::getJ2000EquatorialPosAtJDE() (e.g. stars with their proper motion, in AU or as unit vectors).
+	Vec3d getObjectJ2000EquatorialPos(const StelObjectP& object) const;
+	//! Get the position of any object relative to the observer in altazimuthal coordinates at the date of the session.
+	Vec3d getObjectAltAzPos(const StelObjectP& object, StelCore::RefractionMode refMode=StelCore::RefractionAuto) const;
+	//! Get the angular size of the spheroid of a body (i.e. without the rings) [degrees]
+	double getSpheroidAngularSize(const PlanetP& body) const;
+	//! Get the phase angle of a body [radians]
+	double getPhaseAngle(const PlanetP& body) const;
+	//! Get the elongation of a body [radians]
+	double getElongation(const PlanetP& body) const;
+
+	//! Transform a vector from equatorial J2000 coordinates, like StelCore::j2000ToEquinoxEqu() without refraction.
+	Vec3d j2000ToEquinoxEqu(const Vec3d& v) const {return matJ2000ToEquinoxEqu*v;}
+	//! Transform a vector from equatorial J2000 coordinates, like StelCore::j2000ToAltAz().
+	Vec3d j2000ToAltAz(const Vec3d& v, StelCore::RefractionMode refMode=StelCore::RefractionAuto) const;
+	//! Transform a vector from equatorial coordinates of date, like StelCore::equinoxEquToAltAz().
+	Vec3d equinoxEquToAltAz(const Vec3d& v, StelCore::RefractionMode refMode=StelCore::RefractionAuto) const;
+
+private:
+	Q_DISABLE_COPY(StelEphemerisSession)
+
+	bool useRefraction(StelCore::RefractionMode refMode) const;
+
+	const Settings settings;
+
+	double JD;
+	double JDE;
+	Vec3d observerPos;
+	// Where the Sun is seen, like SolarSystem::getLightTimeSunPosition()
+	Vec3d sunPos;
+	Mat4d matAltAzToEquinoxEqu;
+	Mat4d matEquinoxEquToAltAz;
+	Mat4d matEquinoxEquToJ2000;
+	Mat4d matJ2000ToEquinoxEqu;
+	Mat4d matJ2000ToAltAz;
+};
+
+#endif // _STELEPHEMERISSESSION_HPP_
@@ -0,0 +1,286 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelEventFinder.hpp"
+
+#include <QtGlobal>
+
+#include <cmath>
+
+namespace
+{
+	// Enough for any bracket of a few days and a tolerance down to a millisecond
+	const int maxIterations = 100;
+	// Fraction of the bracket taken by each golden section step
+	const double goldenSection = 0.3819660;
+	// Relative precision of the Julian days, about 40 µs around the current epoch
+	const double epsilon = 2e-16;
+}
+
+StelEventFinder::StelEventFinder(Function& function, double tolerance)
+	: function(function)
+	, tolerance(tolerance)
+	, evaluations(0)
+{
+}
+
+double StelEventFinder::evaluate(double JD)
+{
+	QHash<double, double>::const_iterator it = cache.constFind(JD);
+	if (it!=cache.constEnd())
+		return it.value();
+	const double v = function.value(JD);
+	++evaluations;
+	cache.insert(JD, v);
+	return v;
+}
+
+bool StelEventFinder::findRoot(double a, double b, double* root)
+{
+	// Brent-Dekker method, as in Numerical Recipes (zbrent)
+	double fa = evaluate(a);
+	double fb = evaluate(b);
+	if (fa==0.)
+	{
+		*root = a;
+		return true;
+	}
+	if ((fa>0. && fb>0.) || (fa<0. && fb<0.))
+		return false;
+
+	double c = b, fc = fb, d = 0., e = 0.;
+	for (int i=0; i<maxIterations; ++i)
+	{
+		if ((fb>0. && fc>0.) || (fb<0. && fc<0.))
+		{
+			// Keep the root between b and c
+			c = a;
+			fc = fa;
+			e = d = b-a;
+		}
+		if (std::fabs(fc)<std::fabs(fb))
+		{
+			// b is the best estimate
+			a = b; b = c; c = a;
+			fa = fb; fb = fc; fc = fa;
+		}
+		const double tol1 = 2.*epsilon*std::fabs(b) + 0.5*tolerance;
+		const double xm = 0.5*(c-b);
+		if (std::fabs(xm)<=tol1 || fb==0.)
+		{
+			*root = b;
+			return true;
+		}
+		if (std::fabs(e)>=tol1 && std::fabs(fa)>std::fabs(fb))
+		{
+			// Inverse quadratic interpolation, or secant if only two points are distinct
+			double p, q;
+			const double s = fb/fa;
+			if (a==c)
+			{
+				p = 2.*xm*s;
+				q = 1.-s;
+			}
+			else
+			{
+				const double r = fb/fc;
+				q = fa/fc;
+				p = s*(2.*xm*q*(q-r)-(b-a)*(r-1.));
+				q = (q-1.)*(r-1.)*(s-1.);
+			}
+			if (p>0.)
+				q = -q;
+			p = std::fabs(p);
+			if (2.*p < qMin(3.*xm*q-std::fabs(tol1*q), std::fabs(e*q)))
+			{
+				// Accept the interpolation
+				e = d;
+				d = p/q;
+			}
+			else
+			{
+				// Bisection
+				d = xm;
+				e = d;
+			}
+		}
+		else
+		{
+			// Bounds decreasing too slowly: bisection
+			d = xm;
+			e = d;
+		}
+		a = b;
+		fa = fb;
+		b += std::fabs(d)>tol1 ? d : (xm>0. ? tol1 : -tol1);
+		fb = evaluate(b);
+	}
+	*root = b;
+	return false;
+}
+
+bool StelEventFinder::findRootNear(double guess, double step, double maxDistance, double* root)
+{
+	for (double distance=step; distance<=maxDistance; distance*=2.)
+	{
+		const double a = guess-distance;
+		const double b = guess+distance;
+		const double fa = evaluate(a);
+		const double fg = evaluate(guess);
+		const double fb = evaluate(b);
+		// Prefer the half of the bracket closer to the guess
+		if ((fa<=0. && fg>=0.) || (fa>=0. && fg<=0.))
+		{
+			if ((fg<=0. && fb>=0.) || (fg>=0. && fb<=0.))
+			{
+				// Roots on both sides: take the nearest one
+				double r1, r2;
+				const bool found1 = findRoot(a, guess, &r1);
+				const bool found2 = findRoot(guess, b, &r2);
+				if (found1 && found2)
+					*root = (guess-r1 < r2-guess) ? r1 : r2;
+				else
+					*root = found1 ? r1 : r2;
+				return found1 || found2;
+			}
+			return findRoot(a, guess, root);
+		}
+		if ((fg<=0. && fb>=0.) || (fg>=0. && fb<=0.))
+			return findRoot(guess, b, root);
+	}
+	return false;
+}
+
+bool StelEventFinder::minimize(double sign, double a, double b, double c, double* JD, double* value)
+{
+	// Brent's method, as in Numerical Recipes (brent)
+	double lo = qMin(a, c), hi = qMax(a, c);
+	double x = b, w = b, v = b;
+	double fx = sign*evaluate(b), fw = fx, fv = fx;
+	double d = 0., e = 0.;
+	for (int i=0; i<maxIterations; ++i)
+	{
+		const double xm = 0.5*(lo+hi);
+		const double tol1 = 2.*epsilon*std::fabs(x) + 0.5*tolerance;
+		const double tol2 = 2.*tol1;
+		if (std::fabs(x-xm) <= tol2-0.5*(hi-lo))
+		{
+			*JD = x;
+			if (value)
+				*value = sign*fx;
+			return true;
+		}
+		bool golden = true;
+		if (std::fabs(e)>tol1)
+		{
+			// Parabola through x, v and w
+			const double r = (x-w)*(fx-fv);
+			double q = (x-v)*(fx-fw);
+			double p = (x-v)*q-(x-w)*r;
+			q = 2.*(q-r);
+			if (q>0.)
+				p = -p;
+			q = std::fabs(q);
+			const double etemp = e;
+			e = d;
+			if (std::fabs(p)<std::fabs(0.5*q*etemp) && p>q*(lo-x) && p<q*(hi-x))
+			{
+				d = p/q;
+				const double u = x+d;
+				if (u-lo<tol2 || hi-u<tol2)
+					d = xm>=x ? tol1 : -tol1;
+				golden = false;
+			}
+		}
+		if (golden)
+		{
+			e = (x>=xm) ? lo-x : hi-x;
+			d = goldenSection*e;
+		}
+		const double u = std::fabs(d)>=tol1 ? x+d : x+(d>=0. ? tol1 : -tol1);
+		const double fu = sign*evaluate(u);
+		if (fu<=fx)
+		{
+			if (u>=x)
+				lo = x;
+			else
+				hi = x;
+			v = w; fv = fw;
+			w = x; fw = fx;
+			x = u; fx = fu;
+		}
+		else
+		{
+			if (u<x)
+				lo = u;
+			else
+				hi = u;
+			if (fu<=fw || w==x)
+			{
+				v = w; fv = fw;
+				w = u; fw = fu;
+			}
+			else if (fu<=fv || v==x || v==w)
+			{
+				v = u; fv = fu;
+			}
+		}
+	}
+	*JD = x;
+	if (value)
+		*value = sign*fx;
+	return false;
+}
+
+bool StelEventFinder::findMinimum(double a, double b, double c, double* JD, double* value)
+{
+	return minimize(1., a, b, c, JD, value);
+}
+
+bool StelEventFinder::findMaximum(double a, double b, double c, double* JD, double* value)
+{
+	return minimize(-1., a, b, c, JD, value);
+}
+
+bool StelEventFinder::findMaximumNear(double guess, double step, double maxDistance, double* JD, double* value)
+{
+	double a = guess-step, b = guess, c = guess+step;
+	double fa = evaluate(a), fb = evaluate(b), fc = evaluate(c);
+	// Walk uphill until the middle point is the highest
+	while (fb<fa || fb<fc)
+	{
+		if (fa>fc)
+		{
+			c = b; fc = fb;
+			b = a; fb = fa;
+			a -= step;
+			fa = evaluate(a);
+		}
+		else
+		{
+			a = b; fa = fb;
+			b = c; fb = fc;
+			c += step;
+			fc = evaluate(c);
+		}
+		if (std::fabs(b-guess)>maxDistance)
+			return false;
+	}
+	return findMaximum(a, b, c, JD, value);
+}
@@ -0,0 +1,102 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELEVENTFINDER_HPP_
+#define _STELEVENTFINDER_HPP_
+
+#include <QHash>
+
+//! @class StelEventFinder
+//! Finds the dates of events as the roots or the extrema of a function of time:
+//! rises and sets (roots of the altitude above the horizon), twilights (roots of the altitude
+//! of the Sun below a given altitude), transits (maxima of the altitude), conjunctions
+//! (minima of a separation)...
+//! The events are refined from a bracket, with Brent's methods: the root finding combines bisection
+//! with the secant method and inverse quadratic interpolation, the minimization combines golden section
+//! search with parabolic interpolation. Both converge much faster than bisection or fixed time steps
+//! for smooth functions. The values of the function are cached, so that brackets which share bounds
+//! (e.g. the search of the rise, then of the set of an object) do not evaluate it again.
+//! The functions of the positions of the bodies are in StelEventFunctions.hpp.
+//! A finder is not thread-safe, but several finders can run concurrently on different sessions.
+//! Usage:
+//! @code
+//! StelEphemerisSession session(core);
+//! StelAltitudeFunction altitude(session, planet);
+//! StelEventFinder finder(altitude);
+//! double rise;
+//! if (finder.findRootNear(guess, 1./24., 0.5, &rise))
+//! 	...
+//! @endcode
+class StelEventFinder
+{
+public:
+	//! A function of time whose roots and extrema are searched.
+	class Function
+	{
+	public:
+		virtual ~Function() {}
+		//! @param JD the Julian day (UT)
+		virtual double value(double JD) = 0;
+	};
+
+	//! @param tolerance the precision of the dates of the events [days], one second by default
+	explicit StelEventFinder(Function& function, double tolerance = 1./86400.);
+
+	//! Set the precision of the dates of the events [days].
+	void setTolerance(double t) {tolerance = t;}
+	double getTolerance() const {return tolerance;}
+
+	//! Get the value of the function at JD, from the cache if it was already computed.
+	double evaluate(double JD);
+	//! Get the number of evaluations of the function, not counting the values taken from the cache.
+	int getEvaluationCount() const {return evaluations;}
+	//! Forget the cached values, e.g. after a change of the settings the function depends on.
+	void clearCache() {cache.clear();}
+
+	//! Find a root within [a, b]. The function must change sign between a and b.
+	//! @return false if it does not
+	bool findRoot(double a, double b, double* root);
+	//! Find a root close to guess: the bracket [guess-step, guess+step] is widened until the function
+	//! changes sign in it, up to maxDistance from guess.
+	//! @return false if no bracket was found
+	bool findRootNear(double guess, double step, double maxDistance, double* root);
+	//! Find a minimum bracketed by a<b<c, i.e. with f(b) lower than f(a) and f(c).
+	//! @param value if not null, receives the minimum
+	//! @return false if the method did not converge
+	bool findMinimum(double a, double b, double c, double* JD, double* value = Q_NULLPTR);
+	//! Find a maximum bracketed by a<b<c, i.e. with f(b) greater than f(a) and f(c).
+	bool findMaximum(double a, double b, double c, double* JD, double* value = Q_NULLPTR);
+	//! Find a maximum close to guess: the bracket [guess-step, guess, guess+step] is moved uphill
+	//! until it contains a maximum, up to maxDistance from guess.
+	//! @return false if no bracket was found
+	bool findMaximumNear(double guess, double step, double maxDistance, double* JD, double* value = Q_NULLPTR);
+
+private:
+	Q_DISABLE_COPY(StelEventFinder)
+
+	//! Brent's minimization of sign*f within the bracket a<b<c.
+	bool minimize(double sign, double a, double b, double c, double* JD, double* value);
+
+	Function& function;
+	double tolerance;
+	int evaluations;
+	QHash<double, double> cache;
+};
+
+#endif // _STELEVENTFINDER_HPP_
@@ -0,0 +1,65 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelEventFunctions.hpp"
+#include "StelUtils.hpp"
+
+StelAltitudeFunction::StelAltitudeFunction(StelEphemerisSession& session, const StelObjectP& object,
+					   double altitude, StelCore::RefractionMode refMode)
+	: session(session)
+	, object(object)
+	, altitude(altitude)
+	, refMode(refMode)
+{
+}
+
+double StelAltitudeFunction::value(double JD)
+{
+	session.setJD(JD);
+	const Vec3d altAz = session.getObjectAltAzPos(object, refMode);
+	double az, alt;
+	StelUtils::rectToSphe(&az, &alt, altAz);
+	return alt - altitude;
+}
+
+StelSeparationFunction::StelSeparationFunction(StelEphemerisSession& session, const StelObjectP& object1, const StelObjectP& object2)
+	: session(session)
+	, object1(object1)
+	, object2(object2)
+{
+}
+
+double StelSeparationFunction::value(double JD)
+{
+	session.setJD(JD);
+	const Vec3d pos1 = session.getObjectJ2000EquatorialPos(object1);
+	return pos1.angle(session.getObjectJ2000EquatorialPos(object2));
+}
+
+StelElongationFunction::StelElongationFunction(StelEphemerisSession& session, const PlanetP& body)
+	: session(session)
+	, body(body)
+{
+}
+
+double StelElongationFunction::value(double JD)
+{
+	session.setJD(JD);
+	return session.getElongation(body);
+}
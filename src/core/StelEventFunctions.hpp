@@ -0,0 +1,77 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELEVENTFUNCTIONS_HPP_
+#define _STELEVENTFUNCTIONS_HPP_
+
+#include "StelCore.hpp"
+#include "StelEphemerisSession.hpp"
+#include "StelEventFinder.hpp"
+#include "VecMath.hpp"
+
+//! @file
+//! Functions of the positions of the bodies, computed with a StelEphemerisSession,
+//! whose roots and extrema are searched by a StelEventFinder.
+
+//! @class StelAltitudeFunction
+//! Altitude of an object above a given altitude [radians].
+//! Its roots are the rises and sets of the object, its maxima are its transits.
+class StelAltitudeFunction : public StelEventFinder::Function
+{
+public:
+	//! @param object a solar system body, or any object moving as StelObject::getJ2000EquatorialPosAtJDE() tells
+	//! @param altitude the altitude subtracted from the altitude of the object [radians], e.g. of the horizon
+	StelAltitudeFunction(StelEphemerisSession& session, const StelObjectP& object,
+			     double altitude = 0., StelCore::RefractionMode refMode = StelCore::RefractionAuto);
+	virtual double value(double JD);
+private:
+	StelEphemerisSession& session;
+	StelObjectP object;
+	double altitude;
+	StelCore::RefractionMode refMode;
+};
+
+//! @class StelSeparationFunction
+//! Angular separation of two objects [radians], e.g. of a body and a star.
+//! Its minima are conjunctions, its maxima oppositions.
+class StelSeparationFunction : public StelEventFinder::Function
+{
+public:
+	StelSeparationFunction(StelEphemerisSession& session, const StelObjectP& object1, const StelObjectP& object2);
+	virtual double value(double JD);
+private:
+	StelEphemerisSession& session;
+	StelObjectP object1;
+	StelObjectP object2;
+};
+
+//! @class StelElongationFunction
+//! Elongation of a body from the Sun [radians].
+//! Its maxima are the greatest elongations of inner planets, its minima their conjunctions with the Sun.
+class StelElongationFunction : public StelEventFinder::Function
+{
+public:
+	StelElongationFunction(StelEphemerisSession& session, const PlanetP& body);
+	virtual double value(double JD);
+private:
+	StelEphemerisSession& session;
+	PlanetP body;
+};
+
+#endif // _STELEVENTFUNCTIONS_HPP_
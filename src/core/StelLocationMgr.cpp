@@ -25,6 +25,7 @@
 #include "StelUtils.hpp"
 #include "StelJsonParser.hpp"
 #include "StelLocaleMgr.hpp"
+#include "StelStartupProfiler.hpp"
 
 #include <QStringListModel>
 #include <QDebug>
@@ -394,6 +395,7 @@ void StelLocationMgr::generateBinaryLocationFile(const QString& fileName, bool i
 
 LocationMap StelLocationMgr::loadCitiesBin(const QString& fileName)
 {
+	StelStartupProfiler::Scope profile("catalog", fileName);
 	QMap<QString, StelLocation> res;
 	QString cityDataPath = StelFileMgr::findFile(fileName);
 	if (cityDataPath.isEmpty())
@@ -63,6 +63,13 @@ public:
 	//! If the initialization takes significant time, the progress should be displayed on the loading bar.
 	virtual void init() = 0;
 
+	//! Load the data of the module which does not depend on other modules, e.g. parse its catalogs.
+	//! StelApp may call it from a worker thread before init(), while other modules are being initialized.
+	//! It must therefore only fill the module's own data and use thread-safe functions such as those
+	//! of StelFileMgr: no openGL resources, settings, signals or other modules.
+	//! init() is called on the main thread once preload() returned.
+	virtual void preload() {;}
+
 	//! Called before the module will be delete, and before the openGL context is suppressed.
 	//! Deinitialize all openGL texture in this method.
 	virtual void deinit() {;}
@@ -156,6 +156,13 @@ public:
 	//! Get observer-centered equatorial coordinates at equinox J2000
 	virtual Vec3d getJ2000EquatorialPos(const StelCore* core) const = 0;
 
+	//! Get observer-centered equatorial coordinates at equinox J2000 at another date than the one of core.
+	//! StelEphemerisSession uses it for the objects other than solar system bodies, possibly in a worker thread.
+	//! The default returns getJ2000EquatorialPos(): the object does not move. Objects which move by themselves,
+	//! like the stars with their proper motion, should reimplement it.
+	//! @param JDE the date (TT)
+	virtual Vec3d getJ2000EquatorialPosAtJDE(const StelCore* core, double JDE) const {Q_UNUSED(JDE); return getJ2000EquatorialPos(core);}
+
 	//! Get observer-centered equatorial coordinate at the current equinox
 	//! The frame has its Z axis at the planet's current rotation axis
 	//! At time 2000-01-01 this frame is almost the same as J2000, but ONLY if the observer is on earth
@@ -194,7 +201,8 @@ public:
 	//! Get observer-centered alt/az position
 	//! It is the automatic position, i.e. taking the refraction effect into account if atmosphere is on.
 	//! The frame has its Z axis at the zenith
-	Vec3d getAltAzPosAuto(const StelCore* core) const;
+	//! Virtual so that objects asked for it by many modules each frame can cache it.
+	virtual Vec3d getAltAzPosAuto(const StelCore* core) const;
 
 	//! Checking position an object above mathematical horizon for current location.
 	//! @return true if object an above mathematical horizon
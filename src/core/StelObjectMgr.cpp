@@ -331,12 +331,12 @@ StelObjectP StelObjectMgr::cleverFind(const StelCore* core, const Vec3d& v) cons
 	// Field of view for a searchRadiusPixel pixel diameter circle on screen
 	float fov_around = core->getMovementMgr()->getCurrentFov()/qMin(prj->getViewportWidth(), prj->getViewportHeight()) * searchRadiusPixel;
 
-	// Collect the objects inside the range
-	foreach (const StelObjectModule* m, objectsModule)
-		candidates += m->searchAround(v, fov_around, core);
-
 	// GZ 2014-08-17: This should be exactly the sky's limit magnitude (or even more, but not less!), else visible stars cannot be clicked.
 	float limitMag = core->getSkyDrawer()->getLimitMagnitude(); // -2.f;
+
+	// Collect the objects inside the range. Those above the limit are rejected below anyway.
+	foreach (const StelObjectModule* m, objectsModule)
+		candidates += m->searchAroundSelectable(v, fov_around, limitMag, core);
 	QList<StelObjectP> tmp;
 	foreach (const StelObjectP& obj, candidates)
 	{
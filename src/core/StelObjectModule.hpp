@@ -48,6 +48,20 @@ public:
 	//! @param core the core instance to use.
 	//! @return the list of all the displayed objects contained in the defined zone.
 	virtual QList<StelObjectP> searchAround(const Vec3d& v, double limitFov, const StelCore* core) const = 0;
+
+	//! Search for selectable StelObject in an area around a specified point.
+	//! Same as searchAround(), but objects whose select priority is known to be larger
+	//! than @em maxPriority may be left out. Modules which can skip faint objects
+	//! without looking at them should reimplement it, the default calls searchAround().
+	//! @param v equatorial position at epoch J2000.
+	//! @param limitFov angular diameter of the searching zone in degree.
+	//! @param maxPriority the largest select priority of interest.
+	//! @param core the core instance to use.
+	virtual QList<StelObjectP> searchAroundSelectable(const Vec3d& v, double limitFov, float maxPriority, const StelCore* core) const
+	{
+		Q_UNUSED(maxPriority);
+		return searchAround(v, limitFov, core);
+	}
 	
 	//! Find a StelObject by name.
 	//! @param nameI18n The translated name for the current sky locale.
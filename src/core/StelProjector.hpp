@@ -25,6 +25,8 @@
 #include "VecMath.hpp"
 #include "StelSphereGeometry.hpp"
 
+#include <QByteArray>
+
 //! @class StelProjector
 //! Provide the main interface to all operations of projecting coordinates from sky to screen.
 //! The StelProjector also defines the viewport size and position.
@@ -276,6 +278,22 @@ public:
 	//! Get the current projection matrix.
 	Mat4f getProjectionMatrix() const;
 
+	//! Get the GLSL source of forward(), for the vertex shaders which project on the GPU.
+	//! It defines the function "bool projectorForward(inout highp vec3 v)", which uses
+	//! the uniform "projectorWidthStretch" (see getWidthStretch()).
+	//! @return an empty source if the projection is only done on the CPU
+	virtual QByteArray getForwardShaderSource() const {return QByteArray();}
+
+	//! Get how project() maps the vectors returned by forward() on the viewport: win = center + scale*v.
+	void getViewportMapping(Vec2f* center, Vec2f* scale) const
+	{
+		*center = viewportCenter;
+		scale->set(flipHorz*pixelPerRad, flipVert*pixelPerRad);
+	}
+
+	//! Get the factor applied to the x coordinate by forward().
+	float getWidthStretch() const {return widthStretch;}
+
 	///////////////////////////////////////////////////////////////////////////
 	//! Get a string description of a StelProjectorMaskType.
 	static const QString maskTypeToString(StelProjectorMaskType type);
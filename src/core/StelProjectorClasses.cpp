@@ -81,6 +81,21 @@ float StelProjectorPerspective::deltaZoom(float fov) const
 	return vsf / (1.f+vsf*vsf);
 }
 
+QByteArray StelProjectorPerspective::getForwardShaderSource() const
+{
+	return
+		"bool projectorForward(inout highp vec3 v)\n"
+		"{\n"
+		"    highp float r = length(v);\n"
+		"    if (v.z >= 0.0)\n"
+		"        return false;\n"
+		"    v.x *= -projectorWidthStretch/v.z;\n"
+		"    v.y /= -v.z;\n"
+		"    v.z = r;\n"
+		"    return true;\n"
+		"}\n";
+}
+
 
 QString StelProjectorEqualArea::getNameI18() const
 {
@@ -140,6 +155,20 @@ float StelProjectorEqualArea::deltaZoom(float fov) const
 	return fov;
 }
 
+QByteArray StelProjectorEqualArea::getForwardShaderSource() const
+{
+	return
+		"bool projectorForward(inout highp vec3 v)\n"
+		"{\n"
+		"    highp float r = length(v);\n"
+		"    highp float f = sqrt(2.0/(r*(r-v.z)));\n"
+		"    v.x *= f*projectorWidthStretch;\n"
+		"    v.y *= f;\n"
+		"    v.z = r;\n"
+		"    return true;\n"
+		"}\n";
+}
+
 QString StelProjectorStereographic::getNameI18() const
 {
 	return q_("Stereographic");
@@ -192,6 +221,23 @@ float StelProjectorStereographic::deltaZoom(float fov) const
 	return 4.f*vsf / (4.f+vsf*vsf);
 }
 
+QByteArray StelProjectorStereographic::getForwardShaderSource() const
+{
+	return
+		"bool projectorForward(inout highp vec3 v)\n"
+		"{\n"
+		"    highp float r = length(v);\n"
+		"    highp float h = 0.5*(r-v.z);\n"
+		"    if (h <= 0.0)\n"
+		"        return false;\n"
+		"    highp float f = 1.0/h;\n"
+		"    v.x *= f*projectorWidthStretch;\n"
+		"    v.y *= f;\n"
+		"    v.z = r;\n"
+		"    return true;\n"
+		"}\n";
+}
+
 
 
 
@@ -254,6 +300,30 @@ float StelProjectorFisheye::deltaZoom(float fov) const
 	return fov;
 }
 
+QByteArray StelProjectorFisheye::getForwardShaderSource() const
+{
+	return
+		"bool projectorForward(inout highp vec3 v)\n"
+		"{\n"
+		"    highp float rq1 = v.x*v.x + v.y*v.y;\n"
+		"    if (rq1 > 0.0)\n"
+		"    {\n"
+		"        highp float h = sqrt(rq1);\n"
+		"        highp float f = atan(h, -v.z)/h;\n"
+		"        v.x *= f*projectorWidthStretch;\n"
+		"        v.y *= f;\n"
+		"        v.z = sqrt(rq1 + v.z*v.z);\n"
+		"        return true;\n"
+		"    }\n"
+		"    if (v.z < 0.0)\n"
+		"    {\n"
+		"        v = vec3(0.0, 0.0, 1.0);\n"
+		"        return true;\n"
+		"    }\n"
+		"    return false;\n"
+		"}\n";
+}
+
 
 
 QString StelProjectorHammer::getNameI18() const
@@ -465,6 +535,21 @@ float StelProjectorOrthographic::deltaZoom(float fov) const
 	return fov;
 }
 
+QByteArray StelProjectorOrthographic::getForwardShaderSource() const
+{
+	return
+		"bool projectorForward(inout highp vec3 v)\n"
+		"{\n"
+		"    highp float r = length(v);\n"
+		"    highp float h = 1.0/r;\n"
+		"    bool rval = (v.z <= 0.0);\n"
+		"    v.x *= h*projectorWidthStretch;\n"
+		"    v.y *= h;\n"
+		"    v.z = r;\n"
+		"    return rval;\n"
+		"}\n";
+}
+
 QString StelProjectorSinusoidal::getNameI18() const
 {
 	return q_("Sinusoidal");
@@ -36,6 +36,7 @@
 
 #include <QOpenGLContext>
 #include <QOpenGLShaderProgram>
+#include <QVector4D>
 #include <QStringList>
 #include <QSettings>
 #include <QDebug>
@@ -67,10 +68,15 @@ StelSkyDrawer::StelSkyDrawer(StelCore* acore) :
 	customPlanetMagLimit(0.0),
 	bortleScaleIndex(3),
 	inScale(1.f),
+	nextPointSourceBuffer(0),
+	textureCoordBufferSources(0),
 	starShaderProgram(Q_NULLPTR),
 	starShaderVars(StarShaderVars()),
+	staticPointSourceShader(Q_NULLPTR),
+	staticPointSourceIndexBuffer(QOpenGLBuffer::IndexBuffer),
 	nbPointSources(0),
 	maxPointSources(1000),
+	maxPointSourcesLimit(1000),
 	maxLum(0.f),
 	oldLum(-1.f),
 	flagLuminanceAdaptation(false),
@@ -127,6 +133,9 @@ StelSkyDrawer::StelSkyDrawer(StelCore* acore) :
 	if (!ok)
 		setAtmospherePressure(1013.0);
 
+	// Point sources are buffered until the end of the frame, up to this limit (72 bytes each).
+	maxPointSourcesLimit = qMax(1000, conf->value("stars/max_point_sources_per_batch", 1<<18).toInt());
+
 	// Initialize buffers for use by gl vertex array	
 	
 	vertexArray = new StarVertex[maxPointSources*6];
@@ -140,15 +149,45 @@ StelSkyDrawer::StelSkyDrawer(StelCore* acore) :
 	}
 }
 
+void StelSkyDrawer::growPointSourceArrays()
+{
+	const unsigned int newMaxPointSources = qMin(maxPointSources*2, maxPointSourcesLimit);
+	Q_ASSERT(newMaxPointSources>maxPointSources);
+
+	StarVertex* newVertexArray = new StarVertex[newMaxPointSources*6];
+	memcpy(newVertexArray, vertexArray, nbPointSources*6*sizeof(StarVertex));
+	delete[] vertexArray;
+	vertexArray = newVertexArray;
+
+	unsigned char* newTextureCoordArray = new unsigned char[newMaxPointSources*6*2];
+	memcpy(newTextureCoordArray, textureCoordArray, maxPointSources*6*2);
+	for (unsigned int i=maxPointSources;i<newMaxPointSources; ++i)
+		memcpy(&newTextureCoordArray[i*6*2], textureCoordArray, 12);
+	delete[] textureCoordArray;
+	textureCoordArray = newTextureCoordArray;
+
+	maxPointSources = newMaxPointSources;
+}
+
 StelSkyDrawer::~StelSkyDrawer()
 {
 	delete[] vertexArray;
 	vertexArray = Q_NULLPTR;
 	delete[] textureCoordArray;
 	textureCoordArray = Q_NULLPTR;
+
+	//make sure the correct GL context is bound before releasing the buffers and the shader!
+	StelApp::getInstance().ensureGLContextCurrent();
+	for (int i=0;i<NbPointSourceBuffers;++i)
+		pointSourceBuffers[i].destroy();
+	textureCoordBuffer.destroy();
+	staticPointSourceIndexBuffer.destroy();
 	
 	delete starShaderProgram;
 	starShaderProgram = Q_NULLPTR;
+	foreach (const StaticPointSourceShader& shader, staticPointSourceShaders)
+		delete shader.program;
+	staticPointSourceShaders.clear();
 }
 
 // Init parameters from config file
@@ -202,6 +241,16 @@ void StelSkyDrawer::init()
 	starShaderVars.color = starShaderProgram->attributeLocation("color");
 	starShaderVars.texture = starShaderProgram->uniformLocation("tex");
 
+	// Vertex buffers for the point sources. If they cannot be created, the
+	// point sources are drawn from the client side arrays.
+	for (int i=0;i<NbPointSourceBuffers;++i)
+	{
+		pointSourceBuffers[i].setUsagePattern(QOpenGLBuffer::StreamDraw);
+		pointSourceBuffers[i].create();
+	}
+	textureCoordBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+	textureCoordBuffer.create();
+
 	update(0);
 }
 
@@ -337,6 +386,17 @@ float StelSkyDrawer::luminanceToSurfacebrightness(float lum)
 	return std::log(lum*(1.f/60.f*1.f/60.f)/(2.f*2025000.f))/-0.92103f - 12.12331f;
 }
 
+// Get the exponential law followed by the radius of point sources
+void StelSkyDrawer::getPointSourceRadiusLaw(float* lnRadius0, float* slope) const
+{
+	// This is the radius computed in computeRCMag(), which is exponential in mag
+	const float pFact = starRelativeScale*1.40f/2.f;
+	const float lnLinearScale = std::log(starLinearScale);
+	*lnRadius0 = std::log(eye->adaptLuminanceScaledLn(pointSourceMagToLnLuminance(0.f), pFact)) + lnLinearScale;
+	const float lnRadius1 = std::log(eye->adaptLuminanceScaledLn(pointSourceMagToLnLuminance(1.f), pFact)) + lnLinearScale;
+	*slope = *lnRadius0 - lnRadius1;
+}
+
 // Compute RMag and CMag from magnitude for a point source.
 bool StelSkyDrawer::computeRCMag(float mag, RCMag* rcMag) const
 {
@@ -401,13 +461,35 @@ void StelSkyDrawer::postDrawPointSource(StelPainter* sPainter)
 	Q_ASSERT(sizeof(StarVertex)==12);
 	
 	starShaderProgram->bind();
-	starShaderProgram->setAttributeArray(starShaderVars.pos, GL_FLOAT, (GLfloat*)vertexArray, 2, 12);
+	QOpenGLBuffer& vbo = pointSourceBuffers[nextPointSourceBuffer];
+	if (vbo.isCreated() && textureCoordBuffer.isCreated())
+	{
+		nextPointSourceBuffer = (nextPointSourceBuffer+1)%NbPointSourceBuffers;
+		// allocate() orphans the previous content of the buffer
+		vbo.bind();
+		vbo.allocate(vertexArray, nbPointSources*6*sizeof(StarVertex));
+		starShaderProgram->setAttributeBuffer(starShaderVars.pos, GL_FLOAT, 0, 2, 12);
+		starShaderProgram->setAttributeBuffer(starShaderVars.color, GL_UNSIGNED_BYTE, 8, 3, 12);
+		vbo.release();
+		textureCoordBuffer.bind();
+		if (textureCoordBufferSources<maxPointSources)
+		{
+			textureCoordBuffer.allocate(textureCoordArray, maxPointSources*6*2);
+			textureCoordBufferSources = maxPointSources;
+		}
+		starShaderProgram->setAttributeBuffer(starShaderVars.texCoord, GL_UNSIGNED_BYTE, 0, 2, 0);
+		textureCoordBuffer.release();
+	}
+	else
+	{
+		starShaderProgram->setAttributeArray(starShaderVars.pos, GL_FLOAT, (GLfloat*)vertexArray, 2, 12);
+		starShaderProgram->setAttributeArray(starShaderVars.color, GL_UNSIGNED_BYTE, (GLubyte*)&(vertexArray[0].color), 3, 12);
+		starShaderProgram->setAttributeArray(starShaderVars.texCoord, GL_UNSIGNED_BYTE, (GLubyte*)textureCoordArray, 2, 0);
+	}
 	starShaderProgram->enableAttributeArray(starShaderVars.pos);
-	starShaderProgram->setAttributeArray(starShaderVars.color, GL_UNSIGNED_BYTE, (GLubyte*)&(vertexArray[0].color), 3, 12);
 	starShaderProgram->enableAttributeArray(starShaderVars.color);
-	starShaderProgram->setUniformValue(starShaderVars.projectionMatrix, qMat);
-	starShaderProgram->setAttributeArray(starShaderVars.texCoord, GL_UNSIGNED_BYTE, (GLubyte*)textureCoordArray, 2, 0);
 	starShaderProgram->enableAttributeArray(starShaderVars.texCoord);
+	starShaderProgram->setUniformValue(starShaderVars.projectionMatrix, qMat);
 	
 	glDrawArrays(GL_TRIANGLES, 0, nbPointSources*6);
 	
@@ -436,7 +518,7 @@ bool StelSkyDrawer::drawPointSource(StelPainter* sPainter, const Vec3f& v, const
 	const float tw = (flagStarTwinkle && (flagHasAtmosphere || flagForcedTwinkle)) ? (1.f-twinkleFactor*twinkleAmount*qrand()/RAND_MAX)*rcMag.luminance : rcMag.luminance;
 
 	// If the rmag is big, draw a big halo
-	if (radius>MAX_LINEAR_RADIUS+5.f)
+	if (hasBigHalo(rcMag))
 	{
 		float cmag = qMin(rcMag.luminance,(float)(radius-(MAX_LINEAR_RADIUS+5.f))/30.f);
 		float rmag = 150.f;
@@ -466,12 +548,318 @@ bool StelSkyDrawer::drawPointSource(StelPainter* sPainter, const Vec3f& v, const
 	++nbPointSources;
 	if (nbPointSources>=maxPointSources)
 	{
-		// Flush the buffer (draw all buffered stars)
-		postDrawPointSource(sPainter);
+		// Grow the buffers, or flush them (draw all buffered stars) if they are already huge
+		if (maxPointSources<maxPointSourcesLimit)
+			growPointSourceArrays();
+		else
+			postDrawPointSource(sPainter);
 	}
 	return true;
 }
 
+bool StelSkyDrawer::hasBigHalo(const RCMag& rcMag)
+{
+	return rcMag.radius>MAX_LINEAR_RADIUS+5.f;
+}
+
+void StelSkyDrawer::setStaticPointSource(StaticPointSourceVertex* quad, const Vec3f& pos, const Vec3f& motion, int magIndex, int bV)
+{
+	static const unsigned char corners[4][2] = {{0, 0}, {255, 0}, {255, 255}, {0, 255}};
+	const Vec3f& color = colorTable[bV];
+	for (int i=0;i<4;++i)
+	{
+		StaticPointSourceVertex& vx = quad[i];
+		vx.pos = pos;
+		vx.motion = motion;
+		vx.magCorner[0] = (unsigned char)qBound(0, magIndex, 255);
+		vx.magCorner[1] = corners[i][0];
+		vx.magCorner[2] = corners[i][1];
+		vx.magCorner[3] = 0;
+		vx.color[0] = (unsigned char)qBound(0, (int)(color[0]*255+0.5f), 255);
+		vx.color[1] = (unsigned char)qBound(0, (int)(color[1]*255+0.5f), 255);
+		vx.color[2] = (unsigned char)qBound(0, (int)(color[2]*255+0.5f), 255);
+		vx.color[3] = 0;
+	}
+}
+
+StelSkyDrawer::StaticPointSourceShader* StelSkyDrawer::getStaticPointSourceShader(const QByteArray& projectorSource)
+{
+	QMap<QByteArray, StaticPointSourceShader>::iterator it = staticPointSourceShaders.find(projectorSource);
+	if (it!=staticPointSourceShaders.end())
+		return it->program ? &it.value() : Q_NULLPTR;
+
+	// Same computations as drawPointSource() and computeRCMag(), the point sources
+	// which are not drawn are moved out of the clip volume.
+	QOpenGLShader vshader(QOpenGLShader::Vertex);
+	const QByteArray vsrc =
+		"attribute highp vec3 pos;\n"
+		"attribute highp vec3 motion;\n"
+		"attribute mediump vec4 magCorner;\n"
+		"attribute mediump vec3 color;\n"
+		"uniform mediump mat4 projectionMatrix;\n"
+		"uniform highp mat4 preTransfo;\n"
+		"uniform highp mat4 postTransfo;\n"
+		"uniform bool withRefraction;\n"
+		"uniform highp mat4 j2000ToAltAz;\n"
+		"uniform bool withExtinction;\n"
+		"uniform highp float movementFactor;\n"
+		"uniform highp float magMin;\n"
+		"uniform highp float magStep;\n"
+		"uniform highp float cutoffMagIndex;\n"
+		"uniform highp float lnRadius0;\n"
+		"uniform highp float radiusSlope;\n"
+		"uniform highp float radiusScale;\n"
+		"uniform mediump float twinkleAmount;\n"
+		"uniform highp float twinkleSeed;\n"
+		"uniform highp vec4 visibleCap;\n"
+		"uniform highp vec2 viewportCenter;\n"
+		"uniform highp vec2 viewportScale;\n"
+		"uniform highp vec4 viewportRect;\n"
+		"uniform highp float projectorWidthStretch;\n"
+		"varying mediump vec2 texc;\n"
+		"varying mediump vec3 outColor;\n"
+		+ Refraction::getForwardShaderSource()
+		+ Extinction::getForwardShaderSource()
+		+ projectorSource +
+		"void main(void)\n"
+		"{\n"
+		"    gl_Position = vec4(2.0, 2.0, 2.0, 1.0);\n"
+		"    texc = vec2(0.0, 0.0);\n"
+		"    outColor = vec3(0.0, 0.0, 0.0);\n"
+		"    highp vec3 v = pos + movementFactor*motion;\n"
+		"    highp vec3 n = normalize(v);\n"
+		"    if (dot(n, visibleCap.xyz) < visibleCap.w)\n"
+		"        return;\n"
+		"    highp float magIndex = floor(magCorner.x*255.0+0.5);\n"
+		"    mediump float twinkleFactor = 1.0;\n"
+		"    if (withExtinction)\n"
+		"    {\n"
+		"        highp vec3 altAz = (j2000ToAltAz*vec4(n, 1.0)).xyz;\n"
+		"        magIndex += floor(extinctionMagnitudeShift(altAz.z)/magStep);\n"
+		"        if (magIndex >= cutoffMagIndex || magIndex < 0.0)\n"
+		"            return;\n"
+		"        twinkleFactor = min(1.0, 1.0-0.9*altAz.z);\n"
+		"    }\n"
+		"    highp float radius = exp(lnRadius0 - radiusSlope*(magMin + magStep*magIndex));\n"
+		"    mediump float lum = 1.0;\n"
+		"    if (radius < 0.3)\n"
+		"        return;\n"
+		"    if (radius < 1.2)\n"
+		"    {\n"
+		"        lum = radius*radius*radius/1.728;\n"
+		"        if (lum < 0.05)\n"
+		"            return;\n"
+		"        radius = 1.2;\n"
+		"    }\n"
+		"    else if (radius > " + QByteArray::number(MAX_LINEAR_RADIUS, 'f', 1) + ")\n"
+		"        radius = " + QByteArray::number(MAX_LINEAR_RADIUS, 'f', 1) + "+sqrt(1.0+radius-" + QByteArray::number(MAX_LINEAR_RADIUS, 'f', 1) + ")-1.0;\n"
+		"    radius *= radiusScale;\n"
+		"    highp float random = fract(sin(dot(pos, vec3(12.9898, 78.233, 37.719)) + twinkleSeed)*43758.5453);\n"
+		"    mediump float tw = (1.0-twinkleFactor*twinkleAmount*random)*lum;\n"
+		"    highp vec3 p = (preTransfo*vec4(v, 1.0)).xyz;\n"
+		"    if (withRefraction)\n"
+		"    {\n"
+		"        refractionForward(p);\n"
+		"        p = (postTransfo*vec4(p, 1.0)).xyz;\n"
+		"    }\n"
+		"    if (!projectorForward(p))\n"
+		"        return;\n"
+		"    highp vec2 win = viewportCenter + viewportScale*p.xy;\n"
+		"    if (win.x < viewportRect.x || win.y < viewportRect.y || win.x > viewportRect.z || win.y > viewportRect.w)\n"
+		"        return;\n"
+		"    gl_Position = projectionMatrix * vec4(win + (magCorner.yz*2.0-1.0)*radius, 0.0, 1.0);\n"
+		"    texc = magCorner.yz;\n"
+		"    outColor = min(color*tw, 1.0);\n"
+		"}\n";
+	vshader.compileSourceCode(vsrc);
+	if (!vshader.log().isEmpty()) { qWarning() << "StelSkyDrawer::getStaticPointSourceShader(): Warnings while compiling vshader: " << vshader.log(); }
+
+	QOpenGLShader fshader(QOpenGLShader::Fragment);
+	const char *fsrc =
+		"varying mediump vec2 texc;\n"
+		"varying mediump vec3 outColor;\n"
+		"uniform sampler2D tex;\n"
+		"void main(void)\n"
+		"{\n"
+		"    gl_FragColor = texture2D(tex, texc)*vec4(outColor, 1.);\n"
+		"}\n";
+	fshader.compileSourceCode(fsrc);
+	if (!fshader.log().isEmpty()) { qWarning() << "StelSkyDrawer::getStaticPointSourceShader(): Warnings while compiling fshader: " << fshader.log(); }
+
+	StaticPointSourceShader shader;
+	shader.program = Q_NULLPTR;
+	if (vshader.isCompiled() && fshader.isCompiled())
+	{
+		shader.program = new QOpenGLShaderProgram(QOpenGLContext::currentContext());
+		shader.program->addShader(&vshader);
+		shader.program->addShader(&fshader);
+		if (!StelPainter::linkProg(shader.program, "staticStarShader"))
+		{
+			delete shader.program;
+			shader.program = Q_NULLPTR;
+		}
+	}
+	if (shader.program)
+	{
+		shader.pos = shader.program->attributeLocation("pos");
+		shader.motion = shader.program->attributeLocation("motion");
+		shader.magCorner = shader.program->attributeLocation("magCorner");
+		shader.color = shader.program->attributeLocation("color");
+	}
+	else
+		qWarning() << "StelSkyDrawer: the point sources of static buffers are drawn on the CPU";
+	it = staticPointSourceShaders.insert(projectorSource, shader);
+	return shader.program ? &it.value() : Q_NULLPTR;
+}
+
+bool StelSkyDrawer::preDrawStaticPointSources(StelPainter* p)
+{
+	Q_ASSERT(p);
+	Q_ASSERT(staticPointSourceShader==Q_NULLPTR);
+
+	const StelProjectorP prj = p->getProjector();
+	const QByteArray projectorSource = prj->getForwardShaderSource();
+	if (projectorSource.isEmpty())
+		return false;
+	const StelProjector::ModelViewTranformP modelView = prj->getModelViewTransform();
+	const Refraction* modelViewRefraction = dynamic_cast<const Refraction*>(modelView.data());
+	if (!modelViewRefraction && !dynamic_cast<const StelProjector::Mat4dTransform*>(modelView.data()))
+		return false;
+
+	StaticPointSourceShader* shader = getStaticPointSourceShader(projectorSource);
+	if (!shader)
+		return false;
+
+	if (!staticPointSourceIndexBuffer.isCreated())
+	{
+		if (!staticPointSourceIndexBuffer.create())
+			return false;
+		QVector<GLushort> indices(MaxStaticPointSourcesPerDraw*6);
+		for (int i=0;i<MaxStaticPointSourcesPerDraw;++i)
+		{
+			const GLushort first = i*4;
+			GLushort* quad = &indices[i*6];
+			quad[0] = first; quad[1] = first+1; quad[2] = first+2;
+			quad[3] = first; quad[4] = first+2; quad[5] = first+3;
+		}
+		staticPointSourceIndexBuffer.bind();
+		staticPointSourceIndexBuffer.allocate(indices.constData(), indices.size()*sizeof(GLushort));
+		staticPointSourceIndexBuffer.release();
+	}
+
+	QOpenGLShaderProgram* program = shader->program;
+	program->bind();
+
+	const Mat4f& m = prj->getProjectionMatrix();
+	const QMatrix4x4 qMat(m[0], m[4], m[8], m[12], m[1], m[5], m[9], m[13], m[2], m[6], m[10], m[14], m[3], m[7], m[11], m[15]);
+	program->setUniformValue("projectionMatrix", qMat);
+	if (modelViewRefraction)
+	{
+		program->setUniformValue("preTransfo", modelViewRefraction->getPreTransfoMat().convertToQMatrix());
+		program->setUniformValue("postTransfo", modelViewRefraction->getPostTransfoMat().convertToQMatrix());
+		program->setUniformValue("refractionPressTempCorr", modelViewRefraction->getPressureTemperatureCorrection());
+	}
+	else
+	{
+		program->setUniformValue("preTransfo", modelView->getApproximateLinearTransfo().convertToQMatrix());
+		program->setUniformValue("postTransfo", QMatrix4x4());
+		program->setUniformValue("refractionPressTempCorr", 0.f);
+	}
+	program->setUniformValue("withRefraction", modelViewRefraction ? 1 : 0);
+
+	// The J2000 to AltAz matrix, as applied by StelCore::j2000ToAltAzInPlaceNoRefraction()
+	const Vec3d origin = core->j2000ToAltAz(Vec3d(0., 0., 0.), StelCore::RefractionOff);
+	const Vec3d ex = core->j2000ToAltAz(Vec3d(1., 0., 0.), StelCore::RefractionOff) - origin;
+	const Vec3d ey = core->j2000ToAltAz(Vec3d(0., 1., 0.), StelCore::RefractionOff) - origin;
+	const Vec3d ez = core->j2000ToAltAz(Vec3d(0., 0., 1.), StelCore::RefractionOff) - origin;
+	program->setUniformValue("j2000ToAltAz", Mat4d(ex[0], ex[1], ex[2], 0., ey[0], ey[1], ey[2], 0., ez[0], ez[1], ez[2], 0., origin[0], origin[1], origin[2], 1.).convertToQMatrix());
+	const bool withExtinction = flagHasAtmosphere && extinction.getExtinctionCoefficient()>=0.01f;
+	program->setUniformValue("withExtinction", withExtinction ? 1 : 0);
+	program->setUniformValue("extinctionCoefficient", extinction.getExtinctionCoefficient());
+	program->setUniformValue("extinctionUndergroundMode", (int)extinction.getUndergroundExtinctionMode());
+
+	const bool withTwinkle = flagStarTwinkle && (flagHasAtmosphere || flagForcedTwinkle);
+	program->setUniformValue("twinkleAmount", withTwinkle ? (float)twinkleAmount : 0.f);
+	program->setUniformValue("twinkleSeed", (float)qrand()/RAND_MAX*100.f);
+
+	float lnRadius0, slope;
+	getPointSourceRadiusLaw(&lnRadius0, &slope);
+	program->setUniformValue("lnRadius0", lnRadius0);
+	program->setUniformValue("radiusSlope", slope);
+
+	const SphericalCap visibleCap = core->getVisibleSkyArea();
+	program->setUniformValue("visibleCap", QVector4D(visibleCap.n[0], visibleCap.n[1], visibleCap.n[2], visibleCap.d));
+	Vec2f viewportCenter, viewportScale;
+	prj->getViewportMapping(&viewportCenter, &viewportScale);
+	program->setUniformValue("viewportCenter", viewportCenter[0], viewportCenter[1]);
+	program->setUniformValue("viewportScale", viewportScale[0], viewportScale[1]);
+	const Vec4i& viewport = prj->getViewport();
+	program->setUniformValue("viewportRect", QVector4D(viewport[0], viewport[1], viewport[0]+viewport[2], viewport[1]+viewport[3]));
+	program->setUniformValue("projectorWidthStretch", prj->getWidthStretch());
+	program->setUniformValue("tex", 0);
+	program->release();
+
+	staticPointSourceShader = shader;
+	return true;
+}
+
+void StelSkyDrawer::setStaticPointSourceParams(float movementFactor, float magMin, float magStep, int cutoffMagIndex, float radiusScale)
+{
+	Q_ASSERT(staticPointSourceShader);
+	QOpenGLShaderProgram* program = staticPointSourceShader->program;
+	program->bind();
+	program->setUniformValue("movementFactor", movementFactor);
+	program->setUniformValue("magMin", magMin);
+	program->setUniformValue("magStep", magStep);
+	program->setUniformValue("cutoffMagIndex", (float)cutoffMagIndex);
+	program->setUniformValue("radiusScale", radiusScale);
+	program->release();
+}
+
+void StelSkyDrawer::drawStaticPointSources(StelPainter* p, QOpenGLBuffer& buffer, int first, int count)
+{
+	Q_ASSERT(staticPointSourceShader);
+	Q_ASSERT(sizeof(StaticPointSourceVertex)==32);
+	if (count<=0)
+		return;
+
+	// The state is set again for each buffer, as point sources and their labels may be drawn in between
+	const StaticPointSourceShader& shader = *staticPointSourceShader;
+	texHalo->bind();
+	p->setBlending(true, GL_ONE, GL_ONE);
+	shader.program->bind();
+	staticPointSourceIndexBuffer.bind();
+	buffer.bind();
+	shader.program->enableAttributeArray(shader.pos);
+	shader.program->enableAttributeArray(shader.motion);
+	shader.program->enableAttributeArray(shader.magCorner);
+	shader.program->enableAttributeArray(shader.color);
+	const int stride = sizeof(StaticPointSourceVertex);
+	for (int done=0;done<count;done+=MaxStaticPointSourcesPerDraw)
+	{
+		// The 16 bits indices address the sources of the chunk from its first vertex
+		const int n = qMin((int)MaxStaticPointSourcesPerDraw, count-done);
+		const int offset = (first+done)*4*stride;
+		shader.program->setAttributeBuffer(shader.pos, GL_FLOAT, offset, 3, stride);
+		shader.program->setAttributeBuffer(shader.motion, GL_FLOAT, offset+12, 3, stride);
+		shader.program->setAttributeBuffer(shader.magCorner, GL_UNSIGNED_BYTE, offset+24, 4, stride);
+		shader.program->setAttributeBuffer(shader.color, GL_UNSIGNED_BYTE, offset+28, 3, stride);
+		glDrawElements(GL_TRIANGLES, n*6, GL_UNSIGNED_SHORT, Q_NULLPTR);
+	}
+	shader.program->disableAttributeArray(shader.pos);
+	shader.program->disableAttributeArray(shader.motion);
+	shader.program->disableAttributeArray(shader.magCorner);
+	shader.program->disableAttributeArray(shader.color);
+	buffer.release();
+	staticPointSourceIndexBuffer.release();
+	shader.program->release();
+}
+
+void StelSkyDrawer::postDrawStaticPointSources()
+{
+	staticPointSourceShader = Q_NULLPTR;
+}
+
 // Draw's the Sun's corona during a solar eclipse on Earth.
 void StelSkyDrawer::drawSunCorona(StelPainter* painter, const Vec3f& v, float radius, const Vec3f& color, const float alpha)
 {
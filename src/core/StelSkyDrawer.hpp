@@ -27,6 +27,9 @@
 #include "StelOpenGL.hpp"
 
 #include <QObject>
+#include <QOpenGLBuffer>
+#include <QMap>
+#include <QByteArray>
 
 class StelToneReproducer;
 class StelCore;
@@ -105,6 +108,57 @@ public:
 
 	bool drawPointSource(StelPainter* sPainter, const Vec3f& v, const RCMag &rcMag, const Vec3f& bcolor, bool checkInScreen=false, float twinkleFactor=1.0f);
 
+	//! Vertex of the static buffers drawn by drawStaticPointSources(). A point source is
+	//! stored as a quad of 4 vertices which only differ by their corner, so that the
+	//! buffers can be uploaded once and drawn at any date, zoom and atmosphere.
+	struct StaticPointSourceVertex
+	{
+		Vec3f pos;			//!< J2000 position at epoch J2000.0
+		Vec3f motion;			//!< Position change per unit of the movement factor
+		unsigned char magCorner[4];	//!< Magnitude index, corner x and y (0 or 255), unused
+		unsigned char color[4];		//!< RGB color of the B-V index, unused
+	};
+
+	//! Fill the 4 vertices of a point source in a static buffer.
+	//! @param quad the 4 vertices to fill
+	//! @param pos the J2000 position of the source at epoch J2000.0
+	//! @param motion the change of pos per unit of the movement factor
+	//! @param magIndex the magnitude index of the source, see setStaticPointSourceParams()
+	//! @param bV the source B-V index
+	static void setStaticPointSource(StaticPointSourceVertex* quad, const Vec3f& pos, const Vec3f& motion, int magIndex, int bV);
+
+	//! Prepare the drawing of point sources from static buffers. The point sources are
+	//! projected, extincted, sized and twinkled by a vertex shader. They are never
+	//! labelled and never get the big halo, so callers keep the bright sources for
+	//! drawPointSource().
+	//! @param p the painter, its projector must not change until the sources are drawn
+	//! @return false if the projection or the frame of the painter can only be done on the CPU
+	bool preDrawStaticPointSources(StelPainter* p);
+
+	//! Set the parameters of the next calls to drawStaticPointSources(). A source of
+	//! magnitude index i has the magnitude magMin+magStep*i.
+	//! @param movementFactor the factor applied to the motion of the sources
+	//! @param magMin the magnitude of magnitude index 0
+	//! @param magStep the magnitude increase per magnitude index
+	//! @param cutoffMagIndex sources extincted to this magnitude index or beyond are not drawn
+	//! @param radiusScale the factor applied to the radius of the sources, e.g. for fading
+	void setStaticPointSourceParams(float movementFactor, float magMin, float magStep, int cutoffMagIndex, float radiusScale);
+
+	//! Draw point sources from a static buffer. Must be called between
+	//! preDrawStaticPointSources() and postDrawStaticPointSources(), calls
+	//! to drawPointSource() may be interleaved.
+	//! @param p the painter given to preDrawStaticPointSources()
+	//! @param buffer vertex buffer of StaticPointSourceVertex
+	//! @param first the index of the first source to draw in the buffer
+	//! @param count the number of sources to draw
+	void drawStaticPointSources(StelPainter* p, QOpenGLBuffer& buffer, int first, int count);
+
+	//! Finalize the drawing of point sources from static buffers.
+	void postDrawStaticPointSources();
+
+	//! Get whether drawPointSource() draws the big halo around a source.
+	static bool hasBigHalo(const RCMag& rcMag);
+
 	void drawSunCorona(StelPainter* painter, const Vec3f& v, float radius, const Vec3f& color, const float alpha);
 
 	//! Terminate drawing of a 3D model, draw the halo
@@ -121,6 +175,13 @@ public:
 	//! @return false if the object is too faint to be displayed
 	bool computeRCMag(float mag, RCMag*) const;
 
+	//! Get the law followed by the halo radius of point sources before computeRCMag()
+	//! clamps it: ln(radius) = lnRadius0 - slope*mag. Tables computed by computeRCMag()
+	//! remain valid as long as the law is the same.
+	//! @param lnRadius0 the log of the radius of a point source of magnitude 0
+	//! @param slope the decrease of the log of the radius per magnitude
+	void getPointSourceRadiusLaw(float* lnRadius0, float* slope) const;
+
 	//! Report that an object of luminance lum with an on-screen area of area pixels is currently displayed
 	//! This information is used to determine the world adaptation luminance
 	//! This method should be called during the update operations of the main loop
@@ -436,6 +497,23 @@ private:
 
 	//! Buffer for storing the texture coordinate array data.
 	unsigned char* textureCoordArray;
+
+	//! Grow the vertex and texture coordinate arrays to hold twice as many sources.
+	void growPointSourceArrays();
+
+	//! Number of vertex buffers the point sources are streamed into in turn.
+	static const int NbPointSourceBuffers = 3;
+	//! Ring of vertex buffers the point sources are streamed into. Each flush
+	//! uses the next buffer and orphans its previous storage, so that the upload
+	//! never waits for the GPU to finish drawing from a buffer.
+	QOpenGLBuffer pointSourceBuffers[NbPointSourceBuffers];
+	//! Index of the next buffer to use in pointSourceBuffers.
+	int nextPointSourceBuffer;
+	//! Texture coordinates of the point sources. They are the same for all
+	//! sources, and only uploaded again when the arrays grow.
+	QOpenGLBuffer textureCoordBuffer;
+	//! Number of sources the texture coordinates were uploaded for.
+	unsigned int textureCoordBufferSources;
 	
 	class QOpenGLShaderProgram* starShaderProgram;
 	struct StarShaderVars {
@@ -447,10 +525,35 @@ private:
 	};
 	StarShaderVars starShaderVars;
 	
+	//! Shader program drawing the point sources of static buffers, for one projection.
+	struct StaticPointSourceShader {
+		class QOpenGLShaderProgram* program;
+		int pos;
+		int motion;
+		int magCorner;
+		int color;
+	};
+	//! The programs compiled so far, by source of the projection. A null program
+	//! means that the compilation failed.
+	QMap<QByteArray, StaticPointSourceShader> staticPointSourceShaders;
+	//! The program prepared by preDrawStaticPointSources().
+	StaticPointSourceShader* staticPointSourceShader;
+	//! Get the program for the GLSL source of a projection, compiling it if needed.
+	StaticPointSourceShader* getStaticPointSourceShader(const QByteArray& projectorSource);
+
+	//! Maximum number of sources drawn by a single call from a static buffer,
+	//! so that their vertices can be addressed by 16 bits indices.
+	static const int MaxStaticPointSourcesPerDraw = 16384;
+	//! Indices of the 2 triangles of the quads of MaxStaticPointSourcesPerDraw sources.
+	QOpenGLBuffer staticPointSourceIndexBuffer;
+
 	//! Current number of sources stored in the buffers (still to display)
 	unsigned int nbPointSources;
-	//! Maximum number of sources which can be stored in the buffers
+	//! Maximum number of sources which can currently be stored in the buffers.
+	//! The buffers grow as needed, so that all point sources of a frame are usually drawn at once.
 	unsigned int maxPointSources;
+	//! Number of sources above which the buffers are flushed instead of grown.
+	unsigned int maxPointSourcesLimit;
 
 	//! The maximum transformed luminance to apply at the next update
 	float maxLum;
@@ -0,0 +1,201 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelStartupProfiler.hpp"
+#include "StelFileMgr.hpp"
+#include "StelJsonParser.hpp"
+#include "StelUtils.hpp"
+
+#include <QAtomicInt>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QMutex>
+#include <QSaveFile>
+#include <QThread>
+#include <QVariantList>
+#include <QVariantMap>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <time.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+	// A measured operation
+	struct Measure
+	{
+		QString category;
+		QString name;
+		QString thread;
+		qint64 startMs;
+		qint64 wallMs;
+		double cpuMs;
+		qint64 peakRssDeltaKb;
+	};
+
+	QAtomicInt enabled(0);
+	QMutex measuresMutex;
+	QList<Measure> measures;
+	QString reportPath;
+	// Time at which the profiler was enabled, origin of the start times
+	qint64 originMs = 0;
+}
+
+void StelStartupProfiler::setEnabled(bool b)
+{
+	if (b)
+		originMs = QDateTime::currentMSecsSinceEpoch();
+	enabled.store(b ? 1 : 0);
+}
+
+bool StelStartupProfiler::isEnabled()
+{
+	return enabled.load()!=0;
+}
+
+void StelStartupProfiler::setReportPath(const QString& path)
+{
+	reportPath = path;
+}
+
+double StelStartupProfiler::getThreadCpuMs()
+{
+#ifdef Q_OS_WIN
+	FILETIME creationTime, exitTime, kernelTime, userTime;
+	if (!GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime))
+		return -1.;
+	// FILETIME is in units of 100 ns
+	const quint64 kernel = ((quint64)kernelTime.dwHighDateTime << 32) | kernelTime.dwLowDateTime;
+	const quint64 user = ((quint64)userTime.dwHighDateTime << 32) | userTime.dwLowDateTime;
+	return (kernel + user) / 10000.;
+#elif defined(CLOCK_THREAD_CPUTIME_ID)
+	struct timespec ts;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts)!=0)
+		return -1.;
+	return ts.tv_sec*1000. + ts.tv_nsec/1000000.;
+#else
+	return -1.;
+#endif
+}
+
+qint64 StelStartupProfiler::getPeakRssKb()
+{
+#ifdef Q_OS_WIN
+	// Would need psapi, which Stellarium does not link
+	return -1;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage)!=0)
+		return -1;
+#ifdef Q_OS_MAC
+	// In bytes on macOS, in kB elsewhere
+	return usage.ru_maxrss/1024;
+#else
+	return usage.ru_maxrss;
+#endif
+#endif
+}
+
+StelStartupProfiler::Scope::Scope(const char* category, const QString& name)
+	: category(category)
+	, active(isEnabled())
+	, startWallMs(0)
+	, startCpuMs(0.)
+	, startPeakRssKb(0)
+{
+	if (!active)
+		return;
+	this->name = name;
+	startWallMs = QDateTime::currentMSecsSinceEpoch();
+	startCpuMs = getThreadCpuMs();
+	startPeakRssKb = getPeakRssKb();
+}
+
+StelStartupProfiler::Scope::~Scope()
+{
+	if (!active || !isEnabled())
+		return;
+	const qint64 endWallMs = QDateTime::currentMSecsSinceEpoch();
+	const double endCpuMs = getThreadCpuMs();
+	const qint64 endPeakRssKb = getPeakRssKb();
+
+	Measure m;
+	m.category = category;
+	m.name = name;
+	m.thread = (QCoreApplication::instance() && QThread::currentThread()==QCoreApplication::instance()->thread()) ? "main" : "worker";
+	m.startMs = startWallMs - originMs;
+	m.wallMs = endWallMs - startWallMs;
+	m.cpuMs = (startCpuMs<0. || endCpuMs<0.) ? -1. : endCpuMs - startCpuMs;
+	m.peakRssDeltaKb = (startPeakRssKb<0 || endPeakRssKb<0) ? -1 : endPeakRssKb - startPeakRssKb;
+
+	QMutexLocker lock(&measuresMutex);
+	measures.append(m);
+}
+
+void StelStartupProfiler::writeReport()
+{
+	if (!isEnabled())
+		return;
+	setEnabled(false);
+
+	QVariantList entries;
+	{
+		QMutexLocker lock(&measuresMutex);
+		foreach (const Measure& m, measures)
+		{
+			QVariantMap entry;
+			entry.insert("category", m.category);
+			entry.insert("name", m.name);
+			entry.insert("thread", m.thread);
+			entry.insert("startMs", m.startMs);
+			entry.insert("wallMs", m.wallMs);
+			entry.insert("cpuMs", m.cpuMs);
+			entry.insert("peakRssDeltaKb", m.peakRssDeltaKb);
+			entries << entry;
+		}
+		measures.clear();
+	}
+
+	QVariantMap report;
+	report.insert("version", StelUtils::getApplicationVersion());
+	report.insert("operatingSystem", StelUtils::getOperatingSystemInfo());
+	report.insert("date", QDateTime::currentDateTime().toString(Qt::ISODate));
+	report.insert("totalWallMs", QDateTime::currentMSecsSinceEpoch() - originMs);
+	report.insert("peakRssKb", getPeakRssKb());
+	report.insert("measures", entries);
+
+	const QString path = reportPath.isEmpty() ? StelFileMgr::getUserDir() + "/startup-profile.json" : reportPath;
+	QSaveFile file(path);
+	if (file.open(QIODevice::WriteOnly | QIODevice::Text))
+	{
+		StelJsonParser::write(report, &file);
+		if (file.commit())
+		{
+			qDebug() << "Startup profile written to" << QDir::toNativeSeparators(path);
+			return;
+		}
+	}
+	qWarning() << "WARNING - could not write startup profile" << QDir::toNativeSeparators(path) << file.errorString();
+}
@@ -0,0 +1,76 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELSTARTUPPROFILER_HPP_
+#define _STELSTARTUPPROFILER_HPP_
+
+#include <QString>
+
+//! @class StelStartupProfiler
+//! Measures where the startup time goes when Stellarium is started with --profile-startup.
+//! Module initializations, catalog loads and plugin initializations are measured
+//! with a StelStartupProfiler::Scope. For each of them the wall time, the CPU time of
+//! the calling thread and the increase of the peak resident set size of the process
+//! are recorded. Once the startup is finished, writeReport() saves them as JSON.
+//! When the profiler is disabled, a Scope costs a single test.
+class StelStartupProfiler
+{
+public:
+	//! Measure an operation, from the construction of the Scope to its destruction.
+	//! Scopes may be used from any thread and may be nested.
+	class Scope
+	{
+	public:
+		//! @param category the kind of operation, e.g. "init", "preload", "catalog" or "plugin"
+		//! @param name the name of the module, catalog or plugin. A name which is costly
+		//! to build, like the file name of a path, should only be built if isEnabled().
+		Scope(const char* category, const QString& name);
+		~Scope();
+	private:
+		Q_DISABLE_COPY(Scope)
+		const char* category;
+		QString name;
+		bool active;
+		qint64 startWallMs;
+		double startCpuMs;
+		qint64 startPeakRssKb;
+	};
+
+	//! Enable or disable the recording of measures.
+	//! Start times are counted from the moment the profiler is enabled.
+	static void setEnabled(bool b);
+	//! Get whether measures are recorded.
+	static bool isEnabled();
+
+	//! Set the path of the JSON report.
+	//! If empty, the report is written to startup-profile.json in the user data directory.
+	static void setReportPath(const QString& path);
+
+	//! Write all the measures to the JSON report and stop recording.
+	//! Does nothing if the profiler is disabled.
+	static void writeReport();
+
+private:
+	//! CPU time used by the calling thread in ms, or -1 if not available.
+	static double getThreadCpuMs();
+	//! Peak resident set size of the process in kB, or -1 if not available.
+	static qint64 getPeakRssKb();
+};
+
+#endif // _STELSTARTUPPROFILER_HPP_
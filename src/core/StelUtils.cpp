@@ -2091,13 +2091,18 @@ double getMoonSecularAcceleration(const double jDay, const double nd, const bool
 	getDateFromJulianDay(jDay, &year, &month, &day);
 
 	double t = (getDecYear(year, month, day)-1955.5)/100.0;
+	return getMoonSecularAccelerationCoefficient(nd, useDE43x)*t*t;
+}
+
+double getMoonSecularAccelerationCoefficient(const double nd, const bool useDE43x)
+{
 	// n.dot for secular acceleration of the Moon in ELP2000-82B
 	// have value -23.8946 "/cy/cy (or -25.8 for DE43x usage)
 	double ephND = -23.8946;
 	if (useDE43x)
 		ephND = -25.8;
 
-	return -0.91072 * (ephND + qAbs(nd))*t*t;
+	return -0.91072 * (ephND + qAbs(nd));
 }
 
 double getDeltaTStandardError(const double jDay)
@@ -648,6 +648,13 @@ namespace StelUtils
 	//! @note n-dot for secular acceleration of the Moon in ELP2000-82B is -23.8946 "/cy/cy and for DE43x is -25.8 "/cy/cy
 	double getMoonSecularAcceleration(const double jDay, const double ndot, const bool useDE43x);
 
+	//! Get the coefficient of the Secular Acceleration estimation, which is proportional to the square of the
+	//! time since 1955.5: getMoonSecularAcceleration() is this coefficient times a function of the date only.
+	//! @param ndot value of n-dot, as for getMoonSecularAcceleration()
+	//! @param useDE43x as for getMoonSecularAcceleration()
+	//! @return the coefficient in seconds per square century
+	double getMoonSecularAccelerationCoefficient(const double ndot, const bool useDE43x);
+
 	//! Get the standard error (sigma) for the value of DeltaT
 	//! @param jDay the JD
 	//! @return sigma in seconds
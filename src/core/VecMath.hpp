@@ -367,6 +367,13 @@ public:
 	inline Vector3<T> multiplyWithoutTranslation(const Vector3<T>& a) const;
 	inline Vector4<T> operator*(const Vector4<T>&) const;
 
+	//! Multiply n column vectors in homogeneous coordinates (use a[3]=1), like operator*.
+	//! The computations are done with the precision of the matrix. in and out may be the same array.
+	//! The vectors are independent, so that the compiler can vectorize the loop (SSE2/AVX).
+	template<class U> inline void transfoArray(int n, const Vector3<U>* in, Vector3<U>* out) const;
+	//! Multiply n vectors like multiplyWithoutTranslation(). in and out may be the same array.
+	template<class U> inline void multiplyWithoutTranslationArray(int n, const Vector3<U>* in, Vector3<U>* out) const;
+
 	inline void transfo(Vector3<T>&) const;
 
 	static Matrix4<T> identity();
@@ -1374,6 +1381,33 @@ template<class T> Vector3<T> Matrix4<T>::multiplyWithoutTranslation(const Vector
 			  r[2]*a.v[0] + r[6]*a.v[1] + r[10]*a.v[2]);
 }
 
+template<class T> template<class U> void Matrix4<T>::transfoArray(int n, const Vector3<U>* in, Vector3<U>* out) const
+{
+	// Local copies: the compiler cannot otherwise know that writing out does not change the matrix
+	const T m0=r[0], m1=r[1], m2=r[2], m4=r[4], m5=r[5], m6=r[6];
+	const T m8=r[8], m9=r[9], m10=r[10], m12=r[12], m13=r[13], m14=r[14];
+	for (int i=0; i<n; ++i)
+	{
+		const T x=in[i].v[0], y=in[i].v[1], z=in[i].v[2];
+		out[i].v[0]=static_cast<U>(m0*x + m4*y +  m8*z + m12);
+		out[i].v[1]=static_cast<U>(m1*x + m5*y +  m9*z + m13);
+		out[i].v[2]=static_cast<U>(m2*x + m6*y + m10*z + m14);
+	}
+}
+
+template<class T> template<class U> void Matrix4<T>::multiplyWithoutTranslationArray(int n, const Vector3<U>* in, Vector3<U>* out) const
+{
+	const T m0=r[0], m1=r[1], m2=r[2], m4=r[4], m5=r[5], m6=r[6];
+	const T m8=r[8], m9=r[9], m10=r[10];
+	for (int i=0; i<n; ++i)
+	{
+		const T x=in[i].v[0], y=in[i].v[1], z=in[i].v[2];
+		out[i].v[0]=static_cast<U>(m0*x + m4*y +  m8*z);
+		out[i].v[1]=static_cast<U>(m1*x + m5*y +  m9*z);
+		out[i].v[2]=static_cast<U>(m2*x + m6*y + m10*z);
+	}
+}
+
 // multiply column vector by a 4x4 matrix in homogeneous coordinate (considere a[3]=1)
 template<class T> Vector4<T> Matrix4<T>::operator*(const Vector4<T>& a) const
 {
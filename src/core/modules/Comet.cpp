@@ -113,10 +113,6 @@ Comet::Comet(const QString& englishName,
 	//TODO: Name processing?
 }
 
-Comet::~Comet()
-{
-}
-
 void Comet::setAbsoluteMagnitudeAndSlope(const float magnitude, const float slope)
 {
 	if (slope < 0 || slope > 20.0)
@@ -451,10 +447,14 @@ void Comet::update(int deltaTime)
 
 		gastailColorArr.clear();
 		dusttailColorArr.clear();
+		gastailAltAzArr.resize(gastailVertexArr.size());
+		dusttailAltAzArr.resize(dusttailVertexArr.size());
+		core->j2000ToAltAz(gastailAltAzArr.size(), gastailVertexArr.constData(), gastailAltAzArr.data(), StelCore::RefractionOn);
+		core->j2000ToAltAz(dusttailAltAzArr.size(), dusttailVertexArr.constData(), dusttailAltAzArr.data(), StelCore::RefractionOn);
 		for (int i=0; i<gastailVertexArr.size(); ++i)
 		{
 			// Gastail extinction:
-			Vec3d vertAltAz=core->j2000ToAltAz(gastailVertexArr.at(i), StelCore::RefractionOn);
+			Vec3d vertAltAz=gastailAltAzArr.at(i);
 			vertAltAz.normalize();
 			Q_ASSERT(fabs(vertAltAz.lengthSquared()-1.0) < 0.001);
 			float oneMag=0.0f;
@@ -463,7 +463,7 @@ void Comet::update(int deltaTime)
 			gastailColorArr.append(gasColor*extinctionFactor* brightnessPerVertexFromHead*intensityFovScale);
 
 			// dusttail extinction:
-			vertAltAz=core->j2000ToAltAz(dusttailVertexArr.at(i), StelCore::RefractionOn);
+			vertAltAz=dusttailAltAzArr.at(i);
 			vertAltAz.normalize();
 			Q_ASSERT(fabs(vertAltAz.lengthSquared()-1.0) < 0.001);
 			oneMag=0.0f;
@@ -60,8 +60,6 @@ public:
 	      float dustTailBrightnessFact=1.5f
 	);
 
-	virtual ~Comet();
-
 	//Inherited from StelObject via Planet
 	//! Get a string with data about the Comet.
 	//! Comets support the following InfoStringGroup flags:
@@ -168,6 +166,8 @@ private:
 	QVector<Vec3d> dusttailVertexArr; // computed frequently, describes parabolic shape (along z axis) of dust tail.
 	QVector<Vec3f> gastailColorArr;    // NEW computed for every 5 mins, modulates gas tail brightness for extinction
 	QVector<Vec3f> dusttailColorArr;   // NEW computed for every 5 mins, modulates dust tail brightness for extinction
+	QVector<Vec3d> gastailAltAzArr;    // scratch buffer of update(), kept to avoid an allocation per frame
+	QVector<Vec3d> dusttailAltAzArr;   // scratch buffer of update(), kept to avoid an allocation per frame
 	static QVector<float> tailTexCoordArr; // computed only once for all comets!
 	static QVector<unsigned short> tailIndices; // computed only once for all comets!
 	static StelTextureSP comaTexture;
@@ -172,9 +172,11 @@ void MilkyWay::draw(StelCore* core)
 		const Extinction& extinction=drawer->getExtinction();
 		vertexArray->colors.clear();
 
-		for (int i=0; i<vertexArray->vertex.size(); ++i)
+		QVector<Vec3d> altAzArray(vertexArray->vertex.size());
+		core->j2000ToAltAz(altAzArray.size(), vertexArray->vertex.constData(), altAzArray.data(), StelCore::RefractionOn);
+		for (int i=0; i<altAzArray.size(); ++i)
 		{
-			Vec3d vertAltAz=core->j2000ToAltAz(vertexArray->vertex.at(i), StelCore::RefractionOn);
+			const Vec3d& vertAltAz=altAzArray.at(i);
 			Q_ASSERT(fabs(vertAltAz.lengthSquared()-1.0) < 0.001);
 
 			float oneMag=0.0f;
@@ -39,11 +39,13 @@
 #include "StelPainter.hpp"
 #include "RefractionExtinction.hpp"
 #include "StelActionMgr.hpp"
+#include "StelStartupProfiler.hpp"
 
 #include <algorithm>
 #include <vector>
 #include <QDebug>
 #include <QFile>
+#include <QFileInfo>
 #include <QSettings>
 #include <QString>
 #include <QStringList>
@@ -168,6 +170,18 @@ double NebulaMgr::getCallOrder(StelModuleActionName actionName) const
 }
 
 // read from stream
+void NebulaMgr::preload()
+{
+	// TODO: mechanism to specify which sets get loaded at start time.
+	// candidate methods:
+	// 1. config file option (list of sets to load at startup)
+	// 2. load all
+	// 3. flag in nebula_textures.fab (yuk)
+	// 4. info.ini file in each set containing a "load at startup" item
+	// For now (0.9.0), just load the default set
+	loadNebulaSet("default");
+}
+
 void NebulaMgr::init()
 {
 	QSettings* conf = StelApp::getInstance().getSettings();
@@ -388,14 +402,9 @@ void NebulaMgr::init()
 
 	setTypeFilters(typeFilters);
 
-	// TODO: mechanism to specify which sets get loaded at start time.
-	// candidate methods:
-	// 1. config file option (list of sets to load at startup)
-	// 2. load all
-	// 3. flag in nebula_textures.fab (yuk)
-	// 4. info.ini file in each set containing a "load at startup" item
-	// For now (0.9.0), just load the default set
-	loadNebulaSet("default");
+	// The default set was loaded by preload(), the converter needs to be run first
+	if (flagConverter)
+		loadNebulaSet("default");
 
 	updateI18n();
 
@@ -1320,6 +1329,7 @@ void NebulaMgr::convertDSOCatalog(const QString &in, const QString &out, bool de
 
 bool NebulaMgr::loadDSOCatalog(const QString &filename)
 {
+	StelStartupProfiler::Scope profile("catalog", StelStartupProfiler::isEnabled() ? QFileInfo(filename).fileName() : QString());
 	QFile in(filename);
 	if (!in.open(QIODevice::ReadOnly))
 		return false;
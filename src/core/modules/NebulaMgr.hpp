@@ -311,6 +311,9 @@ public:
 
 	///////////////////////////////////////////////////////////////////////////
 	// Methods defined in the StelModule class
+	//! Load the default deep-sky catalog and outlines into memory.
+	virtual void preload();
+
 	//! Initialize the NebulaMgr object.
 	//!  - Load the font into the Nebula class, which is used to draw Nebula labels.
 	//!  - Load the texture used to draw nebula locations into the Nebula class (for
@@ -273,6 +273,177 @@ void CometOrbit::positionAtTimevInVSOP87Coordinates(double JDE, double *v, bool
 	}
 }
 
+void cometOrbitPosFunc(double jd,double xyz[3], void* userDataPtr)
+{
+	static_cast<CometOrbit*>(userDataPtr)->positionAtTimevInVSOP87Coordinates(jd, xyz);
+}
+
+
+int KeplerOrbitBatch::add(const CometOrbit& orbit)
+{
+	const int index = q.size();
+	q.append(orbit.q);
+	e.append(orbit.e);
+	n.append(orbit.n);
+	t0.append(orbit.t0);
+	if (orbit.e < 1.0)
+	{
+		eEll.append(orbit.e);
+		a.append(orbit.q/(1.0-orbit.e));
+		b.append(orbit.q*std::sqrt((1.0+orbit.e)/(1.0-orbit.e)));
+	}
+	else
+	{
+		eEll.append(0.0);
+		a.append(0.0);
+		b.append(0.0);
+		nonElliptical.append(index);
+	}
+
+	// P and Q of Init3D(), rotated to VSOP87 coordinates like in CometOrbit::positionAtTimevInVSOP87Coordinates()
+	const double cw = cos(orbit.w);
+	const double sw = sin(orbit.w);
+	const double cOm = cos(orbit.Om);
+	const double sOm = sin(orbit.Om);
+	const double ci = cos(orbit.i);
+	const double si = sin(orbit.i);
+	const Vec3d P(-sw*sOm*ci+cw*cOm, sw*cOm*ci+cw*sOm, sw*si);
+	const Vec3d Q(-cw*sOm*ci-sw*cOm, cw*cOm*ci-sw*sOm, cw*si);
+	const double* r = orbit.rotateToVsop87;
+	Px.append(r[0]*P[0] + r[1]*P[1] + r[2]*P[2]);
+	Py.append(r[3]*P[0] + r[4]*P[1] + r[5]*P[2]);
+	Pz.append(r[6]*P[0] + r[7]*P[1] + r[8]*P[2]);
+	Qx.append(r[0]*Q[0] + r[1]*Q[1] + r[2]*Q[2]);
+	Qy.append(r[3]*Q[0] + r[4]*Q[1] + r[5]*Q[2]);
+	Qz.append(r[6]*Q[0] + r[7]*Q[1] + r[8]*Q[2]);
+	return index;
+}
+
+void KeplerOrbitBatch::clear()
+{
+	q.clear();
+	e.clear();
+	eEll.clear();
+	n.clear();
+	t0.clear();
+	a.clear();
+	b.clear();
+	Px.clear(); Py.clear(); Pz.clear();
+	Qx.clear(); Qy.clear(); Qz.clear();
+	nonElliptical.clear();
+}
+
+//! sin(x) and cos(x) for the batch solver, in code without branches or calls so that its loops are vectorized.
+//! x is reduced to [-pi/4, pi/4] around the nearest multiple k of pi/2, with pi/2 split in three parts like
+//! in fdlibm, and the sine and cosine of the remainder use the fdlibm polynomials. Accurate to 1-2 ulp for |x|<1e5.
+static inline void sinCosBatch(const double x, double& s, double& c)
+{
+	// Adding and subtracting 1.5*2^52 rounds to the nearest integer; nearbyint() would be a call
+	const double k = (x*6.36619772367581382433e-01 + 6755399441055744.0) - 6755399441055744.0;
+	const double r = ((x - k*1.57079632673412561417e+00) - k*6.07710050630396597660e-11) - k*2.02226624879595063154e-21;
+	const double z = r*r;
+	const double sr = r + r*z*(-1.66666666666666324348e-01 + z*(8.33333333332248946124e-03 + z*(-1.98412698298579493134e-04
+		+ z*(2.75573137070700676789e-06 + z*(-2.50507602534068634195e-08 + z*1.58969099521155010221e-10)))));
+	const double cr = 1.0 - 0.5*z + z*z*(4.16666666666666019037e-02 + z*(-1.38888888888741095749e-03 + z*(2.48015872894767294178e-05
+		+ z*(-2.75573143513906633035e-07 + z*(2.08757232129817482790e-09 + z*-1.13596475577881948265e-11)))));
+	const int quadrant = static_cast<int>(k) & 3;
+	const double sq = (quadrant & 1) ? cr : sr;
+	const double cq = (quadrant & 1) ? sr : cr;
+	s = (quadrant & 2) ? -sq : sq;
+	c = ((quadrant+1) & 2) ? -cq : cq;
+}
+
+void KeplerOrbitBatch::computePositions(int begin, int end, const double* JDE, double* xyz) const
+{
+	Q_ASSERT(0<=begin && begin<=end && end<=size());
+	// Blocks are small enough for the temporary arrays to stay in the L1 cache.
+	static const int blockSize = 256;
+	double M[blockSize];
+	double E[blockSize];
+	double delta[blockSize];
+	for (int first=begin; first<end; first+=blockSize)
+	{
+		const int count = qMin(blockSize, end-first);
+		// Raw pointers on the block, so that the loops below can be vectorized
+		const double* const ecc = eEll.constData()+first;
+		const double* const nb = n.constData()+first;
+		const double* const t0b = t0.constData()+first;
+		const double* const ab = a.constData()+first;
+		const double* const bb = b.constData()+first;
+		const double* const jde = JDE+(first-begin);
+		double* const pos = xyz+3*(first-begin);
+
+		// Mean anomaly and starting value, like in InitEll()
+		for (int k=0; k<count; ++k)
+		{
+			// fmod(m, 2*M_PI) with the rounding of sinCosBatch(), then wrapped into [0, 2*M_PI)
+			const double m0 = nb[k]*(jde[k]-t0b[k]);
+			const double turns = (m0*(0.5/M_PI) + 6755399441055744.0) - 6755399441055744.0;
+			double m = m0 - turns*(2.0*M_PI);
+			m += (m < 0.0) ? 2.0*M_PI : 0.0;
+			M[k] = m;
+			// StelUtils::sign(sin(m)) for m in [0, 2*M_PI): 0 for m==0, -1 beyond M_PI
+			const double sign = (m > M_PI) ? -1.0 : ((m > 0.0) ? 1.0 : 0.0);
+			E[k] = m + 0.85*ecc[k]*sign;
+		}
+
+		// Laguerre-Conway iterations over the whole block, until all orbits converged.
+		// 1-e*cos(E) is always positive for elliptical orbits: no sign() is needed.
+		// The convergence test is a separate loop: a reduction in the iteration would keep it scalar.
+		for (int pass=0; pass<=10; ++pass)
+		{
+			for (int k=0; k<count; ++k)
+			{
+				double sinE, cosE;
+				sinCosBatch(E[k], sinE, cosE);
+				const double f2 = ecc[k]*sinE;
+				const double f = E[k]-f2-M[k];
+				const double f1 = 1.0-ecc[k]*cosE;
+				delta[k] = (-5.0*f)/(f1+std::sqrt(fabs(16.0*f1*f1-20.0*f*f2)));
+				E[k] += delta[k];
+			}
+			int k = 0;
+			while (k<count && fabs(delta[k]) < EPSILON)
+				++k;
+			if (k==count)
+				break;
+		}
+
+		const double* const Pxb = Px.constData()+first;
+		const double* const Pyb = Py.constData()+first;
+		const double* const Pzb = Pz.constData()+first;
+		const double* const Qxb = Qx.constData()+first;
+		const double* const Qyb = Qy.constData()+first;
+		const double* const Qzb = Qz.constData()+first;
+		for (int k=0; k<count; ++k)
+		{
+			double sinE, cosE;
+			sinCosBatch(E[k], sinE, cosE);
+			const double rCosNu = ab[k]*(cosE-ecc[k]);
+			const double rSinNu = bb[k]*sinE;
+			pos[3*k  ] = Pxb[k]*rCosNu + Qxb[k]*rSinNu;
+			pos[3*k+1] = Pyb[k]*rCosNu + Qyb[k]*rSinNu;
+			pos[3*k+2] = Pzb[k]*rCosNu + Qzb[k]*rSinNu;
+		}
+	}
+
+	// Parabolic and hyperbolic orbits were computed as dummy elliptical orbits: overwrite them.
+	for (QVector<int>::const_iterator it=std::lower_bound(nonElliptical.constBegin(), nonElliptical.constEnd(), begin);
+	     it!=nonElliptical.constEnd() && *it<end; ++it)
+	{
+		const int j = *it;
+		const double dt = JDE[j-begin]-t0[j];
+		double rCosNu, rSinNu;
+		if (e[j] > 1.0)
+			InitHyp(q[j],n[j],e[j],dt,rCosNu,rSinNu);
+		else
+			InitPar(q[j],n[j],dt,rCosNu,rSinNu);
+		double* const pos = xyz+3*(j-begin);
+		pos[0] = Px[j]*rCosNu + Qx[j]*rSinNu;
+		pos[1] = Py[j]*rCosNu + Qy[j]*rSinNu;
+		pos[2] = Pz[j]*rCosNu + Qz[j]*rSinNu;
+	}
+}
 
 
 EllipticalOrbit::EllipticalOrbit(double pericenterDistance,
@@ -511,6 +682,11 @@ void EllipticalOrbit::positionAtTimevInVSOP87Coordinates(const double JDE, doubl
 	v[2] = rotateToVsop87[6]*pos[0] + rotateToVsop87[7]*pos[1] + rotateToVsop87[8]*pos[2];
 }
 
+void ellipticalOrbitPosFunc(double jd,double xyz[3], void* userDataPtr)
+{
+	static_cast<EllipticalOrbit*>(userDataPtr)->positionAtTimevInVSOP87Coordinates(jd, xyz);
+}
+
 double EllipticalOrbit::getPeriod() const
 {
 	return period;
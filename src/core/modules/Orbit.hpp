@@ -15,6 +15,8 @@
 
 #include "VecMath.hpp"
 
+#include <QVector>
+
 class OrbitSampleProc;
 
 //! @internal
@@ -102,6 +104,7 @@ public:
 	double getEccentricity() const { return e; }
 	bool objectDateValid(const double JDE) const { return (fabs(t0-JDE)<orbitGood); }
 private:
+	friend class KeplerOrbitBatch;
 	const double q;  //! perihel distance
 	const double e;  //! eccentricity
 	const double i;  //! inclination
@@ -115,6 +118,46 @@ private:
 	const double orbitGood; //! orb. elements are only valid for this time from perihel [days]. Don't draw the object outside.
 };
 
+//! The coordinate functions (posFuncType) of the bodies with orbital elements: userDataPtr is their orbit.
+void ellipticalOrbitPosFunc(double jd, double xyz[3], void* userDataPtr);
+//! This one also updates the velocity of the CometOrbit, which is used for the tails of comets.
+void cometOrbitPosFunc(double jd, double xyz[3], void* userDataPtr);
+
+
+//! @internal
+//! The elements of many CometOrbits stored in contiguous arrays, to compute all their positions at once.
+//! Elliptical orbits are solved block by block with the same Laguerre-Conway iteration as CometOrbit.
+//! The loops use a polynomial sine and cosine instead of calls to the math library, so that GCC and Clang
+//! vectorize them (see the flags of Orbit.cpp in src/CMakeLists.txt). Parabolic and hyperbolic orbits use
+//! the scalar solvers. Velocities are not computed, so the batch is not suitable for comet tails.
+class KeplerOrbitBatch
+{
+public:
+	//! Add the elements of an orbit.
+	//! @return the index of the orbit in the batch
+	int add(const CometOrbit& orbit);
+	void clear();
+	int size() const { return q.size(); }
+
+	//! Compute the positions of the orbits with indices in [begin, end).
+	//! The computations of disjoint ranges may run in parallel.
+	//! @param JDE the dates, one per orbit of the range
+	//! @param xyz receives the positions in VSOP87 coordinates [AU], 3 per orbit of the range
+	void computePositions(int begin, int end, const double* JDE, double* xyz) const;
+
+private:
+	QVector<double> q;	//! perihel distance
+	QVector<double> e;	//! eccentricity
+	QVector<double> eEll;	//! eccentricity of elliptical orbits, 0 for the others so that they do not disturb the solver
+	QVector<double> n;	//! mean motion
+	QVector<double> t0;	//! time of perihel, JDE
+	QVector<double> a;	//! semimajor axis of elliptical orbits
+	QVector<double> b;	//! semiminor axis of elliptical orbits
+	//! Unit vectors towards the perihel and 90° further along the orbit, in VSOP87 coordinates
+	QVector<double> Px, Py, Pz, Qx, Qy, Qz;
+	//! Indices of the parabolic and hyperbolic orbits, in increasing order
+	QVector<int> nonElliptical;
+};
 
 class OrbitSampleProc
 {
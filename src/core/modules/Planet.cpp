@@ -184,10 +184,9 @@ Planet::Planet(const QString& englishName,
 	       const QString& pTypeStr)
 	: flagNativeName(true),
 	  flagTranslatedName(true),
-	  lastOrbitJDE(0.0),
 	  deltaJDE(StelCore::JD_SECOND),
 	  deltaOrbitJDE(0.0),
-	  orbitCached(false),
+	  orbitJobRunning(false),
 	  closeOrbit(acloseOrbit),
 	  englishName(englishName),
 	  nameI18(englishName),
@@ -211,6 +210,7 @@ Planet::Planet(const QString& englishName,
 	  distance(0.0),
 	  sphereScale(1.f),
 	  lastJDE(J2000),
+	  positionGeneration(0),
 	  coordFunc(coordFunc),
 	  orbitPtr(anOrbitPtr),
 	  osculatingFunc(osculatingFunc),
@@ -222,6 +222,11 @@ Planet::Planet(const QString& englishName,
 	  gl(Q_NULLPTR),
 	  iauMoonNumber("")
 {
+	framePositions.frame = 0;
+	framePositions.core = Q_NULLPTR;
+	framePositions.generation = 0;
+	framePositions.altAzPosAutoValid = false;
+
 	// Initialize pType with the key found in pTypeMap, or mark planet type as undefined.
 	// The latter condition should obviously never happen.
 	pType = pTypeMap.key(pTypeStr, Planet::isUNDEFINED);
@@ -308,6 +313,7 @@ void Planet::init()
 
 Planet::~Planet()
 {
+	waitForOrbitSamples();
 	delete rings;
 	delete objModel;
 }
@@ -724,12 +730,46 @@ void Planet::setRotationElements(float _period, float _offset, double _epoch, fl
 	deltaOrbitJDE = re.siderealPeriod/ORBIT_SEGMENTS;
 }
 
+Planet::FramePositions& Planet::getFramePositions(const StelCore* core) const
+{
+	// The planet or its parents may be recomputed without the frame counter, e.g. when only
+	// the Earth is: their generations are part of the key. The observer only moves with the
+	// transformation matrices, which increment the frame counter.
+	const quint64 generation = getPositionGenerations();
+	if (framePositions.frame!=core->getFrameCounter() || framePositions.core!=core || framePositions.generation!=generation)
+	{
+		framePositions.frame = core->getFrameCounter();
+		framePositions.core = core;
+		framePositions.generation = generation;
+		const Vec3d heliocentricPos = (englishName=="Sun") ? GETSTELMODULE(SolarSystem)->getLightTimeSunPosition() : getHeliocentricEclipticPos();
+		framePositions.j2000EquatorialPos = StelCore::matVsop87ToJ2000.multiplyWithoutTranslation(heliocentricPos - core->getObserverHeliocentricEclipticPos());
+		framePositions.altAzPosAutoValid = false;
+	}
+	return framePositions;
+}
+
+quint64 Planet::getPositionGenerations() const
+{
+	quint64 generations = positionGeneration;
+	for (const Planet* p = parent.data(); p; p = p->parent.data())
+		generations += p->positionGeneration;
+	return generations;
+}
+
 Vec3d Planet::getJ2000EquatorialPos(const StelCore *core) const
 {
-	if (englishName=="Sun")
-		return StelCore::matVsop87ToJ2000.multiplyWithoutTranslation(GETSTELMODULE(SolarSystem)->getLightTimeSunPosition() - core->getObserverHeliocentricEclipticPos());
-	else
-		return StelCore::matVsop87ToJ2000.multiplyWithoutTranslation(getHeliocentricEclipticPos() - core->getObserverHeliocentricEclipticPos());
+	return getFramePositions(core).j2000EquatorialPos;
+}
+
+Vec3d Planet::getAltAzPosAuto(const StelCore* core) const
+{
+	FramePositions& positions = getFramePositions(core);
+	if (!positions.altAzPosAutoValid)
+	{
+		positions.altAzPosAuto = core->j2000ToAltAz(positions.j2000EquatorialPos, StelCore::RefractionAuto);
+		positions.altAzPosAutoValid = true;
+	}
+	return positions.altAzPosAuto;
 }
 
 // Compute the position in the parent Planet coordinate system
@@ -740,6 +780,17 @@ void Planet::computePositionWithoutOrbits(const double dateJDE)
 	{
 		coordFunc(dateJDE, eclipticPos, orbitPtr);
 		lastJDE = dateJDE;
+		++positionGeneration;
+	}
+}
+
+void Planet::setComputedPosition(const double dateJDE, const Vec3d& pos)
+{
+	if (fabs(lastJDE-dateJDE)>deltaJDE)
+	{
+		eclipticPos = pos;
+		lastJDE = dateJDE;
+		++positionGeneration;
 	}
 }
 
@@ -814,133 +865,132 @@ void Planet::computePosition(const double dateJDE)
 {
 	// Make sure the parent position is computed for the dateJDE, otherwise
 	// getHeliocentricPos() would return incorrect values.
-	if (parent)
+	// The Sun is skipped: getHeliocentricPos() never uses its position, and bodies
+	// orbiting it may be computed in parallel (see SolarSystem::computePositions()).
+	if (parent && parent->parent)
 		parent->computePositionWithoutOrbits(dateJDE);
 
-	if (orbitFader.getInterstate()>0.000001 && deltaOrbitJDE > 0 && (fabs(lastOrbitJDE-dateJDE)>deltaOrbitJDE || !orbitCached))
-	{
-		StelCore *core=StelApp::getInstance().getCore();
-
-		double calc_date;
-		// int delta_points = (int)(0.5 + (date - lastOrbitJD)/date_increment);
-		int delta_points;
-
-		if( dateJDE > lastOrbitJDE )
-		{
-			delta_points = (int)(0.5 + (dateJDE - lastOrbitJDE)/deltaOrbitJDE);
-		}
-		else
-		{
-			delta_points = (int)(-0.5 + (dateJDE - lastOrbitJDE)/deltaOrbitJDE);
-		}
-		double new_date = lastOrbitJDE + delta_points*deltaOrbitJDE;
-
-		// qDebug( "Updating orbit coordinates for %s (delta %f) (%d points)\n", getEnglishName().toUtf8().data(), deltaOrbitJDE, delta_points);
-
-		if( delta_points > 0 && delta_points < ORBIT_SEGMENTS && orbitCached)
-		{
-
-			for( int d=0; d<ORBIT_SEGMENTS; d++ )
-			{
-				if(d + delta_points >= ORBIT_SEGMENTS-1 )
-				{
-					// calculate new points
-					calc_date = new_date + (d-ORBIT_SEGMENTS/2)*deltaOrbitJDE;
-
-					// date increments between points will not be completely constant though
-					computeTransMatrix(calc_date-core->computeDeltaT(calc_date)/86400.0, calc_date);
-					if (osculatingFunc)
-					{
-						(*osculatingFunc)(dateJDE,calc_date,eclipticPos);
-					}
-					else
-					{
-						coordFunc(calc_date, eclipticPos, orbitPtr);
-					}
-					orbitP[d] = eclipticPos;
-					orbit[d] = getHeliocentricEclipticPos();
-				}
-				else
-				{
-					orbitP[d] = orbitP[d+delta_points];
-					orbit[d] = getHeliocentricPos(orbitP[d]);
-				}
-			}
+	bool orbitChanged = false;
+	if (orbitFader.getInterstate()>0.000001 && deltaOrbitJDE > 0)
+		orbitChanged = updateOrbitSamples(dateJDE);
 
-			lastOrbitJDE = new_date;
-		}
-		else if( delta_points < 0 && abs(delta_points) < ORBIT_SEGMENTS  && orbitCached)
-		{
+	if (fabs(lastJDE-dateJDE)>deltaJDE)
+	{
+		// calculate actual Planet position
+		coordFunc(dateJDE, eclipticPos, orbitPtr);
+		lastJDE = dateJDE;
+		++positionGeneration;
+		orbitChanged = true;
+	}
 
-			for( int d=ORBIT_SEGMENTS-1; d>=0; d-- )
-			{
-				if(d + delta_points < 0 )
-				{
-					// calculate new points
-					calc_date = new_date + (d-ORBIT_SEGMENTS/2)*deltaOrbitJDE;
+	// The parents may have moved: update the heliocentric coordinates of the orbit line
+	if (orbitChanged && orbitFader.getInterstate()>0.000001)
+	{
+		orbit.resize(orbitSamples.points.size());
+		for (int d=0; d<orbit.size(); d++)
+			orbit[d]=getHeliocentricPos(orbitSamples.points.at(d));
+	}
+}
 
-					computeTransMatrix(calc_date-core->computeDeltaT(calc_date)/86400.0, calc_date);
-					if (osculatingFunc) {
-						(*osculatingFunc)(dateJDE,calc_date,eclipticPos);
-					}
-					else
-					{
-						coordFunc(calc_date, eclipticPos, orbitPtr);
-					}
-					orbitP[d] = eclipticPos;
-					orbit[d] = getHeliocentricEclipticPos();
-				}
-				else
-				{
-					orbitP[d] = orbitP[d+delta_points];
-					orbit[d] = getHeliocentricPos(orbitP[d]);
-				}
-			}
+bool Planet::updateOrbitSamples(const double dateJDE)
+{
+	bool swapped = false;
+	if (orbitJobRunning && orbitJob.isFinished())
+	{
+		orbitSamples = orbitJob.result();
+		orbitJobRunning = false;
+		swapped = true;
+	}
+	// Only one job at a time: while the date changes quickly, the samples of the latest date
+	// are computed once the previous job finished, and the previous line is drawn meanwhile.
+	if (!orbitJobRunning && (orbitSamples.points.isEmpty() || fabs(orbitSamples.jde-dateJDE)>deltaOrbitJDE))
+	{
+		orbitJob = QtConcurrent::run(this, &Planet::computeOrbitSamples, dateJDE);
+		orbitJobRunning = true;
+	}
+	return swapped;
+}
 
-			lastOrbitJDE = new_date;
+Planet::OrbitSamples Planet::computeOrbitSamples(const double dateJDE) const
+{
+	// Start from a regular grid over one period centered on dateJDE,
+	// then subdivide the segments where the orbit line curves.
+	static const int initialSegments = 64;
+	const double startJDE = dateJDE - 0.5*re.siderealPeriod;
+	const double step = re.siderealPeriod/initialSegments;
 
-		}
-		else if( delta_points || !orbitCached)
+	OrbitSamples samples;
+	samples.jde = dateJDE;
+	samples.points.reserve(4*initialSegments);
+	Vec3d previous;
+	computeOrbitPoint(dateJDE, startJDE, previous);
+	samples.points.append(previous);
+	for (int i=1; i<=initialSegments; ++i)
+	{
+		const double jde = (i==initialSegments/2) ? dateJDE : startJDE + i*step;
+		Vec3d pos;
+		computeOrbitPoint(dateJDE, jde, pos);
+		refineOrbitSegment(dateJDE, jde-step, previous, jde, pos, 0, samples.points);
+		// The end of the period is not stored: closed orbit lines are joined to their beginning.
+		if (i<initialSegments)
 		{
-
-			// update all points (less efficient)
-			for( int d=0; d<ORBIT_SEGMENTS; d++ )
-			{
-				calc_date = dateJDE + (d-ORBIT_SEGMENTS/2)*deltaOrbitJDE;
-				computeTransMatrix(calc_date-core->computeDeltaT(calc_date)/86400.0, calc_date);
-				if (osculatingFunc)
-				{
-					(*osculatingFunc)(dateJDE,calc_date,eclipticPos);
-				}
-				else
-				{
-					coordFunc(calc_date, eclipticPos, orbitPtr);
-				}
-				orbitP[d] = eclipticPos;
-				orbit[d] = getHeliocentricEclipticPos();
-			}
-
-			lastOrbitJDE = dateJDE;
-			if (!osculatingFunc) orbitCached = 1;
+			if (i==initialSegments/2)
+				samples.centerIndex = samples.points.size();
+			samples.points.append(pos);
 		}
+		previous = pos;
+	}
+	return samples;
+}
 
+void Planet::refineOrbitSegment(const double jde0, const double jdeA, const Vec3d& posA, const double jdeB, const Vec3d& posB, const int depth, QVector<Vec3d>& points) const
+{
+	// 64 segments subdivided at most 4 times: at least 5.6 degrees of mean anomaly per segment,
+	// at most 1024 points for the whole orbit.
+	static const int maxDepth = 4;
+	// The sagitta of an arc turning by an angle a is about chord*a/8:
+	// subdivide when the orbit line turns by more than 1.5 degrees along the segment.
+	static const double maxSagittaRatio = 1.5*M_PI/180./8.;
+	if (depth>=maxDepth)
+		return;
+	const double jdeM = 0.5*(jdeA+jdeB);
+	Vec3d posM;
+	computeOrbitPoint(jde0, jdeM, posM);
+	if ((posM-(posA+posB)*0.5).length() <= maxSagittaRatio*(posB-posA).length())
+		return;
+	refineOrbitSegment(jde0, jdeA, posA, jdeM, posM, depth+1, points);
+	points.append(posM);
+	refineOrbitSegment(jde0, jdeM, posM, jdeB, posB, depth+1, points);
+}
 
-		// calculate actual Planet position
-		coordFunc(dateJDE, eclipticPos, orbitPtr);
+void Planet::computeOrbitPoint(const double jde0, const double jde, double xyz[3]) const
+{
+	if (osculatingFunc)
+		(*osculatingFunc)(jde0, jde, xyz);
+	else
+		computeEclipticPos(jde, xyz);
+}
 
-		lastJDE = dateJDE;
+void Planet::computeEclipticPos(const double dateJDE, double xyz[3]) const
+{
+	// cometOrbitPosFunc() would also change the velocity used for the tails of comets
+	if (coordFunc==&cometOrbitPosFunc)
+		static_cast<CometOrbit*>(orbitPtr)->positionAtTimevInVSOP87Coordinates(dateJDE, xyz, false);
+	else
+		coordFunc(dateJDE, xyz, orbitPtr);
+}
 
-	}
-	else if (fabs(lastJDE-dateJDE)>deltaJDE)
+Vec3d Planet::computeHeliocentricEclipticPos(const double dateJDE) const
+{
+	// Like getHeliocentricPos(), the position of the Sun is not added
+	Vec3d pos(0.);
+	for (const Planet* p=this; p->parent; p=p->parent.data())
 	{
-		// calculate actual Planet position
-		coordFunc(dateJDE, eclipticPos, orbitPtr);
-		if (orbitFader.getInterstate()>0.000001)
-			for( int d=0; d<ORBIT_SEGMENTS; d++ )
-				orbit[d]=getHeliocentricPos(orbitP[d]);
-		lastJDE = dateJDE;
+		Vec3d eclPos;
+		p->computeEclipticPos(dateJDE, eclPos);
+		pos += eclPos;
 	}
-
+	return pos;
 }
 
 // Compute the transformation matrix from the local Planet coordinate system to the parent Planet coordinate system.
@@ -954,6 +1004,12 @@ void Planet::computeTransMatrix(double JD, double JDE)
 	// Special case - heliocentric coordinates are relative to eclipticJ2000 (VSOP87A XY plane),
 	// not solar equator...
 
+	if (parent)
+		rotLocalToParent = computeRotLocalToParent(JDE);
+}
+
+Mat4d Planet::computeRotLocalToParent(const double JDE) const
+{
 	if (parent)
 	{
 		// We can inject a proper precession plus even nutation matrix in this stage, if available.
@@ -970,7 +1026,7 @@ void Planet::computeTransMatrix(double JD, double JDE)
 			// The final rotation by chi_A rotates the equinox (zero degree).
 			// To achieve ecliptical coords of date, you just have now to add a rotX by epsilon_A (obliquity of date).
 
-			rotLocalToParent= Mat4d::zrotation(-psi_A) * Mat4d::xrotation(-omega_A) * Mat4d::zrotation(chi_A);
+			Mat4d rot = Mat4d::zrotation(-psi_A) * Mat4d::xrotation(-omega_A) * Mat4d::zrotation(chi_A);
 			// Plus nutation IAU-2000B:
 			if (StelApp::getInstance().getCore()->getUseNutation())
 			{
@@ -978,12 +1034,25 @@ void Planet::computeTransMatrix(double JD, double JDE)
 				getNutationAngles(JDE, &deltaPsi, &deltaEps);
 				//qDebug() << "deltaEps, arcsec" << deltaEps*180./M_PI*3600. << "deltaPsi" << deltaPsi*180./M_PI*3600.;
 				Mat4d nut2000B=Mat4d::xrotation(eps_A) * Mat4d::zrotation(deltaPsi)* Mat4d::xrotation(-eps_A-deltaEps);
-				rotLocalToParent=rotLocalToParent*nut2000B;
+				rot=rot*nut2000B;
 			}
+			return rot;
 		}
 		else
-			rotLocalToParent = Mat4d::zrotation(re.ascendingNode - re.precessionRate*(JDE-re.epoch)) * Mat4d::xrotation(re.obliquity);
+			return Mat4d::zrotation(re.ascendingNode - re.precessionRate*(JDE-re.epoch)) * Mat4d::xrotation(re.obliquity);
+	}
+	return rotLocalToParent;
+}
+
+Mat4d Planet::computeRotEquatorialToVsop87(const double JDE) const
+{
+	Mat4d rval = computeRotLocalToParent(JDE);
+	if (parent)
+	{
+		for (PlanetP p=parent;p->parent;p=p->parent)
+			rval = p->computeRotLocalToParent(JDE) * rval;
 	}
+	return rval;
 }
 
 Mat4d Planet::getRotEquatorialToVsop87(void) const
@@ -1131,6 +1200,7 @@ void Planet::setHeliocentricEclipticPos(const Vec3d &pos)
 			p = p->parent;
 		}
 	}
+	++positionGeneration;
 }
 
 // Compute the distance to the given position in heliocentric coordinate (in AU)
@@ -3060,6 +3130,8 @@ void Planet::drawOrbit(const StelCore* core)
 		return;
 	if (!re.siderealPeriod)
 		return;
+	if (orbit.size()<2)
+		return;
 
 	const StelProjectorP prj = core->getProjection(StelCore::FrameHeliocentricEclipticJ2000);
 
@@ -3070,21 +3142,25 @@ void Planet::drawOrbit(const StelCore* core)
 
 	Vec3f orbColor = getCurrentOrbitColor();
 
-	sPainter.setColor(orbColor[0], orbColor[1], orbColor[2], orbitFader.getInterstate());
+	// While the orbit line of another date is being sampled, the previous one is drawn faded.
+	const bool outdated = fabs(orbitSamples.jde-lastJDE) > 2.*deltaOrbitJDE;
+	sPainter.setColor(orbColor[0], orbColor[1], orbColor[2], outdated ? 0.5f*orbitFader.getInterstate() : orbitFader.getInterstate());
 	Vec3d onscreen;
+	const int nbPoints = orbit.size();
 	// special case - use current Planet position as center vertex so that draws
 	// on its orbit all the time (since segmented rather than smooth curve)
-	Vec3d savePos = orbit[ORBIT_SEGMENTS/2];
-	orbit[ORBIT_SEGMENTS/2]=getHeliocentricEclipticPos();
-	orbit[ORBIT_SEGMENTS]=orbit[0];
-	int nbIter = closeOrbit ? ORBIT_SEGMENTS : ORBIT_SEGMENTS-1;
+	const Vec3d savePos = orbit.at(orbitSamples.centerIndex);
+	if (!outdated)
+		orbit[orbitSamples.centerIndex]=getHeliocentricEclipticPos();
+	const int nbIter = closeOrbit ? nbPoints : nbPoints-1;
 	QVarLengthArray<float, 1024> vertexArray;
 
 	sPainter.enableClientStates(true, false, false);
 
 	for (int n=0; n<=nbIter; ++n)
 	{
-		if (prj->project(orbit[n],onscreen) && (vertexArray.size()==0 || !prj->intersectViewportDiscontinuity(orbit[n-1], orbit[n])))
+		const Vec3d& point = orbit.at(n%nbPoints);
+		if (prj->project(point,onscreen) && (vertexArray.size()==0 || !prj->intersectViewportDiscontinuity(orbit.at(n-1), point)))
 		{
 			vertexArray.append(onscreen[0]);
 			vertexArray.append(onscreen[1]);
@@ -3096,7 +3172,7 @@ void Planet::drawOrbit(const StelCore* core)
 			vertexArray.clear();
 		}
 	}
-	orbit[ORBIT_SEGMENTS/2]=savePos;
+	orbit[orbitSamples.centerIndex]=savePos;
 	if (!vertexArray.isEmpty())
 	{
 		sPainter.setVertexPointer(2, GL_FLOAT, vertexArray.constData());
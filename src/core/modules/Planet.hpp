@@ -28,7 +28,9 @@
 #include "StelTextureTypes.hpp"
 #include "StelProjectorType.hpp"
 
+#include <QFuture>
 #include <QString>
+#include <QVector>
 
 // The callback type for the external position computation function
 // The last variable is the userData pointer.
@@ -193,7 +195,11 @@ public:
 	virtual Vec3f getInfoColor(void) const;
 	virtual QString getType(void) const {return PLANET_TYPE;}
 	virtual QString getID(void) const { return englishName; }
+	//! The position is cached until StelCore::getFrameCounter() or the position of the planet or its parents
+	//! changes. Main thread only.
 	virtual Vec3d getJ2000EquatorialPos(const StelCore *core) const;
+	//! The position is cached like getJ2000EquatorialPos().
+	virtual Vec3d getAltAzPosAuto(const StelCore* core) const;
 	virtual QString getEnglishName(void) const;
 	virtual QString getNameI18n(void) const;
 	QString getCommonEnglishName(void) const {return englishName;}
@@ -272,11 +278,29 @@ public:
 	//! Compute the position in the parent Planet coordinate system
 	void computePositionWithoutOrbits(const double dateJDE);
 	virtual void computePosition(const double dateJDE);
+	//! Set the position in the parent Planet coordinate system when it was computed by other means
+	//! than the coordinate function, e.g. together with many other bodies by SolarSystem.
+	//! Like computePositionWithoutOrbits(), nothing changes while the position is still valid for dateJDE.
+	void setComputedPosition(const double dateJDE, const Vec3d& pos);
+	//! Get whether the position must be recomputed for dateJDE.
+	bool isPositionOutdated(const double dateJDE) const {return fabs(lastJDE-dateJDE)>deltaJDE;}
 
 	//! Compute the transformation matrix from the local Planet coordinate to the parent Planet coordinate.
 	//! This requires both flavours of JD in cases involving Earth.
 	void computeTransMatrix(double JD, double JDE);
 
+	//! Compute the position in the parent Planet coordinate system at dateJDE like computePosition(),
+	//! but without changing the Planet. Thread-safe.
+	void computeEclipticPos(const double dateJDE, double xyz[3]) const;
+	//! Compute the heliocentric ecliptical position at dateJDE from the positions of the Planet
+	//! and of its parents at that date, without changing them. Thread-safe.
+	Vec3d computeHeliocentricEclipticPos(const double dateJDE) const;
+	//! Compute the matrix set by computeTransMatrix() for JDE, without changing the Planet. Thread-safe.
+	Mat4d computeRotLocalToParent(const double JDE) const;
+	//! Compute getRotEquatorialToVsop87() for JDE from the rotations of the Planet and of its parents
+	//! at that date, without changing them. Thread-safe.
+	Mat4d computeRotEquatorialToVsop87(const double JDE) const;
+
 	//! Get the phase angle (rad) for an observer at pos obsPos in heliocentric coordinates (in AU)
 	double getPhaseAngle(const Vec3d& obsPos) const;
 	//! Get the elongation angle (rad) for an observer at pos obsPos in heliocentric coordinates (in AU)
@@ -336,12 +360,23 @@ public:
 	LinearFader orbitFader;
 	// draw orbital path of Planet
 	void drawOrbit(const StelCore*);
-	Vec3d orbit[ORBIT_SEGMENTS+1];  // store heliocentric coordinates for drawing the orbit
-	Vec3d orbitP[ORBIT_SEGMENTS+1]; // store local coordinate for orbit
-	double lastOrbitJDE;
+	//! Wait until the orbit line being sampled in the background, if any, is finished.
+	//! Must be called before deleting the Orbit used by the Planet.
+	void waitForOrbitSamples() {orbitJob.waitForFinished();}
+	//! The samples of an orbit line over one period
+	struct OrbitSamples
+	{
+		OrbitSamples() : centerIndex(0), jde(0.) {}
+		QVector<Vec3d> points;  // positions in the parent Planet coordinate system
+		int centerIndex;        // index of the position at jde
+		double jde;             // the date the orbit line was sampled for
+	};
+	OrbitSamples orbitSamples;      // the samples of the orbit line drawn
+	QFuture<OrbitSamples> orbitJob; // the job sampling the next orbit line
+	QVector<Vec3d> orbit;           // store heliocentric coordinates for drawing the orbit
 	double deltaJDE;                // time difference between positional updates.
-	double deltaOrbitJDE;
-	bool orbitCached;               // whether orbit calculations are cached for drawing orbit yet
+	double deltaOrbitJDE;           // the orbit line is sampled again when the date moved by more than this
+	bool orbitJobRunning;           // whether orbitJob was started and its result not used yet
 	bool closeOrbit;                // whether to connect the beginning of the orbit line to
 					// the end: good for elliptical orbits, bad for parabolic
 					// and hyperbolic orbits
@@ -465,6 +500,20 @@ protected:
 	void computeModelMatrix(Mat4d &result) const;
 
 	Vec3f getCurrentOrbitColor() const;
+
+	//! Swap in the orbit line sampled in the background once it is finished, and start sampling
+	//! a new one when the date moved too far from the one drawn.
+	//! @return true if the orbit line was swapped
+	bool updateOrbitSamples(const double dateJDE);
+	//! Sample the orbit line over one period centered on dateJDE, more densely where it curves.
+	//! Runs in a worker thread: it must not change the Planet.
+	OrbitSamples computeOrbitSamples(const double dateJDE) const;
+	//! Add the samples needed between two positions of the orbit line to points, in order.
+	void refineOrbitSegment(const double jde0, const double jdeA, const Vec3d& posA, const double jdeB, const Vec3d& posB, const int depth, QVector<Vec3d>& points) const;
+	//! Compute a position of the orbit line in the parent Planet coordinate system.
+	//! Runs in a worker thread: it must be thread-safe and must not change the Planet.
+	//! @param jde0 the date of the osculating orbit, if any
+	void computeOrbitPoint(const double jde0, const double jde, double xyz[3]) const;
 	
 	// Return the information string "ready to print" :)
 	QString getSkyLabel(const StelCore* core) const;
@@ -530,6 +579,7 @@ protected:
 	// it is used for sorting while drawing
 	float sphereScale;               // Artificial scaling for better viewing.
 	double lastJDE;                  // caches JDE of last positional computation
+	quint64 positionGeneration;      // incremented each time eclipticPos changes
 	// The callback for the calculation of the equatorial rect heliocentric position at time JDE.
 	posFuncType coordFunc;
 	void* orbitPtr;               // this is always used with an Orbit object.
@@ -564,6 +614,25 @@ protected:
 private:
 	QString iauMoonNumber;
 
+	// The coordinates asked for by several modules each frame, cached for the current frame.
+	// The cache is written by const getters without locking: it must only be used from the main thread.
+	// Worker threads compute positions with StelEphemerisSession instead.
+	struct FramePositions
+	{
+		quint64 frame;          // StelCore::getFrameCounter() at which they were computed
+		const StelCore* core;
+		quint64 generation;     // getPositionGenerations() at which they were computed
+		Vec3d j2000EquatorialPos;
+		bool altAzPosAutoValid;
+		Vec3d altAzPosAuto;
+	};
+	mutable FramePositions framePositions;
+	//! Get the cached coordinates, cleared if they are out of date.
+	FramePositions& getFramePositions(const StelCore* core) const;
+	//! Get the sum of the position generations of the planet and its parents,
+	//! which grows whenever one of them moves.
+	quint64 getPositionGenerations() const;
+
 	const QString getContextString() const;
 
 	// Shader-related variables
@@ -20,6 +20,7 @@
  */
 
 #include "SolarSystem.hpp"
+#include "SolarSystemElementStore.hpp"
 #include "StelTexture.hpp"
 #include "EphemWrapper.hpp"
 #include "Orbit.hpp"
@@ -33,7 +34,6 @@
 #include "StelSkyCultureMgr.hpp"
 #include "StelFileMgr.hpp"
 #include "StelModuleMgr.hpp"
-#include "StelIniParser.hpp"
 #include "Planet.hpp"
 #include "MinorPlanet.hpp"
 #include "Comet.hpp"
@@ -44,6 +44,7 @@
 #include "StelPainter.hpp"
 #include "TrailGroup.hpp"
 #include "RefractionExtinction.hpp"
+#include "StelStartupProfiler.hpp"
 
 #include "AstroCalcDialog.hpp"
 
@@ -58,9 +59,13 @@
 #include <QMap>
 #include <QMultiMap>
 #include <QMapIterator>
+#include <QSet>
 #include <QDebug>
 #include <QDir>
 #include <QHash>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
 
 SolarSystem::SolarSystem()
 	: shadowPlanetCount(0)
@@ -70,6 +75,11 @@ SolarSystem::SolarSystem()
 	, minorBodyScale(1.0)
 	, labelsAmount(false)
 	, flagOrbits(false)
+	, positionGroupsDirty(true)
+	, lazyPositionsJDE(0.)
+	, lazyPositionsValid(false)
+	, lazyBrightestMagnitude(99.f)
+	, lazyMinorBodiesThreshold(20000)
 	, flagLightTravelTime(true)
 	, flagUseObjModels(false)
 	, flagShowObjSelfShadows(true)
@@ -101,6 +111,11 @@ SolarSystem::~SolarSystem()
 {
 	// release selected:
 	selected.clear();
+	// The orbit lines may still be sampled in the background from the orbits, and
+	// the users of the bodies in other threads (e.g. AstroCalc searches) must stop.
+	foreach (const PlanetP& p, systemPlanets)
+		p->waitForOrbitSamples();
+	emit solarSystemDataAboutToReload();
 	foreach (Orbit* orb, orbits)
 	{
 		delete orb;
@@ -394,20 +409,21 @@ void SolarSystem::drawPointer(const StelCore* core)
 	}
 }
 
-void ellipticalOrbitPosFunc(double jd,double xyz[3], void* userDataPtr)
-{
-	static_cast<EllipticalOrbit*>(userDataPtr)->positionAtTimevInVSOP87Coordinates(jd, xyz);
-}
-void cometOrbitPosFunc(double jd,double xyz[3], void* userDataPtr)
-{
-	static_cast<CometOrbit*>(userDataPtr)->positionAtTimevInVSOP87Coordinates(jd, xyz);
-}
-
 // Init and load the solar system data (2 files)
 void SolarSystem::loadPlanets()
 {
+	StelStartupProfiler::Scope profile("catalog", "ssystem");
 	minorBodies.clear();
 	systemMinorBodies.clear();
+	// Their orbits are deleted with the others by reloadPlanets()
+	lazyStores.clear();
+	lazyBodies.clear();
+	lazyBodyIndex.clear();
+	lazyOrbits.clear();
+	lazyGroupIndices.clear();
+	lazyDrawOrder.clear();
+	lazyPositionsValid = false;
+	lazyMinorBodiesThreshold = conf->value("astro/lazy_minor_bodies_threshold", 20000).toInt();
 	qDebug() << "Loading Solar System data (1: planets and moons) ...";
 	QString solarSystemFile = StelFileMgr::findFile("data/ssystem_major.ini");
 	if (solarSystemFile.isEmpty())
@@ -455,6 +471,7 @@ void SolarSystem::loadPlanets()
 				}
 			}			
 			systemPlanets.clear();			
+			positionGroupsDirty = true;
 			//Memory leak? What's the proper way of cleaning shared pointers?
 
 			// TODO: 0.16pre what about the orbits list?
@@ -493,17 +510,48 @@ unsigned char SolarSystem::BvToColorIndex(float bV)
 	return (unsigned int)floor(0.5+127.0*((500.0+dBV)/4000.0));
 }
 
+namespace
+{
+	// Whether the bodies of a type are created as MinorPlanets (see SolarSystem::createPlanet())
+	bool isMinorPlanetType(const QString& type, const QString& englishName)
+	{
+		return (type == "asteroid" || type == "dwarf planet" || type == "cubewano" || type == "plutino" || type == "scattered disc object" || type == "Oort cloud object") && !englishName.contains("Pluto");
+	}
+
+	// Whether the Planet of a section may be created only when needed: minor planets with H-G magnitudes
+	// on Keplerian orbits around the Sun, without satellites, whose positions can be computed in bulk.
+	bool isLazyMinorBodySection(const SolarSystemElementStore& pd, int section, const QSet<QString>& parentNames)
+	{
+		const QString englishName = pd.getString(section, "name").simplified();
+		return isMinorPlanetType(pd.getString(section, "type"), englishName)
+			&& pd.getString(section, "coord_func") == "comet_orbit"
+			&& pd.getString(section, "parent", "Sun") == "Sun"
+			&& !parentNames.contains(englishName)
+			&& pd.getDouble(section, "absolute_magnitude", -99) > -99
+			&& !pd.getBool(section, "hidden", false);
+	}
+}
+
+Vec3f SolarSystem::getMinorPlanetColor(const SolarSystemElementStore& pd, int section)
+{
+	const float bV = pd.getFloat(section, "color_index_bv", 99.f);
+	if (bV<99.f)
+		return StelSkyDrawer::indexToColor(BvToColorIndex(bV))*0.75f;
+	return StelUtils::strToVec3f(pd.getString(section, "color", "1.0,1.0,1.0"));
+}
+
 bool SolarSystem::loadPlanets(const QString& filePath)
 {
-	StelSkyDrawer* skyDrawer = StelApp::getInstance().getCore()->getSkyDrawer();
 	qDebug() << "Loading from :"  << filePath;
 	int readOk = 0;
-	QSettings pd(filePath, StelIniFormat);
-	if (pd.status() != QSettings::NoError)
+	// Kept alive by the minor bodies whose Planet is created later (see addLazyMinorBody())
+	QSharedPointer<SolarSystemElementStore> store(new SolarSystemElementStore());
+	if (!store->load(filePath))
 	{
 		qWarning() << "ERROR while parsing" << QDir::toNativeSeparators(filePath);
 		return false;
 	}
+	const SolarSystemElementStore& pd = *store;
 
 	// QSettings does not allow us to say that the sections of the file
 	// will be listed in the same order  as in the file like the old
@@ -536,18 +584,18 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 	//
 	// Stage 3: iterate over the ordered sections decided in stage 2,
 	// creating the planet objects from the QSettings data.
+	//
+	// The sections are read from a SolarSystemElementStore, which keeps them in the order
+	// of QSettings and indexes them by body name: the map of body names back to the
+	// section names is not needed.
 
 	// Stage 1 (as described above).
-	QMap<QString, QString> secNameMap;
 	QMap<QString, QString> parentMap;
-	QStringList sections = pd.childGroups();
-	// qDebug() << "Stage 1: load ini file with" << sections.size() << "entries: "<< sections;
-	for (int i=0; i<sections.size(); ++i)
-	{
-		const QString secname = sections.at(i);
-		const QString englishName = pd.value(secname+"/name").toString();
-		const QString strParent = pd.value(secname+"/parent", "Sun").toString();
-		secNameMap[englishName] = secname;
+	// qDebug() << "Stage 1: load ini file with" << pd.size() << "entries";
+	for (int section=0; section<pd.size(); ++section)
+	{
+		const QString englishName = pd.getString(section, "name");
+		const QString strParent = pd.getString(section, "parent", "Sun");
 		if (strParent!="none" && !strParent.isEmpty() && !englishName.isEmpty())
 		{
 			parentMap[englishName] = strParent;
@@ -555,11 +603,28 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 		}
 	}
 
+	// Minor planets orbiting the Sun alone are created lazily when the file has many of them
+	// (see addLazyMinorBody()): creating hundreds of thousands of Planets takes long and most
+	// of them are too faint to ever be drawn as more than a point.
+	QVector<bool> lazySections(pd.size(), false);
+	const QSet<QString> parentNames = QSet<QString>::fromList(parentMap.values());
+	int lazyCount = 0;
+	for (int section=0; section<pd.size(); ++section)
+	{
+		if (isLazyMinorBodySection(pd, section, parentNames))
+		{
+			lazySections[section] = true;
+			lazyCount++;
+		}
+	}
+	if (lazyCount < lazyMinorBodiesThreshold)
+		lazySections.fill(false);
+
 	// Stage 2a (as described above).
-	QMultiMap<int, QString> depLevelMap;
-	for (int i=0; i<sections.size(); ++i)
+	QMultiMap<int, int> depLevelMap;
+	for (int section=0; section<pd.size(); ++section)
 	{
-		const QString englishName = pd.value(sections.at(i)+"/name").toString();
+		const QString englishName = pd.getString(section, "name");
 
 		// follow dependencies, incrementing level when we have one
 		// till we run out.
@@ -571,14 +636,14 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 			p = parentMap[p];
 		}
 
-		depLevelMap.insert(level, secNameMap[englishName]);
-		// qDebug() << "2a: Level" << level << "secNameMap[" << englishName << "]="<< secNameMap[englishName];
+		depLevelMap.insert(level, pd.indexOf(englishName));
+		// qDebug() << "2a: Level" << level << "section of" << englishName << "=" << pd.indexOf(englishName);
 	}
 
 	// Stage 2b (as described above).
 	// qDebug() << "Stage 2b:";
-	QStringList orderedSections;
-	QMapIterator<int, QString> levelMapIt(depLevelMap);
+	QList<int> orderedSections;
+	QMapIterator<int, int> levelMapIt(depLevelMap);
 	while(levelMapIt.hasNext())
 	{
 		levelMapIt.next();
@@ -590,27 +655,29 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 	//int readOk=0;
 	//int totalPlanets=0;
 
+	// The first of the planets with each name, to find the parents
+	QHash<QString, PlanetP> planetsByName;
+	foreach (const PlanetP& p, systemPlanets)
+	{
+		if (!planetsByName.contains(p->getEnglishName()))
+			planetsByName.insert(p->getEnglishName(), p);
+	}
+
 	// qDebug() << "Adding " << orderedSections.size() << "objects...";
 	for (int i = 0;i<orderedSections.size();++i)
 	{
 		// qDebug() << "Processing entry" << orderedSections.at(i);
 
 		//totalPlanets++;
-		const QString secname = orderedSections.at(i);
-		const QString englishName = pd.value(secname+"/name").toString().simplified();
-		const QString strParent = pd.value(secname+"/parent", "Sun").toString(); // Obvious default, keep file entries simple.
+		const int section = orderedSections.at(i);
+		const QString secname = pd.getSectionName(section);
+		const QString englishName = pd.getString(section, "name").simplified();
+		const QString strParent = pd.getString(section, "parent", "Sun"); // Obvious default, keep file entries simple.
 		PlanetP parent;
 		if (strParent!="none")
 		{
 			// Look in the other planets the one named with strParent
-			foreach (const PlanetP& p, systemPlanets)
-			{
-				if (p->getEnglishName()==strParent)
-				{
-					parent = p;
-					break;
-				}
-			}
+			parent = planetsByName.value(strParent);
 			if (parent.isNull())
 			{
 				qWarning() << "ERROR : can't find parent solar system body for " << englishName;
@@ -619,24 +686,24 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 			}
 		}
 
-		const QString funcName = pd.value(secname+"/coord_func").toString();
+		const QString funcName = pd.getString(section, "coord_func");
 		// qDebug() << "englishName:" << englishName << ", parent:" << strParent <<  ", coord_func:" << funcName;
 		posFuncType posfunc=Q_NULLPTR;
 		void* orbitPtr=Q_NULLPTR;
 		OsculatingFunctType *osculatingFunc = Q_NULLPTR;
-		bool closeOrbit = pd.value(secname+"/closeOrbit", true).toBool();
+		bool closeOrbit = pd.getBool(section, "closeOrbit", true);
 
 		if (funcName=="ell_orbit")
 		{
 			// GZ TODO: It seems ell_orbit is only used for planet moons. Just assert eccentricity<1 and remove a few extra calculations?
 			// Read the orbital elements
-			const double epoch = pd.value(secname+"/orbit_Epoch",J2000).toDouble();
-			const double eccentricity = pd.value(secname+"/orbit_Eccentricity").toDouble();
+			const double epoch = pd.getDouble(section, "orbit_Epoch", J2000);
+			const double eccentricity = pd.getDouble(section, "orbit_Eccentricity");
 			if (eccentricity >= 1.0) closeOrbit = false;
-			double pericenterDistance = pd.value(secname+"/orbit_PericenterDistance",-1e100).toDouble();
+			double pericenterDistance = pd.getDouble(section, "orbit_PericenterDistance", -1e100);
 			double semi_major_axis;
 			if (pericenterDistance <= 0.0) {
-				semi_major_axis = pd.value(secname+"/orbit_SemiMajorAxis",-1e100).toDouble();
+				semi_major_axis = pd.getDouble(section, "orbit_SemiMajorAxis", -1e100);
 				if (semi_major_axis <= -1e100) {
 					qDebug() << "ERROR: " << englishName
 						 << ": you must provide orbit_PericenterDistance or orbit_SemiMajorAxis";
@@ -653,10 +720,10 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 								? 0.0 // parabolic orbits have no semi_major_axis
 								: pericenterDistance / (1.0-eccentricity);
 			}
-			double meanMotion = pd.value(secname+"/orbit_MeanMotion",-1e100).toDouble();
+			double meanMotion = pd.getDouble(section, "orbit_MeanMotion", -1e100);
 			double period;
 			if (meanMotion <= -1e100) {
-				period = pd.value(secname+"/orbit_Period",-1e100).toDouble();
+				period = pd.getDouble(section, "orbit_Period", -1e100);
 				if (period <= -1e100) {
 					meanMotion = (eccentricity == 1.0)
 								? 0.01720209895 * (1.5/pericenterDistance) * std::sqrt(0.5/pericenterDistance)
@@ -670,21 +737,21 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 			} else {
 				period = 2.0*M_PI/meanMotion;
 			}
-			const double inclination = pd.value(secname+"/orbit_Inclination").toDouble()*(M_PI/180.0);
-			const double ascending_node = pd.value(secname+"/orbit_AscendingNode").toDouble()*(M_PI/180.0);
-			double arg_of_pericenter = pd.value(secname+"/orbit_ArgOfPericenter",-1e100).toDouble();
+			const double inclination = pd.getDouble(section, "orbit_Inclination")*(M_PI/180.0);
+			const double ascending_node = pd.getDouble(section, "orbit_AscendingNode")*(M_PI/180.0);
+			double arg_of_pericenter = pd.getDouble(section, "orbit_ArgOfPericenter", -1e100);
 			double long_of_pericenter;
 			if (arg_of_pericenter <= -1e100) {
-				long_of_pericenter = pd.value(secname+"/orbit_LongOfPericenter").toDouble()*(M_PI/180.0);
+				long_of_pericenter = pd.getDouble(section, "orbit_LongOfPericenter")*(M_PI/180.0);
 				arg_of_pericenter = long_of_pericenter - ascending_node;
 			} else {
 				arg_of_pericenter *= (M_PI/180.0);
 				long_of_pericenter = arg_of_pericenter + ascending_node;
 			}
-			double mean_anomaly = pd.value(secname+"/orbit_MeanAnomaly",-1e100).toDouble();
+			double mean_anomaly = pd.getDouble(section, "orbit_MeanAnomaly", -1e100);
 			double mean_longitude;
 			if (mean_anomaly <= -1e100) {
-				mean_longitude = pd.value(secname+"/orbit_MeanLongitude").toDouble()*(M_PI/180.0);
+				mean_longitude = pd.getDouble(section, "orbit_MeanLongitude")*(M_PI/180.0);
 				mean_anomaly = mean_longitude - long_of_pericenter;
 			} else {
 				mean_anomaly *= (M_PI/180.0);
@@ -738,12 +805,12 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 			// orbit_Period: given in days
 			// orbit_TimeAtPericenter,orbit_Epoch: JD
 			// orbit_MeanAnomaly,orbit_Inclination,orbit_ArgOfPericenter,orbit_AscendingNode: given in degrees
-			const double eccentricity = pd.value(secname+"/orbit_Eccentricity",0.0).toDouble();
+			const double eccentricity = pd.getDouble(section, "orbit_Eccentricity", 0.0);
 			if (eccentricity >= 1.0) closeOrbit = false;
-			double pericenterDistance = pd.value(secname+"/orbit_PericenterDistance",-1e100).toDouble();
+			double pericenterDistance = pd.getDouble(section, "orbit_PericenterDistance", -1e100);
 			double semi_major_axis;
 			if (pericenterDistance <= 0.0) {
-				semi_major_axis = pd.value(secname+"/orbit_SemiMajorAxis",-1e100).toDouble();
+				semi_major_axis = pd.getDouble(section, "orbit_SemiMajorAxis", -1e100);
 				if (semi_major_axis <= -1e100) {
 					qWarning() << "ERROR: " << englishName
 						   << ": you must provide orbit_PericenterDistance or orbit_SemiMajorAxis";
@@ -758,9 +825,9 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 								? 0.0 // parabolic orbits have no semi_major_axis
 								: pericenterDistance / (1.0-eccentricity);
 			}
-			double meanMotion = pd.value(secname+"/orbit_MeanMotion",-1e100).toDouble();
+			double meanMotion = pd.getDouble(section, "orbit_MeanMotion", -1e100);
 			if (meanMotion <= -1e100) {
-				const double period = pd.value(secname+"/orbit_Period",-1e100).toDouble();
+				const double period = pd.getDouble(section, "orbit_Period", -1e100);
 				if (period <= -1e100) {
 					if (parent->getParent()) {
 						qWarning() << "ERROR: " << englishName
@@ -784,10 +851,10 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 			} else {
 				meanMotion *= (M_PI/180.0);
 			}
-			double time_at_pericenter = pd.value(secname+"/orbit_TimeAtPericenter",-1e100).toDouble();
+			double time_at_pericenter = pd.getDouble(section, "orbit_TimeAtPericenter", -1e100);
 			if (time_at_pericenter <= -1e100) {
-				const double epoch = pd.value(secname+"/orbit_Epoch",-1e100).toDouble();
-				double mean_anomaly = pd.value(secname+"/orbit_MeanAnomaly",-1e100).toDouble();
+				const double epoch = pd.getDouble(section, "orbit_Epoch", -1e100);
+				double mean_anomaly = pd.getDouble(section, "orbit_MeanAnomaly", -1e100);
 				if (epoch <= -1e100 || mean_anomaly <= -1e100) {
 					qWarning() << "ERROR: " << englishName
 						   << ": when you do not provide orbit_TimeAtPericenter, you must provide both "
@@ -799,10 +866,10 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 					time_at_pericenter = epoch - mean_anomaly / meanMotion;
 				}
 			}
-			const double orbitGoodDays=pd.value(secname+"/orbit_good", 1000).toDouble();
-			const double inclination = pd.value(secname+"/orbit_Inclination").toDouble()*(M_PI/180.0);
-			const double arg_of_pericenter = pd.value(secname+"/orbit_ArgOfPericenter").toDouble()*(M_PI/180.0);
-			const double ascending_node = pd.value(secname+"/orbit_AscendingNode").toDouble()*(M_PI/180.0);
+			const double orbitGoodDays=pd.getDouble(section, "orbit_good", 1000);
+			const double inclination = pd.getDouble(section, "orbit_Inclination")*(M_PI/180.0);
+			const double arg_of_pericenter = pd.getDouble(section, "orbit_ArgOfPericenter")*(M_PI/180.0);
+			const double ascending_node = pd.getDouble(section, "orbit_AscendingNode")*(M_PI/180.0);
 			const double parentRotObliquity = parent->getParent() ? parent->getRotObliquity(2451545.0) : 0.0;
 			const double parent_rot_asc_node = parent->getParent() ? parent->getRotAscendingNode() : 0.0;
 			double parent_rot_j2000_longitude = 0.0;
@@ -949,255 +1016,632 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 			exit(-1);
 		}
 
-		// Create the Solar System body and add it to the list
-		QString type = pd.value(secname+"/type").toString();
-
-		//TODO: Refactor the subclass selection to reduce duplicate code mess here,
-		// by at least using this base class pointer and using setXXX functions instead of mega-constructors
-		// that have to pass most of it on to the Planet class
-		PlanetP p;
+		const QString type = pd.getString(section, "type");
+		if (type == "comet" || isMinorPlanetType(type, englishName))
+			minorBodies << englishName;
 
-		// New class objects, named "plutino", "cubewano", "dwarf planet", "SDO", "OCO", has properties
-		// similar to asteroids and we should calculate their positions like for asteroids. Dwarf planets
-		// have one exception: Pluto - we should use special function for calculation of orbit of Pluto.
-		if ((type == "asteroid" || type == "dwarf planet" || type == "cubewano" || type == "plutino" || type == "scattered disc object" || type == "Oort cloud object") && !englishName.contains("Pluto"))
+		if (lazySections.at(section))
 		{
-			minorBodies << englishName;
+			addLazyMinorBody(store, section, englishName, static_cast<CometOrbit*>(orbitPtr), closeOrbit);
+			readOk++;
+			continue;
+		}
 
-			Vec3f color = Vec3f(1.f, 1.f, 1.f);
-			float bV = pd.value(secname+"/color_index_bv", 99.f).toFloat();
-			if (bV<99.f)
-				color = skyDrawer->indexToColor(BvToColorIndex(bV))*0.75f;
-			else
-				color = StelUtils::strToVec3f(pd.value(secname+"/color", "1.0,1.0,1.0").toString());
-
-			p = PlanetP(new MinorPlanet(englishName,
-						    pd.value(secname+"/radius").toDouble()/AU,
-						    pd.value(secname+"/oblateness", 0.0).toDouble(),
-						    color, // halo color
-						    pd.value(secname+"/albedo", 0.25f).toFloat(),
-						    pd.value(secname+"/roughness",0.9f).toFloat(),
-						    pd.value(secname+"/tex_map", "nomap.png").toString(),
-						    pd.value(secname+"/model").toString(),
-						    posfunc,
-						    orbitPtr,
-						    osculatingFunc,
-						    closeOrbit,
-						    pd.value(secname+"/hidden", false).toBool(),
-						    type));
-
-			QSharedPointer<MinorPlanet> mp =  p.dynamicCast<MinorPlanet>();
-
-			//Number
-			int minorPlanetNumber = pd.value(secname+"/minor_planet_number", 0).toInt();
-			if (minorPlanetNumber)
-			{
-				mp->setMinorPlanetNumber(minorPlanetNumber);
-			}
+		const PlanetP p = createPlanet(pd, section, englishName, parent, posfunc, orbitPtr, osculatingFunc, closeOrbit);
+		if (!planetsByName.contains(p->getEnglishName()))
+			planetsByName.insert(p->getEnglishName(), p);
+		readOk++;
+	}
 
-			//Provisional designation
-			QString provisionalDesignation = pd.value(secname+"/provisional_designation").toString();
-			if (!provisionalDesignation.isEmpty())
-			{
-				mp->setProvisionalDesignation(provisionalDesignation);
-			}
+	if (systemPlanets.isEmpty())
+	{
+		qWarning() << "No Solar System objects loaded from" << QDir::toNativeSeparators(filePath);
+		return false;
+	}
 
-			//H-G magnitude system
-			double magnitude = pd.value(secname+"/absolute_magnitude", -99).toDouble();
-			double slope = pd.value(secname+"/slope_parameter", 0.15).toDouble();
-			if (magnitude > -99)
-			{
-				if (slope >= 0 && slope <= 1)
-				{
-					mp->setAbsoluteMagnitudeAndSlope(magnitude, slope);
-				}
-				else
-				{
-					mp->setAbsoluteMagnitudeAndSlope(magnitude, 0.15);
-				}
-			}
+	// special case: load earth shadow texture
+	if (!Planet::texEarthShadow)
+		Planet::texEarthShadow = StelApp::getInstance().getTextureManager().createTexture(StelFileMgr::getInstallationDir()+"/textures/earth-shadow.png");
 
-			mp->setSemiMajorAxis(pd.value(secname+"/orbit_SemiMajorAxis", 0).toDouble());
-			mp->setColorIndexBV(bV);
-			mp->setSpectralType(pd.value(secname+"/spec_t", "").toString(), pd.value(secname+"/spec_b", "").toString());
+	// Also comets just have static textures.
+	if (!Comet::comaTexture)
+		Comet::comaTexture = StelApp::getInstance().getTextureManager().createTextureThread(StelFileMgr::getInstallationDir()+"/textures/cometComa.png", StelTexture::StelTextureParams(true, GL_LINEAR, GL_CLAMP_TO_EDGE));
+	//tail textures. We use paraboloid tail bodies, textured like a fisheye sphere, i.e. center=head. The texture should be something like a mottled star to give some structure.
+	if (!Comet::tailTexture)
+		Comet::tailTexture = StelApp::getInstance().getTextureManager().createTextureThread(StelFileMgr::getInstallationDir()+"/textures/cometTail.png", StelTexture::StelTextureParams(true, GL_LINEAR, GL_CLAMP_TO_EDGE));
 
-			systemMinorBodies.push_back(p);
+	if (readOk>0)
+		qDebug() << "Loaded" << readOk << "Solar System bodies";
+
+	return true;
+}
+
+// Create a Solar System body from its section of a solar system file and add it to systemPlanets
+PlanetP SolarSystem::createPlanet(const SolarSystemElementStore& pd, int section, const QString& englishName, const PlanetP& parent,
+				  posFuncType posfunc, void* orbitPtr, OsculatingFunctType* osculatingFunc, bool closeOrbit)
+{
+	const QString secname = pd.getSectionName(section);
+
+	// Create the Solar System body and add it to the list
+	const QString type = pd.getString(section, "type");
+
+	//TODO: Refactor the subclass selection to reduce duplicate code mess here,
+	// by at least using this base class pointer and using setXXX functions instead of mega-constructors
+	// that have to pass most of it on to the Planet class
+	PlanetP p;
+
+	// New class objects, named "plutino", "cubewano", "dwarf planet", "SDO", "OCO", has properties
+	// similar to asteroids and we should calculate their positions like for asteroids. Dwarf planets
+	// have one exception: Pluto - we should use special function for calculation of orbit of Pluto.
+	if (isMinorPlanetType(type, englishName))
+	{
+		p = PlanetP(new MinorPlanet(englishName,
+					    pd.getDouble(section, "radius")/AU,
+					    pd.getDouble(section, "oblateness", 0.0),
+					    getMinorPlanetColor(pd, section), // halo color
+					    pd.getFloat(section, "albedo", 0.25f),
+					    pd.getFloat(section, "roughness", 0.9f),
+					    pd.getString(section, "tex_map", "nomap.png"),
+					    pd.getString(section, "model"),
+					    posfunc,
+					    orbitPtr,
+					    osculatingFunc,
+					    closeOrbit,
+					    pd.getBool(section, "hidden", false),
+					    type));
+
+		QSharedPointer<MinorPlanet> mp =  p.dynamicCast<MinorPlanet>();
+
+		//Number
+		int minorPlanetNumber = pd.getInt(section, "minor_planet_number", 0);
+		if (minorPlanetNumber)
+		{
+			mp->setMinorPlanetNumber(minorPlanetNumber);
 		}
-		else if (type == "comet")
+
+		//Provisional designation
+		QString provisionalDesignation = pd.getString(section, "provisional_designation");
+		if (!provisionalDesignation.isEmpty())
 		{
-			minorBodies << englishName;
-			p = PlanetP(new Comet(englishName,
-					      pd.value(secname+"/radius").toDouble()/AU,
-					      pd.value(secname+"/oblateness", 0.0).toDouble(),
-					      StelUtils::strToVec3f(pd.value(secname+"/color", "1.0,1.0,1.0").toString()), // halo color
-					      pd.value(secname+"/albedo", 0.25f).toFloat(),
-					      pd.value(secname+"/roughness",0.9f).toFloat(),
-					      pd.value(secname+"/outgas_intensity",0.1f).toFloat(),
-					      pd.value(secname+"/outgas_falloff", 0.1f).toFloat(),
-					      pd.value(secname+"/tex_map", "nomap.png").toString(),
-					      pd.value(secname+"/model").toString(),
-					      posfunc,
-					      orbitPtr,
-					      osculatingFunc,
-					      closeOrbit,
-					      pd.value(secname+"/hidden", false).toBool(),
-					      type,
-					      pd.value(secname+"/dust_widthfactor", 1.5f).toFloat(),
-					      pd.value(secname+"/dust_lengthfactor", 0.4f).toFloat(),
-					      pd.value(secname+"/dust_brightnessfactor", 1.5f).toFloat()
-					      ));
-
-			QSharedPointer<Comet> mp =  p.dynamicCast<Comet>();
-
-			//g,k magnitude system
-			double magnitude = pd.value(secname+"/absolute_magnitude", -99).toDouble();
-			double slope = pd.value(secname+"/slope_parameter", 4.0).toDouble();
-			if (magnitude > -99)
+			mp->setProvisionalDesignation(provisionalDesignation);
+		}
+
+		//H-G magnitude system
+		double magnitude = pd.getDouble(section, "absolute_magnitude", -99);
+		double slope = pd.getDouble(section, "slope_parameter", 0.15);
+		if (magnitude > -99)
+		{
+			if (slope >= 0 && slope <= 1)
 			{
-				if (slope >= 0 && slope <= 20)
-				{
-					mp->setAbsoluteMagnitudeAndSlope(magnitude, slope);
-				}
-				else
-				{
-					mp->setAbsoluteMagnitudeAndSlope(magnitude, 4.0);
-				}
+				mp->setAbsoluteMagnitudeAndSlope(magnitude, slope);
 			}
-
-			const double eccentricity = pd.value(secname+"/orbit_Eccentricity",0.0).toDouble();
-			const double pericenterDistance = pd.value(secname+"/orbit_PericenterDistance",-1e100).toDouble();
-			if (eccentricity<1 && pericenterDistance>0)
+			else
 			{
-				mp->setSemiMajorAxis(pericenterDistance / (1.0-eccentricity));
+				mp->setAbsoluteMagnitudeAndSlope(magnitude, 0.15);
 			}
-			systemMinorBodies.push_back(p);
 		}
-		else
+
+		mp->setSemiMajorAxis(pd.getDouble(section, "orbit_SemiMajorAxis", 0));
+		mp->setColorIndexBV(pd.getFloat(section, "color_index_bv", 99.f));
+		mp->setSpectralType(pd.getString(section, "spec_t", ""), pd.getString(section, "spec_b", ""));
+
+		systemMinorBodies.push_back(p);
+	}
+	else if (type == "comet")
+	{
+		p = PlanetP(new Comet(englishName,
+				      pd.getDouble(section, "radius")/AU,
+				      pd.getDouble(section, "oblateness", 0.0),
+				      StelUtils::strToVec3f(pd.getString(section, "color", "1.0,1.0,1.0")), // halo color
+				      pd.getFloat(section, "albedo", 0.25f),
+				      pd.getFloat(section, "roughness", 0.9f),
+				      pd.getFloat(section, "outgas_intensity", 0.1f),
+				      pd.getFloat(section, "outgas_falloff", 0.1f),
+				      pd.getString(section, "tex_map", "nomap.png"),
+				      pd.getString(section, "model"),
+				      posfunc,
+				      orbitPtr,
+				      osculatingFunc,
+				      closeOrbit,
+				      pd.getBool(section, "hidden", false),
+				      type,
+				      pd.getFloat(section, "dust_widthfactor", 1.5f),
+				      pd.getFloat(section, "dust_lengthfactor", 0.4f),
+				      pd.getFloat(section, "dust_brightnessfactor", 1.5f)
+				      ));
+
+		QSharedPointer<Comet> mp =  p.dynamicCast<Comet>();
+
+		//g,k magnitude system
+		double magnitude = pd.getDouble(section, "absolute_magnitude", -99);
+		double slope = pd.getDouble(section, "slope_parameter", 4.0);
+		if (magnitude > -99)
 		{
-			// Set possible default name of the normal map for avoiding yin-yang shaped moon
-			// phase when normal map key not exists. Example: moon_normals.png
-			// Details: https://bugs.launchpad.net/stellarium/+bug/1335609
-			QString normalMapName = "";
-			if (!pd.value(secname+"/hidden", false).toBool()) // no normal maps for invisible objects!
-				normalMapName = englishName.toLower().append("_normals.png");
-			p = PlanetP(new Planet(englishName,
-					       pd.value(secname+"/radius").toDouble()/AU,
-					       pd.value(secname+"/oblateness", 0.0).toDouble(),
-					       StelUtils::strToVec3f(pd.value(secname+"/color", "1.0,1.0,1.0").toString()), // halo color
-					       pd.value(secname+"/albedo", 0.25f).toFloat(),
-					       pd.value(secname+"/roughness",0.9f).toFloat(),
-					       pd.value(secname+"/tex_map", "nomap.png").toString(),
-					       pd.value(secname+"/normals_map", normalMapName).toString(),
-					       pd.value(secname+"/model").toString(),
-					       posfunc,
-					       orbitPtr,
-					       osculatingFunc,
-					       closeOrbit,
-					       pd.value(secname+"/hidden", false).toBool(),
-					       pd.value(secname+"/atmosphere", false).toBool(),
-					       pd.value(secname+"/halo", true).toBool(),          // GZ new default. Avoids clutter in ssystem.ini.
-					       type));
-			p->absoluteMagnitude = pd.value(secname+"/absolute_magnitude", -99.).toDouble();
-
-			// Moon designation (planet index + IAU moon number)
-			QString moonDesignation = pd.value(secname+"/iau_moon_number", "").toString();
-			if (!moonDesignation.isEmpty())
+			if (slope >= 0 && slope <= 20)
 			{
-				p->setIAUMoonNumber(moonDesignation);
+				mp->setAbsoluteMagnitudeAndSlope(magnitude, slope);
+			}
+			else
+			{
+				mp->setAbsoluteMagnitudeAndSlope(magnitude, 4.0);
 			}
 		}
 
-
-		if (!parent.isNull())
+		const double eccentricity = pd.getDouble(section, "orbit_Eccentricity", 0.0);
+		const double pericenterDistance = pd.getDouble(section, "orbit_PericenterDistance", -1e100);
+		if (eccentricity<1 && pericenterDistance>0)
 		{
-			parent->satellites.append(p);
-			p->parent = parent;
+			mp->setSemiMajorAxis(pericenterDistance / (1.0-eccentricity));
 		}
-		if (secname=="earth") earth = p;
-		if (secname=="sun") sun = p;
-		if (secname=="moon") moon = p;
+		systemMinorBodies.push_back(p);
+	}
+	else
+	{
+		// Set possible default name of the normal map for avoiding yin-yang shaped moon
+		// phase when normal map key not exists. Example: moon_normals.png
+		// Details: https://bugs.launchpad.net/stellarium/+bug/1335609
+		QString normalMapName = "";
+		if (!pd.getBool(section, "hidden", false)) // no normal maps for invisible objects!
+			normalMapName = englishName.toLower().append("_normals.png");
+		p = PlanetP(new Planet(englishName,
+				       pd.getDouble(section, "radius")/AU,
+				       pd.getDouble(section, "oblateness", 0.0),
+				       StelUtils::strToVec3f(pd.getString(section, "color", "1.0,1.0,1.0")), // halo color
+				       pd.getFloat(section, "albedo", 0.25f),
+				       pd.getFloat(section, "roughness", 0.9f),
+				       pd.getString(section, "tex_map", "nomap.png"),
+				       pd.getString(section, "normals_map", normalMapName),
+				       pd.getString(section, "model"),
+				       posfunc,
+				       orbitPtr,
+				       osculatingFunc,
+				       closeOrbit,
+				       pd.getBool(section, "hidden", false),
+				       pd.getBool(section, "atmosphere", false),
+				       pd.getBool(section, "halo", true),          // GZ new default. Avoids clutter in ssystem.ini.
+				       type));
+		p->absoluteMagnitude = pd.getDouble(section, "absolute_magnitude", -99.);
+
+		// Moon designation (planet index + IAU moon number)
+		QString moonDesignation = pd.getString(section, "iau_moon_number", "");
+		if (!moonDesignation.isEmpty())
+		{
+			p->setIAUMoonNumber(moonDesignation);
+		}
+	}
 
-		double rotObliquity = pd.value(secname+"/rot_obliquity",0.).toDouble()*(M_PI/180.0);
-		double rotAscNode = pd.value(secname+"/rot_equator_ascending_node",0.).toDouble()*(M_PI/180.0);
 
-		// Use more common planet North pole data if available
-		// NB: N pole as defined by IAU (NOT right hand rotation rule)
-		// NB: J2000 epoch
-		const double J2000NPoleRA = pd.value(secname+"/rot_pole_ra", 0.).toDouble()*M_PI/180.;
-		const double J2000NPoleDE = pd.value(secname+"/rot_pole_de", 0.).toDouble()*M_PI/180.;
+	if (!parent.isNull())
+	{
+		parent->satellites.append(p);
+		p->parent = parent;
+	}
+	if (secname=="earth") earth = p;
+	if (secname=="sun") sun = p;
+	if (secname=="moon") moon = p;
 
-		if(J2000NPoleRA || J2000NPoleDE)
-		{
-			Vec3d J2000NPole;
-			StelUtils::spheToRect(J2000NPoleRA,J2000NPoleDE,J2000NPole);
+	double rotObliquity = pd.getDouble(section, "rot_obliquity", 0.)*(M_PI/180.0);
+	double rotAscNode = pd.getDouble(section, "rot_equator_ascending_node", 0.)*(M_PI/180.0);
 
-			Vec3d vsop87Pole(StelCore::matJ2000ToVsop87.multiplyWithoutTranslation(J2000NPole));
+	// Use more common planet North pole data if available
+	// NB: N pole as defined by IAU (NOT right hand rotation rule)
+	// NB: J2000 epoch
+	const double J2000NPoleRA = pd.getDouble(section, "rot_pole_ra", 0.)*M_PI/180.;
+	const double J2000NPoleDE = pd.getDouble(section, "rot_pole_de", 0.)*M_PI/180.;
 
-			double ra, de;
-			StelUtils::rectToSphe(&ra, &de, vsop87Pole);
+	if(J2000NPoleRA || J2000NPoleDE)
+	{
+		Vec3d J2000NPole;
+		StelUtils::spheToRect(J2000NPoleRA,J2000NPoleDE,J2000NPole);
 
-			rotObliquity = (M_PI_2 - de);
-			rotAscNode = (ra + M_PI_2);
+		Vec3d vsop87Pole(StelCore::matJ2000ToVsop87.multiplyWithoutTranslation(J2000NPole));
 
-			// qDebug() << "\tCalculated rotational obliquity: " << rotObliquity*180./M_PI << endl;
-			// qDebug() << "\tCalculated rotational ascending node: " << rotAscNode*180./M_PI << endl;
-		}
+		double ra, de;
+		StelUtils::rectToSphe(&ra, &de, vsop87Pole);
 
-		// rot_periode given in hours, or orbit_Period given in days, orbit_visualization_period in days. The latter should have a meaningful default.
-		p->setRotationElements(
-			pd.value(secname+"/rot_periode", pd.value(secname+"/orbit_Period", 1.).toDouble()*24.).toDouble()/24.,
-			pd.value(secname+"/rot_rotation_offset",0.).toDouble(),
-			pd.value(secname+"/rot_epoch", J2000).toDouble(),
-			rotObliquity,
-			rotAscNode,
-			pd.value(secname+"/rot_precession_rate",0.).toDouble()*M_PI/(180*36525),
-			pd.value(secname+"/orbit_visualization_period", fabs(pd.value(secname+"/orbit_Period", 1.).toDouble())).toDouble()); // this is given in days...
-
-
-		if (pd.value(secname+"/rings", 0).toBool()) {
-			const double rMin = pd.value(secname+"/ring_inner_size").toDouble()/AU;
-			const double rMax = pd.value(secname+"/ring_outer_size").toDouble()/AU;
-			Ring *r = new Ring(rMin,rMax,pd.value(secname+"/tex_ring").toString());
-			p->setRings(r);
-		}
+		rotObliquity = (M_PI_2 - de);
+		rotAscNode = (ra + M_PI_2);
 
-		systemPlanets.push_back(p);
-		readOk++;
+		// qDebug() << "\tCalculated rotational obliquity: " << rotObliquity*180./M_PI << endl;
+		// qDebug() << "\tCalculated rotational ascending node: " << rotAscNode*180./M_PI << endl;
 	}
 
-	if (systemPlanets.isEmpty())
+	// rot_periode given in hours, or orbit_Period given in days, orbit_visualization_period in days. The latter should have a meaningful default.
+	p->setRotationElements(
+		pd.getDouble(section, "rot_periode", pd.getDouble(section, "orbit_Period", 1.)*24.)/24.,
+		pd.getDouble(section, "rot_rotation_offset", 0.),
+		pd.getDouble(section, "rot_epoch", J2000),
+		rotObliquity,
+		rotAscNode,
+		pd.getDouble(section, "rot_precession_rate", 0.)*M_PI/(180*36525),
+		pd.getDouble(section, "orbit_visualization_period", fabs(pd.getDouble(section, "orbit_Period", 1.)))); // this is given in days...
+
+
+	if (pd.getBool(section, "rings", 0)) {
+		const double rMin = pd.getDouble(section, "ring_inner_size")/AU;
+		const double rMax = pd.getDouble(section, "ring_outer_size")/AU;
+		Ring *r = new Ring(rMin,rMax,pd.getString(section, "tex_ring"));
+		p->setRings(r);
+	}
+
+	systemPlanets.push_back(p);
+	positionGroupsDirty = true;
+	return p;
+}
+
+namespace
+{
+	// Below this number of bodies, the positions are computed on the calling thread:
+	// dispatching them to the thread pool would cost more than it saves.
+	const int minBodiesForParallelComputation = 128;
+	// Number of bodies of each of SolarSystem::bulkGroups
+	const int bulkGroupSize = 512;
+
+	// Maximum number of evaluations of the position of a body when correcting it for light time.
+	// The first estimate of the light time comes from the previous position of the body: while the time
+	// runs smoothly, it is right to much less than the time between position updates of the body and a
+	// single evaluation is enough. After a jump in time, each evaluation reduces the error about 10000
+	// times (the ratio of the speed of light to the speeds in the solar system): three are enough.
+	const int maxLightTimeIterations = 3;
+
+	// The positions of SolarSystem::lazyBodies are only recomputed when the date changed by more than this [days].
+	// They are drawn as points, which move less than a pixel in that time but in very large zooms.
+	const double lazyPositionsDeltaJDE = 1./1440.;
+	// The positions of SolarSystem::lazyBodies are also recomputed when the observer moved by more than this [AU],
+	// e.g. to another planet. Their minimum magnitudes allow the observer to come that much closer in between.
+	const double lazyObserverDelta = 1e-4;
+	// Number of Planets of SolarSystem::lazyBodies created at most per frame, to spread the cost over frames.
+	const int maxLazyBodiesCreatedPerFrame = 32;
+
+	// Split the number from the english name of a numbered minor planet, see MinorPlanet::getEnglishName().
+	// @return the name without number
+	QString splitMinorPlanetNumber(const QString& englishName, int* number)
 	{
-		qWarning() << "No Solar System objects loaded from" << QDir::toNativeSeparators(filePath);
-		return false;
+		*number = 0;
+		if (!englishName.startsWith('('))
+			return englishName;
+		const int end = englishName.indexOf(") ");
+		bool ok = false;
+		const int n = englishName.mid(1, end-1).toInt(&ok);
+		if (end<0 || !ok || n<=0)
+			return englishName;
+		*number = n;
+		return englishName.mid(end+2);
 	}
 
-	// special case: load earth shadow texture
-	if (!Planet::texEarthShadow)
-		Planet::texEarthShadow = StelApp::getInstance().getTextureManager().createTexture(StelFileMgr::getInstallationDir()+"/textures/earth-shadow.png");
+	// Light time from a heliocentric position to the observer [days]
+	inline double lightTime(const Vec3d& pos, const Vec3d& obsPos)
+	{
+		return (pos-obsPos).length() * (AU / (SPEED_OF_LIGHT * 86400.));
+	}
 
-	// Also comets just have static textures.
-	if (!Comet::comaTexture)
-		Comet::comaTexture = StelApp::getInstance().getTextureManager().createTextureThread(StelFileMgr::getInstallationDir()+"/textures/cometComa.png", StelTexture::StelTextureParams(true, GL_LINEAR, GL_CLAMP_TO_EDGE));
-	//tail textures. We use paraboloid tail bodies, textured like a fisheye sphere, i.e. center=head. The texture should be something like a mottled star to give some structure.
-	if (!Comet::tailTexture)
-		Comet::tailTexture = StelApp::getInstance().getTextureManager().createTextureThread(StelFileMgr::getInstallationDir()+"/textures/cometTail.png", StelTexture::StelTextureParams(true, GL_LINEAR, GL_CLAMP_TO_EDGE));
+	// Iterate the light time correction of a body whose position was computed for lightTimeJDE,
+	// until the correction changes by less than the time between position updates of the body.
+	void refineLightTime(Planet* p, double dateJDE, const Vec3d& obsPos, double lightTimeJDE)
+	{
+		for (int i=1; i<maxLightTimeIterations; ++i)
+		{
+			const double correctedJDE = dateJDE - lightTime(p->getHeliocentricEclipticPos(), obsPos);
+			if (fabs(correctedJDE-lightTimeJDE) <= p->deltaJDE)
+				return;
+			lightTimeJDE = correctedJDE;
+			p->computePosition(lightTimeJDE);
+		}
+	}
 
-	if (readOk>0)
-		qDebug() << "Loaded" << readOk << "Solar System bodies";
+	// Compute the positions of a group of bodies, corrected for light time if obsPos is given
+	struct GroupPositions
+	{
+		typedef void result_type;
+		GroupPositions(double dateJDE, const Vec3d* obsPos) : dateJDE(dateJDE), obsPos(obsPos) {}
+		void operator()(const QVector<Planet*>& group) const
+		{
+			foreach (Planet* p, group)
+			{
+				if (obsPos)
+				{
+					// The previous position of the body gives the first estimate of the light time
+					const double lightTimeJDE = dateJDE - lightTime(p->getHeliocentricEclipticPos(), *obsPos);
+					p->computePosition(lightTimeJDE);
+					refineLightTime(p, dateJDE, *obsPos, lightTimeJDE);
+				}
+				else
+					p->computePosition(dateJDE);
+			}
+		}
+		double dateJDE;
+		const Vec3d* obsPos;
+	};
 
-	return true;
+	// Compute the transformation matrices of a group of bodies, corrected for light time if obsPos is given
+	struct GroupTransMatrices
+	{
+		typedef void result_type;
+		GroupTransMatrices(double dateJD, double dateJDE, const Vec3d* obsPos) : dateJD(dateJD), dateJDE(dateJDE), obsPos(obsPos) {}
+		void operator()(const QVector<Planet*>& group) const
+		{
+			foreach (Planet* p, group)
+			{
+				if (obsPos)
+				{
+					const double light_speed_correction = lightTime(p->getHeliocentricEclipticPos(), *obsPos);
+					p->computeTransMatrix(dateJD-light_speed_correction, dateJDE-light_speed_correction);
+				}
+				else
+					p->computeTransMatrix(dateJD, dateJDE);
+			}
+		}
+		double dateJD;
+		double dateJDE;
+		const Vec3d* obsPos;
+	};
+
+	// Compute the positions of one of SolarSystem::bulkGroups, corrected for light time if obsPos is given
+	struct BulkGroupPositions
+	{
+		typedef void result_type;
+		BulkGroupPositions(const QVector<QVector<Planet*> >& groups, const KeplerOrbitBatch& orbits, double dateJDE, const Vec3d* obsPos)
+			: groups(groups), orbits(orbits), dateJDE(dateJDE), obsPos(obsPos) {}
+		void operator()(int groupIndex) const
+		{
+			const QVector<Planet*>& group = groups.at(groupIndex);
+			const int count = group.size();
+			double JDE[bulkGroupSize];
+			double xyz[3*bulkGroupSize];
+			bool outdated = false;
+			for (int i=0; i<count; ++i)
+			{
+				Planet* p = group.at(i);
+				JDE[i] = dateJDE;
+				// The previous position of the body gives the first estimate of the light time
+				if (obsPos)
+					JDE[i] -= lightTime(p->getHeliocentricEclipticPos(), *obsPos);
+				outdated = outdated || p->isPositionOutdated(JDE[i]);
+			}
+			if (outdated)
+			{
+				const int first = groupIndex*bulkGroupSize;
+				orbits.computePositions(first, first+count, JDE, xyz);
+			}
+			for (int i=0; i<count; ++i)
+			{
+				Planet* p = group.at(i);
+				// Bodies whose orbit is displayed also need their orbit line to be updated
+				if (p->orbitFader.getInterstate()>0.000001)
+					p->computePosition(JDE[i]);
+				else if (outdated)
+					p->setComputedPosition(JDE[i], Vec3d(xyz[3*i], xyz[3*i+1], xyz[3*i+2]));
+				// Bodies whose estimate was too far off, e.g. after a jump in time, are computed again one by one
+				if (obsPos)
+					refineLightTime(p, dateJDE, *obsPos, JDE[i]);
+			}
+		}
+		const QVector<QVector<Planet*> >& groups;
+		const KeplerOrbitBatch& orbits;
+		double dateJDE;
+		const Vec3d* obsPos;
+	};
+
+	// Order of the indices of SolarSystem::lazyBodies by increasing minimum magnitude
+	template <class Body>
+	struct MinMagnitudeLess
+	{
+		MinMagnitudeLess(const Body* bodies) : bodies(bodies) {}
+		bool operator()(int a, int b) const {return bodies[a].minMagnitude < bodies[b].minMagnitude;}
+		const Body* bodies;
+	};
+
+	// Compute the positions of one group of bulkGroupSize bodies of SolarSystem::lazyBodies, corrected for
+	// light time if lightTimeCorrection is set. Each pass estimates the light time from the positions of the
+	// previous one. Unlike for the Planets, the passes are not iterated per body until they converge: the
+	// bodies are only drawn as points, and their Planet is computed exactly once created.
+	// The group is then sorted by minimum magnitude in SolarSystem::lazyDrawOrder.
+	template <class Body>
+	struct LazyGroupPositions
+	{
+		typedef void result_type;
+		LazyGroupPositions(Body* bodies, int* order, int bodyCount, const KeplerOrbitBatch& orbits, double dateJDE, const Vec3d& obsPos, bool lightTimeCorrection, int passes)
+			: bodies(bodies), order(order), bodyCount(bodyCount), orbits(orbits), dateJDE(dateJDE), obsPos(obsPos), lightTimeCorrection(lightTimeCorrection), passes(passes) {}
+		void operator()(int groupIndex) const
+		{
+			const int first = groupIndex*bulkGroupSize;
+			const int count = qMin(bulkGroupSize, bodyCount-first);
+			double JDE[bulkGroupSize];
+			double xyz[3*bulkGroupSize];
+			for (int pass=0; pass<passes; ++pass)
+			{
+				for (int i=0; i<count; ++i)
+					JDE[i] = lightTimeCorrection ? dateJDE - lightTime(bodies[first+i].pos, obsPos) : dateJDE;
+				orbits.computePositions(first, first+count, JDE, xyz);
+				for (int i=0; i<count; ++i)
+					bodies[first+i].pos.set(xyz[3*i], xyz[3*i+1], xyz[3*i+2]);
+			}
+			// The phase and the extinction can only make a body fainter than its H-G magnitude at opposition
+			for (int i=0; i<count; ++i)
+			{
+				Body& body = bodies[first+i];
+				const double distance = qMax((body.pos-obsPos).length()-lazyObserverDelta, 1e-8);
+				body.minMagnitude = body.absoluteMagnitude + 5.f*(float)std::log10(body.pos.length()*distance);
+			}
+			std::sort(order+first, order+first+count, MinMagnitudeLess<Body>(bodies));
+		}
+		Body* bodies;
+		int* order;
+		int bodyCount;
+		const KeplerOrbitBatch& orbits;
+		double dateJDE;
+		Vec3d obsPos;
+		bool lightTimeCorrection;
+		int passes;
+	};
+
+	// Apply a functor to all groups, in parallel if there are enough bodies
+	template <class T, class Functor>
+	void forEachGroup(QVector<T>& groups, int bodyCount, const Functor& f)
+	{
+		if (bodyCount>=minBodiesForParallelComputation && QThreadPool::globalInstance()->maxThreadCount()>1)
+			QtConcurrent::blockingMap(groups, f);
+		else
+			std::for_each(groups.constBegin(), groups.constEnd(), f);
+	}
+}
+
+void SolarSystem::updatePositionGroups()
+{
+	if (!positionGroupsDirty)
+		return;
+	positionGroups.clear();
+	bulkGroups.clear();
+	bulkGroupIndices.clear();
+	bulkOrbits.clear();
+	// Index of the group of each body orbiting the Sun
+	QHash<const Planet*, int> groupIndex;
+	foreach (const PlanetP& p, systemPlanets)
+	{
+		// Minor planets on Keplerian orbits around the Sun are computed in bulk.
+		// Comets are not: their tails need the velocity computed by CometOrbit.
+		if (p->coordFunc==&cometOrbitPosFunc && p->parent && !p->parent->parent && p->satellites.isEmpty() && p->pType!=Planet::isComet)
+		{
+			if (bulkOrbits.size()%bulkGroupSize==0)
+			{
+				bulkGroupIndices.append(bulkGroups.size());
+				bulkGroups.append(QVector<Planet*>());
+				bulkGroups.last().reserve(bulkGroupSize);
+			}
+			bulkOrbits.add(*static_cast<CometOrbit*>(p->orbitPtr));
+			bulkGroups.last().append(p.data());
+			continue;
+		}
+		// Find the body orbiting the Sun which p belongs to. The Sun is in a group of its own.
+		const Planet* top = p.data();
+		while (top->parent && top->parent->parent)
+			top = top->parent.data();
+		QHash<const Planet*, int>::const_iterator it = groupIndex.constFind(top);
+		if (it==groupIndex.constEnd())
+		{
+			it = groupIndex.insert(top, positionGroups.size());
+			positionGroups.append(QVector<Planet*>());
+		}
+		// systemPlanets is ordered hierarchically, so parents come first in each group
+		positionGroups[it.value()].append(p.data());
+	}
+	positionGroupsDirty = false;
+}
+
+void SolarSystem::computeBulkPositions(double dateJDE, const Vec3d* obsPos)
+{
+	forEachGroup(bulkGroupIndices, bulkOrbits.size(), BulkGroupPositions(bulkGroups, bulkOrbits, dateJDE, obsPos));
+}
+
+void SolarSystem::addLazyMinorBody(const QSharedPointer<SolarSystemElementStore>& store, int section, const QString& englishName, CometOrbit* orbit, bool closeOrbit)
+{
+	if (lazyStores.isEmpty() || lazyStores.last()!=store)
+		lazyStores.append(store);
+	const SolarSystemElementStore& pd = *store;
+	LazyMinorBody body;
+	body.store = lazyStores.size()-1;
+	body.section = section;
+	body.englishName = englishName;
+	body.nameI18n = englishName; // translated by updateI18n()
+	body.type = pd.getString(section, "type");
+	body.minorPlanetNumber = pd.getInt(section, "minor_planet_number", 0);
+	// Same H-G magnitude system as in createPlanet()
+	body.absoluteMagnitude = pd.getDouble(section, "absolute_magnitude", -99);
+	const double slope = pd.getDouble(section, "slope_parameter", 0.15);
+	body.slopeParameter = (slope >= 0 && slope <= 1) ? slope : 0.15;
+	body.color = getMinorPlanetColor(pd, section);
+	body.orbit = orbit;
+	body.closeOrbit = closeOrbit;
+	body.pos.set(0.,0.,0.);
+	body.minMagnitude = -99.f;
+	body.removed = false;
+
+	// The positions of the bodies are computed by groups of bulkGroupSize, like bulkGroups
+	if (lazyOrbits.size()%bulkGroupSize==0)
+		lazyGroupIndices.append(lazyGroupIndices.size());
+	lazyOrbits.add(*orbit);
+	if (!lazyBodyIndex.contains(englishName))
+		lazyBodyIndex.insert(englishName, lazyBodies.size());
+	lazyDrawOrder.append(lazyBodies.size());
+	lazyBodies.append(body);
+	lazyPositionsValid = false;
+}
+
+int SolarSystem::lazyBodyIndexOf(const QString& englishName) const
+{
+	if (lazyBodies.isEmpty())
+		return -1;
+	int index = lazyBodyIndex.value(englishName, -1);
+	if (index<0)
+	{
+		int number = 0;
+		index = lazyBodyIndex.value(splitMinorPlanetNumber(englishName, &number), -1);
+		if (index>=0 && lazyBodies.at(index).minorPlanetNumber!=number)
+			index = -1;
+	}
+	return index;
+}
+
+PlanetP SolarSystem::createLazyMinorBody(int index) const
+{
+	// The searches are const, but must find the minor planets whose Planet does not exist yet.
+	// Creating it does not change what the SolarSystem holds, only the form it has.
+	SolarSystem* self = const_cast<SolarSystem*>(this);
+	LazyMinorBody& body = self->lazyBodies[index];
+	if (body.planet || body.removed)
+		return body.planet;
+	Q_ASSERT(QThread::currentThread()==thread());
+
+	// Give it the same state as the Planets created by loadPlanets()
+	const bool hints = getFlagHints();
+	const bool labels = getFlagLabels();
+	body.planet = self->createPlanet(*lazyStores.at(body.store), body.section, body.englishName, sun, &cometOrbitPosFunc, body.orbit, Q_NULLPTR, body.closeOrbit);
+	body.planet->translateName(StelApp::getInstance().getLocaleMgr().getSkyTranslator());
+	body.planet->setFlagHints(hints);
+	body.planet->setFlagLabels(labels);
+	body.planet->setFlagOrbits(flagOrbits && !flagPlanetsOrbitsOnly && (!selected || selected==sun));
+	if (flagMinorBodyScale)
+		body.planet->setSphereScale(minorBodyScale);
+
+	// It is drawn before the next computePositions()
+	const StelCore* core = StelApp::getInstance().getCore();
+	const double light_speed_correction = flagLightTravelTime ? lightTime(body.pos, core->getObserverHeliocentricEclipticPos()) : 0.;
+	body.planet->computePosition(core->getJDE()-light_speed_correction);
+	body.planet->computeTransMatrix(core->getJD()-light_speed_correction, core->getJDE()-light_speed_correction);
+	return body.planet;
+}
+
+void SolarSystem::computeLazyPositions(double dateJDE, const Vec3d& obsPos, bool lightTimeCorrection)
+{
+	if (lazyBodies.isEmpty() || (lazyPositionsValid && fabs(dateJDE-lazyPositionsJDE)<lazyPositionsDeltaJDE
+				     && (obsPos-lazyObserverPos).lengthSquared()<lazyObserverDelta*lazyObserverDelta))
+		return;
+	// After a jump in time, the previous positions give a light time too far off
+	const int passes = (lightTimeCorrection && (!lazyPositionsValid || fabs(dateJDE-lazyPositionsJDE)>1.)) ? 2 : 1;
+	forEachGroup(lazyGroupIndices, lazyOrbits.size(), LazyGroupPositions<LazyMinorBody>(lazyBodies.data(), lazyDrawOrder.data(), lazyBodies.size(), lazyOrbits, dateJDE, obsPos, lightTimeCorrection, passes));
+	lazyBrightestMagnitude = 99.f;
+	for (int first=0; first<lazyDrawOrder.size(); first+=bulkGroupSize)
+		lazyBrightestMagnitude = qMin(lazyBrightestMagnitude, lazyBodies.at(lazyDrawOrder.at(first)).minMagnitude);
+	lazyPositionsJDE = dateJDE;
+	lazyObserverPos = obsPos;
+	lazyPositionsValid = true;
 }
 
 // Compute the position for every elements of the solar system.
-// The order is not important since the position is computed relatively to the mother body
+// Bodies are computed in groups: a body orbiting the Sun and its satellites, parents first.
+// Groups do not depend on each other and are computed in parallel when there are many bodies.
+// Minor planets without satellites are computed separately, many at once (see computeBulkPositions()),
+// as are the minor planets of large sets which have no Planet yet (see computeLazyPositions()).
+// With light travel time, each body is computed at the date its light left it. The light time is
+// estimated from the previous position of the body, so usually each position is computed only once.
 void SolarSystem::computePositions(double dateJDE, PlanetP observerPlanet)
 {
+	updatePositionGroups();
+	const int bodyCount = systemPlanets.size()-bulkOrbits.size();
 	if (flagLightTravelTime)
 	{
-		foreach (PlanetP p, systemPlanets)
-		{
-			p->computePositionWithoutOrbits(dateJDE);
-		}
+		// Only the observer is needed at dateJDE
+		observerPlanet->computePosition(dateJDE);
 		// BEGIN HACK: 0.16.0post for solar aberration/light time correction
 		// This fixes eclipse bug LP:#1275092) and outer planet rendering bug (LP:#1699648) introduced by the first fix in 0.16.0.
 		// We compute a "light time corrected position" for the sun and apply it only for rendering, not for other computations.
@@ -1212,21 +1656,20 @@ void SolarSystem::computePositions(double dateJDE, PlanetP observerPlanet)
 		// We must reset observerPlanet for the next step!
 		observerPlanet->computePosition(dateJDE);
 		// END HACK FOR SOLAR LIGHT TIME/ABERRATION
-		foreach (PlanetP p, systemPlanets)
-		{
-			const double light_speed_correction = (p->getHeliocentricEclipticPos()-obsPosJDE).length() * (AU / (SPEED_OF_LIGHT * 86400.));
-			p->computePosition(dateJDE-light_speed_correction);
-		}
+		forEachGroup(positionGroups, bodyCount, GroupPositions(dateJDE, &obsPosJDE));
+		computeBulkPositions(dateJDE, &obsPosJDE);
+		computeLazyPositions(dateJDE, obsPosJDE, true);
 	}
 	else
 	{
-		foreach (PlanetP p, systemPlanets)
-		{
-			p->computePosition(dateJDE);
-		}
+		forEachGroup(positionGroups, bodyCount, GroupPositions(dateJDE, Q_NULLPTR));
+		computeBulkPositions(dateJDE, Q_NULLPTR);
+		computeLazyPositions(dateJDE, observerPlanet->getHeliocentricEclipticPos(), false);
 		lightTimeSunPosition.set(0.,0.,0.);
 	}
 	computeTransMatrices(dateJDE, observerPlanet->getHeliocentricEclipticPos());
+	// The coordinates the planets cached for the previous positions are out of date
+	StelApp::getInstance().getCore()->invalidateFrameCache();
 }
 
 // Compute the transformation matrix for every elements of the solar system.
@@ -1235,21 +1678,10 @@ void SolarSystem::computeTransMatrices(double dateJDE, const Vec3d& observerPos)
 {
 	double dateJD=dateJDE - (StelApp::getInstance().getCore()->computeDeltaT(dateJDE))/86400.0;
 
-	if (flagLightTravelTime)
-	{
-		foreach (PlanetP p, systemPlanets)
-		{
-			const double light_speed_correction = (p->getHeliocentricEclipticPos()-observerPos).length() * (AU / (SPEED_OF_LIGHT * 86400));
-			p->computeTransMatrix(dateJD-light_speed_correction, dateJDE-light_speed_correction);
-		}
-	}
-	else
-	{
-		foreach (PlanetP p, systemPlanets)
-		{
-			p->computeTransMatrix(dateJD, dateJDE);
-		}
-	}
+	updatePositionGroups();
+	const GroupTransMatrices transMatrices(dateJD, dateJDE, flagLightTravelTime ? &observerPos : Q_NULLPTR);
+	forEachGroup(positionGroups, systemPlanets.size()-bulkOrbits.size(), transMatrices);
+	forEachGroup(bulkGroups, bulkOrbits.size(), transMatrices);
 }
 
 // And sort them from the furthest to the closest to the observer
@@ -1296,6 +1728,7 @@ void SolarSystem::draw(StelCore* core)
 	{
 		p->draw(core, maxMagLabel, planetNameFont);
 	}
+	drawLazyMinorBodies(core, maxMagLabel);
 
 	if (GETSTELMODULE(StelObjectMgr)->getFlagSelectedObjectPointer() && getFlagPointer())
 		drawPointer(core);
@@ -1356,6 +1789,88 @@ void SolarSystem::draw(StelCore* core)
 	}
 }
 
+// The minor planets of large sets are drawn as points until they are bright enough to get a label.
+// Then their Planet is created, which draws them from the next frame on.
+void SolarSystem::drawLazyMinorBodies(StelCore* core, float maxMagLabel)
+{
+	if (lazyBodies.isEmpty())
+		return;
+
+	StelSkyDrawer* skyDrawer = core->getSkyDrawer();
+	float limitMag = skyDrawer->getLimitMagnitude();
+	if (skyDrawer->getFlagPlanetMagnitudeLimit())
+		limitMag = qMin(limitMag, (float)skyDrawer->getCustomPlanetMagnitudeLimit());
+	// Usually none of them is bright enough, e.g. by daylight
+	if (lazyBrightestMagnitude > limitMag)
+		return;
+
+	const Vec3d obsHelioPos = core->getObserverHeliocentricEclipticPos();
+	StelPainter sPainter(core->getProjection(StelCore::FrameJ2000));
+	// The bodies outside of the viewport are rejected before computing their magnitude and projecting them.
+	// The positions are heliocentric ecliptic: rotate the viewport to them rather than all the positions.
+	const SphericalCap& viewportCap = sPainter.getProjector()->getBoundingCap();
+	const Vec3d viewportDir = StelCore::matJ2000ToVsop87.multiplyWithoutTranslation(viewportCap.n);
+	skyDrawer->preDrawPointSource(&sPainter);
+	int created = 0;
+	for (int first=0; first<lazyDrawOrder.size(); first+=bulkGroupSize)
+	{
+		// Each group is sorted by minimum magnitude: stop at its first body fainter than the limit
+		const int last = qMin(first+bulkGroupSize, lazyDrawOrder.size());
+		for (int k=first; k<last && lazyBodies.at(lazyDrawOrder.at(k)).minMagnitude<=limitMag; ++k)
+		{
+			const int i = lazyDrawOrder.at(k);
+			const LazyMinorBody& body = lazyBodies.at(i);
+			if (body.planet || body.removed)
+				continue;
+			const Vec3d pos = body.pos - obsHelioPos;
+			if (pos.dot(viewportDir) < viewportCap.d*pos.length())
+				continue;
+
+			Vec3d j2000Pos = StelCore::matVsop87ToJ2000.multiplyWithoutTranslation(pos);
+			j2000Pos.normalize();
+			Vec3d win;
+			if (!sPainter.getProjector()->projectCheck(j2000Pos, win))
+				continue;
+			const float mag = body.getVMagnitudeWithExtinction(core, obsHelioPos, j2000Pos);
+			RCMag rcMag;
+			if (mag > limitMag || !skyDrawer->computeRCMag(mag, &rcMag))
+				continue;
+			skyDrawer->drawPointSource(&sPainter, Vec3f(j2000Pos[0], j2000Pos[1], j2000Pos[2]), rcMag, body.color);
+
+			if (mag < maxMagLabel && created < maxLazyBodiesCreatedPerFrame)
+			{
+				createLazyMinorBody(i);
+				created++;
+			}
+		}
+	}
+	skyDrawer->postDrawPointSource(&sPainter);
+}
+
+float SolarSystem::LazyMinorBody::getVMagnitudeWithExtinction(const StelCore* core, const Vec3d& observerHelioPos, const Vec3d& j2000Pos) const
+{
+	// Same as MinorPlanet::getVMagnitude()
+	const float observerRq = observerHelioPos.lengthSquared();
+	const float planetRq = pos.lengthSquared();
+	const float observerPlanetRq = (observerHelioPos - pos).lengthSquared();
+	const float cos_chi = (observerPlanetRq + planetRq - observerRq)/(2.0*std::sqrt(observerPlanetRq*planetRq));
+	const float phaseAngle = std::acos(cos_chi);
+	const float tanPhaseAngleHalf=std::tan(phaseAngle*0.5f);
+	const float phi1 = std::exp(-3.33f * std::pow(tanPhaseAngleHalf, 0.63f));
+	const float phi2 = std::exp(-1.87f * std::pow(tanPhaseAngleHalf, 1.22f));
+	const float reducedMagnitude = absoluteMagnitude - 2.5f * std::log10( (1.0f - slopeParameter) * phi1 + slopeParameter * phi2 );
+	float vMag = reducedMagnitude + 5.0f * std::log10(std::sqrt(planetRq * observerPlanetRq));
+
+	// Same as StelObject::getVMagnitudeWithExtinction()
+	if (core->getSkyDrawer()->getFlagHasAtmosphere())
+	{
+		Vec3d altAzPos = core->j2000ToAltAz(j2000Pos, StelCore::RefractionOff);
+		altAzPos.normalize();
+		core->getSkyDrawer()->getExtinction().forward(altAzPos, &vMag);
+	}
+	return vMag;
+}
+
 PlanetP SolarSystem::searchByEnglishName(QString planetEnglishName) const
 {
 	foreach (const PlanetP& p, systemPlanets)
@@ -1363,6 +1878,9 @@ PlanetP SolarSystem::searchByEnglishName(QString planetEnglishName) const
 		if (p->getEnglishName() == planetEnglishName)
 			return p;
 	}
+	const int index = lazyBodyIndexOf(planetEnglishName);
+	if (index>=0)
+		return createLazyMinorBody(index);
 	return PlanetP();
 }
 
@@ -1373,6 +1891,9 @@ PlanetP SolarSystem::searchMinorPlanetByEnglishName(QString planetEnglishName) c
 		if (p->getCommonEnglishName() == planetEnglishName)
 			return p;
 	}
+	const int index = lazyBodyIndex.value(planetEnglishName, -1);
+	if (index>=0)
+		return createLazyMinorBody(index);
 	return PlanetP();
 }
 
@@ -1384,6 +1905,18 @@ StelObjectP SolarSystem::searchByNameI18n(const QString& planetNameI18) const
 		if (p->getNameI18n() == planetNameI18)
 			return qSharedPointerCast<StelObject>(p);
 	}
+	if (!lazyBodies.isEmpty())
+	{
+		// The translated names are not indexed: they change with the language
+		int number = 0;
+		const QString nameI18n = splitMinorPlanetNumber(planetNameI18, &number);
+		for (int i=0; i<lazyBodies.size(); ++i)
+		{
+			const LazyMinorBody& body = lazyBodies.at(i);
+			if (!body.planet && !body.removed && ((body.nameI18n==nameI18n && body.minorPlanetNumber==number) || body.nameI18n==planetNameI18))
+				return qSharedPointerCast<StelObject>(createLazyMinorBody(i));
+		}
+	}
 	return StelObjectP();
 }
 
@@ -1395,6 +1928,9 @@ StelObjectP SolarSystem::searchByName(const QString& name) const
 		if (p->getEnglishName() == name || p->getCommonEnglishName() == name)
 			return qSharedPointerCast<StelObject>(p);
 	}
+	const int index = lazyBodyIndexOf(name);
+	if (index>=0)
+		return qSharedPointerCast<StelObject>(createLazyMinorBody(index));
 	return StelObjectP();
 }
 
@@ -1533,12 +2069,50 @@ QList<StelObjectP> SolarSystem::searchAround(const Vec3d& vv, double limitFov, c
 	return result;
 }
 
+QList<StelObjectP> SolarSystem::searchAroundSelectable(const Vec3d& vv, double limitFov, float maxPriority, const StelCore* core) const
+{
+	QList<StelObjectP> result = searchAround(vv, limitFov, core);
+	if (lazyBodies.isEmpty() || !getFlagPlanets())
+		return result;
+
+	// Only the bodies drawn as points can be selected, see drawLazyMinorBodies().
+	// Their select priority is lower than their magnitude, see Planet::getSelectPriority().
+	const StelSkyDrawer* skyDrawer = core->getSkyDrawer();
+	float limitMag = qMin(skyDrawer->getLimitMagnitude(), maxPriority);
+	if (skyDrawer->getFlagPlanetMagnitudeLimit())
+		limitMag = qMin(limitMag, (float)skyDrawer->getCustomPlanetMagnitudeLimit());
+	Vec3d v(vv);
+	v.normalize();
+	const double cosLimFov = std::cos(limitFov * M_PI/180.);
+	const Vec3d obsHelioPos = core->getObserverHeliocentricEclipticPos();
+	for (int i=0; i<lazyBodies.size(); ++i)
+	{
+		const LazyMinorBody& body = lazyBodies.at(i);
+		if (body.planet || body.removed)
+			continue;
+		Vec3d j2000Pos = StelCore::matVsop87ToJ2000.multiplyWithoutTranslation(body.pos - obsHelioPos);
+		j2000Pos.normalize();
+		if (j2000Pos*v>=cosLimFov && body.getVMagnitudeWithExtinction(core, obsHelioPos, j2000Pos)<=limitMag)
+			result.append(qSharedPointerCast<StelObject>(createLazyMinorBody(i)));
+	}
+	return result;
+}
+
 // Update i18 names from english names according to current sky culture translator
 void SolarSystem::updateI18n()
 {
 	const StelTranslator& trans = StelApp::getInstance().getLocaleMgr().getSkyTranslator();
 	foreach (PlanetP p, systemPlanets)
 		p->translateName(trans);
+	// Same as MinorPlanet::translateName()
+	for (int i=0; i<lazyBodies.size(); ++i)
+	{
+		LazyMinorBody& body = lazyBodies[i];
+		if (body.englishName.endsWith('*'))
+			body.nameI18n = trans.qtranslate(body.englishName.left(body.englishName.count() - 1), "minor planet").append('*');
+		else
+			body.nameI18n = trans.qtranslate(body.englishName, "minor planet");
+	}
 }
 
 void SolarSystem::setFlagTrails(bool b)
@@ -1739,6 +2313,11 @@ QStringList SolarSystem::listAllObjects(bool inEnglish) const
 		{
 			result << p->getEnglishName();
 		}
+		foreach(const LazyMinorBody& body, lazyBodies)
+		{
+			if (!body.planet && !body.removed)
+				result << body.getEnglishName();
+		}
 	}
 	else
 	{
@@ -1746,6 +2325,11 @@ QStringList SolarSystem::listAllObjects(bool inEnglish) const
 		{
 			result << p->getNameI18n();
 		}
+		foreach(const LazyMinorBody& body, lazyBodies)
+		{
+			if (!body.planet && !body.removed)
+				result << body.getNameI18n();
+		}
 	}
 	return result;
 }
@@ -1760,6 +2344,11 @@ QStringList SolarSystem::listAllObjectsByType(const QString &objType, bool inEng
 			if (p->getPlanetTypeString()==objType)
 				result << p->getEnglishName();
 		}
+		foreach(const LazyMinorBody& body, lazyBodies)
+		{
+			if (!body.planet && !body.removed && body.type==objType)
+				result << body.getEnglishName();
+		}
 	}
 	else
 	{
@@ -1768,6 +2357,11 @@ QStringList SolarSystem::listAllObjectsByType(const QString &objType, bool inEng
 			if (p->getPlanetTypeString()==objType)
 				result << p->getNameI18n();
 		}
+		foreach(const LazyMinorBody& body, lazyBodies)
+		{
+			if (!body.planet && !body.removed && body.type==objType)
+				result << body.getNameI18n();
+		}
 	}
 	return result;
 }
@@ -2222,6 +2816,11 @@ QStringList SolarSystem::getAllPlanetEnglishNames() const
 	QStringList res;
 	foreach (const PlanetP& p, systemPlanets)
 		res.append(p->getEnglishName());
+	foreach (const LazyMinorBody& body, lazyBodies)
+	{
+		if (!body.planet && !body.removed)
+			res.append(body.getEnglishName());
+	}
 	return res;
 }
 
@@ -2230,6 +2829,11 @@ QStringList SolarSystem::getAllPlanetLocalizedNames() const
 	QStringList res;
 	foreach (const PlanetP& p, systemPlanets)
 		res.append(p->getNameI18n());
+	foreach (const LazyMinorBody& body, lazyBodies)
+	{
+		if (!body.planet && !body.removed)
+			res.append(body.getNameI18n());
+	}
 	return res;
 }
 
@@ -2238,6 +2842,11 @@ QStringList SolarSystem::getAllMinorPlanetCommonEnglishNames() const
 	QStringList res;
 	foreach (const PlanetP& p, systemMinorBodies)
 		res.append(p->getCommonEnglishName());
+	foreach (const LazyMinorBody& body, lazyBodies)
+	{
+		if (!body.planet && !body.removed)
+			res.append(body.englishName);
+	}
 	return res;
 }
 
@@ -2276,6 +2885,9 @@ void SolarSystem::reloadPlanets()
 	selected.clear();//Release the selected one
 
 	// GZ TODO in case this methods gets converted to only reload minor bodies: Only delete Orbits which are not referenced by some Planet.
+	// The orbit lines may still be sampled in the background from the orbits
+	foreach (const PlanetP& p, systemPlanets)
+		p->waitForOrbitSamples();
 	foreach (Orbit* orb, orbits)
 	{
 		delete orb;
@@ -2298,6 +2910,7 @@ void SolarSystem::reloadPlanets()
 	}
 	systemPlanets.clear();
 	systemMinorBodies.clear();
+	positionGroupsDirty = true;
 	// Memory leak? What's the proper way of cleaning shared pointers?
 
 	// Also delete Comet textures (loaded in loadPlanets()
@@ -2517,7 +3130,14 @@ bool SolarSystem::removeMinorPlanet(QString name)
 	if (orbPtr)
 		orbits.removeOne(orbPtr);
 	systemPlanets.removeOne(candidate);
+	positionGroupsDirty = true;
 	systemMinorBodies.removeOne(candidate);
+	const int index = lazyBodyIndex.value(candidate->getCommonEnglishName(), -1);
+	if (index>=0 && lazyBodies.at(index).planet==candidate)
+	{
+		lazyBodies[index].planet.clear();
+		lazyBodies[index].removed = true;
+	}
 	candidate.clear();
 	return true;
 }
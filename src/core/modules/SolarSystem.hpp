@@ -28,11 +28,13 @@
 #include "StelObjectModule.hpp"
 #include "StelTextureTypes.hpp"
 #include "Planet.hpp"
+#include "Orbit.hpp"
 #include "StelGui.hpp"
 
 #include <QFont>
 
 class Orbit;
+class SolarSystemElementStore;
 class StelTranslator;
 class StelObject;
 class StelCore;
@@ -321,6 +323,10 @@ public:
 	//! from v.
 	virtual QList<StelObjectP> searchAround(const Vec3d& v, double limitFov, const StelCore* core) const;
 
+	//! Same as searchAround(), but also finds the minor planets of large sets drawn as points
+	//! brighter than maxPriority, whose Planets are created for that.
+	virtual QList<StelObjectP> searchAroundSelectable(const Vec3d& v, double limitFov, float maxPriority, const StelCore* core) const;
+
 	//! Search for a SolarSystem object based on the localised name.
 	//! @param nameI18n the case in-sensistive translated planet name.
 	//! @return a StelObjectP for the object if found, else Q_NULLPTR.
@@ -833,6 +839,9 @@ signals:
 
 	void orbitColorStyleChanged(QString style) const;
 
+	//! Emitted by reloadPlanets() before it deletes the bodies and their orbits.
+	//! The users of the bodies in other threads must be stopped when it returns.
+	void solarSystemDataAboutToReload();
 	void solarSystemDataReloaded();
 
 public:
@@ -841,6 +850,7 @@ public:
 	//! Get a pointer to a Planet object.
 	//! @param planetEnglishName the English name of the desired planet.
 	//! @return The matching planet pointer if exists or Q_NULLPTR.
+	//! The Planet of a minor planet of a large set is created by the search if needed.
 	PlanetP searchByEnglishName(QString planetEnglishName) const;
 
 	PlanetP searchMinorPlanetByEnglishName(QString planetEnglishName) const;
@@ -881,8 +891,10 @@ public:
 	void computePositions(double dateJDE, PlanetP observerPlanet);
 
 	//! Get the list of all the bodies of the solar system.	
+	//! @note the minor planets of large sets are only included once their Planet is created, see searchByEnglishName().
 	const QList<PlanetP>& getAllPlanets() const {return systemPlanets;}
 	//! Get the list of all the bodies of the solar system.
+	//! @note the minor planets of large sets are only included once their Planet is created, see searchByEnglishName().
 	const QList<PlanetP>& getAllMinorBodies() const {return systemMinorBodies;}
 	//! Get the list of all minor bodies names.
 	const QStringList getMinorBodiesList() const { return minorBodies; }
@@ -926,6 +938,13 @@ private:
 	//! observerPos is needed for light travel time computation.
 	void computeTransMatrices(double dateJDE, const Vec3d& observerPos = Vec3d(0.));
 
+	//! Split systemPlanets into positionGroups and bulkGroups, if it changed since the last call.
+	void updatePositionGroups();
+
+	//! Compute the positions of the bodies of bulkGroups with bulkOrbits.
+	//! @param obsPos if given, the positions are corrected for light time to this observer
+	void computeBulkPositions(double dateJDE, const Vec3d* obsPos);
+
 	//! Draw a nice animated pointer around the object.
 	void drawPointer(const StelCore* core);
 
@@ -938,6 +957,35 @@ private:
 	//! Load planet data from the given file
 	bool loadPlanets(const QString& filePath);
 
+	//! Create the body described by a section of a solar system file and add it to systemPlanets.
+	PlanetP createPlanet(const SolarSystemElementStore& pd, int section, const QString& englishName, const PlanetP& parent,
+			     posFuncType posfunc, void* orbitPtr, OsculatingFunctType* osculatingFunc, bool closeOrbit);
+
+	//! Get the halo color of a minor planet described by a section of a solar system file.
+	Vec3f getMinorPlanetColor(const SolarSystemElementStore& pd, int section);
+
+	//! Add a minor planet to lazyBodies instead of creating its Planet.
+	//! @param orbit its orbit, already added to orbits
+	void addLazyMinorBody(const QSharedPointer<SolarSystemElementStore>& store, int section, const QString& englishName, CometOrbit* orbit, bool closeOrbit);
+
+	//! Get the Planet of a body of lazyBodies, creating it if needed.
+	//! Like all changes of systemPlanets, this must happen in the main thread.
+	//! @return Q_NULLPTR if the body was removed
+	PlanetP createLazyMinorBody(int index) const;
+
+	//! Find a body of lazyBodies by its english name, with or without its number.
+	//! @return its index, or -1
+	int lazyBodyIndexOf(const QString& englishName) const;
+
+	//! Compute the positions and minimum magnitudes of lazyBodies, if they are out of date.
+	//! @param obsPos the heliocentric ecliptic position of the observer
+	//! @param lightTimeCorrection whether the positions are corrected for light time to the observer
+	void computeLazyPositions(double dateJDE, const Vec3d& obsPos, bool lightTimeCorrection);
+
+	//! Draw the visible bodies of lazyBodies as points, and create the Planets of
+	//! those bright enough to get a label, a few at a time.
+	void drawLazyMinorBodies(StelCore* core, float maxMagLabel);
+
 	void recreateTrails();
 
 	//! Calculate a color of Solar system bodies
@@ -979,6 +1027,68 @@ private:
 	QList<PlanetP> systemPlanets;
 	//! List of all the minor bodies of the solar system.
 	QList<PlanetP> systemMinorBodies;
+	//! The bodies of systemPlanets, grouped for the computation of their positions:
+	//! a body orbiting the Sun followed by all its satellites, parents first.
+	//! The groups are independent of each other, so they can be computed in parallel.
+	QVector<QVector<Planet*> > positionGroups;
+	//! Minor planets on heliocentric CometOrbits and without satellites, which are not in positionGroups.
+	//! Their positions are computed all at once by bulkOrbits rather than by their coordinate functions.
+	//! Group k holds the bodies of the orbits of bulkOrbits starting at index k*bulkGroupSize.
+	QVector<QVector<Planet*> > bulkGroups;
+	//! The indices of bulkGroups, to process them in parallel.
+	QVector<int> bulkGroupIndices;
+	KeplerOrbitBatch bulkOrbits;
+	//! Set when systemPlanets changed, to rebuild positionGroups and bulkGroups.
+	bool positionGroupsDirty;
+
+	//! A minor planet of a large set (see lazyMinorBodiesThreshold), whose Planet is only created when
+	//! needed: when it is searched for or selected, or when it gets bright enough to be labelled.
+	//! Until then it is drawn as a point, from a position computed by lazyOrbits.
+	struct LazyMinorBody
+	{
+		int store;		//! Index of its solar system file in lazyStores
+		int section;		//! Its section in that file
+		QString englishName;	//! Common english name, as in the file
+		QString nameI18n;	//! Translated common name
+		QString type;
+		int minorPlanetNumber;
+		float absoluteMagnitude;
+		float slopeParameter;
+		Vec3f color;
+		CometOrbit* orbit;	//! Owned by orbits
+		bool closeOrbit;
+		Vec3d pos;		//! Heliocentric ecliptic position [AU]
+		float minMagnitude;	//! Lower bound of its magnitude from pos, see computeLazyPositions()
+		PlanetP planet;		//! The Planet, once created
+		bool removed;		//! Set by removeMinorPlanet()
+
+		//! Same as MinorPlanet::getEnglishName() and MinorPlanet::getNameI18n()
+		QString getEnglishName() const {return minorPlanetNumber ? QString("(%1) %2").arg(minorPlanetNumber).arg(englishName) : englishName;}
+		QString getNameI18n() const {return minorPlanetNumber ? QString("(%1) %2").arg(minorPlanetNumber).arg(nameI18n) : nameI18n;}
+		//! Same as MinorPlanet::getVMagnitudeWithExtinction()
+		//! @param observerHelioPos the heliocentric ecliptic position of the observer
+		//! @param j2000Pos the position of the body from the observer, in J2000 equatorial coordinates
+		float getVMagnitudeWithExtinction(const StelCore* core, const Vec3d& observerHelioPos, const Vec3d& j2000Pos) const;
+	};
+	//! The solar system files which have lazyBodies, to create their Planets later.
+	QVector<QSharedPointer<SolarSystemElementStore> > lazyStores;
+	QVector<LazyMinorBody> lazyBodies;
+	//! Indices in lazyBodies by common english name.
+	QHash<QString, int> lazyBodyIndex;
+	//! The orbits of lazyBodies, in the same order.
+	KeplerOrbitBatch lazyOrbits;
+	//! The indices of the groups of lazyBodies computed together, to process them in parallel.
+	QVector<int> lazyGroupIndices;
+	//! The indices of lazyBodies, sorted by minMagnitude within each group.
+	QVector<int> lazyDrawOrder;
+	//! The date and observer position of the positions of lazyBodies, if lazyPositionsValid.
+	double lazyPositionsJDE;
+	Vec3d lazyObserverPos;
+	bool lazyPositionsValid;
+	//! The lowest minMagnitude of lazyBodies.
+	float lazyBrightestMagnitude;
+	//! Minimum number of minor planets in a file for them to be lazyBodies (astro/lazy_minor_bodies_threshold).
+	int lazyMinorBodiesThreshold;
 
 	// Master settings
 	bool flagOrbits;
@@ -0,0 +1,244 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "SolarSystemElementStore.hpp"
+#include "StelFileMgr.hpp"
+#include "StelIniParser.hpp"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSettings>
+
+#include <cstring>
+
+namespace
+{
+	const quint32 cacheMagic = 0x53534553; // "SSES"
+	// Increment when the format of the cache changes
+	const quint32 cacheVersion = 1;
+}
+
+SolarSystemElementStore::SolarSystemElementStore()
+{
+}
+
+bool SolarSystemElementStore::load(const QString& filePath)
+{
+	strings.clear();
+	keys.clear();
+	values.clear();
+	sections.clear();
+
+	const QFileInfo fileInfo(filePath);
+	const QString canonicalPath = fileInfo.canonicalFilePath().isEmpty() ? filePath : fileInfo.canonicalFilePath();
+	const QString cachePath = QString("%1/ssystem/%2.bin").arg(StelFileMgr::getCacheDir(),
+		QString::fromLatin1(QCryptographicHash::hash(canonicalPath.toUtf8(), QCryptographicHash::Md5).toHex()));
+
+	if (readCache(cachePath, canonicalPath, fileInfo.size(), fileInfo.lastModified()))
+	{
+		buildIndices();
+		return true;
+	}
+
+	strings.clear();
+	keys.clear();
+	values.clear();
+	sections.clear();
+	if (!parse(filePath))
+		return false;
+	buildIndices();
+	writeCache(cachePath, canonicalPath, fileInfo.size(), fileInfo.lastModified());
+	return true;
+}
+
+bool SolarSystemElementStore::parse(const QString& filePath)
+{
+	QSettings pd(filePath, StelIniFormat);
+	if (pd.status() != QSettings::NoError)
+		return false;
+
+	QHash<QString, qint32> stringIndex;
+	QHash<QString, qint32> keyNames;
+	foreach (const QString& group, pd.childGroups())
+	{
+		Section section;
+		section.name = intern(group, stringIndex);
+		section.first = values.size();
+		pd.beginGroup(group);
+		foreach (const QString& key, pd.childKeys())
+		{
+			const QString str = pd.value(key).toString();
+			Value v;
+			v.key = keyNames.value(key, -1);
+			if (v.key<0)
+			{
+				v.key = keys.size();
+				keyNames.insert(key, v.key);
+				keys << key;
+			}
+			v.string = intern(str, stringIndex);
+			v.integer = str.toInt();
+			v.number = str.toDouble();
+			const QString lower = str.toLower();
+			v.boolean = !(lower.isEmpty() || lower=="0" || lower=="false");
+			values.append(v);
+		}
+		pd.endGroup();
+		section.count = values.size()-section.first;
+		sections.append(section);
+	}
+	return true;
+}
+
+qint32 SolarSystemElementStore::intern(const QString& s, QHash<QString, qint32>& index)
+{
+	QHash<QString, qint32>::const_iterator it = index.constFind(s);
+	if (it!=index.constEnd())
+		return it.value();
+	const qint32 i = strings.size();
+	strings << s;
+	index.insert(s, i);
+	return i;
+}
+
+void SolarSystemElementStore::buildIndices()
+{
+	keyIndex.clear();
+	for (int i=0; i<keys.size(); ++i)
+		keyIndex.insert(keys.at(i).toUtf8(), i);
+	nameIndex.clear();
+	for (int i=0; i<sections.size(); ++i)
+		nameIndex.insert(getString(i, "name"), i);
+}
+
+const SolarSystemElementStore::Value* SolarSystemElementStore::find(int section, const char* key) const
+{
+	// The keys are literals: look them up without allocating a QByteArray
+	const qint32 k = keyIndex.value(QByteArray::fromRawData(key, static_cast<int>(std::strlen(key))), -1);
+	if (k<0)
+		return Q_NULLPTR;
+	const Section& s = sections.at(section);
+	const Value* v = values.constData()+s.first;
+	for (const Value* end = v+s.count; v!=end; ++v)
+		if (v->key==k)
+			return v;
+	return Q_NULLPTR;
+}
+
+QString SolarSystemElementStore::getString(int section, const char* key, const QString& def) const
+{
+	const Value* v = find(section, key);
+	return v ? strings.at(v->string) : def;
+}
+
+double SolarSystemElementStore::getDouble(int section, const char* key, double def) const
+{
+	const Value* v = find(section, key);
+	return v ? v->number : def;
+}
+
+float SolarSystemElementStore::getFloat(int section, const char* key, float def) const
+{
+	const Value* v = find(section, key);
+	return v ? static_cast<float>(v->number) : def;
+}
+
+int SolarSystemElementStore::getInt(int section, const char* key, int def) const
+{
+	const Value* v = find(section, key);
+	return v ? v->integer : def;
+}
+
+bool SolarSystemElementStore::getBool(int section, const char* key, bool def) const
+{
+	const Value* v = find(section, key);
+	return v ? v->boolean : def;
+}
+
+bool SolarSystemElementStore::readCache(const QString& cachePath, const QString& filePath, qint64 fileSize, const QDateTime& fileModified)
+{
+	QFile file(cachePath);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+	QDataStream in(&file);
+	in.setVersion(QDataStream::Qt_5_2);
+
+	quint32 magic, version;
+	QString path;
+	qint64 size, modified;
+	in >> magic >> version;
+	if (magic!=cacheMagic || version!=cacheVersion)
+		return false;
+	in >> path >> size >> modified;
+	if (path!=filePath || size!=fileSize || modified!=fileModified.toMSecsSinceEpoch())
+		return false;
+
+	qint32 sectionCount, valueCount;
+	in >> strings >> keys >> sectionCount >> valueCount;
+	if (in.status()!=QDataStream::Ok || sectionCount<0 || valueCount<0)
+		return false;
+	sections.resize(sectionCount);
+	for (int i=0; i<sectionCount; ++i)
+	{
+		Section& s = sections[i];
+		in >> s.name >> s.first >> s.count;
+		if (s.name<0 || s.name>=strings.size() || s.first<0 || s.count<0 || s.first+s.count>valueCount)
+			return false;
+	}
+	values.resize(valueCount);
+	for (int i=0; i<valueCount; ++i)
+	{
+		Value& v = values[i];
+		in >> v.key >> v.string >> v.integer >> v.number >> v.boolean;
+		if (v.key<0 || v.key>=keys.size() || v.string<0 || v.string>=strings.size())
+			return false;
+	}
+	if (in.status()!=QDataStream::Ok)
+		return false;
+	qDebug() << "Loaded" << sectionCount << "Solar System bodies from cache" << QDir::toNativeSeparators(cachePath);
+	return true;
+}
+
+void SolarSystemElementStore::writeCache(const QString& cachePath, const QString& filePath, qint64 fileSize, const QDateTime& fileModified) const
+{
+	if (!QDir().mkpath(QFileInfo(cachePath).absolutePath()))
+		return;
+	QSaveFile file(cachePath);
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		qWarning() << "WARNING - could not write Solar System cache" << QDir::toNativeSeparators(cachePath) << file.errorString();
+		return;
+	}
+	QDataStream out(&file);
+	out.setVersion(QDataStream::Qt_5_2);
+	out << cacheMagic << cacheVersion;
+	out << filePath << fileSize << fileModified.toMSecsSinceEpoch();
+	out << strings << keys << (qint32)sections.size() << (qint32)values.size();
+	foreach (const Section& s, sections)
+		out << s.name << s.first << s.count;
+	foreach (const Value& v, values)
+		out << v.key << v.string << v.integer << v.number << v.boolean;
+	if (!file.commit())
+		qWarning() << "WARNING - could not write Solar System cache" << QDir::toNativeSeparators(cachePath) << file.errorString();
+}
@@ -0,0 +1,107 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _SOLARSYSTEMELEMENTSTORE_HPP_
+#define _SOLARSYSTEMELEMENTSTORE_HPP_
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QDataStream;
+
+//! @class SolarSystemElementStore
+//! The contents of a solar system file (ssystem_major.ini, ssystem_minor.ini...), in a form fast to load.
+//! Parsing the INI files through QSettings takes long for the large sets of minor bodies, and every
+//! QSettings::value() call is a string-keyed lookup. The first time a file is loaded, its values are
+//! converted once to all the types they are read as and saved in a binary file in the cache directory.
+//! Later loads read that file instead, as long as the INI file keeps the same size and modification time.
+//! Strings are interned: the keys and the values which repeat across bodies are stored once.
+//! Each section of the file describes one body. The getters mimic what QSettings::value(section+"/"+key, def)
+//! converted with QVariant::toString(), toDouble()... would return.
+class SolarSystemElementStore
+{
+public:
+	SolarSystemElementStore();
+
+	//! Load the sections of a solar system file, from the cache if it is up to date.
+	//! @return false if the file cannot be parsed
+	bool load(const QString& filePath);
+
+	//! Number of sections, in the order of QSettings::childGroups().
+	int size() const {return sections.size();}
+	//! Name of a section, e.g. "earth".
+	QString getSectionName(int section) const {return strings.at(sections.at(section).name);}
+	//! Index of the last section whose name key is englishName, or -1.
+	int indexOf(const QString& englishName) const {return nameIndex.value(englishName, -1);}
+
+	//! Whether a section has a key.
+	bool contains(int section, const char* key) const {return find(section, key)!=Q_NULLPTR;}
+	QString getString(int section, const char* key, const QString& def = QString()) const;
+	double getDouble(int section, const char* key, double def = 0.) const;
+	float getFloat(int section, const char* key, float def = 0.f) const;
+	int getInt(int section, const char* key, int def = 0) const;
+	bool getBool(int section, const char* key, bool def = false) const;
+
+private:
+	//! A value, converted to all the types it can be read as
+	struct Value
+	{
+		qint32 key;	// index of the key in keys
+		qint32 string;	// index of the value in strings
+		qint32 integer;	// QString::toInt(), 0 if the value is not an integer
+		double number;	// QString::toDouble(), 0 if the value is not a number
+		bool boolean;	// QVariant::toBool()
+	};
+	struct Section
+	{
+		qint32 name;	// index of the section name in strings
+		qint32 first;	// index of the first value of the section in values
+		qint32 count;	// number of values of the section
+	};
+
+	//! Find the value of a key in a section, or return Q_NULLPTR.
+	const Value* find(int section, const char* key) const;
+
+	//! Parse the INI file with QSettings.
+	bool parse(const QString& filePath);
+	//! Intern a string.
+	qint32 intern(const QString& s, QHash<QString, qint32>& index);
+	//! Rebuild the indices which are not saved.
+	void buildIndices();
+
+	//! Read the cache, if it was made from the same file.
+	bool readCache(const QString& cachePath, const QString& filePath, qint64 fileSize, const QDateTime& fileModified);
+	//! Save the cache.
+	void writeCache(const QString& cachePath, const QString& filePath, qint64 fileSize, const QDateTime& fileModified) const;
+
+	QStringList strings;
+	QStringList keys;
+	QVector<Value> values;
+	QVector<Section> sections;
+	//! Index of the keys, by their UTF-8 name
+	QHash<QByteArray, qint32> keyIndex;
+	//! Index of the sections by name key
+	QHash<QString, int> nameIndex;
+};
+
+#endif // _SOLARSYSTEMELEMENTSTORE_HPP_
@@ -252,6 +252,10 @@ public:
 		return ((qint32)v) << 14 >> 14;
 	}
 
+	// Star3 has no proper motion
+	inline int getDx0() const {return 0;}
+	inline int getDx1() const {return 0;}
+
 	inline int getBVIndex() const
 	{
 		return d[4] >> 4 | (d[5] & 0x7) << 4;
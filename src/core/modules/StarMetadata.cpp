@@ -0,0 +1,648 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StarMetadata.hpp"
+#include "StelFileMgr.hpp"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDir>
+#include <QHash>
+#include <QSet>
+#include <QSaveFile>
+#include <QStringList>
+#include <QVector>
+#include <QDebug>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+// Written in native byte order: a file from another platform has a wrong magic and is recompiled
+static const quint32 STAR_METADATA_MAGIC = 0x444d5453; // "STMD"
+// This number must be incremented each time the binary format changes
+static const quint32 STAR_METADATA_VERSION = 1;
+
+namespace
+{
+	//! A pool of interned UTF-8 strings, each terminated by a null character.
+	//! The offset 0 is the empty string.
+	class StringPool
+	{
+	public:
+		StringPool() : pool(1, '\0') {}
+		quint32 add(const QString& s)
+		{
+			if (s.isEmpty())
+				return 0;
+			const QByteArray utf8 = s.toUtf8();
+			QHash<QByteArray, quint32>::const_iterator it = offsets.constFind(utf8);
+			if (it!=offsets.constEnd())
+				return it.value();
+			const quint32 offset = pool.size();
+			pool.append(utf8.constData(), utf8.size()+1);
+			offsets.insert(utf8, offset);
+			return offset;
+		}
+		QByteArray pool;
+	private:
+		QHash<QByteArray, quint32> offsets;
+	};
+
+	typedef StarMetadataTable::IndexEntry IndexEntry;
+
+	struct IndexEntryLess
+	{
+		bool operator()(const IndexEntry& a, const IndexEntry& b) const {return a.key<b.key;}
+	};
+
+	struct IndexNameLess
+	{
+		IndexNameLess(const char* strings) : strings(strings) {}
+		bool operator()(const IndexEntry& a, const IndexEntry& b) const {return qstrcmp(strings+a.key, strings+b.key)<0;}
+		bool operator()(const IndexEntry& a, const char* b) const {return qstrcmp(strings+a.key, b)<0;}
+		bool operator()(const char* a, const IndexEntry& b) const {return qstrcmp(a, strings+b.key)<0;}
+		const char* strings;
+	};
+
+	template <class R> struct RecordHipLess
+	{
+		bool operator()(const R& a, const R& b) const {return a.hip<b.hip;}
+		bool operator()(const R& a, quint32 hip) const {return a.hip<hip;}
+		bool operator()(quint32 hip, const R& b) const {return hip<b.hip;}
+	};
+
+	struct CrossIdLess
+	{
+		bool operator()(const StarMetadataTable::CrossIdRecord& a, const StarMetadataTable::CrossIdRecord& b) const
+		{
+			return a.hip<b.hip || (a.hip==b.hip && a.component<b.component);
+		}
+	};
+
+	// Sort an index and keep the last inserted entry of equal keys, like a QMap would
+	template <class Less> void sortIndex(QVector<IndexEntry>& index, Less less)
+	{
+		std::stable_sort(index.begin(), index.end(), less);
+		QVector<IndexEntry> unique;
+		unique.reserve(index.size());
+		for (int i=0;i<index.size();++i)
+		{
+			if (i+1<index.size() && !less(index.at(i), index.at(i+1)))
+				continue;
+			unique.append(index.at(i));
+		}
+		index.swap(unique);
+	}
+
+	void appendAligned(QByteArray& out, const void* data, int size)
+	{
+		out.append(static_cast<const char*>(data), size);
+		while (out.size()%8)
+			out.append('\0');
+	}
+
+	// Lay out the header, records, indexes and string pool of a binary file
+	template <class R> QByteArray assemble(StarMetadataTable::Kind kind, const QVector<R>& records,
+					       QVector<IndexEntry> indexes[3], const StringPool& strings)
+	{
+		StarMetadataTable::Header header;
+		memset(&header, 0, sizeof(header));
+		header.magic = STAR_METADATA_MAGIC;
+		header.version = STAR_METADATA_VERSION;
+		header.kind = kind;
+		header.recordSize = sizeof(R);
+		header.recordCount = records.size();
+
+		QByteArray out;
+		appendAligned(out, &header, sizeof(header));
+		header.recordsOffset = out.size();
+		appendAligned(out, records.constData(), sizeof(R)*records.size());
+		for (int i=0;i<3;++i)
+		{
+			header.indexCount[i] = indexes[i].size();
+			header.indexOffset[i] = out.size();
+			appendAligned(out, indexes[i].constData(), sizeof(IndexEntry)*indexes[i].size());
+		}
+		header.stringsOffset = out.size();
+		header.stringsSize = strings.pool.size();
+		appendAligned(out, strings.pool.constData(), strings.pool.size());
+		memcpy(out.data(), &header, sizeof(header));
+		return out;
+	}
+
+	// Read the records of a text file, skipping comments and empty lines
+	QStringList readRecords(const QString& textFilePath)
+	{
+		QFile file(textFilePath);
+		if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+		{
+			qWarning() << "WARNING - could not open" << QDir::toNativeSeparators(textFilePath);
+			return QStringList();
+		}
+		return QString::fromUtf8(file.readAll()).split('\n');
+	}
+
+	inline bool isComment(const QString& record)
+	{
+		return record.startsWith("//") || record.startsWith("#") || record.isEmpty();
+	}
+
+	QByteArray compileGcvs(const QString& gcvsFile)
+	{
+		const QStringList& allRecords = readRecords(gcvsFile);
+		if (allRecords.isEmpty())
+			return QByteArray();
+
+		StringPool strings;
+		QVector<StarMetadataTable::GcvsRecord> records;
+		QVector<IndexEntry> indexes[3];
+		QSet<quint32> hips;
+
+		int readOk=0;
+		int totalRecords=0;
+		int lineNumber=0;
+
+		// record structure is delimited with a tab character.
+		foreach(const QString& record, allRecords)
+		{
+			++lineNumber;
+			if (isComment(record))
+				continue;
+
+			++totalRecords;
+			const QStringList& fields = record.split('\t');
+
+			bool ok;
+			unsigned int hip = fields.at(0).toUInt(&ok);
+			if (!ok)
+			{
+				qWarning() << "WARNING - parse error at line" << lineNumber << "in" << QDir::toNativeSeparators(gcvsFile)
+					   << " - failed to convert " << fields.at(0) << "to a number";
+				continue;
+			}
+			if (fields.size()<12)
+			{
+				qWarning() << "WARNING - parse error at line" << lineNumber << "in" << QDir::toNativeSeparators(gcvsFile)
+					   << " - record does not match record pattern";
+				continue;
+			}
+
+			// Don't set the star if it's already set
+			if (hips.contains(hip))
+				continue;
+			hips.insert(hip);
+
+			StarMetadataTable::GcvsRecord variableStar;
+			variableStar.hip = hip;
+			const QString designation = fields.at(1).trimmed();
+			variableStar.designation = strings.add(designation);
+			variableStar.vtype = strings.add(fields.at(2).trimmed());
+			if (fields.at(3).isEmpty())
+				variableStar.maxmag = 99.f;
+			else
+				variableStar.maxmag = fields.at(3).toFloat();
+			variableStar.mflag = fields.at(4).toInt();
+			if (fields.at(5).isEmpty())
+				variableStar.min1mag = 99.f;
+			else
+				variableStar.min1mag = fields.at(5).toFloat();
+			if (fields.at(6).isEmpty())
+				variableStar.min2mag = 99.f;
+			else
+				variableStar.min2mag = fields.at(6).toFloat();
+			variableStar.photosys = strings.add(fields.at(7).trimmed());
+			variableStar.epoch = fields.at(8).toDouble();
+			variableStar.period = fields.at(9).toDouble();
+			variableStar.Mm = fields.at(10).toInt();
+			variableStar.stype = strings.add(fields.at(11).trimmed());
+
+			records.append(variableStar);
+			IndexEntry name = {strings.add(designation.toUpper()), hip};
+			indexes[0].append(name);
+			++readOk;
+		}
+
+		std::stable_sort(records.begin(), records.end(), RecordHipLess<StarMetadataTable::GcvsRecord>());
+		sortIndex(indexes[0], IndexNameLess(strings.pool.constData()));
+		qDebug() << "Compiled" << readOk << "/" << totalRecords << "variable stars";
+		return assemble(StarMetadataTable::Gcvs, records, indexes, strings);
+	}
+
+	QByteArray compileWds(const QString& wdsFile)
+	{
+		const QStringList& allRecords = readRecords(wdsFile);
+		if (allRecords.isEmpty())
+			return QByteArray();
+
+		StringPool strings;
+		QVector<StarMetadataTable::WdsRecord> records;
+		QVector<IndexEntry> indexes[3];
+		QSet<quint32> hips;
+
+		int readOk=0;
+		int totalRecords=0;
+		int lineNumber=0;
+
+		// record structure is delimited with a tab character.
+		foreach(const QString& record, allRecords)
+		{
+			++lineNumber;
+			if (isComment(record))
+				continue;
+
+			++totalRecords;
+			const QStringList& fields = record.split('\t');
+
+			bool ok;
+			unsigned int hip = fields.at(0).toUInt(&ok);
+			if (!ok)
+			{
+				qWarning() << "WARNING - parse error at line" << lineNumber << "in" << QDir::toNativeSeparators(wdsFile)
+					   << " - failed to convert " << fields.at(0) << "to a number";
+				continue;
+			}
+			if (fields.size()<5)
+			{
+				qWarning() << "WARNING - parse error at line" << lineNumber << "in" << QDir::toNativeSeparators(wdsFile)
+					   << " - record does not match record pattern";
+				continue;
+			}
+
+			// Don't set the star if it's already set
+			if (hips.contains(hip))
+				continue;
+			hips.insert(hip);
+
+			StarMetadataTable::WdsRecord doubleStar;
+			doubleStar.hip = hip;
+			const QString designation = fields.at(1).trimmed();
+			doubleStar.designation = strings.add(designation);
+			doubleStar.observation = fields.at(2).toInt();
+			doubleStar.positionAngle = fields.at(3).toFloat();
+			doubleStar.separation = fields.at(4).toFloat();
+
+			records.append(doubleStar);
+			IndexEntry name = {strings.add(QString("WDS J%1").arg(designation.toUpper())), hip};
+			indexes[0].append(name);
+			++readOk;
+		}
+
+		std::stable_sort(records.begin(), records.end(), RecordHipLess<StarMetadataTable::WdsRecord>());
+		sortIndex(indexes[0], IndexNameLess(strings.pool.constData()));
+		qDebug() << "Compiled" << readOk << "/" << totalRecords << "double stars";
+		return assemble(StarMetadataTable::Wds, records, indexes, strings);
+	}
+
+	QByteArray compileCrossId(const QString& crossIdFile)
+	{
+		const QStringList& allRecords = readRecords(crossIdFile);
+		if (allRecords.isEmpty())
+			return QByteArray();
+
+		StringPool strings;
+		QVector<StarMetadataTable::CrossIdRecord> records;
+		QVector<IndexEntry> indexes[3];
+
+		int readOk=0;
+		int totalRecords=0;
+		int lineNumber=0;
+		// record structure is delimited with a 'tab' character. Example record strings:
+		// "1	128522	224700"
+		// "2	165988	224690"
+		foreach(const QString& record, allRecords)
+		{
+			++lineNumber;
+			if (isComment(record))
+				continue;
+
+			++totalRecords;
+			const QStringList& fields = record.split('\t');
+			if (fields.size()!=5)
+			{
+				qWarning() << "WARNING - parse error at line" << lineNumber << "in" << QDir::toNativeSeparators(crossIdFile)
+					   << " - record does not match record pattern";
+				continue;
+			}
+
+			// The record is the right format.  Extract the fields
+			bool ok;
+			unsigned int hip = fields.at(0).toUInt(&ok);
+			if (!ok)
+			{
+				qWarning() << "WARNING - parse error at line" << lineNumber << "in" << QDir::toNativeSeparators(crossIdFile)
+					   << " - failed to convert " << fields.at(0) << "to a number";
+				continue;
+			}
+
+			StarMetadataTable::CrossIdRecord crossIdData;
+			crossIdData.hip = hip;
+			crossIdData.component = strings.add(fields.at(1).trimmed());
+			crossIdData.sao = fields.at(2).toUInt(&ok);
+			crossIdData.hd = fields.at(3).toUInt(&ok);
+			crossIdData.hr = fields.at(4).toUInt(&ok);
+			records.append(crossIdData);
+
+			const quint32 numbers[3] = {crossIdData.sao, crossIdData.hd, crossIdData.hr};
+			for (int i=0;i<3;++i)
+			{
+				if (numbers[i]>0)
+				{
+					IndexEntry entry = {numbers[i], hip};
+					indexes[i].append(entry);
+				}
+			}
+			++readOk;
+		}
+
+		// A later record of the same star replaces the earlier one
+		std::stable_sort(records.begin(), records.end(), CrossIdLess());
+		QVector<StarMetadataTable::CrossIdRecord> unique;
+		unique.reserve(records.size());
+		for (int i=0;i<records.size();++i)
+		{
+			if (i+1<records.size() && !CrossIdLess()(records.at(i), records.at(i+1)))
+				continue;
+			unique.append(records.at(i));
+		}
+		for (int i=0;i<3;++i)
+			sortIndex(indexes[i], IndexEntryLess());
+		qDebug() << "Compiled" << readOk << "/" << totalRecords << "cross-identification data records for stars";
+		return assemble(StarMetadataTable::CrossId, unique, indexes, strings);
+	}
+}
+
+StarMetadataTable::StarMetadataTable()
+	: file(Q_NULLPTR)
+	, data(Q_NULLPTR)
+	, header(Q_NULLPTR)
+{
+}
+
+StarMetadataTable::~StarMetadataTable()
+{
+	clear();
+}
+
+void StarMetadataTable::clear()
+{
+	data = Q_NULLPTR;
+	header = Q_NULLPTR;
+	buffer.clear();
+	if (file)
+	{
+		file->close();
+		delete file;
+		file = Q_NULLPTR;
+	}
+}
+
+QString StarMetadataTable::getBinaryPath(const QString& textFilePath)
+{
+	// The name changes with the text file, so that an edited file is compiled again
+	const QFileInfo info(textFilePath);
+	return StelFileMgr::getCacheDir() + "/stars/" + info.completeBaseName()
+		+ QString("_%1_%2.smd").arg(info.size()).arg(info.lastModified().toTime_t());
+}
+
+QByteArray StarMetadataTable::compile(const QString& textFilePath, Kind kind)
+{
+	qDebug() << "Compiling star metadata from" << QDir::toNativeSeparators(textFilePath);
+	switch (kind)
+	{
+		case Gcvs:
+			return compileGcvs(textFilePath);
+		case Wds:
+			return compileWds(textFilePath);
+		case CrossId:
+			return compileCrossId(textFilePath);
+	}
+	return QByteArray();
+}
+
+bool StarMetadataTable::writeBinary(const QString& binaryPath, const QByteArray& content)
+{
+	const QString cacheDir = StelFileMgr::dirName(binaryPath);
+	try
+	{
+		StelFileMgr::makeSureDirExistsAndIsWritable(cacheDir);
+	}
+	catch (std::runtime_error& e)
+	{
+		qWarning() << "Cannot write compiled star metadata:" << e.what();
+		return false;
+	}
+
+	// Remove outdated versions compiled from the same text file
+	const QString name = QFileInfo(binaryPath).fileName();
+	const QString prefix = name.left(name.lastIndexOf('_', name.lastIndexOf('_')-1)+1);
+	foreach (const QString& oldVersion, QDir(cacheDir).entryList(QStringList(prefix + "*.smd"), QDir::Files))
+		QFile::remove(cacheDir + "/" + oldVersion);
+
+	QSaveFile out(binaryPath);
+	if (!out.open(QIODevice::WriteOnly) || out.write(content)!=content.size() || !out.commit())
+	{
+		qWarning() << "Cannot write compiled star metadata" << QDir::toNativeSeparators(binaryPath) << out.errorString();
+		return false;
+	}
+	return true;
+}
+
+bool StarMetadataTable::load(const QString& textFilePath, Kind kind)
+{
+	clear();
+
+	const QString binaryPath = getBinaryPath(textFilePath);
+	if (QFileInfo(binaryPath).exists())
+	{
+		file = new QFile(binaryPath);
+		if (file->open(QIODevice::ReadOnly))
+		{
+			const uchar* mapped = file->map(0, file->size());
+			if (mapped && attach(mapped, file->size(), kind))
+			{
+				qDebug() << "Loaded" << size() << "star metadata records from" << QDir::toNativeSeparators(binaryPath);
+				return true;
+			}
+		}
+		qWarning() << "WARNING - invalid compiled star metadata" << QDir::toNativeSeparators(binaryPath);
+		clear();
+	}
+
+	const QByteArray content = compile(textFilePath, kind);
+	if (content.isEmpty())
+		return false;
+
+	if (writeBinary(binaryPath, content))
+	{
+		file = new QFile(binaryPath);
+		if (file->open(QIODevice::ReadOnly))
+		{
+			const uchar* mapped = file->map(0, file->size());
+			if (mapped && attach(mapped, file->size(), kind))
+				return true;
+		}
+		clear();
+	}
+
+	// Keep the compiled table in memory
+	buffer = content;
+	return attach(reinterpret_cast<const uchar*>(buffer.constData()), buffer.size(), kind);
+}
+
+bool StarMetadataTable::attach(const uchar* d, qint64 size, Kind kind)
+{
+	if (size<(qint64)sizeof(Header))
+		return false;
+	const Header* h = reinterpret_cast<const Header*>(d);
+	if (h->magic!=STAR_METADATA_MAGIC || h->version!=STAR_METADATA_VERSION || h->kind!=(quint32)kind)
+		return false;
+
+	quint32 recordSize = 0;
+	switch (kind)
+	{
+		case Gcvs:
+			recordSize = sizeof(GcvsRecord);
+			break;
+		case Wds:
+			recordSize = sizeof(WdsRecord);
+			break;
+		case CrossId:
+			recordSize = sizeof(CrossIdRecord);
+			break;
+	}
+	if (h->recordSize!=recordSize)
+		return false;
+
+	// All sections must be within the file, and the string pool must end with a null character
+	if ((qint64)h->recordsOffset + (qint64)h->recordSize*h->recordCount > size)
+		return false;
+	for (int i=0;i<3;++i)
+	{
+		if ((qint64)h->indexOffset[i] + (qint64)sizeof(IndexEntry)*h->indexCount[i] > size)
+			return false;
+	}
+	if (h->stringsSize==0 || (qint64)h->stringsOffset + h->stringsSize > size || d[h->stringsOffset+h->stringsSize-1]!='\0')
+		return false;
+
+	data = d;
+	header = h;
+	return true;
+}
+
+int StarMetadataTable::size() const
+{
+	return header ? header->recordCount : 0;
+}
+
+QString StarMetadataTable::string(quint32 offset) const
+{
+	if (!header || offset>=header->stringsSize)
+		return QString();
+	return QString::fromUtf8(reinterpret_cast<const char*>(data + header->stringsOffset + offset));
+}
+
+const StarMetadataTable::GcvsRecord* StarMetadataTable::findGcvs(int hip) const
+{
+	if (!header || header->kind!=Gcvs)
+		return Q_NULLPTR;
+	const GcvsRecord* begin = reinterpret_cast<const GcvsRecord*>(data + header->recordsOffset);
+	const GcvsRecord* end = begin + header->recordCount;
+	const GcvsRecord* it = std::lower_bound(begin, end, (quint32)hip, RecordHipLess<GcvsRecord>());
+	return (it!=end && it->hip==(quint32)hip) ? it : Q_NULLPTR;
+}
+
+const StarMetadataTable::WdsRecord* StarMetadataTable::findWds(int hip) const
+{
+	if (!header || header->kind!=Wds)
+		return Q_NULLPTR;
+	const WdsRecord* begin = reinterpret_cast<const WdsRecord*>(data + header->recordsOffset);
+	const WdsRecord* end = begin + header->recordCount;
+	const WdsRecord* it = std::lower_bound(begin, end, (quint32)hip, RecordHipLess<WdsRecord>());
+	return (it!=end && it->hip==(quint32)hip) ? it : Q_NULLPTR;
+}
+
+const StarMetadataTable::CrossIdRecord* StarMetadataTable::findCrossId(int hip, const QString& component) const
+{
+	if (!header || header->kind!=CrossId)
+		return Q_NULLPTR;
+	const CrossIdRecord* begin = reinterpret_cast<const CrossIdRecord*>(data + header->recordsOffset);
+	const CrossIdRecord* end = begin + header->recordCount;
+	const CrossIdRecord* it = std::lower_bound(begin, end, (quint32)hip, RecordHipLess<CrossIdRecord>());
+	// A star has only a few components
+	for (;it!=end && it->hip==(quint32)hip;++it)
+	{
+		if (string(it->component)==component)
+			return it;
+	}
+	return Q_NULLPTR;
+}
+
+const StarMetadataTable::IndexEntry* StarMetadataTable::indexBegin(int index) const
+{
+	return reinterpret_cast<const IndexEntry*>(data + header->indexOffset[index]);
+}
+
+const StarMetadataTable::IndexEntry* StarMetadataTable::indexEnd(int index) const
+{
+	return indexBegin(index) + header->indexCount[index];
+}
+
+int StarMetadataTable::findHipByName(const QString& upperName) const
+{
+	if (!header || header->kind==CrossId)
+		return -1;
+	const QByteArray name = upperName.toUtf8();
+	const IndexNameLess less(reinterpret_cast<const char*>(data + header->stringsOffset));
+	const IndexEntry* it = std::lower_bound(indexBegin(0), indexEnd(0), name.constData(), less);
+	if (it!=indexEnd(0) && !less(name.constData(), *it))
+		return it->hip;
+	return -1;
+}
+
+QList<int> StarMetadataTable::findHipsByNamePrefix(const QString& upperPrefix, int maxNbItem) const
+{
+	QList<int> result;
+	if (!header || header->kind==CrossId)
+		return result;
+	const QByteArray prefix = upperPrefix.toUtf8();
+	const char* strings = reinterpret_cast<const char*>(data + header->stringsOffset);
+	const IndexEntry* end = indexEnd(0);
+	// Names starting with the prefix follow each other in the index
+	for (const IndexEntry* it = std::lower_bound(indexBegin(0), end, prefix.constData(), IndexNameLess(strings));
+	     it!=end && result.size()<maxNbItem; ++it)
+	{
+		if (qstrncmp(strings + it->key, prefix.constData(), prefix.size())!=0)
+			break;
+		result << it->hip;
+	}
+	return result;
+}
+
+int StarMetadataTable::findHipByNumber(NumberIndex index, unsigned int number) const
+{
+	if (!header || header->kind!=CrossId)
+		return -1;
+	const IndexEntry key = {number, 0};
+	const IndexEntry* it = std::lower_bound(indexBegin(index), indexEnd(index), key, IndexEntryLess());
+	if (it!=indexEnd(index) && it->key==number)
+		return it->hip;
+	return -1;
+}
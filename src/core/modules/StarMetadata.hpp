@@ -0,0 +1,184 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STARMETADATA_HPP_
+#define _STARMETADATA_HPP_
+
+#include <QString>
+#include <QByteArray>
+#include <QList>
+
+class QFile;
+
+//! @class StarMetadataTable
+//! A table of metadata about Hipparcos stars (GCVS, WDS or cross-identification
+//! data), stored in a compact binary format.
+//! The binary file holds fixed-width records sorted by HIP number, sorted
+//! indexes and a pool of interned UTF-8 strings. It is compiled from the text
+//! file shipped with Stellarium into the cache directory, and recompiled
+//! whenever the text file changes. The binary file is then mmapped, so that
+//! lookups are binary searches in the mapping and nothing is parsed at startup.
+class StarMetadataTable
+{
+public:
+	//! The text file a table is compiled from
+	enum Kind
+	{
+		Gcvs	= 1,	//!< gcvs_hip_part.dat
+		Wds	= 2,	//!< wds_hip_part.dat
+		CrossId	= 3	//!< cross-id.dat
+	};
+
+	//! The catalog numbers indexed by a CrossId table
+	enum NumberIndex
+	{
+		SaoIndex = 0,
+		HdIndex = 1,
+		HrIndex = 2
+	};
+
+	//! A GCVS record. Strings are offsets into the string pool, see string().
+	struct GcvsRecord
+	{
+		double epoch;		//! Epoch for maximum light (Julian days)
+		double period;		//! Period of the variable star (days)
+		quint32 hip;
+		quint32 designation;	//! GCVS designation
+		quint32 vtype;		//! Type of variability
+		quint32 photosys;	//! The photometric system for magnitudes
+		quint32 stype;		//! Spectral type
+		float maxmag;		//! Magnitude at maximum brightness
+		float min1mag;		//! First minimum magnitude or amplitude
+		float min2mag;		//! Second minimum magnitude or amplitude
+		qint32 mflag;		//! Magnitude flag code
+		qint32 Mm;		//! Rising time or duration of eclipse (%)
+	};
+
+	//! A WDS record. Strings are offsets into the string pool, see string().
+	struct WdsRecord
+	{
+		quint32 hip;
+		quint32 designation;	//! WDS designation
+		qint32 observation;	//! Date of last satisfactory observation, yr
+		float positionAngle;	//! Position Angle at date of last satisfactory observation, deg
+		float separation;	//! Separation at date of last satisfactory observation, arcsec
+	};
+
+	//! A cross-identification record. Strings are offsets into the string pool, see string().
+	struct CrossIdRecord
+	{
+		quint32 hip;
+		quint32 component;	//! Component of a multiple star, or empty
+		quint32 sao;
+		quint32 hd;
+		quint32 hr;
+	};
+
+	StarMetadataTable();
+	~StarMetadataTable();
+
+	//! Load a table, compiling the text file into its binary form first if needed.
+	//! If the binary form cannot be written, it is only kept in memory.
+	//! @param textFilePath path of the text file the table is compiled from
+	//! @param kind the format of the text file
+	//! @return false if the table could not be loaded, in which case it is empty.
+	bool load(const QString& textFilePath, Kind kind);
+
+	//! Unload the table.
+	void clear();
+
+	//! Get the number of records of the table.
+	int size() const;
+
+	//! Get the record of a star in a Gcvs table, or Q_NULLPTR if there is none.
+	const GcvsRecord* findGcvs(int hip) const;
+	//! Get the record of a star in a Wds table, or Q_NULLPTR if there is none.
+	const WdsRecord* findWds(int hip) const;
+	//! Get the record of a star or one of its components in a CrossId table, or Q_NULLPTR if there is none.
+	//! @param component the component ID, empty for the star itself
+	const CrossIdRecord* findCrossId(int hip, const QString& component) const;
+
+	//! Get a string from the string pool.
+	QString string(quint32 offset) const;
+
+	//! Find a star by designation in a Gcvs or Wds table.
+	//! @param upperName the designation in upper case, prefixed by "WDS J" for WDS designations
+	//! @return the HIP number of the star, or -1 if there is none.
+	int findHipByName(const QString& upperName) const;
+
+	//! Find stars whose designations start with a prefix in a Gcvs or Wds table.
+	//! @param upperPrefix the prefix in upper case
+	//! @param maxNbItem the maximum number of stars to return
+	//! @return the HIP numbers of the stars, sorted by designation.
+	QList<int> findHipsByNamePrefix(const QString& upperPrefix, int maxNbItem) const;
+
+	//! Find a star by SAO, HD or HR number in a CrossId table.
+	//! @return the HIP number of the star, or -1 if there is none.
+	int findHipByNumber(NumberIndex index, unsigned int number) const;
+
+	//! Header of the binary file. All offsets are counted from the start of the file.
+	struct Header
+	{
+		quint32 magic;
+		quint32 version;
+		quint32 kind;
+		quint32 recordSize;
+		quint32 recordCount;
+		quint32 recordsOffset;
+		quint32 indexCount[3];
+		quint32 indexOffset[3];
+		quint32 stringsOffset;
+		quint32 stringsSize;
+		quint32 reserved[2];
+	};
+
+	//! An entry of a sorted index: either a string offset or a catalog number, and a HIP number.
+	struct IndexEntry
+	{
+		quint32 key;
+		quint32 hip;
+	};
+
+private:
+	Q_DISABLE_COPY(StarMetadataTable)
+
+	//! Get the path of the binary form of a text file in the cache directory.
+	static QString getBinaryPath(const QString& textFilePath);
+
+	//! Compile a text file into the binary format.
+	//! @return the binary file content, or an empty array if the text file could not be read.
+	static QByteArray compile(const QString& textFilePath, Kind kind);
+
+	//! Write the binary form of a text file and remove outdated versions of it.
+	static bool writeBinary(const QString& binaryPath, const QByteArray& content);
+
+	//! Check the layout of binary data and use it as the table content.
+	bool attach(const uchar* data, qint64 size, Kind kind);
+
+	//! Get the sorted entries of one of the indexes.
+	const IndexEntry* indexBegin(int index) const;
+	const IndexEntry* indexEnd(int index) const;
+
+	QFile* file;		// the mmapped binary file
+	QByteArray buffer;	// the binary content when it could not be mmapped
+	const uchar* data;
+	const Header* header;
+};
+
+#endif // _STARMETADATA_HPP_
@@ -58,6 +58,7 @@
 #include <QCryptographicHash>
 
 #include <errno.h>
+#include <limits>
 
 static QStringList spectral_array;
 static QStringList component_array;
@@ -81,14 +82,9 @@ QHash<int,QString> StarMgr::sciNamesMapI18n;
 QMap<QString,int> StarMgr::sciNamesIndexI18n;
 QHash<int,QString> StarMgr::sciAdditionalNamesMapI18n;
 QMap<QString,int> StarMgr::sciAdditionalNamesIndexI18n;
-QHash<int, varstar> StarMgr::varStarsMapI18n;
-QMap<QString, int> StarMgr::varStarsIndexI18n;
-QHash<int, wds> StarMgr::wdsStarsMapI18n;
-QMap<QString, int> StarMgr::wdsStarsIndexI18n;
-QMap<QString, crossid> StarMgr::crossIdMap;
-QMap<int, int> StarMgr::saoStarsIndex;
-QMap<int, int> StarMgr::hdStarsIndex;
-QMap<int, int> StarMgr::hrStarsIndex;
+StarMetadataTable StarMgr::gcvsTable;
+StarMetadataTable StarMgr::wdsTable;
+StarMetadataTable StarMgr::crossIdTable;
 QHash<int, QString> StarMgr::referenceMap;
 
 QStringList initStringListFromFile(const QString& file_name)
@@ -139,6 +135,7 @@ StarMgr::StarMgr(void)
 	: flagStarName(false)
 	, labelsAmount(0.)
 	, gravityLabel(false)
+	, flagGpuStars(false)
 	, hipIndex(new HipIndexStruct[NR_OF_HIP+1])
 {
 	setObjectName("StarMgr");
@@ -229,13 +226,18 @@ QString StarMgr::getSciAdditionalName(int hip)
 QString StarMgr::getCrossIdentificationDesignations(QString hip)
 {
 	QString designations;
-	QMap<QString, crossid>::const_iterator cr(crossIdMap.find(hip));
-	if (cr==crossIdMap.end() && hip.right(1).toUInt()==0)
-		cr = crossIdMap.find(hip.left(hip.size()-1));
-
-	if (cr!=crossIdMap.end())
-	{
-		crossid crossIdData = cr.value();
+	// The key is the HIP number followed by the component ID, if any
+	int digits = 0;
+	while (digits<hip.size() && hip.at(digits).isDigit())
+		++digits;
+	const int hipNumber = hip.left(digits).toInt();
+	const StarMetadataTable::CrossIdRecord* cr = crossIdTable.findCrossId(hipNumber, hip.mid(digits));
+	if (cr==Q_NULLPTR && digits<hip.size())
+		cr = crossIdTable.findCrossId(hipNumber, hip.mid(digits, hip.size()-1-digits));
+
+	if (cr!=Q_NULLPTR)
+	{
+		const StarMetadataTable::CrossIdRecord& crossIdData = *cr;
 		if (crossIdData.sao>0)
 			designations = QString("SAO %1").arg(crossIdData.sao);
 
@@ -261,81 +263,81 @@ QString StarMgr::getCrossIdentificationDesignations(QString hip)
 
 QString StarMgr::getWdsName(int hip)
 {
-	QHash<int,wds>::const_iterator it(wdsStarsMapI18n.find(hip));
-	if (it!=wdsStarsMapI18n.end())
-		return QString("WDS J%1").arg(it.value().designation);
+	const StarMetadataTable::WdsRecord* it = wdsTable.findWds(hip);
+	if (it)
+		return QString("WDS J%1").arg(wdsTable.string(it->designation));
 	return QString();
 }
 
 int StarMgr::getWdsLastObservation(int hip)
 {
-	QHash<int,wds>::const_iterator it(wdsStarsMapI18n.find(hip));
-	if (it!=wdsStarsMapI18n.end())
-		return it.value().observation;
+	const StarMetadataTable::WdsRecord* it = wdsTable.findWds(hip);
+	if (it)
+		return it->observation;
 	return 0;
 }
 
 int StarMgr::getWdsLastPositionAngle(int hip)
 {
-	QHash<int,wds>::const_iterator it(wdsStarsMapI18n.find(hip));
-	if (it!=wdsStarsMapI18n.end())
-		return it.value().positionAngle;
+	const StarMetadataTable::WdsRecord* it = wdsTable.findWds(hip);
+	if (it)
+		return it->positionAngle;
 	return 0;
 }
 
 float StarMgr::getWdsLastSeparation(int hip)
 {
-	QHash<int,wds>::const_iterator it(wdsStarsMapI18n.find(hip));
-	if (it!=wdsStarsMapI18n.end())
-		return it.value().separation;
+	const StarMetadataTable::WdsRecord* it = wdsTable.findWds(hip);
+	if (it)
+		return it->separation;
 	return 0.f;
 }
 
 QString StarMgr::getGcvsName(int hip)
 {
-	QHash<int,varstar>::const_iterator it(varStarsMapI18n.find(hip));
-	if (it!=varStarsMapI18n.end())
-		return it.value().designation;
+	const StarMetadataTable::GcvsRecord* it = gcvsTable.findGcvs(hip);
+	if (it)
+		return gcvsTable.string(it->designation);
 	return QString();
 }
 
 QString StarMgr::getGcvsVariabilityType(int hip)
 {
-	QHash<int,varstar>::const_iterator it(varStarsMapI18n.find(hip));
-	if (it!=varStarsMapI18n.end())
-		return it.value().vtype;
+	const StarMetadataTable::GcvsRecord* it = gcvsTable.findGcvs(hip);
+	if (it)
+		return gcvsTable.string(it->vtype);
 	return QString();
 }
 
 float StarMgr::getGcvsMaxMagnitude(int hip)
 {
-	QHash<int,varstar>::const_iterator it(varStarsMapI18n.find(hip));
-	if (it!=varStarsMapI18n.end())
-		return it.value().maxmag;
+	const StarMetadataTable::GcvsRecord* it = gcvsTable.findGcvs(hip);
+	if (it)
+		return it->maxmag;
 	return -99.f;
 }
 
 int StarMgr::getGcvsMagnitudeFlag(int hip)
 {
-	QHash<int,varstar>::const_iterator it(varStarsMapI18n.find(hip));
-	if (it!=varStarsMapI18n.end())
-		return it.value().mflag;
+	const StarMetadataTable::GcvsRecord* it = gcvsTable.findGcvs(hip);
+	if (it)
+		return it->mflag;
 	return 0;
 }
 
 
 float StarMgr::getGcvsMinMagnitude(int hip, bool firstMinimumFlag)
 {
-	QHash<int,varstar>::const_iterator it(varStarsMapI18n.find(hip));
-	if (it!=varStarsMapI18n.end())
+	const StarMetadataTable::GcvsRecord* it = gcvsTable.findGcvs(hip);
+	if (it)
 	{
 		if (firstMinimumFlag)
 		{
-			return it.value().min1mag;
+			return it->min1mag;
 		}
 		else
 		{
-			return it.value().min2mag;
+			return it->min2mag;
 		}
 	}
 	return -99.f;
@@ -343,33 +345,33 @@ float StarMgr::getGcvsMinMagnitude(int hip, bool firstMinimumFlag)
 
 QString StarMgr::getGcvsPhotometricSystem(int hip)
 {
-	QHash<int,varstar>::const_iterator it(varStarsMapI18n.find(hip));
-	if (it!=varStarsMapI18n.end())
-		return it.value().photosys;
+	const StarMetadataTable::GcvsRecord* it = gcvsTable.findGcvs(hip);
+	if (it)
+		return gcvsTable.string(it->photosys);
 	return QString();
 }
 
 double StarMgr::getGcvsEpoch(int hip)
 {
-	QHash<int,varstar>::const_iterator it(varStarsMapI18n.find(hip));
-	if (it!=varStarsMapI18n.end())
-		return it.value().epoch;
+	const StarMetadataTable::GcvsRecord* it = gcvsTable.findGcvs(hip);
+	if (it)
+		return it->epoch;
 	return -99.f;
 }
 
 double StarMgr::getGcvsPeriod(int hip)
 {
-	QHash<int,varstar>::const_iterator it(varStarsMapI18n.find(hip));
-	if (it!=varStarsMapI18n.end())
-		return it.value().period;
+	const StarMetadataTable::GcvsRecord* it = gcvsTable.findGcvs(hip);
+	if (it)
+		return it->period;
 	return -99.f;
 }
 
 int StarMgr::getGcvsMM(int hip)
 {
-	QHash<int,varstar>::const_iterator it(varStarsMapI18n.find(hip));
-	if (it!=varStarsMapI18n.end())
-		return it.value().Mm;
+	const StarMetadataTable::GcvsRecord* it = gcvsTable.findGcvs(hip);
+	if (it)
+		return it->Mm;
 	return -99;
 }
 
@@ -390,11 +392,8 @@ void StarMgr::copyDefaultConfigFile()
 	}
 }
 
-void StarMgr::init()
+void StarMgr::preload()
 {
-	QSettings* conf = StelApp::getInstance().getSettings();
-	Q_ASSERT(conf);
-
 	starConfigFileFullPath = StelFileMgr::findFile("stars/default/starsConfig.json", StelFileMgr::Flags(StelFileMgr::Writable|StelFileMgr::File));
 	if (starConfigFileFullPath.isEmpty())
 	{
@@ -426,6 +425,13 @@ void StarMgr::init()
 	loadData(starSettings);
 
 	populateStarsDesignations();
+}
+
+void StarMgr::init()
+{
+	QSettings* conf = StelApp::getInstance().getSettings();
+	Q_ASSERT(conf);
+
 	populateHipparcosLists();
 
 	starFont.setPixelSize(StelApp::getInstance().getBaseFontSize());
@@ -433,6 +439,7 @@ void StarMgr::init()
 	setFlagStars(conf->value("astro/flag_stars", true).toBool());
 	setFlagLabels(conf->value("astro/flag_star_name",true).toBool());
 	setLabelsAmount(conf->value("stars/labels_amount",3.f).toFloat());
+	setFlagGpuStars(conf->value("stars/flag_gpu_stars", false).toBool());
 
 	// Load colors from config file
 	QString defaultColor = conf->value("color/default_color").toString();
@@ -544,7 +551,7 @@ bool StarMgr::checkAndLoadCatalog(const QVariantMap& catDesc)
 		}
 	}
 
-	ZoneArray* z = ZoneArray::create(catalogFilePath, true);
+	ZoneArray* z = ZoneArray::create(catalogFilePath, true, catDesc.value("checksum").toString());
 	if (z)
 	{
 		if (z->level<gridLevels.size())
@@ -593,6 +600,14 @@ void StarMgr::loadData(QVariantMap starsConfig)
 
 	qDebug() << "Loading star data ...";
 
+	// Memory budget for the decoded (structure of arrays) copies of the star zones.
+	// Machines with little RAM may set it to 0 to keep using the packed catalogs only.
+	ZoneArray::setDecodedCacheBudget(starsConfig.value("decodedCacheBudgetMb", 256).toInt());
+	// GPU memory budget for the static vertex buffers of the faint stars, see stars/flag_gpu_stars
+	ZoneArray::setGpuBufferBudget(starsConfig.value("gpuBufferBudgetMb", 256).toInt());
+	// In lazy mode, the stars of the faint catalogs are only read when first needed
+	ZoneArray::setLazyLoading(starsConfig.value("lazyLoading", false).toBool(), starsConfig.value("lazyLoadingBudgetMb", 512).toInt());
+
 	catalogsDescription = starsConfig.value("catalogs").toList();
 	foreach (const QVariant& catV, catalogsDescription)
 	{
@@ -600,6 +615,14 @@ void StarMgr::loadData(QVariantMap starsConfig)
 		checkAndLoadCatalog(m);
 	}
 
+	// Zones are decoded lazily when they become visible, unless requested at load time
+	if (starsConfig.value("decodedCachePreload", false).toBool())
+	{
+		foreach(ZoneArray* z, gridLevels)
+			z->decodeAllZones();
+		qDebug() << "Decoded star cache uses" << ZoneArray::getDecodedCacheUsage() << "kB";
+	}
+
 	for (int i=0; i<=NR_OF_HIP; i++)
 	{
 		hipIndex[i].a = 0;
@@ -877,208 +900,25 @@ void StarMgr::loadSciNames(const QString& sciNameFile)
 // Load GCVS from file
 void StarMgr::loadGcvs(const QString& GcvsFile)
 {
-	varStarsMapI18n.clear();
-	varStarsIndexI18n.clear();
-
 	qDebug() << "Loading variable stars from" << QDir::toNativeSeparators(GcvsFile);
-	QFile vsFile(GcvsFile);
-	if (!vsFile.open(QIODevice::ReadOnly | QIODevice::Text))
-	{
-		qWarning() << "WARNING - could not open" << QDir::toNativeSeparators(GcvsFile);
-		return;
-	}
-	const QStringList& allRecords = QString::fromUtf8(vsFile.readAll()).split('\n');
-	vsFile.close();
-
-	int readOk=0;
-	int totalRecords=0;
-	int lineNumber=0;
-
-	// record structure is delimited with a tab character.
-	foreach(const QString& record, allRecords)
-	{
-		++lineNumber;
-		// skip comments and empty lines
-		if (record.startsWith("//") || record.startsWith("#") || record.isEmpty())
-			continue;
-
-		++totalRecords;
-		const QStringList& fields = record.split('\t');
-
-		bool ok;
-		unsigned int hip = fields.at(0).toUInt(&ok);
-		if (!ok)
-		{
-			qWarning() << "WARNING - parse error at line" << lineNumber << "in" << QDir::toNativeSeparators(GcvsFile)
-				   << " - failed to convert " << fields.at(0) << "to a number";
-			continue;
-		}
-
-		// Don't set the star if it's already set
-		if (varStarsMapI18n.find(hip)!=varStarsMapI18n.end())
-			continue;
-
-		varstar variableStar;
-
-		variableStar.designation = fields.at(1).trimmed();
-		variableStar.vtype = fields.at(2).trimmed();
-		if (fields.at(3).isEmpty())
-			variableStar.maxmag = 99.f;
-		else
-			variableStar.maxmag = fields.at(3).toFloat();
-		variableStar.mflag = fields.at(4).toInt();
-		if (fields.at(5).isEmpty())
-			variableStar.min1mag = 99.f;
-		else
-			variableStar.min1mag = fields.at(5).toFloat();
-		if (fields.at(6).isEmpty())
-			variableStar.min2mag = 99.f;
-		else
-			variableStar.min2mag = fields.at(6).toFloat();
-		variableStar.photosys = fields.at(7).trimmed();
-		variableStar.epoch = fields.at(8).toDouble();
-		variableStar.period = fields.at(9).toDouble();
-		variableStar.Mm = fields.at(10).toInt();
-		variableStar.stype = fields.at(11).trimmed();
-
-		varStarsMapI18n[hip] = variableStar;
-		varStarsIndexI18n[variableStar.designation.toUpper()] = hip;
-		++readOk;
-	}
-
-	qDebug() << "Loaded" << readOk << "/" << totalRecords << "variable stars";
+	if (!gcvsTable.load(GcvsFile, StarMetadataTable::Gcvs))
+		qWarning() << "WARNING - could not load variable stars from" << QDir::toNativeSeparators(GcvsFile);
 }
 
 // Load WDS from file
 void StarMgr::loadWds(const QString& WdsFile)
 {
-	wdsStarsMapI18n.clear();
-	wdsStarsIndexI18n.clear();
-
 	qDebug() << "Loading double stars from" << QDir::toNativeSeparators(WdsFile);
-	QFile dsFile(WdsFile);
-	if (!dsFile.open(QIODevice::ReadOnly | QIODevice::Text))
-	{
-		qWarning() << "WARNING - could not open" << QDir::toNativeSeparators(WdsFile);
-		return;
-	}
-	const QStringList& allRecords = QString::fromUtf8(dsFile.readAll()).split('\n');
-	dsFile.close();
-
-	int readOk=0;
-	int totalRecords=0;
-	int lineNumber=0;
-
-	// record structure is delimited with a tab character.
-	foreach(const QString& record, allRecords)
-	{
-		++lineNumber;
-		// skip comments and empty lines
-		if (record.startsWith("//") || record.startsWith("#") || record.isEmpty())
-			continue;
-
-		++totalRecords;
-		const QStringList& fields = record.split('\t');
-
-		bool ok;
-		unsigned int hip = fields.at(0).toUInt(&ok);
-		if (!ok)
-		{
-			qWarning() << "WARNING - parse error at line" << lineNumber << "in" << QDir::toNativeSeparators(WdsFile)
-				   << " - failed to convert " << fields.at(0) << "to a number";
-			continue;
-		}
-
-		// Don't set the star if it's already set
-		if (wdsStarsMapI18n.find(hip)!=wdsStarsMapI18n.end())
-			continue;
-
-		wds doubleStar;
-
-		doubleStar.designation = fields.at(1).trimmed();
-		doubleStar.observation = fields.at(2).toInt();
-		doubleStar.positionAngle = fields.at(3).toFloat();
-		doubleStar.separation = fields.at(4).toFloat();
-
-		wdsStarsMapI18n[hip] = doubleStar;
-		wdsStarsIndexI18n[QString("WDS J%1").arg(doubleStar.designation.toUpper())] = hip;
-		++readOk;
-	}
-
-	qDebug() << "Loaded" << readOk << "/" << totalRecords << "double stars";
+	if (!wdsTable.load(WdsFile, StarMetadataTable::Wds))
+		qWarning() << "WARNING - could not load double stars from" << QDir::toNativeSeparators(WdsFile);
 }
 
 // Load cross-identification data from file
 void StarMgr::loadCrossIdentificationData(const QString& crossIdFile)
 {
-	crossIdMap.clear();
-	saoStarsIndex.clear();	
-	hdStarsIndex.clear();	
-	hrStarsIndex.clear();
-
 	qDebug() << "Loading cross-identification data from" << QDir::toNativeSeparators(crossIdFile);
-	QFile ciFile(crossIdFile);
-	if (!ciFile.open(QIODevice::ReadOnly | QIODevice::Text))
-	{
-		qWarning() << "WARNING - could not open" << QDir::toNativeSeparators(crossIdFile);
-		return;
-	}
-	const QStringList& allRecords = QString::fromUtf8(ciFile.readAll()).split('\n');
-	ciFile.close();
-
-	crossid crossIdData;
-
-	int readOk=0;
-	int totalRecords=0;
-	int lineNumber=0;
-	// record structure is delimited with a 'tab' character. Example record strings:
-	// "1	128522	224700"
-	// "2	165988	224690"
-	foreach(const QString& record, allRecords)
-	{
-		++lineNumber;
-		// skip comments and empty lines
-		if (record.startsWith("//") || record.startsWith("#") || record.isEmpty())
-			continue;
-
-		++totalRecords;
-		const QStringList& fields = record.split('\t');
-		if (fields.size()!=5)
-		{
-			qWarning() << "WARNING - parse error at line" << lineNumber << "in" << QDir::toNativeSeparators(crossIdFile)
-				   << " - record does not match record pattern";
-			continue;
-		}
-		else
-		{
-			// The record is the right format.  Extract the fields
-			bool ok;
-			unsigned int hip = fields.at(0).toUInt(&ok);
-			if (!ok)
-			{
-				qWarning() << "WARNING - parse error at line" << lineNumber << "in" << QDir::toNativeSeparators(crossIdFile)
-					   << " - failed to convert " << fields.at(0) << "to a number";
-				continue;
-			}
-
-			QString hipstar = QString("%1%2").arg(hip).arg(fields.at(1).trimmed());
-			crossIdData.sao = fields.at(2).toUInt(&ok);
-			crossIdData.hd = fields.at(3).toUInt(&ok);
-			crossIdData.hr = fields.at(4).toUInt(&ok);
-
-			crossIdMap[hipstar] = crossIdData;
-			if (crossIdData.sao>0)
-				saoStarsIndex[crossIdData.sao] = hip;
-			if (crossIdData.hd>0)
-				hdStarsIndex[crossIdData.hd] = hip;
-			if (crossIdData.hr>0)
-				hrStarsIndex[crossIdData.hr] = hip;
-
-			++readOk;
-		}
-	}
-
-	qDebug() << "Loaded" << readOk << "/" << totalRecords << "cross-identification data records for stars";
+	if (!crossIdTable.load(crossIdFile, StarMetadataTable::CrossId))
+		qWarning() << "WARNING - could not load cross-identification data from" << QDir::toNativeSeparators(crossIdFile);
 }
 
 int StarMgr::getMaxSearchLevel() const
@@ -1096,6 +936,45 @@ int StarMgr::getMaxSearchLevel() const
 }
 
 
+const StarMgr::RCMagTable& StarMgr::getRCMagTable(int gridLevelIndex, const StelSkyDrawer* skyDrawer, float lnRadius0, float slope)
+{
+	const ZoneArray* z = gridLevels.at(gridLevelIndex);
+	const float fader = starsFader.getInterstate();
+	RCMagTable& table = rcMagTables[gridLevelIndex];
+	if (table.array==z && table.lnRadius0==lnRadius0 && table.slope==slope && table.fader==fader)
+		return table;
+
+	table.array = z;
+	table.lnRadius0 = lnRadius0;
+	table.slope = slope;
+	table.fader = fader;
+	table.limitMagIndex = RCMAG_TABLE_SIZE;
+	table.rcmag.resize(RCMAG_TABLE_SIZE);
+	RCMag* rcmag_table = table.rcmag.data();
+	const float mag_min = 0.001f*z->mag_min;
+	const float k = (0.001f*z->mag_range)/z->mag_steps; // MagStepIncrement
+	for (int i=0;i<RCMAG_TABLE_SIZE;++i)
+	{
+		const float mag = mag_min+k*i;
+		if (skyDrawer->computeRCMag(mag, &rcmag_table[i])==false)
+		{
+			// The last magnitude at which the star is visible
+			table.limitMagIndex = i-1;
+
+			// We reached the point where stars are not visible anymore
+			// Fill the rest of the table with zero and leave.
+			for (;i<RCMAG_TABLE_SIZE;++i)
+			{
+				rcmag_table[i].luminance=0;
+				rcmag_table[i].radius=0;
+			}
+			break;
+		}
+		rcmag_table[i].radius *= fader;
+	}
+	return table;
+}
+
 // Draw all the stars
 void StarMgr::draw(StelCore* core)
 {
@@ -1119,37 +998,30 @@ void StarMgr::draw(StelCore* core)
 	sPainter.setFont(starFont);
 	skyDrawer->preDrawPointSource(&sPainter);
 
-	// Prepare a table for storing precomputed RCMag for all ZoneArrays
-	RCMag rcmag_table[RCMAG_TABLE_SIZE];
+	// The precomputed RCMag tables of the ZoneArrays are reused as long as
+	// the brightness of point sources does not change
+	float lnRadius0, slope;
+	skyDrawer->getPointSourceRadiusLaw(&lnRadius0, &slope);
+	if (rcMagTables.size()!=gridLevels.size())
+		rcMagTables.resize(gridLevels.size());
+
+	// Zones used from now on belong to this frame and cannot be evicted
+	ZoneArray::advanceLazyClock();
+	
+	// The faint stars may be drawn on the GPU, unless the projection or the frame are not supported
+	const bool gpuStars = flagGpuStars && skyDrawer->preDrawStaticPointSources(&sPainter);
 	
 	// Draw all the stars of all the selected zones
-	foreach(const ZoneArray* z, gridLevels)
+	for (int l=0;l<gridLevels.size();++l)
 	{
-		int limitMagIndex=RCMAG_TABLE_SIZE;
+		const ZoneArray* z = gridLevels.at(l);
+		const RCMagTable& rcMagTable = getRCMagTable(l, skyDrawer, lnRadius0, slope);
+		if (rcMagTable.limitMagIndex<0)
+			break;
+		const int limitMagIndex = rcMagTable.limitMagIndex;
+		const RCMag* rcmag_table = rcMagTable.rcmag.constData();
 		const float mag_min = 0.001f*z->mag_min;
 		const float k = (0.001f*z->mag_range)/z->mag_steps; // MagStepIncrement
-		for (int i=0;i<RCMAG_TABLE_SIZE;++i)
-		{
-			const float mag = mag_min+k*i;
-			if (skyDrawer->computeRCMag(mag, &rcmag_table[i])==false)
-			{
-				if (i==0)
-					goto exit_loop;
-				
-				// The last magnitude at which the star is visible
-				limitMagIndex = i-1;
-				
-				// We reached the point where stars are not visible anymore
-				// Fill the rest of the table with zero and leave.
-				for (;i<RCMAG_TABLE_SIZE;++i)
-				{
-					rcmag_table[i].luminance=0;
-					rcmag_table[i].radius=0;
-				}
-				break;
-			}
-			rcmag_table[i].radius *= starsFader.getInterstate();
-		}
 		lastMaxSearchLevel = z->level;
 
 		unsigned int maxMagStarName = 0;
@@ -1161,18 +1033,38 @@ void StarMgr::draw(StelCore* core)
 			if (x > 0)
 				maxMagStarName = x;
 		}
+		// Stars which may get a label or a big halo are drawn on the CPU. Extinction
+		// only makes stars fainter, so their raw magnitude index is enough to tell.
+		int cpuMagIndexLimit = std::numeric_limits<int>::max();
+		if (gpuStars)
+		{
+			cpuMagIndexLimit = 0;
+			while (cpuMagIndexLimit<RCMAG_TABLE_SIZE && StelSkyDrawer::hasBigHalo(rcmag_table[cpuMagIndexLimit]))
+				++cpuMagIndexLimit;
+			cpuMagIndexLimit = qMax(cpuMagIndexLimit, (int)maxMagStarName);
+			skyDrawer->setStaticPointSourceParams(z->getMovementFactor(core), mag_min, k, z->getCutoffMagStep(skyDrawer, limitMagIndex),
+							      starsFader.getInterstate());
+		}
 		int zone;
-		
+
+		// Collect the visible zones, they are culled in parallel by ZoneArray::draw
+		QVector<ZoneDrawJob> jobs;
 		for (GeodesicSearchInsideIterator it1(*geodesic_search_result,z->level);(zone = it1.next()) >= 0;)
-			z->draw(&sPainter, zone, true, rcmag_table, limitMagIndex, core, maxMagStarName, names_brightness, viewportCaps);
+			jobs.append(ZoneDrawJob(zone, true));
 		for (GeodesicSearchBorderIterator it1(*geodesic_search_result,z->level);(zone = it1.next()) >= 0;)
-			z->draw(&sPainter, zone, false, rcmag_table, limitMagIndex, core, maxMagStarName,names_brightness, viewportCaps);
+			jobs.append(ZoneDrawJob(zone, false));
+		z->draw(&sPainter, jobs, rcmag_table, limitMagIndex, core, maxMagStarName, names_brightness, viewportCaps, cpuMagIndexLimit);
 	}
-	exit_loop:
 
 	// Finish drawing many stars
+	if (gpuStars)
+		skyDrawer->postDrawStaticPointSources();
 	skyDrawer->postDrawPointSource(&sPainter);
 
+	// Release lazily loaded zones beyond the memory budget, faintest catalogs first
+	for (int i=gridLevels.size()-1;i>=0;--i)
+		gridLevels.at(i)->evictLazyZones();
+
 	if (objectMgr->getFlagSelectedObjectPointer())
 		drawPointer(sPainter, core);
 }
@@ -1181,6 +1073,11 @@ void StarMgr::draw(StelCore* core)
 // Return a QList containing the stars located
 // inside the limFov circle around position v
 QList<StelObjectP > StarMgr::searchAround(const Vec3d& vv, double limFov, const StelCore* core) const
+{
+	return searchAroundSelectable(vv, limFov, std::numeric_limits<float>::max(), core);
+}
+
+QList<StelObjectP > StarMgr::searchAroundSelectable(const Vec3d& vv, double limFov, float maxPriority, const StelCore* core) const
 {
 	QList<StelObjectP > result;
 	if (!getFlagStars())
@@ -1234,17 +1131,26 @@ QList<StelObjectP > StarMgr::searchAround(const Vec3d& vv, double limFov, const
 	f = cos(limFov * M_PI/180.);
 	foreach(ZoneArray* z, gridLevels)
 	{
+		// The select priority of a star is its extincted magnitude, capped at 15.
+		// Extinction only makes stars fainter, so the fainter ones can be skipped.
+		int maxMagIndex = std::numeric_limits<int>::max();
+		if (maxPriority<15.f)
+		{
+			// Keep one more step for rounding
+			const float m = (1000.f*maxPriority - z->mag_min)*z->mag_steps/z->mag_range;
+			maxMagIndex = m<0.f ? -1 : (int)m + 1;
+		}
 		//qDebug() << "search inside(" << it->first << "):";
 		int zone;
 		for (GeodesicSearchInsideIterator it1(*geodesic_search_result,z->level);(zone = it1.next()) >= 0;)
 		{
-			z->searchAround(core, zone,v,f,result);
+			z->searchAround(core, zone,v,f,maxMagIndex,result);
 			//qDebug() << " " << zone;
 		}
 		//qDebug() << endl << "search border(" << it->first << "):";
 		for (GeodesicSearchBorderIterator it1(*geodesic_search_result,z->level); (zone = it1.next()) >= 0;)
 		{
-			z->searchAround(core, zone,v,f,result);
+			z->searchAround(core, zone,v,f,maxMagIndex,result);
 			//qDebug() << " " << zone;
 		}
 	}
@@ -1315,27 +1221,27 @@ StelObjectP StarMgr::searchByNameI18n(const QString& nameI18n) const
 	QRegExp rx2("^\\s*(SAO)\\s*(\\d+)\\s*$", Qt::CaseInsensitive);
 	if (rx2.exactMatch(objw))
 	{
-		QMap<int, int>::const_iterator sao(saoStarsIndex.find(rx2.capturedTexts().at(2).toInt()));
-		if (sao!=saoStarsIndex.end())
-			return searchHP(sao.value());
+		const int saoHip = crossIdTable.findHipByNumber(StarMetadataTable::SaoIndex, rx2.capturedTexts().at(2).toUInt());
+		if (saoHip>0)
+			return searchHP(saoHip);
 	}
 
 	// Search by HD number if it's an HD formated number
 	QRegExp rx3("^\\s*(HD)\\s*(\\d+)\\s*$", Qt::CaseInsensitive);
 	if (rx3.exactMatch(objw))
 	{
-		QMap<int, int>::const_iterator hd(hdStarsIndex.find(rx3.capturedTexts().at(2).toInt()));
-		if (hd!=hdStarsIndex.end())
-			return searchHP(hd.value());
+		const int hdHip = crossIdTable.findHipByNumber(StarMetadataTable::HdIndex, rx3.capturedTexts().at(2).toUInt());
+		if (hdHip>0)
+			return searchHP(hdHip);
 	}
 
 	// Search by HR number if it's an HR formated number
 	QRegExp rx4("^\\s*(HR)\\s*(\\d+)\\s*$", Qt::CaseInsensitive);
 	if (rx4.exactMatch(objw))
 	{
-		QMap<int, int>::const_iterator hr(hrStarsIndex.find(rx4.capturedTexts().at(2).toInt()));
-		if (hr!=hrStarsIndex.end())
-			return searchHP(hr.value());
+		const int hrHip = crossIdTable.findHipByNumber(StarMetadataTable::HrIndex, rx4.capturedTexts().at(2).toUInt());
+		if (hrHip>0)
+			return searchHP(hrHip);
 	}
 
 	// Search by I18n common name
@@ -1368,17 +1274,17 @@ StelObjectP StarMgr::searchByNameI18n(const QString& nameI18n) const
 	}
 
 	// Search by GCVS name
-	QMap<QString,int>::const_iterator it4 = varStarsIndexI18n.find(objw);
-	if (it4!=varStarsIndexI18n.end())
+	const int gcvsHip = gcvsTable.findHipByName(objw);
+	if (gcvsHip>0)
 	{
-		return searchHP(it4.value());
+		return searchHP(gcvsHip);
 	}
 
 	// Search by WDS name
-	QMap<QString,int>::const_iterator wdsIt = wdsStarsIndexI18n.find(objw);
-	if (wdsIt!=wdsStarsIndexI18n.end())
+	const int wdsHip = wdsTable.findHipByName(objw);
+	if (wdsHip>0)
 	{
-		return searchHP(wdsIt.value());
+		return searchHP(wdsHip);
 	}
 
 	return StelObjectP();
@@ -1400,27 +1306,27 @@ StelObjectP StarMgr::searchByName(const QString& name) const
 	QRegExp rx2("^\\s*(SAO)\\s*(\\d+)\\s*$", Qt::CaseInsensitive);
 	if (rx2.exactMatch(objw))
 	{
-		QMap<int, int>::const_iterator sao(saoStarsIndex.find(rx2.capturedTexts().at(2).toInt()));
-		if (sao!=saoStarsIndex.end())
-			return searchHP(sao.value());
+		const int saoHip = crossIdTable.findHipByNumber(StarMetadataTable::SaoIndex, rx2.capturedTexts().at(2).toUInt());
+		if (saoHip>0)
+			return searchHP(saoHip);
 	}
 
 	// Search by HD number if it's an HD formated number
 	QRegExp rx3("^\\s*(HD)\\s*(\\d+)\\s*$", Qt::CaseInsensitive);
 	if (rx3.exactMatch(objw))
 	{
-		QMap<int, int>::const_iterator hd(hdStarsIndex.find(rx3.capturedTexts().at(2).toInt()));
-		if (hd!=hdStarsIndex.end())
-			return searchHP(hd.value());
+		const int hdHip = crossIdTable.findHipByNumber(StarMetadataTable::HdIndex, rx3.capturedTexts().at(2).toUInt());
+		if (hdHip>0)
+			return searchHP(hdHip);
 	}
 
 	// Search by HR number if it's an HR formated number
 	QRegExp rx4("^\\s*(HR)\\s*(\\d+)\\s*$", Qt::CaseInsensitive);
 	if (rx4.exactMatch(objw))
 	{
-		QMap<int, int>::const_iterator hr(hrStarsIndex.find(rx4.capturedTexts().at(2).toInt()));
-		if (hr!=hrStarsIndex.end())
-			return searchHP(hr.value());
+		const int hrHip = crossIdTable.findHipByNumber(StarMetadataTable::HrIndex, rx4.capturedTexts().at(2).toUInt());
+		if (hrHip>0)
+			return searchHP(hrHip);
 	}
 
 	// Search by English common name
@@ -1580,17 +1486,10 @@ QStringList StarMgr::listMatchingObjects(const QString& objPrefix, int maxNbItem
 	}
 
 	// Search for sci names for var stars
-	for (QMap<QString,int>::const_iterator it(varStarsIndexI18n.lowerBound(objw)); it!=varStarsIndexI18n.end(); ++it)
+	foreach(int hip, gcvsTable.findHipsByNamePrefix(objw, maxNbItem))
 	{
-		if (it.key().startsWith(objw))
-		{
-			if (maxNbItem<=0)
-				break;
-			result << getGcvsName(it.value());
-			--maxNbItem;
-		}
-		else
-			break;
+		result << getGcvsName(hip);
+		--maxNbItem;
 	}
 
 	// Add exact Hp catalogue numbers
@@ -1618,10 +1517,10 @@ QStringList StarMgr::listMatchingObjects(const QString& objPrefix, int maxNbItem
 	{
 		bool ok;
 		int saoNum = saoRx.capturedTexts().at(2).toInt(&ok);
-		QMap<int, int>::const_iterator sao(saoStarsIndex.find(saoNum));
-		if (sao!=saoStarsIndex.end())
+		const int saoHip = crossIdTable.findHipByNumber(StarMetadataTable::SaoIndex, saoNum);
+		if (saoHip>0)
 		{
-			StelObjectP s = searchHP(sao.value());
+			StelObjectP s = searchHP(saoHip);
 			if (s && maxNbItem>0)
 			{
 				result << QString("SAO%1").arg(saoNum);
@@ -1637,10 +1536,10 @@ QStringList StarMgr::listMatchingObjects(const QString& objPrefix, int maxNbItem
 	{
 		bool ok;
 		int hdNum = hdRx.capturedTexts().at(2).toInt(&ok);
-		QMap<int, int>::const_iterator hd(hdStarsIndex.find(hdNum));
-		if (hd!=hdStarsIndex.end())
+		const int hdHip = crossIdTable.findHipByNumber(StarMetadataTable::HdIndex, hdNum);
+		if (hdHip>0)
 		{
-			StelObjectP s = searchHP(hd.value());
+			StelObjectP s = searchHP(hdHip);
 			if (s && maxNbItem>0)
 			{
 				result << QString("HD%1").arg(hdNum);
@@ -1656,10 +1555,10 @@ QStringList StarMgr::listMatchingObjects(const QString& objPrefix, int maxNbItem
 	{
 		bool ok;
 		int hrNum = hrRx.capturedTexts().at(2).toInt(&ok);
-		QMap<int, int>::const_iterator hr(hrStarsIndex.find(hrNum));
-		if (hr!=hrStarsIndex.end())
+		const int hrHip = crossIdTable.findHipByNumber(StarMetadataTable::HrIndex, hrNum);
+		if (hrHip>0)
 		{
-			StelObjectP s = searchHP(hr.value());
+			StelObjectP s = searchHP(hrHip);
 			if (s && maxNbItem>0)
 			{
 				result << QString("HR%1").arg(hrNum);
@@ -1674,17 +1573,10 @@ QStringList StarMgr::listMatchingObjects(const QString& objPrefix, int maxNbItem
 	wdsRx.setCaseSensitivity(Qt::CaseInsensitive);
 	if (wdsRx.exactMatch(objw))
 	{
-		for (QMap<QString,int>::const_iterator wds(wdsStarsIndexI18n.lowerBound(objw)); wds!=wdsStarsIndexI18n.end(); ++wds)
+		foreach(int hip, wdsTable.findHipsByNamePrefix(objw, maxNbItem))
 		{
-			if (wds.key().startsWith(objw))
-			{
-				if (maxNbItem==0)
-					break;
-				result << getWdsName(wds.value());
-				--maxNbItem;
-			}
-			else
-				break;
+			result << getWdsName(hip);
+			--maxNbItem;
 		}
 	}
 
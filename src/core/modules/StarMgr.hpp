@@ -27,6 +27,7 @@
 #include "StelObjectModule.hpp"
 #include "StelTextureTypes.hpp"
 #include "StelProjectorType.hpp"
+#include "StarMetadata.hpp"
 
 class StelObject;
 class StelToneReproducer;
@@ -39,37 +40,6 @@ struct HipIndexStruct;
 
 static const int RCMAG_TABLE_SIZE = 4096;
 
-typedef struct
-{
-	QString designation;	//! GCVS designation
-	QString vtype;		//! Type of variability
-	float maxmag;		//! Magnitude at maximum brightness
-	int mflag;		//! Magnitude flag code
-	float min1mag;		//! First minimum magnitude or amplitude
-	float min2mag;		//! Second minimum magnitude or amplitude
-	QString photosys;	//! The photometric system for magnitudes
-	double epoch;		//! Epoch for maximum light (Julian days)
-	double period;		//! Period of the variable star (days)
-	int Mm;			//! Rising time or duration of eclipse (%)
-	QString stype;		//! Spectral type
-} varstar;
-
-typedef struct
-{
-	QString designation;	//! WDS designation
-	int observation;	//! Date of last satisfactory observation, yr
-	float positionAngle;	//! Position Angle at date of last satisfactory observation, deg
-	float separation;	//! Separation at date of last satisfactory observation, arcsec
-} wds;
-
-typedef struct
-{
-	unsigned int sao;
-	unsigned int hd;
-	unsigned int hr;
-
-} crossid;
-
 typedef QMap<StelObjectP, float> StelACStarData;
 
 //! @class StarMgr
@@ -117,8 +87,11 @@ public:
 
 	///////////////////////////////////////////////////////////////////////////
 	// Methods defined in the StelModule class
+	//! Load the star catalogue data, the GCVS, WDS and cross-identification
+	//! data and the scientific names into memory.
+	virtual void preload();
+
 	//! Initialize the StarMgr.
-	//! - Loads the star catalogue data into memory
 	//! - Sets up the star color table
 	//! - Loads the star texture
 	//! - Loads the star font (for labels on named stars)
@@ -141,6 +114,11 @@ public:
 	//! Return a list containing the stars located inside the limFov circle around position v
 	virtual QList<StelObjectP > searchAround(const Vec3d& v, double limitFov, const StelCore* core) const;
 
+	//! Return a list containing the stars located inside the limFov circle around position v,
+	//! leaving out the stars which are too faint for a select priority up to maxPriority.
+	//! The per-zone magnitude index is used to skip them without looking at them.
+	virtual QList<StelObjectP > searchAroundSelectable(const Vec3d& v, double limitFov, float maxPriority, const StelCore* core) const;
+
 	//! Return the matching Stars object's pointer if exists or Q_NULLPTR
 	//! @param nameI18n The case in-sensistive star common name or HP
 	//! catalog name (format can be HP1234 or HP 1234 or HIP 1234) or sci name
@@ -198,6 +176,13 @@ public slots:
 	//! Define font size to use for star names display.
 	void setFontSize(float newFontSize);
 
+	//! Set whether the faint stars are drawn on the GPU from static vertex buffers.
+	//! The stars which may get a label or a big halo are always drawn on the CPU,
+	//! as are all stars in the projections and frames the GPU cannot compute.
+	void setFlagGpuStars(bool b) {flagGpuStars=b;}
+	//! Get whether the faint stars are drawn on the GPU from static vertex buffers.
+	bool getFlagGpuStars(void) const {return flagGpuStars;}
+
 	//! Show scientific or catalog names on stars without common names.
 	static void setFlagSciNames(bool f) {flagSciNames = f;}
 	static bool getFlagSciNames(void) {return flagSciNames;}
@@ -378,15 +363,15 @@ private:
 	//! @param the path to a file containing the scientific names for bright stars.
 	void loadSciNames(const QString& sciNameFile);
 
-	//! Loads GCVS from a file.
+	//! Loads GCVS from a file, through its compiled binary form.
 	//! @param the path to a file containing the GCVS.
 	void loadGcvs(const QString& GcvsFile);
 
-	//! Loads WDS from a file.
+	//! Loads WDS from a file, through its compiled binary form.
 	//! @param the path to a file containing the WDS.
 	void loadWds(const QString& WdsFile);
 
-	//! Loads cross-identification data from a file.
+	//! Loads cross-identification data from a file, through its compiled binary form.
 	//! @param the path to a file containing the cross-identification data.
 	void loadCrossIdentificationData(const QString& crossIdFile);
 
@@ -413,12 +398,33 @@ private:
 	bool flagStarName;
 	double labelsAmount;
 	bool gravityLabel;
+	bool flagGpuStars;
 
 	int maxGeodesicGridLevel;
 	int lastMaxSearchLevel;
 	
 	// A ZoneArray per grid level
 	QVector<ZoneArray*> gridLevels;
+
+	//! Precomputed RCMag of all magnitude steps of a ZoneArray. The table is
+	//! kept between frames and only recomputed when the point source radius
+	//! law of the sky drawer or the stars fader changed.
+	struct RCMagTable
+	{
+		RCMagTable() : array(Q_NULLPTR), lnRadius0(0.f), slope(0.f), fader(-1.f), limitMagIndex(-1) {}
+		const ZoneArray* array;
+		float lnRadius0;
+		float slope;
+		float fader;
+		//! Index of the last visible magnitude step, -1 if no star of the ZoneArray is visible
+		int limitMagIndex;
+		QVector<RCMag> rcmag;
+	};
+	//! The RCMag table of each ZoneArray in gridLevels
+	QVector<RCMagTable> rcMagTables;
+
+	//! Get the RCMag table of a ZoneArray, recomputing it if needed.
+	const RCMagTable& getRCMagTable(int gridLevelIndex, const StelSkyDrawer* skyDrawer, float lnRadius0, float slope);
 	static void initTriangleFunc(int lev, int index,
 								 const Vec3f &c0,
 								 const Vec3f &c1,
@@ -451,16 +457,10 @@ private:
 	static QHash<int, QString> sciAdditionalNamesMapI18n;
 	static QMap<QString, int> sciAdditionalNamesIndexI18n;
 
-	static QHash<int, varstar> varStarsMapI18n;
-	static QMap<QString, int> varStarsIndexI18n;
-
-	static QHash<int, wds> wdsStarsMapI18n;
-	static QMap<QString, int> wdsStarsIndexI18n;
-
-	static QMap<QString, crossid> crossIdMap;
-	static QMap<int, int> saoStarsIndex;
-	static QMap<int, int> hdStarsIndex;
-	static QMap<int, int> hrStarsIndex;
+	// GCVS, WDS and cross-identification data, mmapped from their compiled form
+	static StarMetadataTable gcvsTable;
+	static StarMetadataTable wdsTable;
+	static StarMetadataTable crossIdTable;
 
 	static QHash<int, QString> referenceMap;
 
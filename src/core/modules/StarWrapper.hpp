@@ -73,12 +73,17 @@ template <class Star> class StarWrapper : public StarWrapperBase
 protected:
 	StarWrapper(const SpecialZoneArray<Star> *a,
 		const SpecialZoneData<Star> *z,
-		const Star *s) : a(a), z(z), s(s) {;}
+		const Star *s) : a(a), z(z), starCopy(*s), s(&starCopy) {;}
 	Vec3d getJ2000EquatorialPos(const StelCore* core) const
+	{
+		return getJ2000EquatorialPosAtJDE(core, core->getJDE());
+	}
+	//! The position with the proper motion of the star until JDE
+	Vec3d getJ2000EquatorialPosAtJDE(const StelCore*, double JDE) const
 	{
 		static const double d2000 = 2451545.0;
 		Vec3f v;
-		s->getJ2000Pos(z, (M_PI/180.)*(0.0001/3600.) * ((core->getJDE()-d2000)/365.25) / a->star_position_scale, v);
+		s->getJ2000Pos(z, (M_PI/180.)*(0.0001/3600.) * ((JDE-d2000)/365.25) / a->star_position_scale, v);
 		return Vec3d(v[0], v[1], v[2]);
 	}
 	Vec3f getInfoColor(void) const
@@ -97,7 +102,13 @@ protected:
 protected:
 	const SpecialZoneArray<Star> *const a;
 	const SpecialZoneData<Star> *const z;
+	//! Copy of the star record: the stars of a lazily loaded zone may be
+	//! evicted while the wrapper is still alive (e.g. the selected star).
+	const Star starCopy;
 	const Star *const s;
+private:
+	// A copy would keep s pointing into the starCopy of the original
+	Q_DISABLE_COPY(StarWrapper)
 };
 
 
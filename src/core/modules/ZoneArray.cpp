@@ -23,14 +23,27 @@
 #include "StelGeodesicGrid.hpp"
 #include "StelObject.hpp"
 #include "StelPainter.hpp"
+#include "StelStartupProfiler.hpp"
 
 #include <QDebug>
 #include <QFile>
 #include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSaveFile>
+#include <QVarLengthArray>
+#include <QPair>
+#include <QtConcurrent>
+#include <algorithm>
 #ifdef Q_OS_WIN
 #include <io.h>
 #include <windows.h>
 #endif
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
 
 
 static unsigned int stel_bswap_32(unsigned int val)
@@ -41,6 +54,33 @@ static unsigned int stel_bswap_32(unsigned int val)
 
 static const Vec3f north(0,0,1);
 
+int ZoneArray::decodedCacheBudgetKb = 0;
+QAtomicInt ZoneArray::decodedCacheUsedKb(0);
+
+void ZoneArray::setDecodedCacheBudget(int megabytes)
+{
+	decodedCacheBudgetKb = qMax(0, megabytes)*1024;
+}
+
+int ZoneArray::gpuBufferBudgetKb = 0;
+QAtomicInt ZoneArray::gpuBufferUsedKb(0);
+
+void ZoneArray::setGpuBufferBudget(int megabytes)
+{
+	gpuBufferBudgetKb = qMax(0, megabytes)*1024;
+}
+
+bool ZoneArray::lazyLoading = false;
+int ZoneArray::lazyBudgetKb = 0;
+QAtomicInt ZoneArray::lazyLoadedKb(0);
+QAtomicInt ZoneArray::lazyClock(0);
+
+void ZoneArray::setLazyLoading(bool enabled, int budgetMb)
+{
+	lazyLoading = enabled;
+	lazyBudgetKb = qMax(0, budgetMb)*1024;
+}
+
 void ZoneArray::initTriangle(int index, const Vec3f &c0, const Vec3f &c1, const Vec3f &c2)
 {
 	// initialize center,axis0,axis1:
@@ -50,6 +90,8 @@ void ZoneArray::initTriangle(int index, const Vec3f &c0, const Vec3f &c1, const
 	z.axis0 = north ^ z.center;
 	z.axis0.normalize();
 	z.axis1 = z.center ^ z.axis0;
+	// The corners are normalized, the farthest one bounds the triangle.
+	z.cosRadius = qMin(qMin(z.center*c0, z.center*c1), z.center*c2);
 	
 	// Initialize star_position_scale. This scale is used to multiply stars position
 	// encoded as integers so that it optimize precision over the triangle.
@@ -90,8 +132,9 @@ static inline int ReadInt(QFile& file, unsigned int &x)
 #endif
 #endif
 
-ZoneArray* ZoneArray::create(const QString& catalogFilePath, bool use_mmap)
+ZoneArray* ZoneArray::create(const QString& catalogFilePath, bool use_mmap, const QString& checksum)
 {
+	StelStartupProfiler::Scope profile("catalog", StelStartupProfiler::isEnabled() ? QFileInfo(catalogFilePath).fileName() : QString());
 	QString dbStr; // for debugging output.
 	QFile* file = new QFile(catalogFilePath);
 	if (!file->open(QIODevice::ReadOnly))
@@ -115,21 +158,12 @@ ZoneArray* ZoneArray::create(const QString& catalogFilePath, bool use_mmap)
 		return 0;
 	}
 	const bool byte_swap = (magic == FILE_MAGIC_OTHER_ENDIAN);
+	// Whether the catalogue must be converted to native format before mmap loading
+	bool needsNativeCopy = false;
 	if (byte_swap)
 	{
 		// ok, FILE_MAGIC_OTHER_ENDIAN, must swap
-		if (use_mmap)
-		{
-			dbStr += "warning - must convert catalogue ";
-#if (!defined(__GNUC__))
-			dbStr += "to native format ";
-#endif
-			dbStr += "before mmap loading";
-			qWarning() << dbStr;
-			use_mmap = false;
-			qWarning() << "Revert to not using mmmap";
-			//return 0;
-		}
+		needsNativeCopy = true;
 		dbStr += "byteswap ";
 		type = stel_bswap_32(type);
 		major = stel_bswap_32(major);
@@ -143,14 +177,8 @@ ZoneArray* ZoneArray::create(const QString& catalogFilePath, bool use_mmap)
 	{
 		// ok, FILE_MAGIC
 #if (!defined(__GNUC__) && !defined(_MSC_BUILD))
-		if (use_mmap)
-		{
-			// mmap only with gcc:
-			dbStr += "warning - you must convert catalogue to native format before mmap loading";
-			qDebug(qPrintable(dbStr));
-
-			return 0;
-		}
+		// mmap only with gcc:
+		needsNativeCopy = true;
 #endif
 	}
 	else if (magic == FILE_MAGIC_NATIVE)
@@ -163,6 +191,50 @@ ZoneArray* ZoneArray::create(const QString& catalogFilePath, bool use_mmap)
 		qDebug() << dbStr;
 		return 0;
 	}
+
+	// The faint catalogs (all but Hipparcos) are read zone by zone in lazy mode
+	const bool lazy = lazyLoading && type!=0;
+	if (lazy)
+	{
+		dbStr += "lazy ";
+		use_mmap = false;
+	}
+
+	if (use_mmap && needsNativeCopy)
+	{
+		// Convert the catalogue once, all later starts mmap the native copy
+		const QString nativePath = getNativeCopyPath(catalogFilePath, checksum);
+		if (QFileInfo(nativePath).exists())
+		{
+			ZoneArray* nativeArray = create(nativePath, true);
+			if (nativeArray)
+			{
+				dbStr += "using native copy " + QDir::toNativeSeparators(nativePath);
+				qDebug() << dbStr;
+				delete file;
+				return nativeArray;
+			}
+			// Truncated or unreadable, e.g. after a crash: convert the catalogue again
+			qWarning() << "Removing unusable native star catalogue copy" << QDir::toNativeSeparators(nativePath);
+			QFile::remove(nativePath);
+		}
+		if (writeNativeCopy(*file, nativePath, byte_swap, type, major, minor, level, mag_min, mag_range, mag_steps))
+		{
+			ZoneArray* nativeArray = create(nativePath, true);
+			if (nativeArray)
+			{
+				dbStr += "using new native copy " + QDir::toNativeSeparators(nativePath);
+				qDebug() << dbStr;
+				delete file;
+				return nativeArray;
+			}
+			QFile::remove(nativePath);
+		}
+		dbStr += "warning - could not convert catalogue to native format for mmap loading";
+		qWarning() << dbStr;
+		use_mmap = false;
+		qWarning() << "Revert to not using mmmap";
+	}
 	ZoneArray *rval = Q_NULLPTR;
 	dbStr += QString("%1_%2v%3_%4; ").arg(level).arg(type).arg(major).arg(minor);
 
@@ -201,7 +273,7 @@ ZoneArray* ZoneArray::create(const QString& catalogFilePath, bool use_mmap)
 #ifndef _MSC_BUILD
 				Q_ASSERT(sizeof(Star2) == 10);
 #endif
-				rval = new SpecialZoneArray<Star2>(file, byte_swap, use_mmap, level, mag_min, mag_range, mag_steps);
+				rval = new SpecialZoneArray<Star2>(file, byte_swap, use_mmap, lazy, level, mag_min, mag_range, mag_steps);
 				if (rval == Q_NULLPTR)
 				{
 					dbStr += "error - no memory ";
@@ -222,7 +294,7 @@ ZoneArray* ZoneArray::create(const QString& catalogFilePath, bool use_mmap)
 #ifndef _MSC_BUILD
 				Q_ASSERT(sizeof(Star3) == 6);
 #endif
-				rval = new SpecialZoneArray<Star3>(file, byte_swap, use_mmap, level, mag_min, mag_range, mag_steps);
+				rval = new SpecialZoneArray<Star3>(file, byte_swap, use_mmap, lazy, level, mag_min, mag_range, mag_steps);
 				if (rval == Q_NULLPTR)
 				{
 					dbStr += "error - no memory ";
@@ -251,11 +323,102 @@ ZoneArray* ZoneArray::create(const QString& catalogFilePath, bool use_mmap)
 	return rval;
 }
 
+QString ZoneArray::getNativeCopyPath(const QString& catalogFilePath, const QString& checksum)
+{
+	const QFileInfo info(catalogFilePath);
+	QString key = checksum;
+	if (key.isEmpty())
+		key = QString("%1_%2").arg(info.size()).arg(info.lastModified().toTime_t());
+	return StelFileMgr::getCacheDir() + "/stars/" + info.completeBaseName() + "_" + key + ".cat";
+}
+
+bool ZoneArray::writeNativeCopy(QFile& file, const QString& nativePath, bool byte_swap,
+				unsigned int type, unsigned int major, unsigned int minor, unsigned int level,
+				unsigned int mag_min, unsigned int mag_range, unsigned int mag_steps)
+{
+	const QString cacheDir = StelFileMgr::dirName(nativePath);
+	try
+	{
+		StelFileMgr::makeSureDirExistsAndIsWritable(cacheDir);
+	}
+	catch (std::runtime_error& e)
+	{
+		qWarning() << "Cannot write native star catalogue copy:" << e.what();
+		return false;
+	}
+
+	// Remove outdated copies of the same catalogue
+	const QString prefix = QFileInfo(file.fileName()).completeBaseName() + "_";
+	foreach (const QString& oldCopy, QDir(cacheDir).entryList(QStringList(prefix + "*.cat"), QDir::Files))
+		QFile::remove(cacheDir + "/" + oldCopy);
+
+	qDebug() << "Writing native copy of star catalogue" << QDir::toNativeSeparators(file.fileName())
+		 << "to" << QDir::toNativeSeparators(nativePath);
+	const qint64 headerEnd = file.pos();
+	QSaveFile out(nativePath);
+	if (!out.open(QIODevice::WriteOnly))
+	{
+		qWarning() << "Cannot write native star catalogue copy:" << out.errorString();
+		return false;
+	}
+
+	bool ok = true;
+	const unsigned int header[8] = {FILE_MAGIC_NATIVE, type, major, minor, level, mag_min, mag_range, mag_steps};
+	ok = ok && out.write((const char*)header, sizeof(header))==(qint64)sizeof(header);
+
+	// Zone sizes
+	const unsigned int nr_of_zones = StelGeodesicGrid::nrOfZones(level);
+	QVector<unsigned int> zone_size(nr_of_zones);
+	const qint64 zonesBytes = sizeof(unsigned int)*nr_of_zones;
+	ok = ok && file.read((char*)zone_size.data(), zonesBytes)==zonesBytes;
+	if (byte_swap)
+	{
+		for (unsigned int z=0;z<nr_of_zones;z++)
+			zone_size[z] = stel_bswap_32(zone_size[z]);
+	}
+	ok = ok && out.write((const char*)zone_size.constData(), zonesBytes)==zonesBytes;
+
+	// The star records are stored in little endian byte order and need no conversion
+	static const qint64 bufferSize = 8*1024*1024;
+	QByteArray buffer;
+	while (ok && !file.atEnd())
+	{
+		buffer = file.read(bufferSize);
+		ok = !buffer.isEmpty() && out.write(buffer)==buffer.size();
+	}
+
+	file.seek(headerEnd);
+	if (!ok || !out.commit())
+	{
+		qWarning() << "Error while writing native star catalogue copy" << QDir::toNativeSeparators(nativePath);
+		out.cancelWriting();
+		return false;
+	}
+	return true;
+}
+
+void ZoneArray::adviseMapping(const uchar* start, qint64 size, bool willNeed)
+{
+#if defined(Q_OS_UNIX) && defined(MADV_RANDOM)
+	// madvise() needs a page aligned address, QFile::map() returns the requested offset
+	const quintptr pageSize = sysconf(_SC_PAGESIZE);
+	const quintptr begin = reinterpret_cast<quintptr>(start) & ~(pageSize-1);
+	const size_t length = reinterpret_cast<quintptr>(start) + size - begin;
+	if (madvise(reinterpret_cast<void*>(begin), length, willNeed ? MADV_WILLNEED : MADV_RANDOM)!=0)
+		qDebug() << "madvise() failed for star catalogue mapping:" << strerror(errno);
+#else
+	Q_UNUSED(start);
+	Q_UNUSED(size);
+	Q_UNUSED(willNeed);
+#endif
+}
+
 ZoneArray::ZoneArray(const QString& fname, QFile* file, int level, int mag_min,
 			 int mag_range, int mag_steps)
 			: fname(fname), level(level), mag_min(mag_min),
 			  mag_range(mag_range), mag_steps(mag_steps),
-			  star_position_scale(0.0), nr_of_stars(0), zones(Q_NULLPTR), file(file)
+			  star_position_scale(0.0), nr_of_stars(0), zones(Q_NULLPTR), file(file),
+			  decodedZones(Q_NULLPTR), magIndexes(Q_NULLPTR)
 {
 	nr_of_zones = StelGeodesicGrid::nrOfZones(level);	
 }
@@ -316,10 +479,10 @@ void SpecialZoneArray<Star>::scaleAxis()
 }
 
 template<class Star>
-SpecialZoneArray<Star>::SpecialZoneArray(QFile* file, bool byte_swap,bool use_mmap,
+SpecialZoneArray<Star>::SpecialZoneArray(QFile* file, bool byte_swap,bool use_mmap, bool lazy,
 					 int level, int mag_min, int mag_range, int mag_steps)
 		: ZoneArray(file->fileName(), file, level, mag_min, mag_range, mag_steps),
-		  stars(0), mmap_start(0)
+		  stars(0), mmap_start(0), lazy(lazy), zoneOffsets(Q_NULLPTR), zoneLastUse(Q_NULLPTR)
 {
 	if (nr_of_zones > 0)
 	{
@@ -369,9 +532,39 @@ SpecialZoneArray<Star>::SpecialZoneArray(QFile* file, bool byte_swap,bool use_mm
 		}
 		else
 		{
-			if (use_mmap)
+			if (lazy)
+			{
+				// Only remember where the stars of each zone are, they are read
+				// by ensureZoneLoaded() when the zone is first used. The file stays open.
+				zoneOffsets = new qint64[nr_of_zones];
+				zoneLastUse = new quint32[nr_of_zones];
+				qint64 offset = file->pos();
+				for (unsigned int z=0;z<nr_of_zones;z++)
+				{
+					getZones()[z].stars = Q_NULLPTR;
+					zoneOffsets[z] = offset;
+					zoneLastUse[z] = 0;
+					offset += sizeof(Star)*getZones()[z].size;
+				}
+				if (offset > file->size())
+				{
+					qDebug() << "ERROR: SpecialZoneArray(" << level
+						 << ")::SpecialZoneArray: catalog" << file->fileName() << "is truncated";
+					delete[] zoneOffsets;
+					zoneOffsets = Q_NULLPTR;
+					delete[] zoneLastUse;
+					zoneLastUse = Q_NULLPTR;
+					nr_of_stars = 0;
+					delete[] getZones();
+					zones = Q_NULLPTR;
+					nr_of_zones = 0;
+				}
+			}
+			else if (use_mmap)
 			{
-				mmap_start = file->map(file->pos(), sizeof(Star)*nr_of_stars);
+				// A truncated catalog must not be mapped: reading past its end would crash
+				if (file->pos() + (qint64)(sizeof(Star)*nr_of_stars) <= file->size())
+					mmap_start = file->map(file->pos(), sizeof(Star)*nr_of_stars);
 				if (mmap_start == Q_NULLPTR)
 				{
 					qDebug() << "ERROR: SpecialZoneArray(" << level
@@ -387,6 +580,9 @@ SpecialZoneArray<Star>::SpecialZoneArray(QFile* file, bool byte_swap,bool use_mm
 				}
 				else
 				{
+					// The small bright star levels are always needed, the faint
+					// levels are only touched zone by zone.
+					adviseMapping(mmap_start, sizeof(Star)*nr_of_stars, level<3);
 					stars = (Star*)mmap_start;
 					Star *s = stars;
 					for (unsigned int z=0;z<nr_of_zones;z++)
@@ -430,12 +626,39 @@ SpecialZoneArray<Star>::SpecialZoneArray(QFile* file, bool byte_swap,bool use_mm
 		}
 		// GZ: Some diagnostics to understand the undocumented vars around mag.
 		// qDebug() << "SpecialZoneArray: mag_min=" << mag_min << ", mag_steps=" << mag_steps << ", mag_range=" << mag_range ;
+
+		if (zones && decodedCacheBudgetKb>0)
+		{
+			decodedZones = new QAtomicPointer<DecodedZoneData>[nr_of_zones];
+		}
+		if (zones)
+			magIndexes = new QAtomicPointer<QVector<int> >[nr_of_zones];
 	}
 }
 
 template<class Star>
 SpecialZoneArray<Star>::~SpecialZoneArray(void)
 {
+	if (lazy)
+	{
+		if (zones)
+		{
+			for (unsigned int z=0;z<nr_of_zones;z++)
+			{
+				if (getZones()[z].stars)
+				{
+					lazyLoadedKb.fetchAndAddOrdered(-(int)((sizeof(Star)*getZones()[z].size+1023)/1024));
+					delete[] getZones()[z].getStars();
+				}
+			}
+		}
+		delete[] zoneOffsets;
+		zoneOffsets = Q_NULLPTR;
+		delete[] zoneLastUse;
+		zoneLastUse = Q_NULLPTR;
+		delete file;
+		file = Q_NULLPTR;
+	}
 	if (stars)
 	{
 		if (mmap_start != Q_NULLPTR)
@@ -449,6 +672,44 @@ SpecialZoneArray<Star>::~SpecialZoneArray(void)
 		delete file;
 		stars = Q_NULLPTR;
 	}
+	if (decodedZones)
+	{
+		for (unsigned int z=0;z<nr_of_zones;z++)
+		{
+			DecodedZoneData* decoded = decodedZones[z].load();
+			if (decoded)
+			{
+				decodedCacheUsedKb.fetchAndAddOrdered(-decoded->sizeInKb());
+				delete decoded;
+			}
+		}
+		delete[] decodedZones;
+		decodedZones = Q_NULLPTR;
+	}
+	if (magIndexes)
+	{
+		for (unsigned int z=0;z<nr_of_zones;z++)
+			delete magIndexes[z].load();
+		delete[] magIndexes;
+		magIndexes = Q_NULLPTR;
+	}
+	if (!gpuZones.isEmpty())
+	{
+		//make sure the correct GL context is bound before releasing the buffers!
+		StelApp::getInstance().ensureGLContextCurrent();
+		for (int z=0;z<gpuZones.size();z++)
+		{
+			QOpenGLBuffer* buffer = gpuZones.at(z);
+			if (buffer)
+			{
+				gpuBufferUsedKb.fetchAndAddOrdered(-(buffer->size()+1023)/1024);
+				buffer->destroy();
+				delete buffer;
+			}
+		}
+		gpuZones.clear();
+		gpuZoneFirstStars.clear();
+	}
 	if (zones)
 	{
 		delete[] getZones();
@@ -459,20 +720,303 @@ SpecialZoneArray<Star>::~SpecialZoneArray(void)
 }
 
 template<class Star>
-void SpecialZoneArray<Star>::draw(StelPainter* sPainter, int index, bool isInsideViewport, const RCMag* rcmag_table,
-				  int limitMagIndex, StelCore* core, int maxMagStarName, float names_brightness,
-				  const QVector<SphericalCap> &boundingCaps) const
+bool SpecialZoneArray<Star>::ensureZoneLoaded(int index) const
+{
+	if (!lazy)
+		return true;
+
+	QMutexLocker locker(&lazyMutex);
+	zoneLastUse[index] = lazyClock.load();
+	SpecialZoneData<Star>* z = getZones() + index;
+	if (z->stars || z->size==0)
+		return true;
+
+	const qint64 bytes = sizeof(Star)*z->size;
+	Star* zoneStars = new Star[z->size];
+	if (!file->seek(zoneOffsets[index]) || file->read((char*)zoneStars, bytes)!=bytes)
+	{
+		qWarning() << "ERROR: SpecialZoneArray(" << level << "): cannot read zone" << index
+			   << "from" << QDir::toNativeSeparators(file->fileName()) << ":" << file->errorString();
+		delete[] zoneStars;
+		return false;
+	}
+	z->stars = zoneStars;
+	lazyLoadedKb.fetchAndAddOrdered((bytes+1023)/1024);
+	return true;
+}
+
+template<class Star>
+void SpecialZoneArray<Star>::evictLazyZones()
+{
+	if (!lazy || lazyLoadedKb.load()<=lazyBudgetKb)
+		return;
+
+	QMutexLocker locker(&lazyMutex);
+	// Sort the loaded zones by last use, zones used in the current frame are kept
+	const quint32 now = lazyClock.load();
+	QVector<QPair<quint32, unsigned int> > loaded;
+	for (unsigned int z=0;z<nr_of_zones;z++)
+	{
+		if (getZones()[z].stars && zoneLastUse[z]!=now)
+			loaded.append(qMakePair(zoneLastUse[z], z));
+	}
+	std::sort(loaded.begin(), loaded.end());
+
+	for (int i=0;i<loaded.size() && lazyLoadedKb.load()>lazyBudgetKb;++i)
+	{
+		SpecialZoneData<Star>* z = getZones() + loaded.at(i).second;
+		lazyLoadedKb.fetchAndAddOrdered(-(int)((sizeof(Star)*z->size+1023)/1024));
+		delete[] z->getStars();
+		z->stars = Q_NULLPTR;
+	}
+}
+
+template<class Star>
+int SpecialZoneArray<Star>::getNrOfStarsUpTo(int index, int magIndex) const
+{
+	const SpecialZoneData<Star>* z = getZones() + index;
+	if (magIndex<0 || z->size==0)
+		return 0;
+
+	const QVector<int>* zoneMagIndex = magIndexes[index].loadAcquire();
+	if (zoneMagIndex==Q_NULLPTR)
+	{
+		// The index survives the eviction of lazily loaded zones, it is only built once.
+		const Star* const s = z->getStars();
+		const int lastMag = s[z->size-1].getMag();
+		QVector<int>* built = new QVector<int>(lastMag+2);
+		int n = 0;
+		for (int m=0;m<=lastMag+1;++m)
+		{
+			while (n<z->size && s[n].getMag()<m)
+				++n;
+			(*built)[m] = n;
+		}
+		if (magIndexes[index].testAndSetOrdered(Q_NULLPTR, built))
+			zoneMagIndex = built;
+		else
+		{
+			// Built at the same time by another thread
+			delete built;
+			zoneMagIndex = magIndexes[index].loadAcquire();
+		}
+	}
+	if (magIndex>=zoneMagIndex->size()-1)
+		return z->size;
+	return zoneMagIndex->at(magIndex+1);
+}
+
+template<class Star>
+const DecodedZoneData* SpecialZoneArray<Star>::getDecodedZone(int index) const
+{
+	if (decodedZones==Q_NULLPTR)
+		return Q_NULLPTR;
+	DecodedZoneData* published = decodedZones[index].loadAcquire();
+	if (published)
+		return published;
+
+	// Reserve the memory before decoding, the budget is shared by all catalogs and threads.
+	const SpecialZoneData<Star>* z = getZones() + index;
+	const int size = z->size;
+	const int reservedKb = (size*(4*sizeof(float)+2)+1023)/1024;
+	if (decodedCacheUsedKb.fetchAndAddOrdered(reservedKb)+reservedKb > decodedCacheBudgetKb)
+	{
+		decodedCacheUsedKb.fetchAndAddOrdered(-reservedKb);
+		return Q_NULLPTR;
+	}
+
+	DecodedZoneData* decoded = new DecodedZoneData;
+	decoded->x0.resize(size);
+	decoded->x1.resize(size);
+	decoded->dx0.resize(size);
+	decoded->dx1.resize(size);
+	decoded->mag.resize(size);
+	decoded->bV.resize(size);
+	bool hasProperMotion = false;
+	const Star* s = z->getStars();
+	for (int i=0;i<size;++i,++s)
+	{
+		decoded->x0[i] = (float)s->getX0();
+		decoded->x1[i] = (float)s->getX1();
+		decoded->dx0[i] = (float)s->getDx0();
+		decoded->dx1[i] = (float)s->getDx1();
+		decoded->mag[i] = s->getMag();
+		decoded->bV[i] = s->getBVIndex();
+		hasProperMotion |= (s->getDx0()!=0 || s->getDx1()!=0);
+	}
+	if (!hasProperMotion)
+	{
+		decoded->dx0.clear();
+		decoded->dx0.squeeze();
+		decoded->dx1.clear();
+		decoded->dx1.squeeze();
+	}
+	if (!decodedZones[index].testAndSetOrdered(Q_NULLPTR, decoded))
+	{
+		// Decoded at the same time by another thread, keep its copy
+		decodedCacheUsedKb.fetchAndAddOrdered(-reservedKb);
+		delete decoded;
+		return decodedZones[index].loadAcquire();
+	}
+	decodedCacheUsedKb.fetchAndAddOrdered(decoded->sizeInKb()-reservedKb);
+	return decoded;
+}
+
+template<class Star>
+QOpenGLBuffer* SpecialZoneArray<Star>::getGpuZone(int index, int cpuMagIndexLimit, int limitMagIndex) const
+{
+	if (gpuZones.isEmpty())
+	{
+		gpuZones.fill(Q_NULLPTR, nr_of_zones);
+		gpuZoneFirstStars.fill(0, nr_of_zones);
+	}
+	if (!ensureZoneLoaded(index))
+		return Q_NULLPTR;
+	// The stars are sorted by magnitude: the faint ones drawn on the GPU come last
+	const int firstStar = getNrOfStarsUpTo(index, cpuMagIndexLimit-1);
+	QOpenGLBuffer* buffer = gpuZones.at(index);
+	if (buffer && gpuZoneFirstStars.at(index)<=firstStar)
+		return buffer;
+	if (buffer)
+	{
+		// More stars than it holds are faint enough for the GPU now
+		gpuBufferUsedKb.fetchAndAddOrdered(-(buffer->size()+1023)/1024);
+		buffer->destroy();
+		delete buffer;
+		gpuZones[index] = Q_NULLPTR;
+	}
+
+	// Do not spend the budget on zones without faint stars
+	const SpecialZoneData<Star>* z = getZones() + index;
+	const int starCount = z->size-firstStar;
+	const int bytes = starCount*4*sizeof(StelSkyDrawer::StaticPointSourceVertex);
+	if (gpuBufferUsedKb.load()+(bytes+1023)/1024 > gpuBufferBudgetKb
+	    || getNrOfStarsUpTo(index, limitMagIndex)<=firstStar)
+		return Q_NULLPTR;
+
+	// The position at J2000.0 and the proper motion of the faint stars, which the
+	// vertex shader combines like getJ2000Pos() does
+	QVector<StelSkyDrawer::StaticPointSourceVertex> vertices(starCount*4);
+	const DecodedZoneData* decoded = getDecodedZone(index);
+	const bool hasProperMotion = decoded && !decoded->dx0.isEmpty();
+	const Star* const s = z->getStars();
+	for (int i=firstStar;i<z->size;++i)
+	{
+		StelSkyDrawer::StaticPointSourceVertex* quad = &vertices[(i-firstStar)*4];
+		if (decoded)
+		{
+			const Vec3f pos = z->center + z->axis0*decoded->x0[i] + z->axis1*decoded->x1[i];
+			const Vec3f motion = hasProperMotion ? z->axis0*decoded->dx0[i] + z->axis1*decoded->dx1[i] : Vec3f(0.f);
+			StelSkyDrawer::setStaticPointSource(quad, pos, motion, decoded->mag[i], decoded->bV[i]);
+		}
+		else
+		{
+			const Vec3f pos = z->center + z->axis0*(float)s[i].getX0() + z->axis1*(float)s[i].getX1();
+			const Vec3f motion = z->axis0*(float)s[i].getDx0() + z->axis1*(float)s[i].getDx1();
+			StelSkyDrawer::setStaticPointSource(quad, pos, motion, s[i].getMag(), s[i].getBVIndex());
+		}
+	}
+
+	buffer = new QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
+	buffer->setUsagePattern(QOpenGLBuffer::StaticDraw);
+	if (!buffer->create())
+	{
+		delete buffer;
+		return Q_NULLPTR;
+	}
+	buffer->bind();
+	buffer->allocate(vertices.constData(), bytes);
+	buffer->release();
+	gpuZones[index] = buffer;
+	gpuZoneFirstStars[index] = firstStar;
+	gpuBufferUsedKb.fetchAndAddOrdered((bytes+1023)/1024);
+	return buffer;
+}
+
+template<class Star>
+void SpecialZoneArray<Star>::decodeAllZones()
+{
+	// Decoding everything would defeat lazy loading
+	if (decodedZones==Q_NULLPTR || lazy)
+		return;
+	for (unsigned int z=0;z<nr_of_zones;z++)
+	{
+		if (getDecodedZone(z)==Q_NULLPTR)
+		{
+			qDebug() << "Decoded star cache budget exhausted while decoding level" << level;
+			return;
+		}
+	}
+}
+
+namespace
+{
+	// Number of stars decoded and tested together by SpecialZoneArray::cullStars.
+	// The inner loops work on plain float arrays of this size so that the compiler
+	// can keep them in vector registers.
+	const int StarCullBlockSize = 64;
+
+	// Functor used to run ZoneArray::cullStars with QtConcurrent::blockingMap
+	struct ZoneCuller
+	{
+		typedef void result_type;
+		ZoneCuller(const ZoneArray* array, int limitMagIndex, int cpuMagIndexLimit, const StelCore* core, const QVector<SphericalCap>& boundingCaps)
+			: array(array), limitMagIndex(limitMagIndex), cpuMagIndexLimit(cpuMagIndexLimit), core(core), boundingCaps(boundingCaps) {}
+		void operator()(ZoneDrawJob& job) const
+		{
+			array->cullStars(job, limitMagIndex, cpuMagIndexLimit, core, boundingCaps);
+		}
+		const ZoneArray* array;
+		int limitMagIndex;
+		int cpuMagIndexLimit;
+		const StelCore* core;
+		const QVector<SphericalCap>& boundingCaps;
+	};
+}
+
+void ZoneArray::draw(StelPainter* sPainter, QVector<ZoneDrawJob>& jobs, const RCMag* rcmag_table,
+		     int limitMagIndex, StelCore* core, int maxMagStarName, float names_brightness,
+		     const QVector<SphericalCap>& boundingCaps, int cpuMagIndexLimit) const
+{
+	if (jobs.isEmpty())
+		return;
+
+	// GL stage: upload the zones whose faint stars are drawn on the GPU.
+	const bool withGpu = cpuMagIndexLimit<=limitMagIndex;
+	if (withGpu)
+	{
+		for (QVector<ZoneDrawJob>::iterator it=jobs.begin();it!=jobs.end();++it)
+			it->gpuBuffer = getGpuZone(it->index, cpuMagIndexLimit, limitMagIndex);
+	}
+
+	// Data-parallel stage: decode positions, apply proper motion, cull and extinct.
+	if (jobs.size()==1)
+		cullStars(jobs.first(), limitMagIndex, cpuMagIndexLimit, core, boundingCaps);
+	else
+		QtConcurrent::blockingMap(jobs, ZoneCuller(this, limitMagIndex, cpuMagIndexLimit, core, boundingCaps));
+
+	// Serial stage: hand the survivors to the sky drawer, in zone order.
+	for (QVector<ZoneDrawJob>::const_iterator it=jobs.constBegin();it!=jobs.constEnd();++it)
+		drawCulledStars(sPainter, *it, rcmag_table, core, maxMagStarName, names_brightness);
+	if (withGpu)
+	{
+		StelSkyDrawer* drawer = core->getSkyDrawer();
+		for (QVector<ZoneDrawJob>::iterator it=jobs.begin();it!=jobs.end();++it)
+		{
+			if (it->gpuStarCount>0)
+				drawer->drawStaticPointSources(sPainter, *it->gpuBuffer, it->gpuFirstStar, it->gpuStarCount);
+		}
+	}
+}
+
+float ZoneArray::getMovementFactor(const StelCore* core) const
 {
-	StelSkyDrawer* drawer = core->getSkyDrawer();
-	Vec3f vf;
 	static const double d2000 = 2451545.0;
-	const float movementFactor = (M_PI/180.)*(0.0001/3600.) * ((core->getJDE()-d2000)/365.25) / star_position_scale;
+	return (M_PI/180.)*(0.0001/3600.) * ((core->getJDE()-d2000)/365.25) / star_position_scale;
+}
 
-	// GZ, added for extinction
-	const Extinction& extinction=core->getSkyDrawer()->getExtinction();
-	const bool withExtinction=drawer->getFlagHasAtmosphere() && extinction.getExtinctionCoefficient()>=0.01f;
-	const float k = 0.001f*mag_range/mag_steps; // from StarMgr.cpp line 654
-	
+int ZoneArray::getCutoffMagStep(const StelSkyDrawer* drawer, int limitMagIndex) const
+{
 	// Allow artificial cutoff:
 	// find the (integer) mag at which is just bright enough to be drawn.
 	int cutoffMagStep=limitMagIndex;
@@ -482,79 +1026,284 @@ void SpecialZoneArray<Star>::draw(StelPainter* sPainter, int index, bool isInsid
 		if (cutoffMagStep>limitMagIndex)
 			cutoffMagStep = limitMagIndex;
 	}
+	return cutoffMagStep;
+}
+
+template<class Star>
+void SpecialZoneArray<Star>::cullStars(ZoneDrawJob& job, int limitMagIndex, int cpuMagIndexLimit, const StelCore* core,
+				       const QVector<SphericalCap>& boundingCaps) const
+{
+	job.stars.clear();
+	job.gpuStarCount = 0;
+
+	const StelSkyDrawer* drawer = core->getSkyDrawer();
+	static const double d2000 = 2451545.0;
+	const float movementFactor = getMovementFactor(core);
+
+	// GZ, added for extinction
+	const Extinction& extinction=drawer->getExtinction();
+	const bool withExtinction=drawer->getFlagHasAtmosphere() && extinction.getExtinctionCoefficient()>=0.01f;
+	const float k = 0.001f*mag_range/mag_steps; // from StarMgr.cpp line 654
+
+	const int cutoffMagStep = getCutoffMagStep(drawer, limitMagIndex);
 	Q_ASSERT(cutoffMagStep<RCMAG_TABLE_SIZE);
-    
-	// Go through all stars, which are sorted by magnitude (bright stars first)
-	const SpecialZoneData<Star>* zoneToDraw = getZones() + index;
-	const Star* lastStar = zoneToDraw->getStars() + zoneToDraw->size;
-	for (const Star* s=zoneToDraw->getStars();s<lastStar;++s)
-	{
-		// Artifical cutoff per magnitude
-		if (s->getMag() > cutoffMagStep)
-			break;
-    
-		// Because of the test above, the star should always be visible from this point.
-		
-		// Array of 2 numbers containing radius and magnitude
-		const RCMag* tmpRcmag = &rcmag_table[s->getMag()];
-		
-		// Get the star position from the array
-		s->getJ2000Pos(zoneToDraw, movementFactor, vf);
-		
-		// If the star zone is not strictly contained inside the viewport, eliminate from the 
-		// beginning the stars actually outside viewport.
-		if (!isInsideViewport)
+
+	const SpecialZoneData<Star>* zoneToDraw = getZones() + job.index;
+	if (zoneToDraw->size==0)
+		return;
+
+	// With extinction no star of the zone is brighter than its brightest
+	// magnitude step, extincted at the highest altitude the zone can reach.
+	// Stars which would be extincted beyond the cutoff even there are skipped
+	// without being looked at.
+	int zoneCutoffMagStep = cutoffMagStep;
+	if (withExtinction)
+	{
+		// Angular radius of the zone, with a margin for rounding and for
+		// the proper motion of the fastest stars (about 10.4"/yr).
+		const double years = std::fabs(core->getJDE()-d2000)/365.25;
+		const double radius = std::acos(qBound(-1.f, zoneToDraw->cosRadius, 1.f)) + (0.5 + years*10.4/3600.)*M_PI/180.;
+		if (radius<M_PI)
 		{
-			vf.normalize();
-			bool isVisible = true;
-			foreach (const SphericalCap& cap, boundingCaps)
+			Vec3f center(zoneToDraw->center);
+			core->j2000ToAltAzInPlaceNoRefraction(&center);
+			const double alt = std::asin(qBound(-1.f, center[2], 1.f));
+			const float sinHigh = std::sin(qMin(alt+radius, M_PI/2.));
+			const float sinLow = std::sin(qMax(alt-radius, -M_PI/2.));
+			float sinBest = sinHigh;
+			bool unbounded = false;
+			if (sinLow < -0.035f) // where Extinction handles the underground
 			{
-				if (!cap.contains(vf))
+				switch (extinction.getUndergroundExtinctionMode())
 				{
-					isVisible = false;
-					continue;
+					case Extinction::UndergroundExtinctionZero:
+						unbounded = true;
+						break;
+					case Extinction::UndergroundExtinctionMirror:
+						sinBest = qMax(sinHigh, qMin(1.f, -0.07f-sinLow));
+						break;
+					case Extinction::UndergroundExtinctionMax:
+						break;
 				}
 			}
-			if (!isVisible)
-				continue;
+			if (!unbounded)
+			{
+				float minExtMagShift = 0.0f;
+				extinction.forward(Vec3f(std::sqrt(qMax(0.f, 1.f-sinBest*sinBest)), 0.f, sinBest), &minExtMagShift);
+				// Stars are dropped if their extincted index reaches the cutoff,
+				// keeping the one at the cutoff leaves a step for rounding.
+				zoneCutoffMagStep = cutoffMagStep - qMax(0, (int)(minExtMagShift/k));
+			}
 		}
+	}
+
+	// Stars are sorted by magnitude (bright stars first): the magnitude index
+	// tells where the artificial cutoff per magnitude ends the list of drawable stars.
+	if (zoneCutoffMagStep<0 || !ensureZoneLoaded(job.index))
+		return;
+	const Star* const firstStar = zoneToDraw->getStars();
+	int nrOfStars = getNrOfStarsUpTo(job.index, zoneCutoffMagStep);
+	if (job.gpuBuffer)
+	{
+		// The faint stars are drawn from the static buffer of the zone
+		const int nrOfCpuStars = getNrOfStarsUpTo(job.index, qMin(zoneCutoffMagStep, cpuMagIndexLimit-1));
+		job.gpuFirstStar = nrOfCpuStars-gpuZoneFirstStars.at(job.index);
+		job.gpuStarCount = nrOfStars-nrOfCpuStars;
+		nrOfStars = nrOfCpuStars;
+	}
+	if (nrOfStars==0)
+		return;
+	const DecodedZoneData* decoded = getDecodedZone(job.index);
+
+	// If the star zone is not strictly contained inside the viewport, the stars
+	// outside the viewport are eliminated from the beginning. Convert the caps
+	// once to single precision for the tests below.
+	const int nrOfCaps = job.isInsideViewport ? 0 : boundingCaps.size();
+	QVarLengthArray<float, 32> caps(nrOfCaps*4);
+	for (int c=0;c<nrOfCaps;++c)
+	{
+		const SphericalCap& cap = boundingCaps.at(c);
+		caps[c*4]   = cap.n[0];
+		caps[c*4+1] = cap.n[1];
+		caps[c*4+2] = cap.n[2];
+		caps[c*4+3] = cap.d;
+	}
 
-		int extinctedMagIndex = s->getMag();
-		float twinkleFactor=1.0f; // allow height-dependent twinkle.
-		if (withExtinction)
+	float px[StarCullBlockSize];
+	float py[StarCullBlockSize];
+	float pz[StarCullBlockSize];
+	int mags[StarCullBlockSize];
+	int bVs[StarCullBlockSize];
+	unsigned char visible[StarCullBlockSize];
+
+	const Vec3f& c = zoneToDraw->center;
+	const Vec3f& a0 = zoneToDraw->axis0;
+	const Vec3f& a1 = zoneToDraw->axis1;
+
+	job.stars.reserve(nrOfStars);
+	for (int blockStart=0;blockStart<nrOfStars;blockStart+=StarCullBlockSize)
+	{
+		const int n = qMin(StarCullBlockSize, nrOfStars-blockStart);
+		const Star* const s = firstStar + blockStart;
+
+		// Get the star positions from the array
+		if (decoded)
 		{
-			Vec3f altAz(vf);
-			altAz.normalize();
-			core->j2000ToAltAzInPlaceNoRefraction(&altAz);
-			float extMagShift=0.0f;
-			extinction.forward(altAz, &extMagShift);
-			extinctedMagIndex = s->getMag() + (int)(extMagShift/k);
-			if (extinctedMagIndex >= cutoffMagStep || extinctedMagIndex<0) // i.e., if extincted it is dimmer than cutoff or extinctedMagIndex is negative (missing star catalog), so remove
+			const float* x0 = decoded->x0.constData() + blockStart;
+			const float* x1 = decoded->x1.constData() + blockStart;
+			if (decoded->dx0.isEmpty())
+			{
+				for (int i=0;i<n;++i)
+				{
+					px[i] = c[0] + a0[0]*x0[i] + a1[0]*x1[i];
+					py[i] = c[1] + a0[1]*x0[i] + a1[1]*x1[i];
+					pz[i] = c[2] + a0[2]*x0[i] + a1[2]*x1[i];
+				}
+			}
+			else
+			{
+				const float* dx0 = decoded->dx0.constData() + blockStart;
+				const float* dx1 = decoded->dx1.constData() + blockStart;
+				for (int i=0;i<n;++i)
+				{
+					const float u = x0[i] + movementFactor*dx0[i];
+					const float v = x1[i] + movementFactor*dx1[i];
+					px[i] = c[0] + a0[0]*u + a1[0]*v;
+					py[i] = c[1] + a0[1]*u + a1[1]*v;
+					pz[i] = c[2] + a0[2]*u + a1[2]*v;
+				}
+			}
+			const quint8* mag = decoded->mag.constData() + blockStart;
+			const quint8* bV = decoded->bV.constData() + blockStart;
+			for (int i=0;i<n;++i)
+			{
+				mags[i] = mag[i];
+				bVs[i] = bV[i];
+			}
+		}
+		else
+		{
+			Vec3f vf;
+			for (int i=0;i<n;++i)
+			{
+				s[i].getJ2000Pos(zoneToDraw, movementFactor, vf);
+				px[i] = vf[0];
+				py[i] = vf[1];
+				pz[i] = vf[2];
+				mags[i] = s[i].getMag();
+				bVs[i] = s[i].getBVIndex();
+			}
+		}
+
+		for (int i=0;i<n;++i)
+			visible[i] = 1;
+		if (nrOfCaps>0)
+		{
+			for (int i=0;i<n;++i)
+			{
+				const float invLength = 1.f/std::sqrt(px[i]*px[i]+py[i]*py[i]+pz[i]*pz[i]);
+				px[i] *= invLength;
+				py[i] *= invLength;
+				pz[i] *= invLength;
+			}
+			for (int c=0;c<nrOfCaps;++c)
+			{
+				const float nx = caps[c*4], ny = caps[c*4+1], nz = caps[c*4+2], d = caps[c*4+3];
+				for (int i=0;i<n;++i)
+					visible[i] &= (px[i]*nx+py[i]*ny+pz[i]*nz >= d) ? 1 : 0;
+			}
+		}
+
+		for (int i=0;i<n;++i)
+		{
+			if (!visible[i])
 				continue;
-			tmpRcmag = &rcmag_table[extinctedMagIndex];
-			twinkleFactor=qMin(1.0f, 1.0f-0.9f*altAz[2]); // suppress twinkling in higher altitudes. Keep 0.1 twinkle amount in zenith.
+
+			CulledStar culled;
+			culled.pos.set(px[i], py[i], pz[i]);
+			culled.starIndex = blockStart+i;
+			culled.extinctedMagIndex = mags[i];
+			culled.twinkleFactor = 1.0f; // allow height-dependent twinkle.
+			culled.bV = bVs[i];
+			if (withExtinction)
+			{
+				Vec3f altAz(culled.pos);
+				altAz.normalize();
+				core->j2000ToAltAzInPlaceNoRefraction(&altAz);
+				float extMagShift=0.0f;
+				extinction.forward(altAz, &extMagShift);
+				culled.extinctedMagIndex = mags[i] + (int)(extMagShift/k);
+				if (culled.extinctedMagIndex >= cutoffMagStep || culled.extinctedMagIndex<0) // i.e., if extincted it is dimmer than cutoff or extinctedMagIndex is negative (missing star catalog), so remove
+					continue;
+				culled.twinkleFactor=qMin(1.0f, 1.0f-0.9f*altAz[2]); // suppress twinkling in higher altitudes. Keep 0.1 twinkle amount in zenith.
+			}
+			job.stars.append(culled);
 		}
+	}
+}
 
-		if (drawer->drawPointSource(sPainter, vf, *tmpRcmag, s->getBVIndex(), !isInsideViewport, twinkleFactor) && s->hasName() && extinctedMagIndex < maxMagStarName && s->hasComponentID()<=1)
+template<class Star>
+void SpecialZoneArray<Star>::drawCulledStars(StelPainter* sPainter, const ZoneDrawJob& job, const RCMag* rcmag_table,
+					     StelCore* core, int maxMagStarName, float names_brightness) const
+{
+	StelSkyDrawer* drawer = core->getSkyDrawer();
+	const SpecialZoneData<Star>* zoneToDraw = getZones() + job.index;
+	for (QVector<CulledStar>::const_iterator it=job.stars.constBegin();it!=job.stars.constEnd();++it)
+	{
+		// Array of 2 numbers containing radius and magnitude
+		const RCMag* tmpRcmag = &rcmag_table[it->extinctedMagIndex];
+		if (drawer->drawPointSource(sPainter, it->pos, *tmpRcmag, it->bV, !job.isInsideViewport, it->twinkleFactor) && it->extinctedMagIndex < maxMagStarName)
 		{
-			const float offset = tmpRcmag->radius*0.7f;
-			const Vec3f colorr = StelSkyDrawer::indexToColor(s->getBVIndex())*0.75f;
-			sPainter->setColor(colorr[0], colorr[1], colorr[2],names_brightness);
-			sPainter->drawText(Vec3d(vf[0], vf[1], vf[2]), s->getNameI18n(), 0, offset, offset, false);
+			const Star* s = zoneToDraw->getStars() + it->starIndex;
+			if (s->hasName() && s->hasComponentID()<=1)
+			{
+				const float offset = tmpRcmag->radius*0.7f;
+				const Vec3f colorr = StelSkyDrawer::indexToColor(it->bV)*0.75f;
+				sPainter->setColor(colorr[0], colorr[1], colorr[2],names_brightness);
+				sPainter->drawText(Vec3d(it->pos[0], it->pos[1], it->pos[2]), s->getNameI18n(), 0, offset, offset, false);
+			}
 		}
 	}
 }
 
 template<class Star>
 void SpecialZoneArray<Star>::searchAround(const StelCore* core, int index, const Vec3d &v, double cosLimFov,
-					  QList<StelObjectP > &result)
+					  int maxMagIndex, QList<StelObjectP > &result)
 {
 	static const double d2000 = 2451545.0;
 	const double movementFactor = (M_PI/180.)*(0.0001/3600.) * ((core->getJDE()-d2000)/365.25)/ star_position_scale;
+	if (!ensureZoneLoaded(index))
+		return;
 	const SpecialZoneData<Star> *const z = getZones()+index;
+	const int nrOfStars = getNrOfStarsUpTo(index, maxMagIndex);
+	if (nrOfStars==0)
+		return;
 	Vec3f tmp;
 	Vec3f vf(v[0], v[1], v[2]);
-	for (const Star* s=z->getStars();s<z->getStars()+z->size;++s)
+	const DecodedZoneData* decoded = getDecodedZone(index);
+	if (decoded)
+	{
+		const bool hasProperMotion = !decoded->dx0.isEmpty();
+		for (int i=0;i<nrOfStars;++i)
+		{
+			float u = decoded->x0[i];
+			float w = decoded->x1[i];
+			if (hasProperMotion)
+			{
+				u += movementFactor*decoded->dx0[i];
+				w += movementFactor*decoded->dx1[i];
+			}
+			tmp = z->center + z->axis0*u + z->axis1*w;
+			tmp.normalize();
+			if (tmp*vf >= cosLimFov)
+			{
+				// TODO: do not select stars that are too faint to display
+				result.push_back(z->getStars()[i].createStelObject(this,z));
+			}
+		}
+		return;
+	}
+	for (const Star* s=z->getStars();s<z->getStars()+nrOfStars;++s)
 	{
 		s->getJ2000Pos(z,movementFactor, tmp);
 		tmp.normalize();
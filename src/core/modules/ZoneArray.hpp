@@ -33,10 +33,17 @@
 #include <QString>
 #include <QFile>
 #include <QDebug>
+#include <QVector>
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QMutex>
 
 #ifdef __OpenBSD__
 #include <unistd.h>
 #endif
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#endif
 
 class StelPainter;
 
@@ -68,6 +75,58 @@ struct HipIndexStruct
 	const Star1 *s;
 };
 
+//! @struct CulledStar
+//! A star which survived the culling stage of ZoneArray::draw. The culling
+//! stage runs in worker threads, the survivors are then handed to the
+//! StelSkyDrawer on the main thread.
+struct CulledStar
+{
+	Vec3f pos;		// J2000 position, normalized if the zone is on the viewport border
+	int starIndex;		// Index of the star in its zone
+	int extinctedMagIndex;	// Index in the RCMag table, taking extinction into account
+	float twinkleFactor;	// Height-dependent twinkle factor
+	int bV;			// B-V index of the star
+};
+
+//! @struct ZoneDrawJob
+//! One zone to be drawn by ZoneArray::draw, together with the stars of
+//! this zone which are still visible after culling.
+struct ZoneDrawJob
+{
+	ZoneDrawJob() : index(-1), isInsideViewport(false), gpuBuffer(Q_NULLPTR), gpuFirstStar(0), gpuStarCount(0) {}
+	ZoneDrawJob(int index, bool isInsideViewport)
+		: index(index), isInsideViewport(isInsideViewport), gpuBuffer(Q_NULLPTR), gpuFirstStar(0), gpuStarCount(0) {}
+	int index;
+	bool isInsideViewport;
+	QVector<CulledStar> stars;
+	//! Static vertex buffer of the zone if its faint stars are drawn on the GPU
+	QOpenGLBuffer* gpuBuffer;
+	//! The stars of the zone drawn from gpuBuffer, they are not culled on the CPU.
+	//! gpuFirstStar counts from the first star uploaded to gpuBuffer.
+	int gpuFirstStar;
+	int gpuStarCount;
+};
+
+//! @struct DecodedZoneData
+//! Structure-of-arrays copy of the stars of one zone. The packed star records
+//! are decoded only once, the draw and search loops then read linear float arrays.
+struct DecodedZoneData
+{
+	QVector<float> x0;
+	QVector<float> x1;
+	QVector<float> dx0;	// Empty if no star of the zone has a proper motion
+	QVector<float> dx1;	// Empty if no star of the zone has a proper motion
+	QVector<quint8> mag;
+	QVector<quint8> bV;
+
+	//! Get the memory used by the decoded zone in kilobytes (rounded up).
+	int sizeInKb() const
+	{
+		const qint64 bytes = sizeof(float)*(x0.size()+x1.size()+dx0.size()+dx1.size()) + mag.size() + bV.size();
+		return (bytes+1023)/1024;
+	}
+};
+
 //! @class ZoneArray
 //! Manages all ZoneData structures of a given StelGeodesicGrid level. An
 //! instance of this class is never created directly; the named constructor
@@ -79,10 +138,15 @@ public:
 	//! Named public constructor for ZoneArray. Opens a catalog, reads its
 	//! header info, and creates a SpecialZoneArray or HipZoneArray for
 	//! loading.
+	//! Catalogs which cannot be mmapped directly (e.g. byte-swapped files) are
+	//! converted once into a native copy in the cache directory, which is
+	//! mmapped instead.
 	//! @param extended_file_name path of the star catalog to load from
 	//! @param use_mmap whether or not to mmap the star catalog
+	//! @param checksum MD5 checksum of the catalog, used to identify its native copy.
+	//! If empty, the size and modification time of the catalog are used instead.
 	//! @return an instance of SpecialZoneArray or HipZoneArray
-	static ZoneArray *create(const QString &extended_file_name, bool use_mmap);
+	static ZoneArray *create(const QString &extended_file_name, bool use_mmap, const QString& checksum=QString());
 	virtual ~ZoneArray()
 	{
 		nr_of_zones = 0;
@@ -96,13 +160,92 @@ public:
 
 	//! Pure virtual method. See subclass implementation.
 	virtual void searchAround(const StelCore* core, int index,const Vec3d &v,double cosLimFov,
-							  QList<StelObjectP > &result) = 0;
+				  int maxMagIndex, QList<StelObjectP > &result) = 0;
+
+	//! Draw stars and their names onto the viewport.
+	//! The stars of all zones are first culled in parallel (position, proper motion,
+	//! bounding caps and extinction), the survivors are then drawn serially.
+	//! The faint stars of a zone may instead be drawn from a static vertex buffer
+	//! by the StelSkyDrawer, which then does all these computations on the GPU.
+	//! @param sPainter the painter to use
+	//! @param jobs the zones to draw. The culled stars are stored in the jobs.
+	//! @param rcmag_table table of magnitudes
+	//! @param limitMagIndex index from rcmag_table at which stars are not visible anymore
+	//! @param core core to use for drawing
+	//! @param maxMagStarName magnitude limit of stars that display labels
+	//! @param names_brightness brightness of labels
+	//! @param boundingCaps the bounding caps of the viewport
+	//! @param cpuMagIndexLimit stars with this magnitude index or fainter are drawn on the GPU
+	//! when the GPU buffer budget allows it. Above limitMagIndex, all stars are drawn on the CPU.
+	//! Otherwise StelSkyDrawer::preDrawStaticPointSources() and setStaticPointSourceParams() must
+	//! have been called.
+	void draw(StelPainter* sPainter, QVector<ZoneDrawJob>& jobs,
+		  const RCMag* rcmag_table, int limitMagIndex, StelCore* core,
+		  int maxMagStarName, float names_brightness,
+		  const QVector<SphericalCap>& boundingCaps, int cpuMagIndexLimit) const;
+
+	//! Get the factor applied to the proper motion of the stars at the current date.
+	float getMovementFactor(const StelCore* core) const;
+
+	//! Get the magnitude index from which stars are not drawn, taking the
+	//! artificial cutoff of the sky drawer into account.
+	//! @param limitMagIndex index from the RCMag table at which stars are not visible anymore
+	int getCutoffMagStep(const StelSkyDrawer* drawer, int limitMagIndex) const;
+
+	//! Pure virtual method. See subclass implementation.
+	virtual void cullStars(ZoneDrawJob& job, int limitMagIndex, int cpuMagIndexLimit, const StelCore* core,
+			       const QVector<SphericalCap>& boundingCaps) const = 0;
+
+	//! Pure virtual method. See subclass implementation.
+	virtual QOpenGLBuffer* getGpuZone(int index, int cpuMagIndexLimit, int limitMagIndex) const = 0;
 
 	//! Pure virtual method. See subclass implementation.
-	virtual void draw(StelPainter* sPainter, int index,bool is_inside,
-					  const RCMag* rcmag_table, int limitMagIndex, StelCore* core,
-					  int maxMagStarName, float names_brightness,
-					  const QVector<SphericalCap>& boundingCaps) const = 0;
+	virtual void drawCulledStars(StelPainter* sPainter, const ZoneDrawJob& job,
+				     const RCMag* rcmag_table, StelCore* core,
+				     int maxMagStarName, float names_brightness) const = 0;
+
+	//! Set the memory budget shared by the decoded star caches of all catalogs.
+	//! Zones are only decoded while the budget allows it, otherwise the packed
+	//! star records are used.
+	//! @param megabytes the budget in MB. 0 disables the decoded caches.
+	static void setDecodedCacheBudget(int megabytes);
+
+	//! Get the memory currently used by the decoded star caches of all catalogs in kB.
+	static int getDecodedCacheUsage() { return decodedCacheUsedKb.load(); }
+
+	//! Set the memory budget shared by the static vertex buffers of all catalogs,
+	//! from which the faint stars are drawn on the GPU. Zones beyond the budget
+	//! are drawn on the CPU.
+	//! @param megabytes the budget in MB of GPU memory
+	static void setGpuBufferBudget(int megabytes);
+
+	//! Get the GPU memory currently used by the static vertex buffers of all catalogs in kB.
+	static int getGpuBufferUsage() { return gpuBufferUsedKb.load(); }
+
+	//! Decode all zones of this catalog into the decoded cache, as long as the
+	//! memory budget allows it.
+	virtual void decodeAllZones() = 0;
+
+	//! Enable or disable lazy loading of the faint star catalogs (all but the
+	//! Hipparcos ones). In lazy mode only the header and the zone table of a
+	//! catalog are read at startup. The stars of a zone are read the first time
+	//! the zone is drawn or searched, and zones unused for the longest time are
+	//! evicted when the memory budget is exceeded. Must be set before loading.
+	//! @param enabled whether lazy loading is used
+	//! @param budgetMb the memory budget shared by all lazily loaded catalogs in MB
+	static void setLazyLoading(bool enabled, int budgetMb);
+
+	//! Get the memory currently used by lazily loaded zones of all catalogs in kB.
+	static int getLazyLoadedUsage() { return lazyLoadedKb.load(); }
+
+	//! Start a new frame for the lazy loading LRU. Zones used in the current
+	//! frame are never evicted.
+	static void advanceLazyClock() { lazyClock.fetchAndAddOrdered(1); }
+
+	//! Evict the lazily loaded zones which were unused for the longest time,
+	//! until the memory budget is respected again. Must not be called while
+	//! zones of this catalog are drawn or searched.
+	virtual void evictLazyZones() = 0;
 
 	//! Get whether or not the catalog was successfully loaded.
 	//! @return @c true if at least one zone was loaded, otherwise @c false
@@ -135,12 +278,67 @@ protected:
 	//! @return @c true if successful, or @c false if an error occurred
 	static bool readFile(QFile& file, void *data, qint64 size);
 
+	//! Get the path of the native copy of a catalog in the cache directory.
+	static QString getNativeCopyPath(const QString& catalogFilePath, const QString& checksum);
+
+	//! Write a copy of a catalog with header and zone sizes in native byte order,
+	//! so that it can be mmapped. The star records themselves are stored in a fixed
+	//! byte order and are copied unchanged.
+	//! @param file the catalog, positioned just after its header
+	//! @param nativePath path of the copy to write
+	//! @param byte_swap whether the header and zone sizes of the catalog must be swapped
+	//! @return @c true if successful, or @c false if an error occurred
+	static bool writeNativeCopy(QFile& file, const QString& nativePath, bool byte_swap,
+				    unsigned int type, unsigned int major, unsigned int minor, unsigned int level,
+				    unsigned int mag_min, unsigned int mag_range, unsigned int mag_steps);
+
+	//! Give the OS paging hints for a mmapped catalog.
+	static void adviseMapping(const uchar* start, qint64 size, bool willNeed);
+
 	//! Protected constructor. Initializes fields and does not load anything.
 	ZoneArray(const QString& fname, QFile* file, int level, int mag_min, int mag_range, int mag_steps);
 	unsigned int nr_of_zones;
 	unsigned int nr_of_stars;
 	ZoneData *zones;
 	QFile* file;
+
+	//! Decoded copies of the zones, one pointer per zone, or Q_NULLPTR if the decoded
+	//! cache is disabled. Filled lazily the first time a zone is drawn or searched.
+	//! A zone may be decoded by a draw job and a search at the same time: the first
+	//! decoded copy is published with a compare-and-swap and the other one dropped.
+	mutable QAtomicPointer<DecodedZoneData> *decodedZones;
+
+	//! Magnitude index of the zones, one pointer per zone, null until the zone is
+	//! first used. As the stars of a zone are sorted by magnitude, entry m is the
+	//! number of stars with a magnitude index lower than m. Published like the
+	//! decoded zones.
+	mutable QAtomicPointer<QVector<int> > *magIndexes;
+
+	//! Static vertex buffers of the zones, one pointer per zone, null until the
+	//! faint stars of the zone are first drawn on the GPU. Only used from the main thread.
+	mutable QVector<QOpenGLBuffer*> gpuZones;
+	//! Index in the zone of the first star uploaded to each of gpuZones: the bright
+	//! stars drawn on the CPU are left out of the buffers.
+	mutable QVector<int> gpuZoneFirstStars;
+
+	//! Memory budget of the decoded caches of all catalogs in kB.
+	static int decodedCacheBudgetKb;
+	//! Memory used by the decoded caches of all catalogs in kB.
+	static QAtomicInt decodedCacheUsedKb;
+
+	//! GPU memory budget of the static vertex buffers of all catalogs in kB.
+	static int gpuBufferBudgetKb;
+	//! GPU memory used by the static vertex buffers of all catalogs in kB.
+	static QAtomicInt gpuBufferUsedKb;
+
+	//! Whether the faint star catalogs are loaded lazily.
+	static bool lazyLoading;
+	//! Memory budget of the lazily loaded zones of all catalogs in kB.
+	static int lazyBudgetKb;
+	//! Memory used by the lazily loaded zones of all catalogs in kB.
+	static QAtomicInt lazyLoadedKb;
+	//! Frame counter used to find the least recently used zones.
+	static QAtomicInt lazyClock;
 };
 
 //! @class SpecialZoneArray
@@ -156,11 +354,12 @@ public:
 	//! @param file catalog to load from
 	//! @param byte_swap whether to switch endianness of catalog data
 	//! @param use_mmap whether or not to mmap the star catalog
+	//! @param lazy whether the stars of a zone are only read when the zone is first used
 	//! @param level level in StelGeodesicGrid
 	//! @param mag_min lower bound of magnitudes
 	//! @param mag_range range of magnitudes
 	//! @param mag_steps number of steps used to describe values in range
-	SpecialZoneArray(QFile* file,bool byte_swap,bool use_mmap,int level,int mag_min,
+	SpecialZoneArray(QFile* file,bool byte_swap,bool use_mmap,bool lazy,int level,int mag_min,
 			 int mag_range,int mag_steps);
 	~SpecialZoneArray(void);
 protected:
@@ -170,27 +369,69 @@ protected:
 		return static_cast<SpecialZoneData<Star>*>(zones);
 	}
 
-	//! Draw stars and their names onto the viewport.
-	//! @param sPainter the painter to use 
-	//! @param index zone index to draw
-	//! @param isInsideViewport whether the zone is inside the current viewport
-	//! @param rcmag_table table of magnitudes
+	//! Compute the stars of a zone which are visible. Thread safe, called
+	//! from worker threads.
+	//! @param job the zone to cull, the visible stars are stored in it
 	//! @param limitMagIndex index from rcmag_table at which stars are not visible anymore
+	//! @param cpuMagIndexLimit if the zone has a GPU buffer, stars with this magnitude
+	//! index or fainter are left to the GPU
+	//! @param core core to use for drawing
+	//! @param boundingCaps the bounding caps of the viewport
+	virtual void cullStars(ZoneDrawJob& job, int limitMagIndex, int cpuMagIndexLimit, const StelCore* core,
+			       const QVector<SphericalCap>& boundingCaps) const;
+
+	//! Get the static vertex buffer of a zone, uploading its stars from magnitude index
+	//! cpuMagIndexLimit on first if the GPU buffer budget allows it. The buffer is uploaded
+	//! again if cpuMagIndexLimit drops below the stars it holds. Must be called from the main thread.
+	//! @return the buffer, or Q_NULLPTR if the zone has no star with a magnitude
+	//! index from cpuMagIndexLimit to limitMagIndex or if the buffer cannot be created
+	virtual QOpenGLBuffer* getGpuZone(int index, int cpuMagIndexLimit, int limitMagIndex) const;
+
+	//! Draw the culled stars of a zone and their names onto the viewport.
+	//! @param sPainter the painter to use
+	//! @param job the zone with its culled stars
+	//! @param rcmag_table table of magnitudes
 	//! @param core core to use for drawing
 	//! @param maxMagStarName magnitude limit of stars that display labels
 	//! @param names_brightness brightness of labels
-	virtual void draw(StelPainter* sPainter, int index, bool isInsideViewport,
-			  const RCMag *rcmag_table, int limitMagIndex, StelCore* core,
-			  int maxMagStarName, float names_brightness,
-			  const QVector<SphericalCap>& boundingCaps) const;
+	virtual void drawCulledStars(StelPainter* sPainter, const ZoneDrawJob& job,
+				     const RCMag* rcmag_table, StelCore* core,
+				     int maxMagStarName, float names_brightness) const;
 
 	virtual void scaleAxis();
+	//! Search the stars of a zone around a position.
+	//! @param maxMagIndex fainter stars are skipped without being looked at
 	virtual void searchAround(const StelCore* core, int index,const Vec3d &v,double cosLimFov,
-					  QList<StelObjectP > &result);
+				  int maxMagIndex, QList<StelObjectP > &result);
+	virtual void decodeAllZones();
+	virtual void evictLazyZones();
+
+	//! Get the decoded copy of a zone, decoding it first if the memory budget allows it.
+	//! @return the decoded zone, or Q_NULLPTR if the packed stars must be used
+	const DecodedZoneData* getDecodedZone(int index) const;
+
+	//! Make sure the stars of a zone are in memory, reading them from the
+	//! catalog file in lazy mode. Thread safe.
+	//! @return @c false if the stars of the zone could not be read
+	bool ensureZoneLoaded(int index) const;
+
+	//! Get the number of stars of a zone with a magnitude index not larger
+	//! than @em magIndex, i.e. the length of the list of these stars at the
+	//! beginning of the zone. The zone must be loaded.
+	int getNrOfStarsUpTo(int index, int magIndex) const;
 
 	Star *stars;
 private:
 	uchar *mmap_start;
+
+	//! Whether the stars of each zone are read on first use.
+	const bool lazy;
+	//! File offsets of the stars of each zone, only used in lazy mode.
+	qint64 *zoneOffsets;
+	//! Value of the lazy clock at the last use of each zone, only used in lazy mode.
+	mutable quint32 *zoneLastUse;
+	//! Protects the catalog file and the zone table in lazy mode.
+	mutable QMutex lazyMutex;
 };
 
 //! @class HipZoneArray
@@ -201,7 +442,7 @@ class HipZoneArray : public SpecialZoneArray<Star1>
 public:
 	HipZoneArray(QFile* file,bool byte_swap,bool use_mmap,
 		   int level,int mag_min,int mag_range,int mag_steps)
-			: SpecialZoneArray<Star1>(file,byte_swap,use_mmap,level,
+			: SpecialZoneArray<Star1>(file,byte_swap,use_mmap,false,level,
 									  mag_min,mag_range,mag_steps) {}
 
 	//! Add Hipparcos information for all stars in this catalog into @em hipIndex.
@@ -44,6 +44,7 @@ struct ZoneData
 	Vec3f center;	// Normalized center of the triangle
 	Vec3f axis0;	// Normalized direction vector of axis 0 (use for storing stars position in 2D relative to this axis)
 	Vec3f axis1;	// Normalized direction vector of axis 0 (use for storing stars position in 2D relative to this axis)
+	float cosRadius;	// Cosine of the angular distance between the center and the farthest corner of the triangle
 	int size;		// Number of stars in the stars array
 	void *stars;
 };
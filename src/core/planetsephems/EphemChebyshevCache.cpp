@@ -0,0 +1,150 @@
+/*
+Copyright (C) 2026 Stellarium Developers
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Library General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+*/
+
+#include "EphemChebyshevCache.hpp"
+#include "elp82b.h"
+#include "l1.h"
+#include "tass17.h"
+#include "gust86.h"
+
+#include <cmath>
+
+static void elp82bCoor(double jd, int body, double xyz[3])
+{
+	Q_UNUSED(body);
+	GetElp82bCoorUninterpolated(jd,xyz);
+}
+
+const EphemChebyshevCache::Series EphemChebyshevCache::theorySeries[TheorySeriesCount] =
+{
+	{&elp82bCoor, 0, 4., 1e-10},
+	{&GetL1CoorUninterpolated, L1_IO, 0.5, 1e-10},
+	{&GetL1CoorUninterpolated, L1_EUROPA, 0.5, 1e-10},
+	{&GetL1CoorUninterpolated, L1_GANYMEDE, 1., 1e-10},
+	{&GetL1CoorUninterpolated, L1_CALLISTO, 1., 1e-10},
+	{&GetTass17CoorUninterpolated, TASS17_MIMAS, 0.25, 1e-10},
+	{&GetTass17CoorUninterpolated, TASS17_ENCELADUS, 0.25, 1e-10},
+	{&GetTass17CoorUninterpolated, TASS17_TETHYS, 0.5, 1e-10},
+	{&GetTass17CoorUninterpolated, TASS17_DIONE, 0.5, 1e-10},
+	{&GetTass17CoorUninterpolated, TASS17_RHEA, 1., 1e-10},
+	{&GetTass17CoorUninterpolated, TASS17_TITAN, 2., 1e-10},
+	{&GetTass17CoorUninterpolated, TASS17_HYPERION, 2., 1e-10},
+	{&GetTass17CoorUninterpolated, TASS17_IAPETUS, 1., 1e-10},
+	{&GetGust86CoorUninterpolated, GUST86_MIRANDA, 0.25, 1e-10},
+	{&GetGust86CoorUninterpolated, GUST86_ARIEL, 0.5, 1e-10},
+	{&GetGust86CoorUninterpolated, GUST86_UMBRIEL, 1., 1e-10},
+	{&GetGust86CoorUninterpolated, GUST86_TITANIA, 2., 1e-10},
+	{&GetGust86CoorUninterpolated, GUST86_OBERON, 2., 1e-10}
+};
+
+EphemChebyshevCache::EphemChebyshevCache(int maxWindows)
+	: windows(maxWindows)
+{
+}
+
+void EphemChebyshevCache::clear()
+{
+	QMutexLocker lock(&mutex);
+	windows.clear();
+}
+
+void EphemChebyshevCache::getCoor(const Series& series, double jd, double xyz[3])
+{
+	const qint64 window = (qint64)std::floor(jd/series.window);
+	// Position of jd in the window, in [-1, 1]
+	const double t = 2.*(jd/series.window - window) - 1.;
+	const Key key = {&series, window};
+	{
+		QMutexLocker lock(&mutex);
+		Window* w = windows.object(key);
+		if (w==Q_NULLPTR)
+		{
+			// First use of the window: only remember it. Windows used a single time,
+			// e.g. by the samples of an orbit line, would cost more to fit than they save.
+			windows.insert(key, new Window());
+		}
+		else if (w->fitted)
+		{
+			if (w->usable)
+			{
+				evaluate(*w, t, xyz);
+				return;
+			}
+		}
+		else
+		{
+			// Second use: fit the window, without holding the lock during the evaluations of the theory.
+			lock.unlock();
+			Window* fitted = new Window();
+			fit(series, window, fitted);
+			lock.relock();
+			windows.insert(key, fitted);
+			if (fitted->usable)
+			{
+				evaluate(*fitted, t, xyz);
+				return;
+			}
+		}
+	}
+	series.func(jd, series.body, xyz);
+}
+
+void EphemChebyshevCache::fit(const Series& series, qint64 window, Window* w)
+{
+	// Interpolation at the Chebyshev nodes, see e.g. Numerical Recipes, 5.8
+	double f[Coefficients][3];
+	for (int k=0; k<Coefficients; ++k)
+	{
+		const double x = std::cos(M_PI*(k+0.5)/Coefficients);
+		const double jd = (window + 0.5*(x+1.))*series.window;
+		series.func(jd, series.body, f[k]);
+	}
+	double error = 0.;
+	for (int i=0; i<3; ++i)
+	{
+		for (int j=0; j<Coefficients; ++j)
+		{
+			double sum = 0.;
+			for (int k=0; k<Coefficients; ++k)
+				sum += f[k][i]*std::cos(M_PI*j*(k+0.5)/Coefficients);
+			w->c[i][j] = 2.*sum/Coefficients;
+		}
+		// The series converge quickly: the last coefficients bound the error of the truncated ones.
+		error = qMax(error, std::fabs(w->c[i][Coefficients-2]) + std::fabs(w->c[i][Coefficients-1]));
+	}
+	w->fitted = true;
+	w->usable = error < series.maxError;
+}
+
+void EphemChebyshevCache::evaluate(const Window& w, double t, double xyz[3])
+{
+	// Clenshaw's recurrence
+	const double t2 = 2.*t;
+	for (int i=0; i<3; ++i)
+	{
+		double d = 0.;
+		double dd = 0.;
+		for (int j=Coefficients-1; j>0; --j)
+		{
+			const double sv = d;
+			d = t2*d - dd + w.c[i][j];
+			dd = sv;
+		}
+		xyz[i] = t*d - dd + 0.5*w.c[i][0];
+	}
+}
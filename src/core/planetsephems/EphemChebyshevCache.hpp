@@ -0,0 +1,107 @@
+/*
+Copyright (C) 2026 Stellarium Developers
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU Library General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+*/
+
+#ifndef _EPHEMCHEBYSHEVCACHE_HPP_
+#define _EPHEMCHEBYSHEVCACHE_HPP_
+
+#include <QCache>
+#include <QMutex>
+
+//! @class EphemChebyshevCache
+//! A cache of Chebyshev polynomials fitted to the positions given by an expensive
+//! analytic theory (ELP82B, L1, TASS17, GUST86), like the JPL ephemerides store them.
+//! The time is split into fixed windows per body. When the same window is used a second
+//! time, the theory is evaluated at the Chebyshev nodes of the window and the positions
+//! are interpolated from the fit afterwards. A window is only used if the estimated
+//! interpolation error is below the maximum error of the body, otherwise the theory is
+//! evaluated directly. The most recently used windows are kept. All methods are thread-safe.
+//! @note The functions must not interpolate between steps, like GetL1Coor() does:
+//! polynomials cannot fit the kinks at the steps.
+class EphemChebyshevCache
+{
+public:
+	//! A function computing the position of a body, e.g. GetL1CoorUninterpolated().
+	//! It must be reentrant.
+	typedef void (*CoorFunc)(double jd, int body, double xyz[3]);
+
+	//! The bodies computed with the cache, one static instance per body.
+	struct Series
+	{
+		CoorFunc func;
+		int body;
+		double window;	//! length of the time windows [days]
+		double maxError;	//! maximum estimated interpolation error of a window [AU]
+	};
+
+	//! The series of the theories interpolated by EphemWrapper.
+	enum TheorySeries
+	{
+		Elp82bMoon,
+		L1Io, L1Europa, L1Ganymede, L1Callisto,
+		Tass17Mimas, Tass17Enceladus, Tass17Tethys, Tass17Dione, Tass17Rhea, Tass17Titan, Tass17Hyperion, Tass17Iapetus,
+		Gust86Miranda, Gust86Ariel, Gust86Umbriel, Gust86Titania, Gust86Oberon,
+		TheorySeriesCount
+	};
+	//! The windows of the theories, short enough for all fits to stay within 1e-10 AU (15 m) of the theories.
+	//! They use the uninterpolated, reentrant versions of the theories.
+	static const Series theorySeries[TheorySeriesCount];
+
+	//! Number of coefficients per coordinate of a window
+	static const int Coefficients = 13;
+
+	//! @param maxWindows the number of windows kept
+	explicit EphemChebyshevCache(int maxWindows = 1024);
+
+	//! Compute the position of a body at jd, from the fitted window if there is one.
+	void getCoor(const Series& series, double jd, double xyz[3]);
+
+	//! Forget all the windows.
+	void clear();
+
+private:
+	Q_DISABLE_COPY(EphemChebyshevCache)
+
+	struct Key
+	{
+		const Series* series;
+		qint64 window;
+		bool operator==(const Key& other) const { return series==other.series && window==other.window; }
+	};
+	friend uint qHash(const Key& key, uint seed = 0)
+	{
+		return qHash(key.window, seed) ^ qHash(quintptr(key.series), seed);
+	}
+
+	struct Window
+	{
+		Window() : fitted(false), usable(false) {}
+		bool fitted;	// the coefficients were computed
+		bool usable;	// the estimated error is below the maximum error of the series
+		double c[3][Coefficients];
+	};
+
+	//! Fit the Chebyshev polynomials of a window.
+	static void fit(const Series& series, qint64 window, Window* w);
+	//! Evaluate the fit of a window at t in [-1, 1].
+	static void evaluate(const Window& w, double t, double xyz[3]);
+
+	mutable QMutex mutex;
+	QCache<Key, Window> windows;
+};
+
+#endif // _EPHEMCHEBYSHEVCACHE_HPP_
@@ -19,6 +19,7 @@ Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
 */
 
 #include "EphemWrapper.hpp"
+#include "EphemChebyshevCache.hpp"
 #include "StelApp.hpp"
 #include "StelCore.hpp"
 #include "vsop87.h"
@@ -31,6 +32,9 @@ Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
 #include "de430.hpp"
 #include "pluto.h"
 
+#include <QMutex>
+#include <QThreadStorage>
+
 #define EPHEM_MERCURY_ID  0
 #define EPHEM_VENUS_ID    1
 #define EPHEM_EMB_ID    2
@@ -58,6 +62,80 @@ Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
 **            7 = uranus 
 **/
 
+static QThreadStorage<EphemContext*> ephemContexts;
+
+// The theory of the satellites of Mars still caches its elements in static variables,
+// so its calls are serialized.
+static QMutex marsSatMutex;
+
+// The theories of the Moon and of the planetary satellites sum thousands of terms,
+// so their positions are interpolated from Chebyshev fits where possible.
+// The fits use the uninterpolated, reentrant versions of the theories: their results do not
+// depend on the previous calls, unlike those of the daily (hourly for ELP82B) interpolation
+// of the elements done by GetL1Coor() and friends, which can differ by up to 1e-6 AU.
+static EphemChebyshevCache positionCache;
+
+static const EphemChebyshevCache::Series& moonSeries      = EphemChebyshevCache::theorySeries[EphemChebyshevCache::Elp82bMoon];
+static const EphemChebyshevCache::Series& ioSeries        = EphemChebyshevCache::theorySeries[EphemChebyshevCache::L1Io];
+static const EphemChebyshevCache::Series& europaSeries    = EphemChebyshevCache::theorySeries[EphemChebyshevCache::L1Europa];
+static const EphemChebyshevCache::Series& ganymedeSeries  = EphemChebyshevCache::theorySeries[EphemChebyshevCache::L1Ganymede];
+static const EphemChebyshevCache::Series& callistoSeries  = EphemChebyshevCache::theorySeries[EphemChebyshevCache::L1Callisto];
+static const EphemChebyshevCache::Series& mimasSeries     = EphemChebyshevCache::theorySeries[EphemChebyshevCache::Tass17Mimas];
+static const EphemChebyshevCache::Series& enceladusSeries = EphemChebyshevCache::theorySeries[EphemChebyshevCache::Tass17Enceladus];
+static const EphemChebyshevCache::Series& tethysSeries    = EphemChebyshevCache::theorySeries[EphemChebyshevCache::Tass17Tethys];
+static const EphemChebyshevCache::Series& dioneSeries     = EphemChebyshevCache::theorySeries[EphemChebyshevCache::Tass17Dione];
+static const EphemChebyshevCache::Series& rheaSeries      = EphemChebyshevCache::theorySeries[EphemChebyshevCache::Tass17Rhea];
+static const EphemChebyshevCache::Series& titanSeries     = EphemChebyshevCache::theorySeries[EphemChebyshevCache::Tass17Titan];
+static const EphemChebyshevCache::Series& hyperionSeries  = EphemChebyshevCache::theorySeries[EphemChebyshevCache::Tass17Hyperion];
+static const EphemChebyshevCache::Series& iapetusSeries   = EphemChebyshevCache::theorySeries[EphemChebyshevCache::Tass17Iapetus];
+static const EphemChebyshevCache::Series& mirandaSeries   = EphemChebyshevCache::theorySeries[EphemChebyshevCache::Gust86Miranda];
+static const EphemChebyshevCache::Series& arielSeries     = EphemChebyshevCache::theorySeries[EphemChebyshevCache::Gust86Ariel];
+static const EphemChebyshevCache::Series& umbrielSeries   = EphemChebyshevCache::theorySeries[EphemChebyshevCache::Gust86Umbriel];
+static const EphemChebyshevCache::Series& titaniaSeries   = EphemChebyshevCache::theorySeries[EphemChebyshevCache::Gust86Titania];
+static const EphemChebyshevCache::Series& oberonSeries    = EphemChebyshevCache::theorySeries[EphemChebyshevCache::Gust86Oberon];
+
+EphemContext::EphemContext()
+	: de430Reader(Q_NULLPTR)
+	, de431Reader(Q_NULLPTR)
+	, de430Opened(false)
+	, de431Opened(false)
+{
+	InitVsop87Context(&vsop87);
+}
+
+EphemContext::~EphemContext()
+{
+	CloseDe430Reader(de430Reader);
+	CloseDe431Reader(de431Reader);
+}
+
+void* EphemContext::getDe430Reader()
+{
+	if (!de430Opened)
+	{
+		de430Reader = OpenDe430Reader();
+		de430Opened = true;
+	}
+	return de430Reader;
+}
+
+void* EphemContext::getDe431Reader()
+{
+	if (!de431Opened)
+	{
+		de431Reader = OpenDe431Reader();
+		de431Opened = true;
+	}
+	return de431Reader;
+}
+
+EphemContext* EphemWrapper::getContext()
+{
+	if (!ephemContexts.hasLocalData())
+		ephemContexts.setLocalData(new EphemContext());
+	return ephemContexts.localData();
+}
+
 void EphemWrapper::init_de430(const char* filepath)
 {
 	InitDE430(filepath);
@@ -106,15 +184,15 @@ void get_planet_helio_coordsv(const double jd, double xyz[3], const int planet_i
 
 	if(use_de430(jd))
 	{
-		deOk=GetDe430Coor(jd, planet_id + 1, xyz);
+		deOk=GetDe430ReaderCoor(EphemWrapper::getContext()->getDe430Reader(), jd, planet_id + 1, xyz);
 	}
 	else if(use_de431(jd))
 	{
-		deOk=GetDe431Coor(jd, planet_id + 1, xyz);
+		deOk=GetDe431ReaderCoor(EphemWrapper::getContext()->getDe431Reader(), jd, planet_id + 1, xyz);
 	}
 	if (!deOk) //VSOP87 as fallback
 	{
-		GetVsop87Coor(jd, planet_id, xyz);
+		GetVsop87CoorCtx(&EphemWrapper::getContext()->vsop87, jd, planet_id, xyz);
 	}
 }
 
@@ -131,15 +209,15 @@ void get_planet_helio_osculating_coordsv(double jd0, double jd, double xyz[3], i
 
 	if(use_de430(jd))
 	{
-		deOk=GetDe430Coor(jd, planet_id + 1, xyz);
+		deOk=GetDe430ReaderCoor(EphemWrapper::getContext()->getDe430Reader(), jd, planet_id + 1, xyz);
 	}
 	else if(use_de431(jd))
 	{
-		deOk=GetDe431Coor(jd, planet_id + 1, xyz);
+		deOk=GetDe431ReaderCoor(EphemWrapper::getContext()->getDe431Reader(), jd, planet_id + 1, xyz);
 	}
 	if (!deOk) //VSOP87 as fallback
 	{
-		GetVsop87OsculatingCoor(jd0, jd, planet_id, xyz);
+		GetVsop87OsculatingCoorCtx(&EphemWrapper::getContext()->vsop87, jd0, jd, planet_id, xyz);
 	}
 }
 
@@ -160,11 +238,11 @@ void get_pluto_helio_coordsv(double jd,double xyz[3], void* unused)
 
 	if(use_de430(jd))
 	{
-		deOk=GetDe430Coor(jd, EPHEM_JPL_PLUTO_ID, xyz);
+		deOk=GetDe430ReaderCoor(EphemWrapper::getContext()->getDe430Reader(), jd, EPHEM_JPL_PLUTO_ID, xyz);
 	}
 	else if(use_de431(jd))
 	{
-		deOk=GetDe431Coor(jd, EPHEM_JPL_PLUTO_ID, xyz);
+		deOk=GetDe431ReaderCoor(EphemWrapper::getContext()->getDe431Reader(), jd, EPHEM_JPL_PLUTO_ID, xyz);
 	}
 	if (!deOk) // fallback to previous solution
 	{
@@ -203,17 +281,17 @@ void get_earth_helio_coordsv(const double jd,double xyz[3], void* unused)
 
 	if(use_de430(jd))
 	{
-		deOk=GetDe430Coor(jd, EPHEM_JPL_EARTH_ID, xyz);
+		deOk=GetDe430ReaderCoor(EphemWrapper::getContext()->getDe430Reader(), jd, EPHEM_JPL_EARTH_ID, xyz);
 	}
 	else if(use_de431(jd))
 	{
-		deOk=GetDe431Coor(jd, EPHEM_JPL_EARTH_ID, xyz);
+		deOk=GetDe431ReaderCoor(EphemWrapper::getContext()->getDe431Reader(), jd, EPHEM_JPL_EARTH_ID, xyz);
 	}
 	if (!deOk) //VSOP87 as fallback
 	{
 		double moon[3];
-		GetVsop87Coor(jd,EPHEM_EMB_ID,xyz);
-		GetElp82bCoor(jd,moon);
+		GetVsop87CoorCtx(&EphemWrapper::getContext()->vsop87, jd,EPHEM_EMB_ID,xyz);
+		positionCache.getCoor(moonSeries, jd, moon);
 		/* Earth != EMB:
 	0.0121505677733761 = mu_m/(1+mu_m),
 	mu_m = mass(moon)/mass(earth) = 0.01230002 */
@@ -305,124 +383,126 @@ void get_lunar_parent_coordsv(double jde,double xyz[3], void* unused)
 	Q_UNUSED(unused);
 	bool deOk=false;
 	if(use_de430(jde))
-		deOk=GetDe430Coor(jde, EPHEM_JPL_MOON_ID, xyz, EPHEM_JPL_EARTH_ID);
+		deOk=GetDe430ReaderCoor(EphemWrapper::getContext()->getDe430Reader(), jde, EPHEM_JPL_MOON_ID, xyz, EPHEM_JPL_EARTH_ID);
 	else if(use_de431(jde))
-		deOk=GetDe431Coor(jde, EPHEM_JPL_MOON_ID, xyz, EPHEM_JPL_EARTH_ID);
+		deOk=GetDe431ReaderCoor(EphemWrapper::getContext()->getDe431Reader(), jde, EPHEM_JPL_MOON_ID, xyz, EPHEM_JPL_EARTH_ID);
 	if (!deOk) // fallback...
-		GetElp82bCoor(jde,xyz);
+		positionCache.getCoor(moonSeries, jde, xyz);
 }
 
 void get_phobos_parent_coordsv(double jd,double xyz[3], void* unused)
 {
 	Q_UNUSED(unused);
+	QMutexLocker lock(&marsSatMutex);
 	GetMarsSatCoor(jd,MARS_SAT_PHOBOS,xyz);
 }
 
 void get_deimos_parent_coordsv(double jd,double xyz[3], void* unused)
 {
 	Q_UNUSED(unused);
+	QMutexLocker lock(&marsSatMutex);
 	GetMarsSatCoor(jd,MARS_SAT_DEIMOS,xyz);
 }
 
 void get_io_parent_coordsv(double jd,double xyz[3], void* unused)
 {
 	Q_UNUSED(unused);
-	GetL1Coor(jd,L1_IO,xyz);
+	positionCache.getCoor(ioSeries, jd, xyz);
 }
 
 void get_europa_parent_coordsv(double jd,double xyz[3], void* unused)
 {
 	Q_UNUSED(unused);
-	GetL1Coor(jd,L1_EUROPA,xyz);
+	positionCache.getCoor(europaSeries, jd, xyz);
 }
 
 void get_ganymede_parent_coordsv(double jd,double xyz[3], void* unused)
 {
 	Q_UNUSED(unused);
-	GetL1Coor(jd,L1_GANYMEDE,xyz);
+	positionCache.getCoor(ganymedeSeries, jd, xyz);
 }
 
 void get_callisto_parent_coordsv(double jd,double xyz[3], void* unused)
 {
 	Q_UNUSED(unused);
-	GetL1Coor(jd,L1_CALLISTO,xyz);
+	positionCache.getCoor(callistoSeries, jd, xyz);
 }
 
 void get_mimas_parent_coordsv(double jd,double xyz[3], void* unused)
 { 
 	Q_UNUSED(unused);
-	GetTass17Coor(jd,TASS17_MIMAS,xyz);
+	positionCache.getCoor(mimasSeries, jd, xyz);
 }
 
 void get_enceladus_parent_coordsv(double jd,double xyz[3], void* unused)
 {
 	Q_UNUSED(unused);
-	GetTass17Coor(jd,TASS17_ENCELADUS,xyz);
+	positionCache.getCoor(enceladusSeries, jd, xyz);
 }
 
 void get_tethys_parent_coordsv(double jd,double xyz[3], void* unused)
 { 
 	Q_UNUSED(unused);
-	GetTass17Coor(jd,TASS17_TETHYS,xyz);
+	positionCache.getCoor(tethysSeries, jd, xyz);
 }
 
 void get_dione_parent_coordsv(double jd,double xyz[3], void* unused)
 { 
 	Q_UNUSED(unused);
-	GetTass17Coor(jd,TASS17_DIONE,xyz);
+	positionCache.getCoor(dioneSeries, jd, xyz);
 }
 
 void get_rhea_parent_coordsv(double jd,double xyz[3], void* unused)
 { 
 	Q_UNUSED(unused);
-	GetTass17Coor(jd,TASS17_RHEA,xyz);
+	positionCache.getCoor(rheaSeries, jd, xyz);
 }
 
 void get_titan_parent_coordsv(double jd,double xyz[3], void* unused)
 { 
 	Q_UNUSED(unused);
-	GetTass17Coor(jd,TASS17_TITAN,xyz);
+	positionCache.getCoor(titanSeries, jd, xyz);
 }
 
 void get_hyperion_parent_coordsv(double jd,double xyz[3], void* unused)
 { 
 	Q_UNUSED(unused);
-	GetTass17Coor(jd,TASS17_HYPERION,xyz);
+	positionCache.getCoor(hyperionSeries, jd, xyz);
 }
 
 void get_iapetus_parent_coordsv(double jd,double xyz[3], void* unused)
 { 
 	Q_UNUSED(unused);
-	GetTass17Coor(jd,TASS17_IAPETUS,xyz);
+	positionCache.getCoor(iapetusSeries, jd, xyz);
 }
 
 void get_miranda_parent_coordsv(double jd,double xyz[3], void* unused)
 {
 	Q_UNUSED(unused);
-	GetGust86Coor(jd,GUST86_MIRANDA,xyz);
+	positionCache.getCoor(mirandaSeries, jd, xyz);
 }
 
 void get_ariel_parent_coordsv(double jd,double xyz[3], void* unused)
 {
 	Q_UNUSED(unused);
-	GetGust86Coor(jd,GUST86_ARIEL,xyz);
+	positionCache.getCoor(arielSeries, jd, xyz);
 }
 
 void get_umbriel_parent_coordsv(double jd,double xyz[3], void* unused)
 {
 	Q_UNUSED(unused);
-	GetGust86Coor(jd,GUST86_UMBRIEL,xyz);
+	positionCache.getCoor(umbrielSeries, jd, xyz);
 }
 
 void get_titania_parent_coordsv(double jd,double xyz[3], void* unused)
 {
 	Q_UNUSED(unused);
-	GetGust86Coor(jd,GUST86_TITANIA,xyz);
+	positionCache.getCoor(titaniaSeries, jd, xyz);
 }
 
 void get_oberon_parent_coordsv(double jd,double xyz[3], void* unused)
 {
 	Q_UNUSED(unused);
-	GetGust86Coor(jd,GUST86_OBERON,xyz);
+	positionCache.getCoor(oberonSeries, jd, xyz);
 }
 
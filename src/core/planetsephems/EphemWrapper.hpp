@@ -35,12 +35,40 @@ Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
 #define DE430_FILENAME  "linux_p1550p2650.430"
 #define DE431_FILENAME  "lnxm13000p17000.431"
 
+#include "vsop87.h"
+
+//! The state of the ephemerides which must not be shared between threads:
+//! the interpolation caches of VSOP87 and the readers of the DE430/DE431 files.
+//! The functions below use the context of the calling thread, given by
+//! EphemWrapper::getContext(), so that they can be called concurrently.
+class EphemContext
+{
+public:
+    EphemContext();
+    ~EphemContext();
+
+    struct Vsop87Context vsop87;
+    //! Get the DE430/DE431 readers of this context, opened on first use.
+    //! @return Q_NULLPTR if the file could not be opened.
+    void* getDe430Reader();
+    void* getDe431Reader();
+
+private:
+    void* de430Reader;
+    void* de431Reader;
+    bool de430Opened;
+    bool de431Opened;
+};
+
 class EphemWrapper{
 public:
     static void init_de430(const char* filepath);
     static void init_de431(const char* filepath);
     static bool jd_fits_de430(const double jd);
     static bool jd_fits_de431(const double jd);
+    //! Get the ephemeris context of the calling thread. It is created on first use
+    //! and deleted when the thread finishes.
+    static EphemContext* getContext();
 };
 
 // These functions have an unused void pointer to be compatible to PosFuncType in SolarSystem and Planet classes.
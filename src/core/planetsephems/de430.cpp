@@ -30,26 +30,31 @@ THE SOFTWARE.
 #include "VecMath.hpp"
 #endif
 
+#include <QByteArray>
+#include <QMutex>
+
 #ifdef __cplusplus
   extern "C" {
 #endif
 
 static void * ephem;
 
-static Vec3d tempECL = Vec3d(0,0,0);
-static Vec3d tempICRF = Vec3d(0,0,0);
 static char nams[JPL_MAX_N_CONSTANTS][6];
 static double vals[JPL_MAX_N_CONSTANTS];
-static double tempXYZ[6];
 #ifdef UNIT_TEST
 // NOTE: Added hook for unit testing
 static const Mat4d matJ2000ToVsop87(Mat4d::xrotation(-23.4392803055555555556*(M_PI/180)) * Mat4d::zrotation(0.0000275*(M_PI/180)));
 #endif
 
 static bool initDone = false;
+// Path of the ephemeris file, used to open further readers
+static QByteArray ephemPath;
+// Serializes calls to jpl_init_ephemeris(), which keeps its error code in a static variable
+static QMutex readerMutex;
 
 void InitDE430(const char* filepath)
 {
+	QMutexLocker lock(&readerMutex);
 	ephem = jpl_init_ephemeris(filepath, nams, vals);
 
 	if(jpl_init_error_code() != 0)
@@ -62,6 +67,7 @@ void InitDE430(const char* filepath)
 	else
 	{
 		initDone = true;
+		ephemPath = filepath;
 		double jd1, jd2;
 		jd1=jpl_get_double(ephem, JPL_EPHEM_START_JD);
 		jd2=jpl_get_double(ephem, JPL_EPHEM_END_JD);
@@ -74,12 +80,38 @@ void TerminateDE430()
   jpl_close_ephemeris(ephem);
 }
 
+void* OpenDe430Reader()
+{
+	QMutexLocker lock(&readerMutex);
+	if (!initDone)
+		return Q_NULLPTR;
+	void* reader = jpl_init_ephemeris(ephemPath.constData(), Q_NULLPTR, Q_NULLPTR);
+	if (reader==Q_NULLPTR)
+		qDebug() << "Error "<< jpl_init_error_code() << "at DE430 reader init:" << jpl_init_error_message();
+	return reader;
+}
+
+void CloseDe430Reader(void* reader)
+{
+	if (reader!=Q_NULLPTR)
+		jpl_close_ephemeris(reader);
+}
+
 bool GetDe430Coor(const double jde, const int planet_id, double * xyz, const int centralBody_id)
 {
-    if(initDone)
-    {
+	if(initDone)
+		return GetDe430ReaderCoor(ephem, jde, planet_id, xyz, centralBody_id);
+	return false;
+}
+
+bool GetDe430ReaderCoor(void* reader, const double jde, const int planet_id, double * xyz, const int centralBody_id)
+{
+	if (reader==Q_NULLPTR)
+		return false;
+
+	double tempXYZ[6];
 	// This may return some error code!
-	int jplresult=jpl_pleph(ephem, jde, planet_id, centralBody_id, tempXYZ, 0);
+	int jplresult=jpl_pleph(reader, jde, planet_id, centralBody_id, tempXYZ, 0);
 
 	switch (jplresult)
 	{
@@ -111,21 +143,17 @@ bool GetDe430Coor(const double jde, const int planet_id, double * xyz, const int
 			break;
 	}
 
-	jpl_pleph(ephem, jde, planet_id, centralBody_id, tempXYZ, 0);
-
-        tempICRF = Vec3d(tempXYZ[0], tempXYZ[1], tempXYZ[2]);
+	const Vec3d tempICRF(tempXYZ[0], tempXYZ[1], tempXYZ[2]);
 	#ifdef UNIT_TEST
-	tempECL = matJ2000ToVsop87 * tempICRF;
+	const Vec3d tempECL = matJ2000ToVsop87 * tempICRF;
 	#else
-        tempECL = StelCore::matJ2000ToVsop87 * tempICRF;
+	const Vec3d tempECL = StelCore::matJ2000ToVsop87 * tempICRF;
 	#endif
 
-        xyz[0] = tempECL[0];
-        xyz[1] = tempECL[1];
-        xyz[2] = tempECL[2];
+	xyz[0] = tempECL[0];
+	xyz[1] = tempECL[1];
+	xyz[2] = tempECL[2];
 	return true;
-    }
-    return false;
 }
 
 
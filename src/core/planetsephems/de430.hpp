@@ -33,7 +33,16 @@ THE SOFTWARE.
 void InitDE430(const char* filepath);
 // most of the time centralBody_id likely is the Sun. However, for Moon, use centralBody_id=EPHEM_JPL_EARTH_ID=3
 // return true if OK, false if something was wrong with the JPL functions. In this case, see log for details.
+// Uses the reader opened by InitDE430(), which must only be used from one thread at a time.
 bool GetDe430Coor(const double jde, const int planet_id, double * xyz, const int centralBody_id=CENTRAL_PLANET_ID);
+
+// Open another reader of the file given to InitDE430(). Each reader has its own file handle and cache,
+// so that positions can be computed in parallel from several threads, with one reader per thread.
+// Returns NULL if DE430 could not be initialized.
+void* OpenDe430Reader();
+void CloseDe430Reader(void* reader);
+// Same as GetDe430Coor(), using the given reader.
+bool GetDe430ReaderCoor(void* reader, const double jde, const int planet_id, double * xyz, const int centralBody_id=CENTRAL_PLANET_ID);
 // Not possible for a DE.
 //void GetDe430OsculatingCoor(double jd0, double jd, int planet_id, double *xyz, const int centralBody_id=CENTRAL_PLANET_ID);
 
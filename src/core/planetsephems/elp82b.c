@@ -162731,11 +162731,8 @@ static const double q3 =  1.265417e-9;
 static const double q4 = -1.371808e-12;
 static const double q5 = -3.20334e-15;
 
-void GetElp82bCoor(const double jd,double xyz[3]) {
-  const double t = (jd - 2451545.0) / 36525.0;
-  double r[3];
-  CalcInterpolatedElements(t,r,3,&GetElp82bSphericalCoor,DELTA_T,
-                           &t_0,r_0,&t_1,r_1,&t_2,r_2);
+static void SphericalToRectangular(const double t,const double r[3],
+                                   double xyz[3]) {
   {
     const double rh = r[2] * cos(r[1]);
     const double x3 = r[2] * sin(r[1]);
@@ -162759,11 +162756,26 @@ void GetElp82bCoor(const double jd,double xyz[3]) {
     xyz[1] = pwqw*x1 + qw2 *x2                - qw*x3;
     xyz[2] = -pw *x1 + qw  *x2 + (pw2 + qw2 - 1.0)*x3;
 
+  }
+}
+
+void GetElp82bCoor(const double jd,double xyz[3]) {
+  const double t = (jd - 2451545.0) / 36525.0;
+  double r[3];
+  CalcInterpolatedElements(t,r,3,&GetElp82bSphericalCoor,DELTA_T,
+                           &t_0,r_0,&t_1,r_1,&t_2,r_2);
+  SphericalToRectangular(t,r,xyz);
 /*
     printf("Moon: %f  %22.15f %22.15f %22.15f\n",
            jd,xyz[0],xyz[1],xyz[2]);
 */
-  }
+}
+
+void GetElp82bCoorUninterpolated(const double jd,double xyz[3]) {
+  const double t = (jd - 2451545.0) / 36525.0;
+  double r[3];
+  GetElp82bSphericalCoor(t,r);
+  SphericalToRectangular(t,r,xyz);
 }
 
 
@@ -79,6 +79,13 @@ void GetElp82bCoor(double jd,double xyz[3]);
      ICRF, J2000 and FK5 are the same, while the transformation
      ICRF <-> VSOP87 must be done with the matrix given above.
    */
+
+void GetElp82bCoorUninterpolated(double jd,double xyz[3]);
+  /* Like GetElp82bCoor, but the spherical coordinates are computed
+     from the series at jd instead of being interpolated between the
+     values of hourly steps. It is slower, but the result does not
+     depend on the previous calls, and the function is reentrant.
+   */
      
 
 #ifdef __cplusplus
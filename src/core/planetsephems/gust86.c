@@ -442,6 +442,16 @@ void GetGust86Coor(const double jd,const int body,double *xyz) {
   GetGust86OsculatingCoor(jd,jd,body,xyz);
 }
 
+void GetGust86CoorUninterpolated(const double jd,const int body,double *xyz) {
+  double elem[GUST86_DIM];
+  double x[3];
+  CalcGust86Elem(jd - 2444239.5,elem);
+  EllipticToRectangularN(gust86_rmu[body],elem+(body*6),0.0,x);
+  xyz[0] = GUST86toVsop87[0]*x[0]+GUST86toVsop87[1]*x[1]+GUST86toVsop87[2]*x[2];
+  xyz[1] = GUST86toVsop87[3]*x[0]+GUST86toVsop87[4]*x[1]+GUST86toVsop87[5]*x[2];
+  xyz[2] = GUST86toVsop87[6]*x[0]+GUST86toVsop87[7]*x[1]+GUST86toVsop87[8]*x[2];
+}
+
 void GetGust86OsculatingCoor(const double jd0,const double jd,
                              const int body,double *xyz) {
   double x[3];
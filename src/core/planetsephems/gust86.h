@@ -89,6 +89,12 @@ void GetGust86Coor(const double jd, const int body, double *xyz);
      ICRF <-> VSOP87 must be done with the matrix given above.
    */
      
+void GetGust86CoorUninterpolated(const double jd, const int body, double *xyz);
+  /* Like GetGust86Coor, but the elements are computed at jd instead of being
+     interpolated between the values of daily steps. It is slower, but the
+     result does not depend on the previous calls, and the function is reentrant.
+  */
+
 void GetGust86OsculatingCoor(const double jd0, const double jd, const int body, double *xyz);
   /* The oculating orbit of epoch jd0, evaluated at jd, is returned.
   */
@@ -52,6 +52,11 @@ struct jpl_eph_data {
    double *cache;
    struct interpolation_info iinfo;
    FILE *ifile;
+               /* The file mapped in memory,  shared by all the readers */
+               /* of the file,  or NULL if it could not be mapped.      */
+   const char *mapped_data;
+   uint64_t mapped_size;
+   void *mapping;
    };
 #pragma pack()
 
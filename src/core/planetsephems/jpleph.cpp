@@ -63,6 +63,14 @@ details of the implementation encapsulated.
 #include <stdint.h>
 
 #include "StelUtils.hpp"
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#ifndef Q_OS_WIN
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 /**** include variable and type definitions, specific for this C version */
 
 #include "jpleph.h"
@@ -80,6 +88,97 @@ details of the implementation encapsulated.
 #endif
 
 
+/* The ephemeris files are mapped in memory once,  and the mapping is shared  */
+/* by all the readers opened on the file with jpl_init_ephemeris().  Reading  */
+/* a record is then pointer arithmetic:  any number of threads can read the  */
+/* same mapping without locking,  and the records stay in the page cache of  */
+/* the system instead of a single cached block per reader.  If the file      */
+/* cannot be mapped,  e.g. DE431 in a 32-bit build,  the records are read    */
+/* with fseek()/fread() as before.                                           */
+struct jpl_mapping
+{
+   QFile file;
+   uchar *data;
+   int ref_count;
+};
+
+static QMutex mapping_mutex;
+static QHash<QString, jpl_mapping *> mappings;
+
+            /* Number of records advised to the system ahead of the one  */
+            /* being read,  in the direction the time goes.  A DE record */
+            /* covers 32 days (16 for DE102) and is about 8 kB.          */
+#define JPL_PREFETCH_RECORDS 4
+
+static jpl_mapping *jpl_map_file(const char *ephemeris_filename)
+{
+   QMutexLocker lock(&mapping_mutex);
+   const QFileInfo info(QFile::decodeName(ephemeris_filename));
+   const QString path = info.canonicalFilePath();
+   jpl_mapping *m = mappings.value(path);
+
+   if(!m)
+   {
+      m = new jpl_mapping;
+      m->file.setFileName(path);
+      m->data = (m->file.open(QIODevice::ReadOnly) ? m->file.map(0, m->file.size()) : NULL);
+      if(!m->data)
+      {
+         qWarning() << "jpl_init_ephemeris(): Cannot map" << path << "in memory, reading it from the file:" << m->file.errorString();
+         delete m;
+         return(NULL);
+      }
+      m->ref_count = 0;
+      mappings.insert(path, m);
+   }
+   m->ref_count++;
+   return(m);
+}
+
+static void jpl_unmap_file(jpl_mapping *m)
+{
+   QMutexLocker lock(&mapping_mutex);
+   if(--m->ref_count == 0)
+   {
+      mappings.remove(mappings.key(m));
+      m->file.unmap(m->data);
+      delete m;
+   }
+}
+
+/* Ask the system to read the records following record nr (preceding it if */
+/* backward is true) in the background,  so that they are in memory by the */
+/* time they are needed.  This does not block.                             */
+static void jpl_prefetch_records(const struct jpl_eph_data *eph,
+                                 const uint32_t nr, const bool backward)
+{
+#ifndef Q_OS_WIN
+   static const uint64_t page_size = (uint64_t)sysconf(_SC_PAGESIZE);
+   uint32_t first = nr + 1, last = nr + JPL_PREFETCH_RECORDS;
+
+   if(backward)
+   {
+      if(nr == 0)
+         return;
+      first = (nr > JPL_PREFETCH_RECORDS ? nr - JPL_PREFETCH_RECORDS : 0);
+      last = nr - 1;
+   }
+            /* Two blocks ahead to account for header: */
+   uint64_t start = (uint64_t)(first + 2) * eph->recsize;
+   uint64_t end = (uint64_t)(last + 3) * eph->recsize;
+   if(end > eph->mapped_size)
+      end = eph->mapped_size;
+   if(start >= end)
+      return;
+   start -= start % page_size;
+   posix_madvise((void *)(eph->mapped_data + start), (size_t)(end - start), POSIX_MADV_WILLNEED);
+#else
+   Q_UNUSED(eph);
+   Q_UNUSED(nr);
+   Q_UNUSED(backward);
+#endif
+}
+
 double DLL_FUNC jpl_get_double(const void *ephem, const int value)
 {
    return(*(double *)((char *)ephem + value));
@@ -603,20 +702,35 @@ int DLL_FUNC jpl_state(void *ephem, const double et, const int list[14],
 		nr--;
 	}
 
+	if(eph->mapped_data && !eph->swap_bytes)
+	{
+		/* Use the record in the mapping, two blocks ahead to account for header: */
+		buf = (double *)(eph->mapped_data + (uint64_t)(nr + 2) * eph->recsize);
+		if(nr != eph->curr_cache_loc)
+		{
+			jpl_prefetch_records(eph, nr, eph->curr_cache_loc != (uint32_t)-1 && nr < eph->curr_cache_loc);
+			eph->curr_cache_loc = nr;
+		}
+	}
 	/*   read correct record if not in core (static vector buf[])   */
-	if(nr != eph->curr_cache_loc)
+	else if(nr != eph->curr_cache_loc)
 	{
 		eph->curr_cache_loc = nr;
-		/* Read two blocks ahead to account for header: */
-		if(FSeek(eph->ifile, (nr + 2) * eph->recsize, SEEK_SET))
+		if(eph->mapped_data)
+			memcpy(buf, eph->mapped_data + (uint64_t)(nr + 2) * eph->recsize, eph->recsize);
+		else
 		{
-			// GZ: Make sure we will try again on next call...
-			eph->curr_cache_loc=0;
-			return(JPL_EPH_FSEEK_ERROR);
+			/* Read two blocks ahead to account for header: */
+			if(FSeek(eph->ifile, (nr + 2) * eph->recsize, SEEK_SET))
+			{
+				// GZ: Make sure we will try again on next call...
+				eph->curr_cache_loc=0;
+				return(JPL_EPH_FSEEK_ERROR);
+			}
+			if(fread(buf, sizeof(double), (size_t)eph->ncoeff, eph->ifile)
+					!= (size_t)eph->ncoeff)
+				return(JPL_EPH_READ_ERROR);
 		}
-		if(fread(buf, sizeof(double), (size_t)eph->ncoeff, eph->ifile)
-				!= (size_t)eph->ncoeff)
-			return(JPL_EPH_READ_ERROR);
 
 		if(eph->swap_bytes)
 			swap_64_bit_val(buf, eph->ncoeff);
@@ -899,6 +1013,9 @@ void * DLL_FUNC jpl_init_ephemeris(const char *ephemeris_filename,
     rval->iinfo.vel_coeff[0] = 0.0;
     rval->iinfo.vel_coeff[1] = 1.0;
     rval->curr_cache_loc = (uint32_t)-1;
+    rval->mapped_data = NULL;
+    rval->mapped_size = 0;
+    rval->mapping = NULL;
     
               /* The 'cache' data is right after the 'jpl_eph_data' struct: */
     rval->cache = (double *)(rval + 1);
@@ -944,6 +1061,22 @@ void * DLL_FUNC jpl_init_ephemeris(const char *ephemeris_filename,
           init_err_code = JPL_INIT_FREAD4_FAILED;
         }
       }
+
+   jpl_mapping *mapping = jpl_map_file(ephemeris_filename);
+   if(mapping)
+   {
+      const uint32_t n_records = (uint32_t)((rval->ephem_end - rval->ephem_start) / rval->ephem_step + .5);
+                /* Don't trust a truncated file: it is read with fread(), */
+                /* which reports the missing records as errors.           */
+      if((uint64_t)(n_records + 2) * rval->recsize <= (uint64_t)mapping->file.size())
+      {
+         rval->mapping = mapping;
+         rval->mapped_data = (const char *)mapping->data;
+         rval->mapped_size = (uint64_t)mapping->file.size();
+      }
+      else
+         jpl_unmap_file(mapping);
+   }
   return(rval);
 }
 
@@ -958,6 +1091,8 @@ void DLL_FUNC jpl_close_ephemeris(void *ephem)
 {
    struct jpl_eph_data *eph = (struct jpl_eph_data *)ephem;
 
+   if(eph->mapping)
+      jpl_unmap_file((jpl_mapping *)eph->mapping);
    fclose(eph->ifile);
    free(ephem);
 }
@@ -1001,6 +1001,16 @@ void GetL1Coor(double jd,int body,double *xyz) {
   GetL1OsculatingCoor(jd,jd,body,xyz);
 }
 
+void GetL1CoorUninterpolated(double jd,int body,double *xyz) {
+  double elem[6];
+  double x[3];
+  CalcL1Elem(jd - 2433282.5,body,elem);
+  EllipticToRectangularA(l1_bodies[body].mu,elem,0.0,x);
+  xyz[0] = L1toVsop87[0]*x[0]+L1toVsop87[1]*x[1]+L1toVsop87[2]*x[2];
+  xyz[1] = L1toVsop87[3]*x[0]+L1toVsop87[4]*x[1]+L1toVsop87[5]*x[2];
+  xyz[2] = L1toVsop87[6]*x[0]+L1toVsop87[7]*x[1]+L1toVsop87[8]*x[2];
+}
+
 void GetL1OsculatingCoor(const double jd0,const double jd,
                          const int body,double *xyz) {
   double x[3];
@@ -66,6 +66,12 @@ void GetL1Coor(double jd,int body,double *xyz);
      WARNING! Due to static internal variables, this function is not reentrant and not parallelizable!
   */
 
+void GetL1CoorUninterpolated(double jd,int body,double *xyz);
+  /* Like GetL1Coor, but the elements are computed at jd instead of being
+     interpolated between the values of daily steps. It is slower, but the
+     result does not depend on the previous calls, and the function is reentrant.
+  */
+
 void GetL1OsculatingCoor(const double jd0,const double jd, const int body,double *xyz);
 
   /* The oculating orbit of epoch jd0, evaluated at jd, is returned.
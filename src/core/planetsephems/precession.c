@@ -39,9 +39,19 @@ Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
 /* Interval threshold (days) for re-computing nutation values. with 1/24, compute only every hour  */
 #define NUTATION_EPOCH_THRESHOLD (1./24.)
 
+/* The caches are per thread: the positions of ephemeris sessions are computed in worker threads
+ * at other dates than those of the main thread. */
+#if defined(_MSC_VER)
+#define PRECESSION_THREAD_LOCAL __declspec(thread)
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_THREADS__)
+#define PRECESSION_THREAD_LOCAL _Thread_local
+#else
+#define PRECESSION_THREAD_LOCAL __thread
+#endif
+
 /* cache results for retrieval if recomputation is not required */
 
-static double c_psi_A=0.0, c_omega_A=0.0, c_chi_A=0.0, /*c_p_A=0.0, */ c_epsilon_A=0.0,
+static PRECESSION_THREAD_LOCAL double c_psi_A=0.0, c_omega_A=0.0, c_chi_A=0.0, /*c_p_A=0.0, */ c_epsilon_A=0.0,
 		c_Y_A=0.0, c_X_A=0.0, c_Q_A=0.0, c_P_A=0.0,
 		c_lastJDE=-1e100;
 
@@ -369,9 +379,9 @@ static const struct nut2000B nut2000Btable[78] = {
 { -1,  0,  4,  0,  2,     9.06,       1146,       0,     -490,     0,     -3,    -1}};
 
 /* cache results for retrieval if recomputation is not required */
-static double c_deltaEps=0.0;
-static double c_deltaPsi=0.0;
-static double c_jdeLastNut=-1e-100;
+static PRECESSION_THREAD_LOCAL double c_deltaEps=0.0;
+static PRECESSION_THREAD_LOCAL double c_deltaPsi=0.0;
+static PRECESSION_THREAD_LOCAL double c_jdeLastNut=-1e-100;
 
 
 //! Compute and return nutation angles of the abridged IAU-2000B nutation.
@@ -399,7 +409,6 @@ void getNutationAngles(const double JDE, double *deltaPsi, double *deltaEpsilon)
 
 	if (fabs(JDE-c_jdeLastNut)>NUTATION_EPOCH_THRESHOLD)
 	{
-		c_jdeLastNut=JDE;
 		double t=(JDE-2451545.0)/36525.0;
 		// F1 : l = mean anomaly of the Moon ['']
 		double     l  =  (485868.249036 + 1717915923.2178*t);//*arcSec2Rad;
@@ -430,6 +439,7 @@ void getNutationAngles(const double JDE, double *deltaPsi, double *deltaEpsilon)
 		deltaEps -= (0.02524*t + 0.0068192 - 0.0016339);
 		c_deltaPsi = deltaPsi * arcSec2Rad;
 		c_deltaEps = deltaEps * arcSec2Rad;
+		c_jdeLastNut=JDE;
 	}
 	double limiter=1.0;
 	if (JDE<NUT_BEGIN)
@@ -51,7 +51,7 @@ void getPrecessionAnglesVondrakPQXYe(const double jde, double *vP_A, double *vQ_
 //! Return ecliptic obliquity. [radians]
 double getPrecessionAngleVondrakEpsilon(const double jde);
 
-//! Just return (previously computed) ecliptic obliquity. [radians]
+//! Just return (previously computed in the calling thread) ecliptic obliquity. [radians]
 double getPrecessionAngleVondrakCurrentEpsilonA(void);
 
 // To complete the task of correct&accurate precession-nutation handling, we need fitting IAU-2000A or IAU-2000B Nutation.
@@ -3168,6 +3168,20 @@ void GetTass17Coor(double jd,int body,double *xyz)
 	GetTass17OsculatingCoor(jd,jd,body,xyz);
 }
 
+void GetTass17CoorUninterpolated(double jd,int body,double *xyz)
+{
+	const double t = jd - 2444240.0;
+	double lon[8];
+	double elem[6];
+	double x[3];
+	CalcLon(t,lon);
+	CalcTass17Elem(t,lon,body,elem);
+	EllipticToRectangularN(tass17bodies[body].mu,elem,0.0,x);
+	xyz[0] = TASS17toVSOP87[0]*x[0]+TASS17toVSOP87[1]*x[1]+TASS17toVSOP87[2]*x[2];
+	xyz[1] = TASS17toVSOP87[3]*x[0]+TASS17toVSOP87[4]*x[1]+TASS17toVSOP87[5]*x[2];
+	xyz[2] = TASS17toVSOP87[6]*x[0]+TASS17toVSOP87[7]*x[1]+TASS17toVSOP87[8]*x[2];
+}
+
 void GetTass17OsculatingCoor(const double jd0,const double jd, const int body,double *xyz)
 {
 	double x[3];
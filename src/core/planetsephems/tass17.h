@@ -69,6 +69,12 @@ extern "C" {
 void GetTass17Coor(double jd,int body,double *xyz);
 void GetTass17OsculatingCoor(const double jd0,const double jd, const int body,double *xyz);
 
+void GetTass17CoorUninterpolated(double jd,int body,double *xyz);
+  /* Like GetTass17Coor, but the elements are computed at jd instead of being
+     interpolated between the values of daily steps. It is slower, but the
+     result does not depend on the previous calls, and the function is reentrant.
+  */
+
 #ifdef __cplusplus
 }
 #endif
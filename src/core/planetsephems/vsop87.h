@@ -42,7 +42,11 @@ Furthermore I used the addition formulas
 so that for given T the functions cos and sin have only to be called 12 times.
 
 
-ATTENTION! Due to static caching this solution is not reentrant and cannot be parallelized to run in several threads.
+The interpolation caches are kept in a struct Vsop87Context.
+GetVsop87CoorCtx() and GetVsop87OsculatingCoorCtx() are reentrant: threads may
+compute positions in parallel as long as each of them uses its own context.
+ATTENTION! GetVsop87Coor() and GetVsop87OsculatingCoor() share one static context,
+so they are not reentrant and must not be called from several threads.
 
 ****************************************************************/
 
@@ -54,6 +58,31 @@ ATTENTION! Due to static caching this solution is not reentrant and cannot be pa
 extern "C" {
 #endif
 
+#define VSOP87_DIM (8*6)
+
+struct Vsop87Context {
+  /* elements at the 3 last interpolation nodes */
+  double t_0,t_1,t_2;
+  double elem_0[VSOP87_DIM];
+  double elem_1[VSOP87_DIM];
+  double elem_2[VSOP87_DIM];
+  /* elements interpolated for the last jd0 */
+  double jd0;
+  double elem[VSOP87_DIM];
+};
+
+void InitVsop87Context(struct Vsop87Context *ctx);
+  /* Empty the caches of a context. Must be called before its first use.
+  */
+
+void GetVsop87CoorCtx(struct Vsop87Context *ctx,double jd,int body,double *xyz);
+void GetVsop87OsculatingCoorCtx(struct Vsop87Context *ctx,
+                                const double jd0,const double jd,
+                                const int body,double *xyz);
+  /* Same as GetVsop87Coor() and GetVsop87OsculatingCoor(),
+     using the caches of the given context.
+  */
+
 void GetVsop87Coor(double jd,int body,double *xyz);
   /* Return the rectangular coordinates of the given planet
      and the given julian date jd expressed in dynamical time (TAI+32.184s).
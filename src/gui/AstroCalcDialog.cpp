@@ -26,6 +26,8 @@
 #include "StelTranslator.hpp"
 #include "StelLocaleMgr.hpp"
 #include "StelFileMgr.hpp"
+#include "StelEventFinder.hpp"
+#include "StelEventFunctions.hpp"
 
 #include "SolarSystem.hpp"
 #include "Planet.hpp"
@@ -42,6 +44,7 @@
 
 #include <QFileDialog>
 #include <QDir>
+#include <QtConcurrent>
 
 QVector<Vec3d> AstroCalcDialog::EphemerisListCoords;
 QVector<QString> AstroCalcDialog::EphemerisListDates;
@@ -58,6 +61,18 @@ float AstroCalcDialog::transitX = -1.f;
 QString AstroCalcDialog::yAxis1Legend = "";
 QString AstroCalcDialog::yAxis2Legend = "";
 
+// Length of the time windows the searches of phenomena are split into [days]
+static const double phenomenaWindow = 365.25;
+// Maximum change of the separation of two objects between the samples of a search [radians]
+static const double phenomenaStepAngle = 2.0*M_PI/180.;
+// Bounds of the steps of the searches [days]
+static const double phenomenaMinStep = 1.0/1440.;
+static const double phenomenaMaxStep = 30.0;
+// Step used to measure the angular rates at the beginning of a search [days]
+static const double phenomenaProbeStep = 1.0/24.;
+// Precision of the dates of phenomena [days]
+static const double phenomenaPrecision = 1.0/1440.;
+
 AstroCalcDialog::AstroCalcDialog(QObject *parent)
 	: StelDialog("AstroCalc",parent)
 	, currentTimeLine(Q_NULLPTR)
@@ -81,6 +96,7 @@ AstroCalcDialog::AstroCalcDialog(QObject *parent)
 
 AstroCalcDialog::~AstroCalcDialog()
 {
+	stopPhenomena();
 	if (currentTimeLine)
 	{
 		currentTimeLine->stop();
@@ -213,6 +229,12 @@ void AstroCalcDialog::createDialogContent()
 	connect(ui->allowedSeparationDoubleSpinBox, SIGNAL(valueChanged(double)), this, SLOT(savePhenomenaAngularSeparation(double)));
 
 	connect(ui->phenomenaPushButton, SIGNAL(clicked()), this, SLOT(calculatePhenomena()));
+	connect(ui->phenomenaCancelButton, SIGNAL(clicked()), this, SLOT(cancelPhenomena()));
+	connect(&phenomenaWatcher, SIGNAL(resultReadyAt(int)), this, SLOT(addPhenomena(int)));
+	connect(&phenomenaWatcher, SIGNAL(progressRangeChanged(int,int)), ui->phenomenaProgressBar, SLOT(setRange(int,int)));
+	connect(&phenomenaWatcher, SIGNAL(progressValueChanged(int)), ui->phenomenaProgressBar, SLOT(setValue(int)));
+	connect(&phenomenaWatcher, SIGNAL(finished()), this, SLOT(finishPhenomena()));
+	ui->phenomenaProgressBar->hide();
 	connect(ui->phenomenaCleanupButton, SIGNAL(clicked()), this, SLOT(cleanupPhenomena()));
 	connect(ui->phenomenaTreeWidget, SIGNAL(doubleClicked(QModelIndex)), this, SLOT(selectCurrentPhenomen(QModelIndex)));
 	connect(ui->phenomenaSaveButton, SIGNAL(clicked()), this, SLOT(savePhenomena()));
@@ -251,6 +273,7 @@ void AstroCalcDialog::createDialogContent()
 	connect(ui->secondCelestialBodyComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(saveSecondCelestialBody(int)));
 	connect(ui->computePlanetaryDataButton, SIGNAL(clicked(bool)), this, SLOT(computePlanetaryData()));
 
+	connect(solarSystem, SIGNAL(solarSystemDataAboutToReload()), this, SLOT(stopPhenomena()));
 	connect(solarSystem, SIGNAL(solarSystemDataReloaded()), this, SLOT(updateSolarSystemData()));
 	connect(core, SIGNAL(locationChanged(StelLocation)), this, SLOT(updateAstroCalcData()));
 	connect(ui->stackListWidget, SIGNAL(currentItemChanged(QListWidgetItem *, QListWidgetItem *)), this, SLOT(changePage(QListWidgetItem *, QListWidgetItem*)));
@@ -1628,24 +1651,37 @@ void AstroCalcDialog::drawAltVsTimeDiagram()
 
 		double shift = core->getUTCOffset(currentJD)/24.0;
 		double xMaxY = -100.f;
-		int step = 180;
-		int limit = 485;
+		double transitJD = 0.;
+		int transitIndex = 0;
+		int step = 600;
+		int first = -2;
+		int limit = 146;
 		bool isSatellite = false;
 		if (selectedObject->getType()=="Satellite") // Reduce accuracy for satellites
 		{
+			first = -5;
 			limit = 121;
 			step = 720;
 			isSatellite = true;
 		}
-		for(int i=-5;i<=limit;i++) // 24 hours + 15 minutes in both directions
+		// The objects other than satellites are computed without changing the time of the core
+		StelEphemerisSession session(core);
+		StelAltitudeFunction altitude(session, selectedObject);
+		StelEventFinder finder(altitude);
+		for(int i=first;i<=limit;i++) // 24 hours + 20 minutes in both directions
 		{
-			// A new point on the graph every 3 minutes with shift to right 12 hours
-			// to get midnight at the center of diagram (i.e. accuracy is 3 minutes)
+			// A new point on the graph every 10 minutes with shift to right 12 hours
+			// to get midnight at the center of diagram. The time of transit is refined below.
 			double ltime = i*step + 43200;
 			aX.append(ltime);
 			double JD = noon + ltime/86400 - shift - 0.5;
-			core->setJD(JD);
-			StelUtils::rectToSphe(&az, &alt, selectedObject->getAltAzPosAuto(core));
+			if (isSatellite)
+			{
+				core->setJD(JD);
+				StelUtils::rectToSphe(&az, &alt, selectedObject->getAltAzPosAuto(core));
+			}
+			else
+				alt = finder.evaluate(JD);
 			StelUtils::radToDecDeg(alt, sign, deg);
 			if (!sign)
 				deg *= -1;
@@ -1654,6 +1690,8 @@ void AstroCalcDialog::drawAltVsTimeDiagram()
 			{
 				xMaxY = deg;
 				transitX = ltime;
+				transitJD = JD;
+				transitIndex = i;
 			}
 
 			if (isSatellite)
@@ -1662,10 +1700,17 @@ void AstroCalcDialog::drawAltVsTimeDiagram()
 				GETSTELMODULE(Satellites)->update(0.0); // force update to avoid caching! WTF???
 				#endif
 			}
-			else
-				core->update(0.0);
 		}
-		core->setJD(currentJD);
+		if (isSatellite)
+			core->setJD(currentJD);
+		else if (transitIndex>first && transitIndex<limit)
+		{
+			// The transit is bracketed by the samples around the highest one
+			double sampleStep = step/86400.;
+			double JD;
+			if (finder.findMaximum(transitJD - sampleStep, transitJD, transitJD + sampleStep, &JD))
+				transitX = (JD - noon + shift + 0.5)*86400.;
+		}
 
 		QVector<double> x = aX.toVector(), y = aY.toVector();
 		double minYa = aY.first();
@@ -2207,6 +2252,9 @@ void AstroCalcDialog::selectCurrentPhenomen(const QModelIndex &modelIndex)
 
 void AstroCalcDialog::calculatePhenomena()
 {
+	if (phenomenaWatcher.isRunning())
+		return;
+
 	QString currentPlanet = ui->object1ComboBox->currentData().toString();
 	double separation = ui->allowedSeparationDoubleSpinBox->value();
 	bool opposition = ui->phenomenaOppositionCheckBox->isChecked();
@@ -2374,11 +2422,11 @@ void AstroCalcDialog::calculatePhenomena()
 			break;
 	}
 
+	QList<PhenomenaSearch> searches;
 	PlanetP planet = solarSystem->searchByEnglishName(currentPlanet);
 	if (planet)
 	{
-		double currentJD = core->getJD(); // save current JD
-		double currentJDE = core->getJDE(); // save current JDE
+		double currentJDE = core->getJDE();
 		double startJD = StelUtils::qDateTimeToJd(QDateTime(ui->phenomenFromDateEdit->date()));
 		double stopJD = StelUtils::qDateTimeToJd(QDateTime(ui->phenomenToDateEdit->date().addDays(1)));
 		startJD = startJD - core->getUTCOffset(startJD)/24;
@@ -2389,16 +2437,34 @@ void AstroCalcDialog::calculatePhenomena()
 		coordsLimit += separation*M_PI/180;
 		double ra, dec;
 
+		// The settings are shared by all the searches, which run in the workers
+		const StelEphemerisSession::Settings sessionSettings(core);
+		PhenomenaSearch search(sessionSettings);
+		search.object1 = planet;
+		search.name1 = planet->getNameI18n();
+		search.fixedSize = 0.;
+		search.opposition = false;
+		search.maxSeparation = separation*M_PI/180.;
+
 		if (obj2Type<10)
 		{
 			// Solar system objects
 			foreach (PlanetP obj, objects)
 			{
+				// The directions of the planet itself and of the home planet are undefined
+				if (obj==planet || obj==core->getCurrentPlanet())
+					continue;
+				search.object2 = obj;
+				search.name2 = obj->getNameI18n();
 				// conjunction
-				fillPhenomenaTable(findClosestApproach(planet, obj, startJD, stopJD, separation, false), planet, obj, false);
+				search.opposition = false;
+				appendPhenomenaSearches(searches, search, startJD, stopJD);
 				// opposition
 				if (opposition)
-					fillPhenomenaTable(findClosestApproach(planet, obj, startJD, stopJD, separation, true), planet, obj, true);
+				{
+					search.opposition = true;
+					appendPhenomenaSearches(searches, search, startJD, stopJD);
+				}
 			}
 		}
 		else if (obj2Type==10 || obj2Type==11 || obj2Type==12)
@@ -2411,7 +2477,10 @@ void AstroCalcDialog::calculatePhenomena()
 				if (dec<=coordsLimit && dec>=-coordsLimit)
 				{
 					// conjunction
-					fillPhenomenaTable(findClosestApproach(planet, obj, startJD, stopJD, separation), planet, obj);
+					search.object2 = obj;
+					search.fixedSize = obj->getAngularSize(core);
+					search.name2 = obj->getNameI18n();
+					appendPhenomenaSearches(searches, search, startJD, stopJD);
 				}
 			}
 		}
@@ -2425,24 +2494,21 @@ void AstroCalcDialog::calculatePhenomena()
 				if (dec<=coordsLimit && dec>=-coordsLimit)
 				{
 					// conjunction
-					fillPhenomenaTable(findClosestApproach(planet, obj, startJD, stopJD, separation), planet, obj);
+					search.object2 = obj;
+					search.fixedSize = obj->getAngularSize(core);
+					search.name2 = obj->getNameI18n().isEmpty() ? obj->getDSODesignation() : obj->getNameI18n();
+					appendPhenomenaSearches(searches, search, startJD, stopJD);
 				}
 			}
 		}
-
-
-		core->setJD(currentJD); // restore time
-		core->update(0);
 	}
 
-	// adjust the column width
-	for(int i = 0; i < PhenomenaCount; ++i)
-	{
-	    ui->phenomenaTreeWidget->resizeColumnToContents(i);
-	}
-
-	// sort-by-date
-	ui->phenomenaTreeWidget->sortItems(PhenomenaDate, Qt::AscendingOrder);
+	// The results are added to the list as the searches complete
+	ui->phenomenaPushButton->setEnabled(false);
+	ui->phenomenaCancelButton->setEnabled(true);
+	ui->phenomenaProgressBar->setValue(0);
+	ui->phenomenaProgressBar->show();
+	phenomenaWatcher.setFuture(QtConcurrent::mapped(searches, &AstroCalcDialog::searchPhenomena));
 }
 
 void AstroCalcDialog::savePhenomena()
@@ -2494,495 +2560,189 @@ void AstroCalcDialog::savePhenomena()
 	phenomena.close();
 }
 
-void AstroCalcDialog::fillPhenomenaTable(const QMap<double, double> list, const PlanetP object1, const PlanetP object2, bool opposition)
-{
-	QMap<double, double>::ConstIterator it;
-	for (it=list.constBegin(); it!=list.constEnd(); ++it)
-	{
-		core->setJD(it.key());
-		core->update(0);
-
-		QString phenomenType = q_("Conjunction");
-		double separation = it.value();
-		bool occultation = false;
-		double s1 = object1->getSpheroidAngularSize(core);
-		double s2 = object2->getSpheroidAngularSize(core);
-		if (opposition)
-		{
-			phenomenType = q_("Opposition");
-			separation += M_PI;
-		}
-		else if (separation<(s2*M_PI/180.) || separation<(s1*M_PI/180.))
-		{
-			double d1 = object1->getJ2000EquatorialPos(core).length();
-			double d2 = object2->getJ2000EquatorialPos(core).length();
-			if ((d1<d2 && s1<=s2) || (d1>d2 && s1>s2))
-				phenomenType = q_("Transit");
-			else
-				phenomenType = q_("Occultation");
-
-			// Added a special case - eclipse
-			if (qAbs(s1-s2)<=0.05 && (object1->getEnglishName()=="Sun" || object2->getEnglishName()=="Sun")) // 5% error of difference of sizes
-				phenomenType = q_("Eclipse");
-
-			occultation = true;
-		}
-
-		ACPhenTreeWidgetItem *treeItem = new ACPhenTreeWidgetItem(ui->phenomenaTreeWidget);
-		treeItem->setText(PhenomenaType, phenomenType);
-		// local date and time
-		treeItem->setText(PhenomenaDate, QString("%1 %2").arg(localeMgr->getPrintableDateLocal(it.key()), localeMgr->getPrintableTimeLocal(it.key())));
-		treeItem->setData(PhenomenaDate, Qt::UserRole,  it.key());
-		treeItem->setText(PhenomenaObject1, object1->getNameI18n());
-		treeItem->setText(PhenomenaObject2, object2->getNameI18n());
-		if (occultation)
-			treeItem->setText(PhenomenaSeparation, QChar(0x2014));
-		else
-			treeItem->setText(PhenomenaSeparation, StelUtils::radToDmsStr(separation));
-	}
-}
-
-QMap<double, double> AstroCalcDialog::findClosestApproach(PlanetP &object1, PlanetP &object2, double startJD, double stopJD, double maxSeparation, bool opposition)
-{
-	double dist, prevDist, step, step0;
-	int sgn, prevSgn = 0;
-	QMap<double, double> separations;
-	QPair<double, double> extremum;
-
-	step0 = (stopJD - startJD)/12.0;
-	if (step0>24.8*365.25)
-		step0 = 24.8*365.25;
-
-	if (object1->getEnglishName()=="Neptune" || object2->getEnglishName()=="Neptune" || object1->getEnglishName()=="Uranus" || object2->getEnglishName()=="Uranus")
-		if (step0 > 3652.5)
-			step0 = 3652.5;
-	if (object1->getEnglishName()=="Jupiter" || object2->getEnglishName()=="Jupiter" || object1->getEnglishName()=="Saturn" || object2->getEnglishName()=="Saturn")
-		if (step0 > 365.25)
-			step0 = 365.f;
-	if (object1->getEnglishName()=="Mars" || object2->getEnglishName()=="Mars")
-		if (step0 > 10.f)
-			step0 = 10.f;
-	if (object1->getEnglishName()=="Venus" || object2->getEnglishName()=="Venus" || object1->getEnglishName()=="Mercury" || object2->getEnglishName()=="Mercury")
-		if (step0 > 5.f)
-			step0 = 5.f;
-	if (object1->getEnglishName()=="Moon" || object2->getEnglishName()=="Moon")
-		if (step0 > 0.25)
-			step0 = 0.25;
-
-	step = step0;
-	double jd = startJD;
-	prevDist = findDistance(jd, object1, object2, opposition);
-	jd += step;
-	while(jd <= stopJD)
-	{
-		dist = findDistance(jd, object1, object2, opposition);
-		sgn = StelUtils::sign(dist - prevDist);
-
-		double factor = qAbs((dist - prevDist)/dist);
-		if (factor>10.f)
-			step = step0 * factor/10.f;
-		else
-			step = step0;
-
-		if (sgn != prevSgn && prevSgn == -1)
-		{
-			if (step > step0)
-			{
-				jd -= step;
-				step = step0;
-				sgn = prevSgn;
-				while(jd <= stopJD)
-				{
-					dist = findDistance(jd, object1, object2, opposition);
-					sgn = StelUtils::sign(dist - prevDist);
-					if (sgn!=prevSgn)
-						break;
-
-					prevDist = dist;
-					prevSgn = sgn;
-					jd += step;
-				}
-			}
-
-			if (findPrecise(&extremum, object1, object2, jd, step, sgn, opposition))
-			{
-				double sep = extremum.second*180./M_PI;
-				if (sep<maxSeparation)
-					separations.insert(extremum.first, extremum.second);
-			}
-
-		}
-
-		prevDist = dist;
-		prevSgn = sgn;
-		jd += step;
-	}
-
-	return separations;
-}
-
-bool AstroCalcDialog::findPrecise(QPair<double, double> *out, PlanetP object1, PlanetP object2, double JD, double step, int prevSign, bool opposition)
+void AstroCalcDialog::appendPhenomenaSearches(QList<PhenomenaSearch>& searches, PhenomenaSearch search, double startJD, double stopJD)
 {
-	int sgn;
-	double dist, prevDist;
-
-	if (out==Q_NULLPTR)
-		return false;
-
-	prevDist = findDistance(JD, object1, object2, opposition);
-	step = -step/2.f;
-	prevSign = -prevSign;
-
-	while(true)
+	for (double jd=startJD; jd<stopJD; jd+=phenomenaWindow)
 	{
-		JD += step;
-		dist = findDistance(JD, object1, object2, opposition);
-
-		if (qAbs(step)< 1.f/1440.f)
-		{
-			out->first = JD - step/2.0;
-			out->second = findDistance(JD - step/2.0, object1, object2, opposition);
-			if (out->second < findDistance(JD - 5.0, object1, object2, opposition))
-				return true;
-			else
-				return false;
-		}
-		sgn = StelUtils::sign(dist - prevDist);
-		if (sgn!=prevSign)
-		{
-			step = -step/2.0;
-			sgn = -sgn;
-		}
-		prevDist = dist;
-		prevSign = sgn;
+		search.startJD = jd;
+		search.stopJD = qMin(jd+phenomenaWindow, stopJD);
+		searches.append(search);
 	}
 }
 
-double AstroCalcDialog::findDistance(double JD, PlanetP object1, PlanetP object2, bool opposition)
+double AstroCalcDialog::findSeparation(const PhenomenaSearch& search, StelEphemerisSession& session, double JD, Vec3d& pos1, Vec3d& pos2)
 {
-	core->setJD(JD);
-	core->update(0);
-	Vec3d obj1 = object1->getJ2000EquatorialPos(core);
-	Vec3d obj2 = object2->getJ2000EquatorialPos(core);
-	double angle = obj1.angle(obj2);
-	if (opposition)
+	session.setJD(JD);
+	pos1 = session.getJ2000EquatorialPos(search.object1);
+	pos2 = session.getObjectJ2000EquatorialPos(search.object2);
+	double angle = pos1.angle(pos2);
+	if (search.opposition)
 		angle = M_PI - angle;
 	return angle;
 }
 
-void AstroCalcDialog::fillPhenomenaTable(const QMap<double, double> list, const PlanetP object1, const NebulaP object2)
-{
-	QMap<double, double>::ConstIterator it;
-	for (it=list.constBegin(); it!=list.constEnd(); ++it)
-	{
-		core->setJD(it.key());
-		core->update(0);
-
-		QString phenomenType = q_("Conjunction");
-		double separation = it.value();
-		bool occultation = false;
-		if (separation<(object2->getAngularSize(core)*M_PI/180.) || separation<(object1->getSpheroidAngularSize(core)*M_PI/180.))
+QList<AstroCalcDialog::Phenomenon> AstroCalcDialog::searchPhenomena(const PhenomenaSearch& search)
+{
+	QList<Phenomenon> phenomena;
+	StelEphemerisSession session(search.settings);
+	Vec3d pos1, pos2, prevPos1, prevPos2;
+
+	// The separation changes at most by the sum of the apparent angular rates of the objects:
+	// the step is adapted to that rate, measured over the previous step.
+	double step = phenomenaProbeStep;
+	findSeparation(search, session, search.startJD, prevPos1, prevPos2);
+	findSeparation(search, session, search.startJD + step, pos1, pos2);
+	double rate = (prevPos1.angle(pos1) + prevPos2.angle(pos2))/step;
+	step = rate>0. ? qBound(phenomenaMinStep, phenomenaStepAngle/rate, phenomenaMaxStep) : phenomenaMaxStep;
+
+	// Start one step before the window and stop one step after it, so that the minima close
+	// to its bounds are bracketed; the minima outside the window belong to its neighbours.
+	double jdA = search.startJD - step;
+	double sepA = findSeparation(search, session, jdA, prevPos1, prevPos2);
+	double jdB = search.startJD;
+	double sepB = findSeparation(search, session, jdB, pos1, pos2);
+	while (jdA <= search.stopJD)
+	{
+		rate = (prevPos1.angle(pos1) + prevPos2.angle(pos2))/(jdB - jdA);
+		step = rate>0. ? qBound(phenomenaMinStep, phenomenaStepAngle/rate, qMin(2.*step, phenomenaMaxStep)) : qMin(2.*step, phenomenaMaxStep);
+		prevPos1 = pos1;
+		prevPos2 = pos2;
+		double jdC = jdB + step;
+		double sepC = findSeparation(search, session, jdC, pos1, pos2);
+
+		if (sepB<sepA && sepB<=sepC)
 		{
-			phenomenType = q_("Occultation");
-			occultation = true;
-		}
-
-		ACPhenTreeWidgetItem *treeItem = new ACPhenTreeWidgetItem(ui->phenomenaTreeWidget);
-		treeItem->setText(PhenomenaType, phenomenType);
-		// local date and time
-		treeItem->setText(PhenomenaDate, QString("%1 %2").arg(localeMgr->getPrintableDateLocal(it.key()), localeMgr->getPrintableTimeLocal(it.key())));
-		treeItem->setData(PhenomenaDate, Qt::UserRole, it.key());
-		treeItem->setText(PhenomenaObject1, object1->getNameI18n());
-		if (!object2->getNameI18n().isEmpty())
-			treeItem->setText(PhenomenaObject2, object2->getNameI18n());
-		else
-			treeItem->setText(PhenomenaObject2, object2->getDSODesignation());
-		if (occultation)
-			treeItem->setText(PhenomenaSeparation, QChar(0x2014));
-		else
-			treeItem->setText(PhenomenaSeparation, StelUtils::radToDmsStr(separation));
-	}
-}
-
-QMap<double, double> AstroCalcDialog::findClosestApproach(PlanetP &object1, NebulaP &object2, double startJD, double stopJD, double maxSeparation)
-{
-	double dist, prevDist, step, step0;
-	int sgn, prevSgn = 0;
-	QMap<double, double> separations;
-	QPair<double, double> extremum;
-
-	step0 = (stopJD - startJD)/8.0;
-	if (step0>24.8*365.25)
-		step0 = 24.8*365.25;
-
-	if (object1->getEnglishName()=="Neptune" || object1->getEnglishName()=="Uranus")
-		if (step0 > 3652.5)
-			step0 = 3652.5;
-	if (object1->getEnglishName()=="Jupiter" || object1->getEnglishName()=="Saturn")
-		if (step0 > 365.25)
-			step0 = 365.f;
-	if (object1->getEnglishName()=="Mars")
-		if (step0 > 10.f)
-			step0 = 10.f;
-	if (object1->getEnglishName()=="Venus" || object1->getEnglishName()=="Mercury")
-		if (step0 > 5.f)
-			step0 = 5.f;
-	if (object1->getEnglishName()=="Moon")
-		if (step0 > 0.25)
-			step0 = 0.25;
-
-	step = step0;
-	double jd = startJD;
-	prevDist = findDistance(jd, object1, object2);
-	jd += step;
-	while(jd <= stopJD)
-	{
-		dist = findDistance(jd, object1, object2);
-		sgn = StelUtils::sign(dist - prevDist);
-
-		double factor = qAbs((dist - prevDist)/dist);
-		if (factor>10.f)
-			step = step0 * factor/10.f;
-		else
-			step = step0;
-
-		if (sgn != prevSgn && prevSgn == -1)
-		{
-			if (step > step0)
+			// Brent's search of the extremum bracketed by jdA and jdC: a conjunction is a minimum
+			// of the separation, an opposition a maximum.
+			StelSeparationFunction separationFunction(session, search.object1, search.object2);
+			StelEventFinder finder(separationFunction, phenomenaPrecision);
+			double jd, separation;
+			if (search.opposition)
 			{
-				jd -= step;
-				step = step0;
-				sgn = prevSgn;
-				while(jd <= stopJD)
-				{
-					dist = findDistance(jd, object1, object2);
-					sgn = StelUtils::sign(dist - prevDist);
-					if (sgn!=prevSgn)
-						break;
-
-					prevDist = dist;
-					prevSgn = sgn;
-					jd += step;
-				}
+				finder.findMaximum(jdA, jdB, jdC, &jd, &separation);
+				separation = M_PI - separation;
 			}
-
-			if (findPrecise(&extremum, object1, object2, jd, step, sgn))
+			else
+				finder.findMinimum(jdA, jdB, jdC, &jd, &separation);
+			if (jd>=search.startJD && jd<search.stopJD && separation<search.maxSeparation)
 			{
-				double sep = extremum.second*180./M_PI;
-				if (sep<maxSeparation)
-					separations.insert(extremum.first, extremum.second);
+				session.setJD(jd);
+				phenomena.append(findPhenomenon(search, session, separation));
 			}
-
 		}
 
-		prevDist = dist;
-		prevSgn = sgn;
-		jd += step;
+		jdA = jdB;
+		sepA = sepB;
+		jdB = jdC;
+		sepB = sepC;
 	}
 
-	return separations;
+	return phenomena;
 }
 
-bool AstroCalcDialog::findPrecise(QPair<double, double> *out, PlanetP object1, NebulaP object2, double JD, double step, int prevSign)
+AstroCalcDialog::Phenomenon AstroCalcDialog::findPhenomenon(const PhenomenaSearch& search, const StelEphemerisSession& session, double separation)
 {
-	int sgn;
-	double dist, prevDist;
+	Phenomenon phenomenon;
+	phenomenon.JD = session.getJD();
+	phenomenon.separation = separation;
+	phenomenon.type = PhenomenonConjunction;
+	phenomenon.object1 = search.name1;
+	phenomenon.object2 = search.name2;
 
-	if (out==Q_NULLPTR)
-		return false;
-
-	prevDist = findDistance(JD, object1, object2);
-	step = -step/2.f;
-	prevSign = -prevSign;
-
-	while(true)
+	if (search.opposition)
 	{
-		JD += step;
-		dist = findDistance(JD, object1, object2);
+		phenomenon.type = PhenomenonOpposition;
+		phenomenon.separation = M_PI - separation;
+		return phenomenon;
+	}
 
-		if (qAbs(step)< 1.f/1440.f)
+	const PlanetP body2 = qSharedPointerDynamicCast<Planet>(search.object2);
+	double s1 = session.getSpheroidAngularSize(search.object1);
+	double s2 = body2 ? session.getSpheroidAngularSize(body2) : search.fixedSize;
+	if (separation<(s2*M_PI/180.) || separation<(s1*M_PI/180.))
+	{
+		if (!body2)
+			phenomenon.type = PhenomenonOccultation;
+		else
 		{
-			out->first = JD - step/2.0;
-			out->second = findDistance(JD - step/2.0, object1, object2);
-			if (out->second < findDistance(JD - 5.0, object1, object2))
-				return true;
+			double d1 = session.getJ2000EquatorialPos(search.object1).length();
+			double d2 = session.getJ2000EquatorialPos(body2).length();
+			if ((d1<d2 && s1<=s2) || (d1>d2 && s1>s2))
+				phenomenon.type = PhenomenonTransit;
 			else
-				return false;
-		}
-		sgn = StelUtils::sign(dist - prevDist);
-		if (sgn!=prevSign)
-		{
-			step = -step/2.0;
-			sgn = -sgn;
+				phenomenon.type = PhenomenonOccultation;
+
+			// Added a special case - eclipse
+			if (qAbs(s1-s2)<=0.05 && (search.object1->getEnglishName()=="Sun" || body2->getEnglishName()=="Sun")) // 5% error of difference of sizes
+				phenomenon.type = PhenomenonEclipse;
 		}
-		prevDist = dist;
-		prevSign = sgn;
 	}
+	return phenomenon;
 }
 
-double AstroCalcDialog::findDistance(double JD, PlanetP object1, NebulaP object2)
+void AstroCalcDialog::addPhenomena(int index)
 {
-	core->setJD(JD);
-	core->update(0);
-	Vec3d obj1 = object1->getJ2000EquatorialPos(core);
-	Vec3d obj2 = object2->getJ2000EquatorialPos(core);
-	return obj1.angle(obj2);
-}
-
-void AstroCalcDialog::fillPhenomenaTable(const QMap<double, double> list, const PlanetP object1, const StelObjectP object2)
-{
-	QMap<double, double>::ConstIterator it;
-	for (it=list.constBegin(); it!=list.constEnd(); ++it)
+	foreach (const Phenomenon& phenomenon, phenomenaWatcher.resultAt(index))
 	{
-		core->setJD(it.key());
-		core->update(0);
-
-		QString phenomenType = q_("Conjunction");
-		double separation = it.value();
-		bool occultation = false;
-		if (separation<(object2->getAngularSize(core)*M_PI/180.) || separation<(object1->getSpheroidAngularSize(core)*M_PI/180.))
+		QString phenomenType;
+		switch (phenomenon.type)
 		{
-			phenomenType = q_("Occultation");
-			occultation = true;
+			case PhenomenonConjunction:
+				phenomenType = q_("Conjunction");
+				break;
+			case PhenomenonOpposition:
+				phenomenType = q_("Opposition");
+				break;
+			case PhenomenonTransit:
+				phenomenType = q_("Transit");
+				break;
+			case PhenomenonOccultation:
+				phenomenType = q_("Occultation");
+				break;
+			case PhenomenonEclipse:
+				phenomenType = q_("Eclipse");
+				break;
 		}
 
 		ACPhenTreeWidgetItem *treeItem = new ACPhenTreeWidgetItem(ui->phenomenaTreeWidget);
 		treeItem->setText(PhenomenaType, phenomenType);
 		// local date and time
-		treeItem->setText(PhenomenaDate, QString("%1 %2").arg(localeMgr->getPrintableDateLocal(it.key()), localeMgr->getPrintableTimeLocal(it.key())));
-		treeItem->setData(PhenomenaDate, Qt::UserRole, it.key());
-		treeItem->setText(PhenomenaObject1, object1->getNameI18n());
-		treeItem->setText(PhenomenaObject2, object2->getNameI18n());
-		if (occultation)
-			treeItem->setText(PhenomenaSeparation, QChar(0x2014));
+		treeItem->setText(PhenomenaDate, QString("%1 %2").arg(localeMgr->getPrintableDateLocal(phenomenon.JD), localeMgr->getPrintableTimeLocal(phenomenon.JD)));
+		treeItem->setData(PhenomenaDate, Qt::UserRole, phenomenon.JD);
+		treeItem->setText(PhenomenaObject1, phenomenon.object1);
+		treeItem->setText(PhenomenaObject2, phenomenon.object2);
+		if (phenomenon.type==PhenomenonConjunction || phenomenon.type==PhenomenonOpposition)
+			treeItem->setText(PhenomenaSeparation, StelUtils::radToDmsStr(phenomenon.separation));
 		else
-			treeItem->setText(PhenomenaSeparation, StelUtils::radToDmsStr(separation));
-	}
-}
-
-QMap<double, double> AstroCalcDialog::findClosestApproach(PlanetP &object1, StelObjectP &object2, double startJD, double stopJD, double maxSeparation)
-{
-	double dist, prevDist, step, step0;
-	int sgn, prevSgn = 0;
-	QMap<double, double> separations;
-	QPair<double, double> extremum;
-
-	step0 = (stopJD - startJD)/8.0;
-	if (step0>24.8*365.25)
-		step0 = 24.8*365.25;
-
-	if (object1->getEnglishName()=="Neptune" || object1->getEnglishName()=="Uranus")
-		if (step0 > 1811.25)
-			step0 = 1811.25;
-	if (object1->getEnglishName()=="Jupiter" || object1->getEnglishName()=="Saturn")
-		if (step0 > 181.125)
-			step0 = 181.125;
-	if (object1->getEnglishName()=="Mars")
-		if (step0 > 5.f)
-			step0 = 5.0;
-	if (object1->getEnglishName()=="Venus" || object1->getEnglishName()=="Mercury")
-		if (step0 > 2.5f)
-			step0 = 2.5;
-	if (object1->getEnglishName()=="Moon")
-		if (step0 > 0.25)
-			step0 = 0.25;
-
-	step = step0;
-	double jd = startJD;
-	prevDist = findDistance(jd, object1, object2);
-	jd += step;
-	while(jd <= stopJD)
-	{
-		dist = findDistance(jd, object1, object2);
-		sgn = StelUtils::sign(dist - prevDist);
-
-		double factor = qAbs((dist - prevDist)/dist);
-		if (factor>10.f)
-			step = step0 * factor/10.f;
-		else
-			step = step0;
-
-		if (sgn != prevSgn && prevSgn == -1)
-		{
-			if (step > step0)
-			{
-				jd -= step;
-				step = step0;
-				sgn = prevSgn;
-				while(jd <= stopJD)
-				{
-					dist = findDistance(jd, object1, object2);
-					sgn = StelUtils::sign(dist - prevDist);
-					if (sgn!=prevSgn)
-						break;
-
-					prevDist = dist;
-					prevSgn = sgn;
-					jd += step;
-				}
-			}
-
-			if (findPrecise(&extremum, object1, object2, jd, step, sgn))
-			{
-				double sep = extremum.second*180./M_PI;
-				if (sep<maxSeparation)
-					separations.insert(extremum.first, extremum.second);
-			}
-
-		}
-
-		prevDist = dist;
-		prevSgn = sgn;
-		jd += step;
+			treeItem->setText(PhenomenaSeparation, QChar(0x2014));
 	}
-
-	return separations;
 }
 
-bool AstroCalcDialog::findPrecise(QPair<double, double> *out, PlanetP object1, StelObjectP object2, double JD, double step, int prevSign)
+void AstroCalcDialog::finishPhenomena()
 {
-	int sgn;
-	double dist, prevDist;
-
-	if (out==Q_NULLPTR)
-		return false;
+	// adjust the column width
+	for(int i = 0; i < PhenomenaCount; ++i)
+	{
+	    ui->phenomenaTreeWidget->resizeColumnToContents(i);
+	}
 
-	prevDist = findDistance(JD, object1, object2);
-	step = -step/2.f;
-	prevSign = -prevSign;
+	// sort-by-date
+	ui->phenomenaTreeWidget->sortItems(PhenomenaDate, Qt::AscendingOrder);
 
-	while(true)
-	{
-		JD += step;
-		dist = findDistance(JD, object1, object2);
+	ui->phenomenaProgressBar->hide();
+	ui->phenomenaCancelButton->setEnabled(false);
+	ui->phenomenaPushButton->setEnabled(true);
+}
 
-		if (qAbs(step)< 1.f/1440.f)
-		{
-			out->first = JD - step/2.0;
-			out->second = findDistance(JD - step/2.0, object1, object2);
-			if (out->second < findDistance(JD - 5.0, object1, object2))
-				return true;
-			else
-				return false;
-		}
-		sgn = StelUtils::sign(dist - prevDist);
-		if (sgn!=prevSign)
-		{
-			step = -step/2.0;
-			sgn = -sgn;
-		}
-		prevDist = dist;
-		prevSign = sgn;
-	}
+void AstroCalcDialog::cancelPhenomena()
+{
+	phenomenaWatcher.cancel();
 }
 
-double AstroCalcDialog::findDistance(double JD, PlanetP object1, StelObjectP object2)
+void AstroCalcDialog::stopPhenomena()
 {
-	core->setJD(JD);
-	core->update(0);
-	Vec3d obj1 = object1->getJ2000EquatorialPos(core);
-	Vec3d obj2 = object2->getJ2000EquatorialPos(core);
-	return obj1.angle(obj2);
+	phenomenaWatcher.cancel();
+	phenomenaWatcher.waitForFinished();
 }
 
 void AstroCalcDialog::changePage(QListWidgetItem *current, QListWidgetItem *previous)
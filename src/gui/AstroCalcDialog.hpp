@@ -22,6 +22,7 @@
 #define _ASTROCALCDIALOG_HPP_
 
 #include <QObject>
+#include <QFutureWatcher>
 #include <QTreeWidget>
 #include <QTreeWidgetItem>
 #include <QMap>
@@ -30,6 +31,7 @@
 
 #include "StelDialog.hpp"
 #include "StelCore.hpp"
+#include "StelEphemerisSession.hpp"
 #include "Planet.hpp"
 #include "SolarSystem.hpp"
 #include "Nebula.hpp"
@@ -177,6 +179,15 @@ private slots:
 
 	void updateSolarSystemData();
 
+	//! Add the phenomena found by a search to the list.
+	void addPhenomena(int index);
+	//! Adjust the list and the buttons once all the searches are over.
+	void finishPhenomena();
+	//! Cancel the searches which have not started yet.
+	void cancelPhenomena();
+	//! Cancel the searches and wait for those which already started, before the planets they use are deleted.
+	void stopPhenomena();
+
 private:
 	class StelCore* core;
 	class SolarSystem* solarSystem;
@@ -225,24 +236,62 @@ private:
 
 	void populateFunctionsList();
 
-	//! Calculation conjunctions and oppositions.
-	//! @note Ported from KStars, should be improved, because this feature calculate
-	//! angular separation ("conjunction" defined as equality of right ascension
-	//! of two body) and current solution is not accurate and slow.
-	QMap<double, double> findClosestApproach(PlanetP& object1, PlanetP& object2, double startJD, double stopJD, double maxSeparation, bool opposition);
-	double findDistance(double JD, PlanetP object1, PlanetP object2, bool opposition);
-	bool findPrecise(QPair<double, double>* out, PlanetP object1, PlanetP object2, double JD, double step, int prevSign, bool opposition);
-	void fillPhenomenaTable(const QMap<double, double> list, const PlanetP object1, const PlanetP object2, bool opposition);
-
-	QMap<double, double> findClosestApproach(PlanetP& object1, NebulaP& object2, double startJD, double stopJD, double maxSeparation);
-	double findDistance(double JD, PlanetP object1, NebulaP object2);
-	bool findPrecise(QPair<double, double>* out, PlanetP object1, NebulaP object2, double JD, double step, int prevSign);
-	void fillPhenomenaTable(const QMap<double, double> list, const PlanetP object1, const NebulaP object2);
-
-	QMap<double, double> findClosestApproach(PlanetP& object1, StelObjectP& object2, double startJD, double stopJD, double maxSeparation);
-	double findDistance(double JD, PlanetP object1, StelObjectP object2);
-	bool findPrecise(QPair<double, double>* out, PlanetP object1, StelObjectP object2, double JD, double step, int prevSign);
-	void fillPhenomenaTable(const QMap<double, double> list, const PlanetP object1, const StelObjectP object2);
+	//! Types of phenomena
+	enum PhenomenonType {
+		PhenomenonConjunction,
+		PhenomenonOpposition,
+		PhenomenonTransit,
+		PhenomenonOccultation,
+		PhenomenonEclipse
+	};
+
+	//! A phenomenon found by searchPhenomena()
+	struct Phenomenon
+	{
+		double JD;
+		double separation;	//! angular separation [radians]
+		PhenomenonType type;
+		QString object1;
+		QString object2;
+	};
+
+	//! The search of conjunctions (or oppositions) between two objects within a time window.
+	//! The searches are independent of each other and run concurrently in the global thread pool.
+	struct PhenomenaSearch
+	{
+		explicit PhenomenaSearch(const StelEphemerisSession::Settings& settings) : settings(settings) {}
+
+		//! Settings captured in the main thread; each search creates its session in its worker.
+		StelEphemerisSession::Settings settings;
+		PlanetP object1;
+		//! Second object: a solar system body, a star or a deep-sky object.
+		//! The stars are computed with their proper motion at the dates of the session.
+		StelObjectP object2;
+		//! Angular size of the second object when it is not a solar system body [degrees]
+		double fixedSize;
+		QString name1;
+		QString name2;
+		bool opposition;
+		double startJD;
+		double stopJD;
+		//! Maximum separation of the phenomena [radians]
+		double maxSeparation;
+	};
+
+	//! Append the searches of the phenomena between two objects from startJD to stopJD, one per time window.
+	void appendPhenomenaSearches(QList<PhenomenaSearch>& searches, PhenomenaSearch search, double startJD, double stopJD);
+	//! Find the closest approaches of the objects of a search within its time window.
+	//! The objects are sampled with steps over which their separation changes by a fixed angle at most,
+	//! derived from the sum of their apparent angular rates, and each minimum is refined by golden section search.
+	//! Runs in a worker thread.
+	static QList<Phenomenon> searchPhenomena(const PhenomenaSearch& search);
+	//! Compute the separation of the objects of a search at JD (its supplement for oppositions).
+	//! @param pos1, pos2 the J2000 positions of the objects
+	static double findSeparation(const PhenomenaSearch& search, StelEphemerisSession& session, double JD, Vec3d& pos1, Vec3d& pos2);
+	//! Classify the closest approach of the objects of a search found at the current date of the session.
+	static Phenomenon findPhenomenon(const PhenomenaSearch& search, const StelEphemerisSession& session, double separation);
+
+	QFutureWatcher<QList<Phenomenon> > phenomenaWatcher;
 
 	bool plotAltVsTime;
 	QString delimiter, acEndl;
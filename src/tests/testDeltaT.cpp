@@ -25,10 +25,19 @@
 #include <QDebug>
 #include <QtGlobal>
 
+#include <cmath>
+
 #include "StelUtils.hpp"
+#include "StelDeltaTTable.hpp"
 
 QTEST_GUILESS_MAIN(TestDeltaT)
 
+// Time factor of the secular acceleration of the Moon, as tabulated by StelCore
+static double getMoonSecularAccelerationTimeFactor(const double JD)
+{
+	return StelUtils::getMoonSecularAcceleration(JD, 0., false)/StelUtils::getMoonSecularAccelerationCoefficient(0., false);
+}
+
 void TestDeltaT::initTestCase()
 {
 }
@@ -337,3 +346,77 @@ void TestDeltaT::testDeltaTByStephensonMorrison1984WideDates()
 							.toUtf8());
 	}
 }
+
+void TestDeltaT::testDeltaTTables()
+{
+	struct Algorithm
+	{
+		const char* name;
+		StelDeltaTTable::Function function;
+	};
+	const Algorithm algorithms[] = {
+		{ "EspenakMeeus", StelUtils::getDeltaTByEspenakMeeus },
+		{ "Schoch", StelUtils::getDeltaTBySchoch },
+		{ "Clemence", StelUtils::getDeltaTByClemence },
+		{ "IAU", StelUtils::getDeltaTByIAU },
+		{ "AstronomicalEphemeris", StelUtils::getDeltaTByAstronomicalEphemeris },
+		{ "TuckermanGoldstine", StelUtils::getDeltaTByTuckermanGoldstine },
+		{ "MullerStephenson", StelUtils::getDeltaTByMullerStephenson },
+		{ "Stephenson1978", StelUtils::getDeltaTByStephenson1978 },
+		{ "Stephenson1997", StelUtils::getDeltaTByStephenson1997 },
+		{ "SchmadelZech1979", StelUtils::getDeltaTBySchmadelZech1979 },
+		{ "MorrisonStephenson1982", StelUtils::getDeltaTByMorrisonStephenson1982 },
+		{ "StephensonMorrison1984", StelUtils::getDeltaTByStephensonMorrison1984 },
+		{ "StephensonMorrison1995", StelUtils::getDeltaTByStephensonMorrison1995 },
+		{ "StephensonHoulden", StelUtils::getDeltaTByStephensonHoulden },
+		{ "Espenak", StelUtils::getDeltaTByEspenak },
+		{ "Borkowski", StelUtils::getDeltaTByBorkowski },
+		{ "SchmadelZech1988", StelUtils::getDeltaTBySchmadelZech1988 },
+		{ "ChaprontTouze", StelUtils::getDeltaTByChaprontTouze },
+		{ "JPLHorizons", StelUtils::getDeltaTByJPLHorizons },
+		{ "MorrisonStephenson2004", StelUtils::getDeltaTByMorrisonStephenson2004 },
+		{ "Reijs", StelUtils::getDeltaTByReijs },
+		{ "ChaprontMeeus", StelUtils::getDeltaTByChaprontMeeus },
+		{ "MeeusSimons", StelUtils::getDeltaTByMeeusSimons },
+		{ "MontenbruckPfleger", StelUtils::getDeltaTByMontenbruckPfleger },
+		{ "ReingoldDershowitz", StelUtils::getDeltaTByReingoldDershowitz },
+		{ "Banjevic", StelUtils::getDeltaTByBanjevic },
+		{ "IslamSadiqQureshi", StelUtils::getDeltaTByIslamSadiqQureshi },
+		{ "KhalidSultanaZaidi", StelUtils::getDeltaTByKhalidSultanaZaidi },
+		{ "StephensonMorrisonHohenkerk2016", StelUtils::getDeltaTByStephensonMorrisonHohenkerk2016 },
+		{ "MoonSecularAccelerationTimeFactor", getMoonSecularAccelerationTimeFactor }
+	};
+
+	// The tables follow the functions within 0.05 s at the quarters of their intervals, and call
+	// them directly around the jumps between the segments of an algorithm. In between, the
+	// algorithms give the same value for the whole day: the table may differ from them by half
+	// the change of DeltaT in a day, about 0.06 s in -2000 for the steepest ones.
+	const double acceptableError = 0.2;
+	double beginJD, endJD;
+	StelUtils::getJDFromDate(&beginJD, -2000, 1, 1, 0, 0, 0);
+	StelUtils::getJDFromDate(&endJD, 3000, 1, 1, 0, 0, 0);
+	for (unsigned int i=0; i<sizeof(algorithms)/sizeof(algorithms[0]); ++i)
+	{
+		const StelDeltaTTable* table = StelDeltaTTable::get(algorithms[i].function);
+		QVERIFY(table==StelDeltaTTable::get(algorithms[i].function));
+		double maxError = 0., maxErrorJD = beginJD;
+		// A step not commensurate with the table step, to sample all the phases of the intervals
+		for (double JD=beginJD; JD<=endJD; JD+=1.37)
+		{
+			const double error = std::fabs(table->value(JD) - algorithms[i].function(JD));
+			if (error>maxError)
+			{
+				maxError = error;
+				maxErrorJD = JD;
+			}
+		}
+		int year, month, day;
+		StelUtils::getDateFromJulianDay(maxErrorJD, &year, &month, &day);
+		QVERIFY2(maxError <= acceptableError, QString("algorithm=%1 date=%2-%3-%4 error=%5 acceptable=%6")
+						.arg(algorithms[i].name)
+						.arg(year).arg(month).arg(day)
+						.arg(maxError)
+						.arg(acceptableError)
+						.toUtf8());
+	}
+}
@@ -35,6 +35,7 @@ private slots:
 	void testDeltaTByChaprontMeeusWideDates();
 	void testDeltaTByMorrisonStephenson1982WideDates();
 	void testDeltaTByStephensonMorrison1984WideDates();
+	void testDeltaTTables();
 
 };
 
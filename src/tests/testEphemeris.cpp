@@ -29,6 +29,7 @@
 #include "vsop87.h"
 #include "de430.hpp"
 #include "de431.hpp"
+#include "EphemChebyshevCache.hpp"
 
 QTEST_GUILESS_MAIN(TestEphemeris)
 
@@ -1764,3 +1765,57 @@ void TestEphemeris::testNeptuneHeliocentricEphemerisDe431()
 		}
 	}
 }
+
+// Compare the positions interpolated by the cache with those of the theory, over 4 millennia
+static void checkChebyshevCache(const EphemChebyshevCache::Series& series, double acceptableError)
+{
+	EphemChebyshevCache cache;
+	double expected[3], xyz[3];
+	int fitted = 0;
+	for (double jd=1721057.5; jd<3182030.5; jd+=3652.5*0.7+0.37)
+	{
+		// The window is fitted on its second use
+		cache.getCoor(series, jd, xyz);
+		cache.getCoor(series, jd, xyz);
+		for (int i=0; i<10; ++i)
+		{
+			const double t = jd + 0.0937*i*series.window;
+			series.func(t, series.body, expected);
+			cache.getCoor(series, t, xyz);
+			if (xyz[0]!=expected[0] || xyz[1]!=expected[1] || xyz[2]!=expected[2])
+				fitted++;
+
+			const double actualErrorX = qAbs(expected[0] - xyz[0]);
+			const double actualErrorY = qAbs(expected[1] - xyz[1]);
+			const double actualErrorZ = qAbs(expected[2] - xyz[2]);
+			QVERIFY2(actualErrorX <= acceptableError && actualErrorY <= acceptableError && actualErrorZ <= acceptableError,
+				 QString("body=%1 jd=%2 x=%3 (%6) y=%4 (%7) z=%5 (%8)")
+				 .arg(series.body)
+				 .arg(QString::number(         t, 'f', 15))
+				 .arg(QString::number(    xyz[0], 'f', 15))
+				 .arg(QString::number(    xyz[1], 'f', 15))
+				 .arg(QString::number(    xyz[2], 'f', 15))
+				 .arg(QString::number(expected[0], 'f', 15))
+				 .arg(QString::number(expected[1], 'f', 15))
+				 .arg(QString::number(expected[2], 'f', 15))
+				 .toUtf8());
+		}
+	}
+	// Make sure the positions really came from the fits
+	QVERIFY2(fitted>0, QString("body=%1: no window was fitted").arg(series.body).toUtf8());
+}
+
+void TestEphemeris::testChebyshevCacheElp82b()
+{
+	checkChebyshevCache(EphemChebyshevCache::theorySeries[EphemChebyshevCache::Elp82bMoon], 1E-09);
+}
+
+void TestEphemeris::testChebyshevCacheSatellites()
+{
+	for (int i=EphemChebyshevCache::L1Io; i<EphemChebyshevCache::TheorySeriesCount; ++i)
+	{
+		checkChebyshevCache(EphemChebyshevCache::theorySeries[i], 1E-09);
+		if (QTest::currentTestFailed())
+			return;
+	}
+}
@@ -53,6 +53,9 @@ private slots:
 	void testSaturnHeliocentricEphemerisDe431();
 	void testUranusHeliocentricEphemerisDe431();
 	void testNeptuneHeliocentricEphemerisDe431();
+	// Chebyshev cache of the lunar and satellite theories
+	void testChebyshevCacheElp82b();
+	void testChebyshevCacheSatellites();
 
 private:
 	QString de430FilePath, de431FilePath;
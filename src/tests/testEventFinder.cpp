@@ -0,0 +1,167 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 Stellarium Developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include <QObject>
+#include <QtDebug>
+#include <QtTest>
+
+#include <cmath>
+
+#include "tests/testEventFinder.hpp"
+#include "StelEventFinder.hpp"
+
+QTEST_GUILESS_MAIN(TestEventFinder)
+
+namespace
+{
+	// Roots at k*pi, maxima at pi/2+2k*pi
+	class SineFunction : public StelEventFinder::Function
+	{
+	public:
+		virtual double value(double x) {return std::sin(x);}
+	};
+
+	// Roots at 1.5 and 3.5, minimum -1 at 2.5
+	class ParabolaFunction : public StelEventFinder::Function
+	{
+	public:
+		virtual double value(double x) {return (x-2.5)*(x-2.5)-1.;}
+	};
+}
+
+void TestEventFinder::testFindRoot()
+{
+	SineFunction sine;
+	const double tolerances[] = {1./86400., 1e-6, 1e-9};
+	for (int i=0; i<3; ++i)
+	{
+		StelEventFinder finder(sine, tolerances[i]);
+		double root;
+		QVERIFY(finder.findRoot(2., 4., &root));
+		QVERIFY2(std::fabs(root-M_PI)<=tolerances[i], QString("tolerance %1: root %2 differs from pi by %3")
+			 .arg(tolerances[i]).arg(root, 0, 'f', 12).arg(root-M_PI).toUtf8());
+		// The bounds may be given in any order
+		QVERIFY(finder.findRoot(7., 5., &root));
+		QVERIFY2(std::fabs(root-2.*M_PI)<=tolerances[i], QString("tolerance %1: root %2 differs from 2pi by %3")
+			 .arg(tolerances[i]).arg(root, 0, 'f', 12).arg(root-2.*M_PI).toUtf8());
+	}
+
+	ParabolaFunction parabola;
+	StelEventFinder finder(parabola, 1e-9);
+	double root;
+	QVERIFY(finder.findRoot(0., 2.5, &root));
+	QVERIFY2(std::fabs(root-1.5)<=1e-9, QString("root %1 instead of 1.5").arg(root, 0, 'f', 12).toUtf8());
+	QVERIFY(finder.findRoot(2.5, 10., &root));
+	QVERIFY2(std::fabs(root-3.5)<=1e-9, QString("root %1 instead of 3.5").arg(root, 0, 'f', 12).toUtf8());
+	// A root at a bound
+	QVERIFY(finder.findRoot(1.5, 2., &root));
+	QCOMPARE(root, 1.5);
+}
+
+void TestEventFinder::testFindRootWithoutSignChange()
+{
+	SineFunction sine;
+	StelEventFinder finder(sine, 1e-9);
+	double root;
+	// Positive at both bounds, without any root in between
+	QVERIFY(!finder.findRoot(0.5, 2.5, &root));
+	// Two roots in between, but the same sign at both bounds
+	QVERIFY(!finder.findRoot(0.5, 6.5, &root));
+
+	ParabolaFunction parabola;
+	StelEventFinder parabolaFinder(parabola, 1e-9);
+	QVERIFY(!parabolaFinder.findRoot(0., 5., &root));
+	// No root within maxDistance of the guess
+	QVERIFY(!finder.findRootNear(M_PI/2., 0.1, 1., &root));
+	QVERIFY(!parabolaFinder.findRootNear(2.5, 0.1, 0.5, &root));
+}
+
+void TestEventFinder::testFindRootNear()
+{
+	SineFunction sine;
+	StelEventFinder finder(sine, 1e-9);
+	double root;
+	// The bracket is widened until it contains a root
+	QVERIFY(finder.findRootNear(2., 0.1, 10., &root));
+	QVERIFY2(std::fabs(root-M_PI)<=1e-9, QString("root %1 instead of pi").arg(root, 0, 'f', 12).toUtf8());
+	// Roots on both sides of the guess: the nearest one is taken
+	QVERIFY(finder.findRootNear(4.6, 2., 10., &root));
+	QVERIFY2(std::fabs(root-M_PI)<=1e-9, QString("root %1 instead of pi").arg(root, 0, 'f', 12).toUtf8());
+	QVERIFY(finder.findRootNear(5., 2., 10., &root));
+	QVERIFY2(std::fabs(root-2.*M_PI)<=1e-9, QString("root %1 instead of 2pi").arg(root, 0, 'f', 12).toUtf8());
+
+	ParabolaFunction parabola;
+	StelEventFinder parabolaFinder(parabola, 1e-9);
+	QVERIFY(parabolaFinder.findRootNear(2.4, 0.5, 10., &root));
+	QVERIFY2(std::fabs(root-1.5)<=1e-9, QString("root %1 instead of 1.5").arg(root, 0, 'f', 12).toUtf8());
+	QVERIFY(parabolaFinder.findRootNear(2.6, 0.5, 10., &root));
+	QVERIFY2(std::fabs(root-3.5)<=1e-9, QString("root %1 instead of 3.5").arg(root, 0, 'f', 12).toUtf8());
+}
+
+void TestEventFinder::testFindExtrema()
+{
+	const double tolerance = 1e-6;
+	ParabolaFunction parabola;
+	StelEventFinder parabolaFinder(parabola, tolerance);
+	double x, value;
+	QVERIFY(parabolaFinder.findMinimum(0., 2., 5., &x, &value));
+	QVERIFY2(std::fabs(x-2.5)<=tolerance, QString("minimum at %1 instead of 2.5").arg(x, 0, 'f', 12).toUtf8());
+	QVERIFY2(std::fabs(value+1.)<=1e-12, QString("minimum %1 instead of -1").arg(value, 0, 'f', 12).toUtf8());
+
+	SineFunction sine;
+	StelEventFinder finder(sine, tolerance);
+	QVERIFY(finder.findMaximum(0., 1., 3., &x, &value));
+	QVERIFY2(std::fabs(x-M_PI/2.)<=tolerance, QString("maximum at %1 instead of pi/2").arg(x, 0, 'f', 12).toUtf8());
+	QVERIFY2(std::fabs(value-1.)<=1e-12, QString("maximum %1 instead of 1").arg(value, 0, 'f', 12).toUtf8());
+	QVERIFY(finder.findMinimum(3., 5., 6., &x));
+	QVERIFY2(std::fabs(x-1.5*M_PI)<=tolerance, QString("minimum at %1 instead of 3pi/2").arg(x, 0, 'f', 12).toUtf8());
+	// The bracket is moved uphill from the guess until it contains the maximum
+	QVERIFY(finder.findMaximumNear(4., 0.5, 10., &x, &value));
+	QVERIFY2(std::fabs(x-M_PI/2.)<=tolerance, QString("maximum at %1 instead of pi/2").arg(x, 0, 'f', 12).toUtf8());
+	QVERIFY(!finder.findMaximumNear(4., 0.5, 1., &x));
+}
+
+void TestEventFinder::testEvaluationCount()
+{
+	SineFunction sine;
+	StelEventFinder finder(sine, 1e-9);
+	QCOMPARE(finder.getEvaluationCount(), 0);
+	double root;
+	QVERIFY(finder.findRoot(2., 4., &root));
+	const int count = finder.getEvaluationCount();
+	// Far fewer than the 31 steps of a bisection down to the tolerance
+	QVERIFY2(count>2 && count<20, QString("%1 evaluations").arg(count).toUtf8());
+
+	// The same search again is answered from the cache
+	double cachedRoot;
+	QVERIFY(finder.findRoot(2., 4., &cachedRoot));
+	QCOMPARE(cachedRoot, root);
+	QCOMPARE(finder.getEvaluationCount(), count);
+	finder.evaluate(2.);
+	finder.evaluate(4.);
+	QCOMPARE(finder.getEvaluationCount(), count);
+	finder.evaluate(10.);
+	QCOMPARE(finder.getEvaluationCount(), count+1);
+
+	// Once the cache is cleared, the function is evaluated again
+	finder.clearCache();
+	QVERIFY(finder.findRoot(2., 4., &cachedRoot));
+	QCOMPARE(cachedRoot, root);
+	QCOMPARE(finder.getEvaluationCount(), 2*count+1);
+}
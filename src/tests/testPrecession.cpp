@@ -20,6 +20,8 @@
 #include <QObject>
 #include <QtDebug>
 #include <QVariantList>
+#include <QVector>
+#include <QtConcurrent>
 #include <QtTest>
 
 #include "tests/testPrecession.hpp"
@@ -31,6 +33,20 @@ QTEST_GUILESS_MAIN(TestPrecession)
 static const double arcSec2Rad=M_PI*2.0/(360.0*3600.0);
 static const double eps0=84381.406*arcSec2Rad;
 
+// The precession and nutation angles at a date, as computed by a thread
+struct PrecessionNutationAngles
+{
+	typedef QVector<double> result_type;
+	QVector<double> operator()(const double jde) const
+	{
+		QVector<double> angles(7);
+		getPrecessionAnglesVondrak(jde, &angles[0], &angles[1], &angles[2], &angles[3]);
+		getNutationAngles(jde, &angles[4], &angles[5]);
+		angles[6]=getPrecessionAngleVondrakCurrentEpsilonA();
+		return angles;
+	}
+};
+
 void TestPrecession::initTestCase()
 {
 }
@@ -119,3 +135,26 @@ void TestPrecession::testPrecessionAnglesVondrak()
 
 	//TODO: Add more dates and verify this angle difference is limited to what we can see in Fig.12
 }
+
+// Ephemeris sessions compute precession and nutation in worker threads at other dates than the main thread.
+// The cached angles must not leak from a thread to another.
+void TestPrecession::testConcurrentAngles()
+{
+	// Dates further apart than the recomputation thresholds, within the years of the nutation model
+	QVector<double> dates;
+	for (int i=0; i<2000; ++i)
+		dates.append(2451545.0 + i*0.1);
+
+	PrecessionNutationAngles angles;
+	QVector<QVector<double> > serial;
+	foreach (double jde, dates)
+		serial.append(angles(jde));
+
+	for (int run=0; run<10; ++run)
+	{
+		const QList<QVector<double> > concurrent=QtConcurrent::blockingMapped<QList<QVector<double> > >(dates, angles);
+		QCOMPARE(concurrent.size(), serial.size());
+		for (int i=0; i<dates.size(); ++i)
+			QVERIFY2(concurrent.at(i)==serial.at(i), QString("JD %1: angles differ when computed concurrently").arg(dates.at(i), 0, 'f', 1).toUtf8());
+	}
+}
@@ -30,6 +30,7 @@ class TestPrecession : public QObject
 private slots:
 	void initTestCase();	
 	void testPrecessionAnglesVondrak(); 
+	void testConcurrentAngles();
 };
 
 #endif // _TESTPRECESSION_HPP_